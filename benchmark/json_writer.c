@@ -0,0 +1,183 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Benchmark for the json writer
+ *
+ * Renders the GET /api/v1/gpio payload for 64 GPIOs with the former
+ * sdscat chain and with the json writer.
+ */
+
+#include "compile_time.h"
+
+#include "dist/sds/sds.h"
+#include "mygpiod/lib/json_print.h"
+#include "mygpiod/lib/json_writer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * Number of GPIOs in the payload
+ */
+#define BENCH_GPIOS 64
+
+/**
+ * Default number of iterations
+ */
+#define BENCH_ITERATIONS 200000
+
+/**
+ * Expected size of a GPIO entry, same as in rest_api_gpio.c
+ */
+#define JSON_GPIO_ENTRY_LEN 96
+
+/**
+ * Synthetic GPIO
+ */
+struct t_bench_gpio {
+    unsigned gpio_nr;      //!< GPIO number
+    char name[32];         //!< GPIO name
+    const char *direction; //!< GPIO direction
+    const char *value;     //!< GPIO value
+};
+
+// private definitions
+
+static sds render_sdscat(sds buffer, const struct t_bench_gpio *gpios, unsigned len);
+static sds render_json_writer(sds buffer, const struct t_bench_gpio *gpios, unsigned len);
+static double now_us(void);
+
+// public functions
+
+/**
+ * Main function
+ * @param argc number of command line arguments
+ * @param argv command line arguments, the optional first argument is the number of iterations
+ * @return 0 on success, else 1
+ */
+int main(int argc, char **argv) {
+    unsigned long iterations = argc > 1
+        ? strtoul(argv[1], NULL, 10)
+        : BENCH_ITERATIONS;
+    if (iterations == 0) {
+        fprintf(stderr, "Invalid number of iterations\n");
+        return 1;
+    }
+    struct t_bench_gpio gpios[BENCH_GPIOS];
+    for (unsigned i = 0; i < BENCH_GPIOS; i++) {
+        gpios[i].gpio_nr = i + 1;
+        snprintf(gpios[i].name, sizeof(gpios[i].name), "GPIO \"%u\" relay", i + 1);
+        gpios[i].direction = i % 2 == 0 ? "in" : "out";
+        gpios[i].value = i % 3 == 0 ? "active" : "inactive";
+    }
+
+    // Both writers must produce the same output
+    sds expected = render_sdscat(sdsempty(), gpios, BENCH_GPIOS);
+    sds buffer = render_json_writer(sdsempty(), gpios, BENCH_GPIOS);
+    if (sdscmp(expected, buffer) != 0) {
+        fprintf(stderr, "Output differs\n%s\n%s\n", expected, buffer);
+        sdsfree(expected);
+        sdsfree(buffer);
+        return 1;
+    }
+    printf("Payload: %lu bytes, %lu iterations\n", (unsigned long)sdslen(expected), iterations);
+    sdsfree(expected);
+    sdsfree(buffer);
+
+    double start = now_us();
+    for (unsigned long i = 0; i < iterations; i++) {
+        buffer = render_sdscat(sdsempty(), gpios, BENCH_GPIOS);
+        sdsfree(buffer);
+    }
+    printf("sdscat chain:            %6.2f us\n", (now_us() - start) / (double)iterations);
+
+    start = now_us();
+    for (unsigned long i = 0; i < iterations; i++) {
+        buffer = render_json_writer(sdsempty(), gpios, BENCH_GPIOS);
+        sdsfree(buffer);
+    }
+    printf("json writer:             %6.2f us\n", (now_us() - start) / (double)iterations);
+
+    // The REST API reuses the buffer of the connection
+    buffer = sdsempty();
+    start = now_us();
+    for (unsigned long i = 0; i < iterations; i++) {
+        sdsclear(buffer);
+        buffer = render_json_writer(buffer, gpios, BENCH_GPIOS);
+    }
+    printf("json writer, reused buf: %6.2f us\n", (now_us() - start) / (double)iterations);
+    sdsfree(buffer);
+    return 0;
+}
+
+// private functions
+
+/**
+ * Renders the gpio list with the former sdscat chain
+ * @param buffer already allocated buffer to append
+ * @param gpios gpios to render
+ * @param len number of gpios
+ * @return sds pointer to buffer
+ */
+static sds render_sdscat(sds buffer, const struct t_bench_gpio *gpios, unsigned len) {
+    buffer = sdscat(buffer, "{\"data\":[");
+    for (unsigned i = 0; i < len; i++) {
+        if (i > 0) {
+            buffer = sdscatlen(buffer, ",", 1);
+        }
+        buffer = sdscatlen(buffer, "{", 1);
+        buffer = sdscatfmt(buffer, "\"gpio\":%u,", gpios[i].gpio_nr);
+        buffer = sdscat(buffer, "\"name\":");
+        buffer = sds_catjson(buffer, gpios[i].name);
+        buffer = sdscatlen(buffer, ",", 1);
+        buffer = sdscatfmt(buffer, "\"direction\":\"%s\",", gpios[i].direction);
+        buffer = sdscat(buffer, "\"value\":");
+        buffer = sds_catjson(buffer, gpios[i].value);
+        buffer = sdscatlen(buffer, "}", 1);
+    }
+    buffer = sdscatfmt(buffer, "],\"entries\":%u}", len);
+    return buffer;
+}
+
+/**
+ * Renders the gpio list with the json writer
+ * @param buffer already allocated buffer to append
+ * @param gpios gpios to render
+ * @param len number of gpios
+ * @return sds pointer to buffer
+ */
+static sds render_json_writer(sds buffer, const struct t_bench_gpio *gpios, unsigned len) {
+    struct t_json_writer w;
+    json_writer_init(&w, buffer, len * JSON_GPIO_ENTRY_LEN + 32);
+    json_writer_object_begin(&w);
+    json_writer_key(&w, "data");
+    json_writer_array_begin(&w);
+    for (unsigned i = 0; i < len; i++) {
+        json_writer_object_begin(&w);
+        json_writer_kv_uint(&w, "gpio", gpios[i].gpio_nr);
+        json_writer_kv_string(&w, "name", gpios[i].name);
+        json_writer_kv_string(&w, "direction", gpios[i].direction);
+        json_writer_kv_string(&w, "value", gpios[i].value);
+        json_writer_object_end(&w);
+    }
+    json_writer_array_end(&w);
+    json_writer_kv_uint(&w, "entries", len);
+    json_writer_object_end(&w);
+    return json_writer_finish(&w);
+}
+
+/**
+ * Returns the monotonic time in microseconds
+ * @return microseconds
+ */
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1000000.0 + (double)ts.tv_nsec / 1000.0;
+}
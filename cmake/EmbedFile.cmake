@@ -0,0 +1,25 @@
+# SPDX-License-Identifier: GPL-3.0-or-later
+# myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+# https://github.com/jcorporation/mympd
+
+# Compresses an embedded web asset and writes its ETag header
+# Called at build time with:
+#   EMBEDDED_SOURCE - absolute path of the asset
+#   EMBEDDED_OUTPUT - path of the compressed asset without the .gz suffix
+#   GZIP_BIN        - path of the gzip executable
+
+get_filename_component(EMBEDDED_NAME "${EMBEDDED_SOURCE}" NAME)
+string(MAKE_C_IDENTIFIER "${EMBEDDED_NAME}" EMBEDDED_ID)
+
+execute_process(
+  COMMAND "${GZIP_BIN}" -9 -n -c "${EMBEDDED_SOURCE}"
+  OUTPUT_FILE "${EMBEDDED_OUTPUT}.gz"
+  RESULT_VARIABLE RC_GZIP
+)
+if(RC_GZIP GREATER 0)
+  message(FATAL_ERROR "Compressing ${EMBEDDED_SOURCE} failed")
+endif()
+
+file(SHA1 "${EMBEDDED_SOURCE}" EMBEDDED_HASH)
+string(SUBSTRING "${EMBEDDED_HASH}" 0 20 EMBEDDED_ETAG)
+file(WRITE "${EMBEDDED_OUTPUT}.etag.h" "#define ${EMBEDDED_ID}_etag \"${EMBEDDED_ETAG}\"\n")
@@ -193,35 +193,35 @@ async function httpRequest(method, path, callback) {
     }
 }
 
-// Poll events
-async function pollEvents() {
-    const uri = serverUri + '/poll';
-    try {
-        response = await fetch(uri, {
-            method: 'GET',
-            mode: 'same-origin',
-            credentials: 'same-origin',
-            cache: 'no-store',
-            redirect: 'follow'
-        });
-    }
-    catch(error) {
-        console.error(error);
-        setPollError(error);
-        pollEvents();
-        return;
-    }
-    pollEvents();
-    getGPIOs();
-    // Parse event data
-    let data = null;
-    try {
-        data = await response.json();
-    }
-    catch(error) {
-        setPollError('Can not parse response from ' + uri);
-    }
+// Subscribe to the server-sent events stream.
+// The browser reconnects automatically and resumes with the Last-Event-ID header.
+function pollEvents() {
+    const uri = serverUri + '/events';
+    const eventSource = new EventSource(uri);
+    eventSource.onopen = function() {
+        setPollError('');
+    };
+    eventSource.onerror = function() {
+        setPollError('Connection to ' + uri + ' lost, reconnecting');
+    };
+    eventSource.onmessage = function(event) {
+        // Parse event data
+        let data = null;
+        try {
+            data = JSON.parse(event.data);
+        }
+        catch(error) {
+            setPollError('Can not parse event from ' + uri);
+            console.error(error);
+            return;
+        }
+        getGPIOs();
+        showEvent(data);
+    };
+}
 
+// Adds an event to the events table.
+function showEvent(data) {
     const tr = document.createElement('tr');
     if (data.event === 'input') {
         tr.appendChild(createTd(data.device));
@@ -282,5 +282,5 @@ document.getElementById('clearEvents').addEventListener('click', function(event)
 const serverUri = getUri();
 // Fetch GPIO table
 getGPIOs();
-// Long poll
+// Event stream
 pollEvents();
@@ -31,5 +31,6 @@
 #include "libmygpio_parser.h"
 #include "libmygpio_protocol.h"
 #include "libmygpio_raspberry_vcio.h"
+#include "libmygpio_stats.h"
 
 #endif
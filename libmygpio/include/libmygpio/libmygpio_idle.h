@@ -49,6 +49,11 @@ enum mygpio_event {
     MYGPIO_EVENT_GPIO_LONG_PRESS,         //!< GPIO long_press
     MYGPIO_EVENT_GPIO_LONG_PRESS_RELEASE, //!< GPIO long_press release
     MYGPIO_EVENT_INPUT,              //!< Input event
+    MYGPIO_EVENT_HTTP_DONE,          //!< HTTP action has finished
+    MYGPIO_EVENT_MPD_PLAYER,         //!< MPD player state has changed
+    MYGPIO_EVENT_MPD_MIXER,          //!< MPD volume has changed
+    MYGPIO_EVENT_SYSTEM_DONE,        //!< System action has finished
+    MYGPIO_EVENT_LUA_TIMEOUT,        //!< Lua execution was aborted
 };
 
 /**
@@ -156,6 +161,97 @@ const char *mygpio_idle_event_get_input_code(struct t_mygpio_idle_event *event);
  */
 unsigned mygpio_idle_event_get_input_value(struct t_mygpio_idle_event *event);
 
+/**
+ * Returns the URI of a finished HTTP action
+ * @param event Pointer to struct t_mygpio_idle_event.
+ * @return The URI
+ */
+const char *mygpio_idle_event_get_http_uri(struct t_mygpio_idle_event *event);
+
+/**
+ * Returns the HTTP response code of a finished HTTP action
+ * @param event Pointer to struct t_mygpio_idle_event.
+ * @return HTTP response code, 0 if the request has failed
+ */
+unsigned mygpio_idle_event_get_http_status(struct t_mygpio_idle_event *event);
+
+/**
+ * Returns the duration of a finished HTTP action
+ * @param event Pointer to struct t_mygpio_idle_event.
+ * @return Duration in milliseconds
+ */
+uint64_t mygpio_idle_event_get_http_duration_ms(struct t_mygpio_idle_event *event);
+
+/**
+ * Returns the MPD player state of a mpd_player event
+ * @param event Pointer to struct t_mygpio_idle_event.
+ * @return The player state: play, pause, stop or unknown
+ */
+const char *mygpio_idle_event_get_mpd_state(struct t_mygpio_idle_event *event);
+
+/**
+ * Returns the queue position of the current song of a mpd_player event
+ * @param event Pointer to struct t_mygpio_idle_event.
+ * @return Queue position, -1 if no song is selected
+ */
+int mygpio_idle_event_get_mpd_song_pos(struct t_mygpio_idle_event *event);
+
+/**
+ * Returns the volume of a mpd_mixer event
+ * @param event Pointer to struct t_mygpio_idle_event.
+ * @return Volume, -1 if unknown
+ */
+int mygpio_idle_event_get_mpd_volume(struct t_mygpio_idle_event *event);
+
+/**
+ * Returns the command of a finished system action
+ * @param event Pointer to struct t_mygpio_idle_event.
+ * @return The command
+ */
+const char *mygpio_idle_event_get_system_command(struct t_mygpio_idle_event *event);
+
+/**
+ * Returns the exit code of a finished system action
+ * @param event Pointer to struct t_mygpio_idle_event.
+ * @return Exit code, 128 + signal number if the process was killed, -1 if not started
+ */
+int mygpio_idle_event_get_system_exit_code(struct t_mygpio_idle_event *event);
+
+/**
+ * Returns the runtime of a finished system action
+ * @param event Pointer to struct t_mygpio_idle_event.
+ * @return Duration in milliseconds
+ */
+uint64_t mygpio_idle_event_get_system_duration_ms(struct t_mygpio_idle_event *event);
+
+/**
+ * Returns the Lua function or script of an aborted Lua execution
+ * @param event Pointer to struct t_mygpio_idle_event.
+ * @return The function or script name
+ */
+const char *mygpio_idle_event_get_lua_script(struct t_mygpio_idle_event *event);
+
+/**
+ * Returns the Lua VM type of an aborted Lua execution
+ * @param event Pointer to struct t_mygpio_idle_event.
+ * @return sync, async or co
+ */
+const char *mygpio_idle_event_get_lua_vm(struct t_mygpio_idle_event *event);
+
+/**
+ * Returns the exceeded limit of an aborted Lua execution
+ * @param event Pointer to struct t_mygpio_idle_event.
+ * @return instructions or timeout
+ */
+const char *mygpio_idle_event_get_lua_reason(struct t_mygpio_idle_event *event);
+
+/**
+ * Returns the runtime of an aborted Lua execution
+ * @param event Pointer to struct t_mygpio_idle_event.
+ * @return Duration in milliseconds
+ */
+uint64_t mygpio_idle_event_get_lua_duration_ms(struct t_mygpio_idle_event *event);
+
 /**
  * Frees the struct received by mygpio_recv_idle_event
  * @param event Pointer to struct t_mygpio_idle_event.
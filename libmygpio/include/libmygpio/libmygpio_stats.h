@@ -0,0 +1,72 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ libmygpio (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/mympd
+*/
+
+/*! \file
+ * \brief myGPIOd client library
+ *
+ * Do not include this header directly. Use libmygpio/libmygpio.h instead.
+ */
+
+#ifndef LIBMYGPIO_STATS_H
+#define LIBMYGPIO_STATS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct t_mygpio_connection;
+
+/**
+ * @defgroup libmygpio_stats Stats
+ *
+ * @brief This module provides functions for the stats protocol command.
+ *
+ * @{
+ */
+
+/**
+ * Runtime counters of myGPIOd
+ */
+struct t_mygpio_stats {
+    uint64_t uptime;          //!< Uptime in seconds
+    uint64_t events;          //!< Processed GPIO and input events
+    uint64_t actions;         //!< Dispatched actions
+    uint64_t actions_failed;  //!< Failed actions
+    uint64_t events_dropped;  //!< Events dropped for slow clients
+    uint64_t timers;          //!< Active timers
+    uint64_t fds;             //!< Open file descriptors
+    uint64_t poll_wakeups;    //!< Event loop wakeups
+    uint64_t memory;          //!< Resident memory in bytes
+};
+
+/**
+ * Requests the runtime counters.
+ * Retrieve the counters with mygpio_recv_stats and end the response with mygpio_response_end.
+ * @param connection Pointer to the connection struct returned by mygpio_connection_new.
+ * @return bool true on success, else false.
+ */
+bool mygpio_stats(struct t_mygpio_connection *connection);
+
+/**
+ * Receives the result of mygpio_stats.
+ * @param connection Pointer to the connection struct returned by mygpio_connection_new.
+ * @param stats Pointer to the struct to populate.
+ * @return bool true on success, else false.
+ */
+bool mygpio_recv_stats(struct t_mygpio_connection *connection, struct t_mygpio_stats *stats);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
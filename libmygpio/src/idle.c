@@ -38,6 +38,21 @@ enum mygpio_event mygpio_parse_event(const char *str) {
     if (strcmp(str, "gpio_input") == 0) {
         return MYGPIO_EVENT_INPUT;
     }
+    if (strcmp(str, "http_done") == 0) {
+        return MYGPIO_EVENT_HTTP_DONE;
+    }
+    if (strcmp(str, "mpd_player") == 0) {
+        return MYGPIO_EVENT_MPD_PLAYER;
+    }
+    if (strcmp(str, "mpd_mixer") == 0) {
+        return MYGPIO_EVENT_MPD_MIXER;
+    }
+    if (strcmp(str, "system_done") == 0) {
+        return MYGPIO_EVENT_SYSTEM_DONE;
+    }
+    if (strcmp(str, "lua_timeout") == 0) {
+        return MYGPIO_EVENT_LUA_TIMEOUT;
+    }
     return MYGPIO_EVENT_UNKNOWN;
 }
 
@@ -58,6 +73,16 @@ const char *mygpio_lookup_event(enum mygpio_event event) {
             return "gpio_long_press_release";
         case MYGPIO_EVENT_INPUT:
             return "input";
+        case MYGPIO_EVENT_HTTP_DONE:
+            return "http_done";
+        case MYGPIO_EVENT_MPD_PLAYER:
+            return "mpd_player";
+        case MYGPIO_EVENT_MPD_MIXER:
+            return "mpd_mixer";
+        case MYGPIO_EVENT_SYSTEM_DONE:
+            return "system_done";
+        case MYGPIO_EVENT_LUA_TIMEOUT:
+            return "lua_timeout";
         case MYGPIO_EVENT_UNKNOWN:
             return "unknown";
     }
@@ -111,6 +136,19 @@ struct t_mygpio_idle_event *mygpio_recv_idle_event(struct t_mygpio_connection *c
     char *input_event_type = NULL;
     char *input_event_code = NULL;
     unsigned input_event_value;
+    char *http_uri = NULL;
+    unsigned http_status;
+    uint64_t http_duration_ms;
+    char *mpd_state = NULL;
+    int mpd_song_pos;
+    int mpd_volume;
+    char *system_command = NULL;
+    int system_exit_code;
+    uint64_t system_duration_ms;
+    char *lua_script = NULL;
+    char *lua_vm = NULL;
+    char *lua_reason = NULL;
+    uint64_t lua_duration_ms;
 
     if ((pair = mygpio_recv_pair_name(connection, "event")) == NULL) {
         return NULL;
@@ -162,6 +200,114 @@ struct t_mygpio_idle_event *mygpio_recv_idle_event(struct t_mygpio_connection *c
         }
         mygpio_free_pair(pair);
     }
+    else if (event == MYGPIO_EVENT_HTTP_DONE) {
+        if ((pair = mygpio_recv_pair_name(connection, "uri")) == NULL) {
+            return NULL;
+        }
+        http_uri = strdup(pair->value);
+        mygpio_free_pair(pair);
+
+        if ((pair = mygpio_recv_pair_name(connection, "status")) == NULL ||
+            mygpio_parse_uint(pair->value, &http_status, NULL, 0, UINT_MAX) == false)
+        {
+            free(http_uri);
+            mygpio_free_pair(pair);
+            return NULL;
+        }
+        mygpio_free_pair(pair);
+
+        if ((pair = mygpio_recv_pair_name(connection, "duration_ms")) == NULL ||
+            mygpio_parse_uint64(pair->value, &http_duration_ms, NULL, 0, UINT64_MAX) == false)
+        {
+            free(http_uri);
+            mygpio_free_pair(pair);
+            return NULL;
+        }
+        mygpio_free_pair(pair);
+    }
+    else if (event == MYGPIO_EVENT_MPD_PLAYER) {
+        if ((pair = mygpio_recv_pair_name(connection, "state")) == NULL) {
+            return NULL;
+        }
+        mpd_state = strdup(pair->value);
+        mygpio_free_pair(pair);
+
+        if ((pair = mygpio_recv_pair_name(connection, "song_pos")) == NULL ||
+            mygpio_parse_int(pair->value, &mpd_song_pos, NULL, -1, INT_MAX) == false)
+        {
+            free(mpd_state);
+            mygpio_free_pair(pair);
+            return NULL;
+        }
+        mygpio_free_pair(pair);
+    }
+    else if (event == MYGPIO_EVENT_MPD_MIXER) {
+        if ((pair = mygpio_recv_pair_name(connection, "volume")) == NULL ||
+            mygpio_parse_int(pair->value, &mpd_volume, NULL, -1, 100) == false)
+        {
+            mygpio_free_pair(pair);
+            return NULL;
+        }
+        mygpio_free_pair(pair);
+    }
+    else if (event == MYGPIO_EVENT_SYSTEM_DONE) {
+        if ((pair = mygpio_recv_pair_name(connection, "command")) == NULL) {
+            return NULL;
+        }
+        system_command = strdup(pair->value);
+        mygpio_free_pair(pair);
+
+        if ((pair = mygpio_recv_pair_name(connection, "exit_code")) == NULL ||
+            mygpio_parse_int(pair->value, &system_exit_code, NULL, -1, INT_MAX) == false)
+        {
+            free(system_command);
+            mygpio_free_pair(pair);
+            return NULL;
+        }
+        mygpio_free_pair(pair);
+
+        if ((pair = mygpio_recv_pair_name(connection, "duration_ms")) == NULL ||
+            mygpio_parse_uint64(pair->value, &system_duration_ms, NULL, 0, UINT64_MAX) == false)
+        {
+            free(system_command);
+            mygpio_free_pair(pair);
+            return NULL;
+        }
+        mygpio_free_pair(pair);
+    }
+    else if (event == MYGPIO_EVENT_LUA_TIMEOUT) {
+        if ((pair = mygpio_recv_pair_name(connection, "script")) == NULL) {
+            return NULL;
+        }
+        lua_script = strdup(pair->value);
+        mygpio_free_pair(pair);
+
+        if ((pair = mygpio_recv_pair_name(connection, "vm")) == NULL) {
+            free(lua_script);
+            return NULL;
+        }
+        lua_vm = strdup(pair->value);
+        mygpio_free_pair(pair);
+
+        if ((pair = mygpio_recv_pair_name(connection, "reason")) == NULL) {
+            free(lua_script);
+            free(lua_vm);
+            return NULL;
+        }
+        lua_reason = strdup(pair->value);
+        mygpio_free_pair(pair);
+
+        if ((pair = mygpio_recv_pair_name(connection, "duration_ms")) == NULL ||
+            mygpio_parse_uint64(pair->value, &lua_duration_ms, NULL, 0, UINT64_MAX) == false)
+        {
+            free(lua_script);
+            free(lua_vm);
+            free(lua_reason);
+            mygpio_free_pair(pair);
+            return NULL;
+        }
+        mygpio_free_pair(pair);
+    }
     else {
         if ((pair = mygpio_recv_pair_name(connection, "gpio")) == NULL) {
             return NULL;
@@ -183,6 +329,29 @@ struct t_mygpio_idle_event *mygpio_recv_idle_event(struct t_mygpio_connection *c
         gpio_event->input_event_code = input_event_code;
         gpio_event->input_event_value = input_event_value;
     }
+    else if (event == MYGPIO_EVENT_HTTP_DONE) {
+        gpio_event->http_uri = http_uri;
+        gpio_event->http_status = http_status;
+        gpio_event->http_duration_ms = http_duration_ms;
+    }
+    else if (event == MYGPIO_EVENT_MPD_PLAYER) {
+        gpio_event->mpd_state = mpd_state;
+        gpio_event->mpd_song_pos = mpd_song_pos;
+    }
+    else if (event == MYGPIO_EVENT_MPD_MIXER) {
+        gpio_event->mpd_volume = mpd_volume;
+    }
+    else if (event == MYGPIO_EVENT_SYSTEM_DONE) {
+        gpio_event->system_command = system_command;
+        gpio_event->system_exit_code = system_exit_code;
+        gpio_event->system_duration_ms = system_duration_ms;
+    }
+    else if (event == MYGPIO_EVENT_LUA_TIMEOUT) {
+        gpio_event->lua_script = lua_script;
+        gpio_event->lua_vm = lua_vm;
+        gpio_event->lua_reason = lua_reason;
+        gpio_event->lua_duration_ms = lua_duration_ms;
+    }
     else {
         gpio_event->gpio = gpio;
     }
@@ -195,7 +364,12 @@ struct t_mygpio_idle_event *mygpio_recv_idle_event(struct t_mygpio_connection *c
  * @return GPIO number.
  */
 unsigned mygpio_idle_event_get_gpio(struct t_mygpio_idle_event *event) {
-    assert(event->event != MYGPIO_EVENT_INPUT);
+    assert(event->event != MYGPIO_EVENT_INPUT &&
+           event->event != MYGPIO_EVENT_HTTP_DONE &&
+           event->event != MYGPIO_EVENT_MPD_PLAYER &&
+           event->event != MYGPIO_EVENT_MPD_MIXER &&
+           event->event != MYGPIO_EVENT_SYSTEM_DONE &&
+           event->event != MYGPIO_EVENT_LUA_TIMEOUT);
     return event->gpio;
 }
 
@@ -266,6 +440,136 @@ unsigned mygpio_idle_event_get_input_value(struct t_mygpio_idle_event *event) {
     return event->input_event_value;
 }
 
+/**
+ * Returns the URI of a finished HTTP action
+ * @param event Pointer to struct t_mygpio_idle_event.
+ * @return The URI
+ */
+const char *mygpio_idle_event_get_http_uri(struct t_mygpio_idle_event *event) {
+    assert(event->event == MYGPIO_EVENT_HTTP_DONE);
+    return event->http_uri;
+}
+
+/**
+ * Returns the HTTP response code of a finished HTTP action
+ * @param event Pointer to struct t_mygpio_idle_event.
+ * @return HTTP response code, 0 if the request has failed
+ */
+unsigned mygpio_idle_event_get_http_status(struct t_mygpio_idle_event *event) {
+    assert(event->event == MYGPIO_EVENT_HTTP_DONE);
+    return event->http_status;
+}
+
+/**
+ * Returns the duration of a finished HTTP action
+ * @param event Pointer to struct t_mygpio_idle_event.
+ * @return Duration in milliseconds
+ */
+uint64_t mygpio_idle_event_get_http_duration_ms(struct t_mygpio_idle_event *event) {
+    assert(event->event == MYGPIO_EVENT_HTTP_DONE);
+    return event->http_duration_ms;
+}
+
+/**
+ * Returns the MPD player state of a mpd_player event
+ * @param event Pointer to struct t_mygpio_idle_event.
+ * @return The player state: play, pause, stop or unknown
+ */
+const char *mygpio_idle_event_get_mpd_state(struct t_mygpio_idle_event *event) {
+    assert(event->event == MYGPIO_EVENT_MPD_PLAYER);
+    return event->mpd_state;
+}
+
+/**
+ * Returns the queue position of the current song of a mpd_player event
+ * @param event Pointer to struct t_mygpio_idle_event.
+ * @return Queue position, -1 if no song is selected
+ */
+int mygpio_idle_event_get_mpd_song_pos(struct t_mygpio_idle_event *event) {
+    assert(event->event == MYGPIO_EVENT_MPD_PLAYER);
+    return event->mpd_song_pos;
+}
+
+/**
+ * Returns the volume of a mpd_mixer event
+ * @param event Pointer to struct t_mygpio_idle_event.
+ * @return Volume, -1 if unknown
+ */
+int mygpio_idle_event_get_mpd_volume(struct t_mygpio_idle_event *event) {
+    assert(event->event == MYGPIO_EVENT_MPD_MIXER);
+    return event->mpd_volume;
+}
+
+/**
+ * Returns the command of a finished system action
+ * @param event Pointer to struct t_mygpio_idle_event.
+ * @return The command
+ */
+const char *mygpio_idle_event_get_system_command(struct t_mygpio_idle_event *event) {
+    assert(event->event == MYGPIO_EVENT_SYSTEM_DONE);
+    return event->system_command;
+}
+
+/**
+ * Returns the exit code of a finished system action
+ * @param event Pointer to struct t_mygpio_idle_event.
+ * @return Exit code, 128 + signal number if the process was killed, -1 if not started
+ */
+int mygpio_idle_event_get_system_exit_code(struct t_mygpio_idle_event *event) {
+    assert(event->event == MYGPIO_EVENT_SYSTEM_DONE);
+    return event->system_exit_code;
+}
+
+/**
+ * Returns the runtime of a finished system action
+ * @param event Pointer to struct t_mygpio_idle_event.
+ * @return Duration in milliseconds
+ */
+uint64_t mygpio_idle_event_get_system_duration_ms(struct t_mygpio_idle_event *event) {
+    assert(event->event == MYGPIO_EVENT_SYSTEM_DONE);
+    return event->system_duration_ms;
+}
+
+/**
+ * Returns the Lua function or script of an aborted Lua execution
+ * @param event Pointer to struct t_mygpio_idle_event.
+ * @return The function or script name
+ */
+const char *mygpio_idle_event_get_lua_script(struct t_mygpio_idle_event *event) {
+    assert(event->event == MYGPIO_EVENT_LUA_TIMEOUT);
+    return event->lua_script;
+}
+
+/**
+ * Returns the Lua VM type of an aborted Lua execution
+ * @param event Pointer to struct t_mygpio_idle_event.
+ * @return sync, async or co
+ */
+const char *mygpio_idle_event_get_lua_vm(struct t_mygpio_idle_event *event) {
+    assert(event->event == MYGPIO_EVENT_LUA_TIMEOUT);
+    return event->lua_vm;
+}
+
+/**
+ * Returns the exceeded limit of an aborted Lua execution
+ * @param event Pointer to struct t_mygpio_idle_event.
+ * @return instructions or timeout
+ */
+const char *mygpio_idle_event_get_lua_reason(struct t_mygpio_idle_event *event) {
+    assert(event->event == MYGPIO_EVENT_LUA_TIMEOUT);
+    return event->lua_reason;
+}
+
+/**
+ * Returns the runtime of an aborted Lua execution
+ * @param event Pointer to struct t_mygpio_idle_event.
+ * @return Duration in milliseconds
+ */
+uint64_t mygpio_idle_event_get_lua_duration_ms(struct t_mygpio_idle_event *event) {
+    assert(event->event == MYGPIO_EVENT_LUA_TIMEOUT);
+    return event->lua_duration_ms;
+}
+
 /**
  * Frees the idle event struct
  * @param event struct to free
@@ -282,5 +586,19 @@ void mygpio_free_idle_event(struct t_mygpio_idle_event *event) {
             free((char *)event->input_event_code);
         }
     }
+    else if (event->event == MYGPIO_EVENT_HTTP_DONE) {
+        free((char *)event->http_uri);
+    }
+    else if (event->event == MYGPIO_EVENT_MPD_PLAYER) {
+        free((char *)event->mpd_state);
+    }
+    else if (event->event == MYGPIO_EVENT_SYSTEM_DONE) {
+        free((char *)event->system_command);
+    }
+    else if (event->event == MYGPIO_EVENT_LUA_TIMEOUT) {
+        free((char *)event->lua_script);
+        free((char *)event->lua_vm);
+        free((char *)event->lua_reason);
+    }
     free(event);
 }
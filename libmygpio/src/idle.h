@@ -22,6 +22,23 @@ struct t_mygpio_idle_event {
     const char *input_event_type;    //!< Input event type
     const char *input_event_code;    //!< Input event code
     unsigned input_event_value;      //!< INput event value
+    // HTTP client event data
+    const char *http_uri;            //!< URI of the finished request
+    unsigned http_status;            //!< HTTP response code
+    uint64_t http_duration_ms;       //!< Duration of the request
+    // MPD event data
+    const char *mpd_state;           //!< MPD player state
+    int mpd_song_pos;                //!< Queue position of the current song
+    int mpd_volume;                  //!< MPD volume
+    // System action event data
+    const char *system_command;      //!< Command of the finished process
+    int system_exit_code;            //!< Exit code of the process
+    uint64_t system_duration_ms;     //!< Runtime of the process
+    // Lua timeout event data
+    const char *lua_script;          //!< Aborted Lua function or script
+    const char *lua_vm;              //!< Lua VM type
+    const char *lua_reason;          //!< Exceeded limit
+    uint64_t lua_duration_ms;        //!< Runtime until the abort
 };
 
 #endif
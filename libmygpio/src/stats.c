@@ -0,0 +1,67 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ libmygpio (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/mympd
+*/
+
+#include "compile_time.h"
+
+#include "libmygpio/include/libmygpio/libmygpio_stats.h"
+#include "libmygpio/src/pair.h"
+#include "libmygpio/src/protocol.h"
+#include "mygpio-common/util.h"
+
+#include <stddef.h>
+
+// private definitions
+
+static bool recv_uint64(struct t_mygpio_connection *connection, const char *name, uint64_t *value);
+
+// public functions
+
+/**
+ * Send the stats command and receives the status
+ * @param connection connection struct
+ * @return true on success, else false
+ */
+bool mygpio_stats(struct t_mygpio_connection *connection) {
+    return libmygpio_send_line(connection, "stats") &&
+        libmygpio_recv_response_status(connection);
+}
+
+/**
+ * Receives the result of mygpio_stats
+ * @param connection connection struct
+ * @param stats struct to populate
+ * @return true on success, else false
+ */
+bool mygpio_recv_stats(struct t_mygpio_connection *connection, struct t_mygpio_stats *stats) {
+    return recv_uint64(connection, "uptime", &stats->uptime) &&
+        recv_uint64(connection, "events", &stats->events) &&
+        recv_uint64(connection, "actions", &stats->actions) &&
+        recv_uint64(connection, "actions_failed", &stats->actions_failed) &&
+        recv_uint64(connection, "events_dropped", &stats->events_dropped) &&
+        recv_uint64(connection, "timers", &stats->timers) &&
+        recv_uint64(connection, "fds", &stats->fds) &&
+        recv_uint64(connection, "poll_wakeups", &stats->poll_wakeups) &&
+        recv_uint64(connection, "memory", &stats->memory);
+}
+
+// private functions
+
+/**
+ * Receives a pair and parses its value as uint64_t
+ * @param connection connection struct
+ * @param name expected name of the pair
+ * @param value pointer to the value to set
+ * @return true on success, else false
+ */
+static bool recv_uint64(struct t_mygpio_connection *connection, const char *name, uint64_t *value) {
+    struct t_mygpio_pair *pair;
+    if ((pair = mygpio_recv_pair_name(connection, name)) == NULL) {
+        return false;
+    }
+    bool rc = mygpio_parse_uint64(pair->value, value, NULL, 0, UINT64_MAX);
+    mygpio_free_pair(pair);
+    return rc;
+}
@@ -54,6 +54,44 @@ int handle_idle(int argc, char **argv, int option_index, struct t_mygpio_connect
                     (unsigned long long)mygpio_idle_event_get_timestamp_ms(event)
                 );
             }
+            else if (mygpio_idle_event_get_event(event) == MYGPIO_EVENT_HTTP_DONE) {
+                printf("HTTP %s, status %u, duration %llu ms, timestamp %llu ms\n",
+                    mygpio_idle_event_get_http_uri(event),
+                    mygpio_idle_event_get_http_status(event),
+                    (unsigned long long)mygpio_idle_event_get_http_duration_ms(event),
+                    (unsigned long long)mygpio_idle_event_get_timestamp_ms(event)
+                );
+            }
+            else if (mygpio_idle_event_get_event(event) == MYGPIO_EVENT_MPD_PLAYER) {
+                printf("MPD player %s, song %d, timestamp %llu ms\n",
+                    mygpio_idle_event_get_mpd_state(event),
+                    mygpio_idle_event_get_mpd_song_pos(event),
+                    (unsigned long long)mygpio_idle_event_get_timestamp_ms(event)
+                );
+            }
+            else if (mygpio_idle_event_get_event(event) == MYGPIO_EVENT_SYSTEM_DONE) {
+                printf("System %s, exit code %d, duration %llu ms, timestamp %llu ms\n",
+                    mygpio_idle_event_get_system_command(event),
+                    mygpio_idle_event_get_system_exit_code(event),
+                    (unsigned long long)mygpio_idle_event_get_system_duration_ms(event),
+                    (unsigned long long)mygpio_idle_event_get_timestamp_ms(event)
+                );
+            }
+            else if (mygpio_idle_event_get_event(event) == MYGPIO_EVENT_LUA_TIMEOUT) {
+                printf("Lua %s (%s) aborted: %s, duration %llu ms, timestamp %llu ms\n",
+                    mygpio_idle_event_get_lua_script(event),
+                    mygpio_idle_event_get_lua_vm(event),
+                    mygpio_idle_event_get_lua_reason(event),
+                    (unsigned long long)mygpio_idle_event_get_lua_duration_ms(event),
+                    (unsigned long long)mygpio_idle_event_get_timestamp_ms(event)
+                );
+            }
+            else if (mygpio_idle_event_get_event(event) == MYGPIO_EVENT_MPD_MIXER) {
+                printf("MPD volume %d, timestamp %llu ms\n",
+                    mygpio_idle_event_get_mpd_volume(event),
+                    (unsigned long long)mygpio_idle_event_get_timestamp_ms(event)
+                );
+            }
             else {
                 printf("GPIO %u, event %s, timestamp %llu ms\n",
                     mygpio_idle_event_get_gpio(event),
@@ -16,6 +16,7 @@
 #include "mygpioc/idle.h"
 #include "mygpioc/options.h"
 #include "mygpioc/raspberry_vcio.h"
+#include "mygpioc/stats.h"
 #include "mygpioc/util.h"
 
 #include <stdio.h>
@@ -55,6 +56,7 @@ static struct t_commands commands[] = {
     { "vcioclock", handle_vcioclock, 0, 0},
     { "vciothrottled", handle_vciothrottled, 0, 0},
     { "hook", handle_hook, 1, 1},
+    { "stats", handle_stats, 0, 0},
     { NULL, NULL, 0, 0}
 };
 
@@ -52,6 +52,7 @@ void print_usage(void) {
                     "  hook <name>                              Trigger a hook\n"
                     "  gpiotoggle <number>                      Toggles the value of an output gpio\n"
                     "  idle [<timeout>]                         Waits for idle events, timeout is in milliseconds\n"
+                    "  stats                                    Prints the runtime counters of myGPIOd\n"
                     "  vciotemp                                 Gets the temperature from /dev/vcio\n"
                     "  vciovolts                                Gets the core voltage from /dev/vcio\n"
                     "  vcioclock                                Gets the core clock from /dev/vcio\n"
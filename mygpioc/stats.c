@@ -0,0 +1,54 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/mympd
+*/
+
+/*! \file
+ * \brief Stats command
+ */
+
+#include "compile_time.h"
+#include "mygpioc/stats.h"
+
+#include "libmygpio/include/libmygpio/libmygpio.h"
+
+#include "mygpioc/util.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * Prints the runtime counters of myGPIOd
+ * @param argc argument count
+ * @param argv argument list
+ * @param option_index parsed option index
+ * @param conn connection struct
+ * @return 0 on success, else 1
+ */
+int handle_stats(int argc, char **argv, int option_index, struct t_mygpio_connection *conn) {
+    (void)argc;
+    (void)argv;
+    (void)option_index;
+    verbose_printf("Sending stats");
+    struct t_mygpio_stats stats;
+    if (mygpio_stats(conn) == true &&
+        mygpio_recv_stats(conn, &stats) == true)
+    {
+        printf("Uptime: %" PRIu64 " s\n", stats.uptime);
+        printf("Events: %" PRIu64 "\n", stats.events);
+        printf("Actions: %" PRIu64 "\n", stats.actions);
+        printf("Failed actions: %" PRIu64 "\n", stats.actions_failed);
+        printf("Dropped events: %" PRIu64 "\n", stats.events_dropped);
+        printf("Active timers: %" PRIu64 "\n", stats.timers);
+        printf("Open fds: %" PRIu64 "\n", stats.fds);
+        printf("Poll wakeups: %" PRIu64 "\n", stats.poll_wakeups);
+        printf("Memory: %" PRIu64 " bytes\n", stats.memory);
+        mygpio_response_end(conn);
+        return EXIT_SUCCESS;
+    }
+    fprintf(stderr, "Error: %s\n", mygpio_connection_get_error(conn));
+    mygpio_response_end(conn);
+    return EXIT_FAILURE;
+}
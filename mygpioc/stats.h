@@ -0,0 +1,18 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/mympd
+*/
+
+/*! \file
+ * \brief Stats command
+ */
+
+#ifndef MYGPIOC_STATS_H
+#define MYGPIOC_STATS_H
+
+struct t_mygpio_connection;
+
+int handle_stats(int argc, char **argv, int option_index, struct t_mygpio_connection *conn);
+
+#endif
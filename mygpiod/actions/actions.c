@@ -69,6 +69,8 @@ const char *lookup_action(enum mygpiod_actions action) {
                 return "lua";
             case MYGPIOD_ACTION_LUA_ASYNC:
                 return "lua_async";
+            case MYGPIOD_ACTION_LUA_CO:
+                return "lua_co";
         #endif
         case MYGPIOD_ACTION_NONE:
             return "none";
@@ -118,6 +120,9 @@ enum mygpiod_actions parse_action(const char *str) {
         if (strcasecmp(str, "lua_async") == 0) {
             return MYGPIOD_ACTION_LUA_ASYNC;
         }
+        if (strcasecmp(str, "lua_co") == 0) {
+            return MYGPIOD_ACTION_LUA_CO;
+        }
     #endif
     if (strcasecmp(str, "none") == 0) {
         return MYGPIOD_ACTION_NONE;
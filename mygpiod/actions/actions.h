@@ -34,6 +34,7 @@ enum mygpiod_actions {
     #ifdef MYGPIOD_ENABLE_ACTION_LUA
         MYGPIOD_ACTION_LUA,       //!< Executes a lua function in main thread
         MYGPIOD_ACTION_LUA_ASYNC, //!< Executes a lua function in a new thread
+        MYGPIOD_ACTION_LUA_CO,    //!< Executes a lua script as coroutine in the main thread
     #endif
     MYGPIOD_ACTION_NONE,          //!< None action
 };
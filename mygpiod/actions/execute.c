@@ -16,6 +16,7 @@
 #include "mygpiod/actions/gpio.h"
 #include "mygpiod/actions/system.h"
 #include "mygpiod/lib/log.h"
+#include "mygpiod/lib/metrics.h"
 #include "mygpiod/lib/sds_extras.h"
 
 #ifdef MYGPIOD_ENABLE_ACTION_MPC
@@ -29,6 +30,7 @@
 
 #ifdef MYGPIOD_ENABLE_ACTION_LUA
     #include "mygpiod/actions/lua_async.h"
+    #include "mygpiod/actions/lua_co.h"
     #include "mygpiod/actions/lua_sync.h"
 #endif
 
@@ -58,42 +60,46 @@ void action_execute(struct t_config *config, struct t_action *action) {
     sds cmd = sdsjoinsds(action->options, action->options_count, " ", 1);
     MYGPIOD_LOG_INFO("Executing %s: \"%s\"", lookup_action(action->action), cmd);
     FREE_SDS(cmd);
+    bool rc = false;
     switch(action->action) {
         case MYGPIOD_ACTION_SYSTEM:
             if (action->options_count != 1) {
                 MYGPIOD_LOG_ERROR("Invalid number of arguments: %d", action->options_count);
-                return;
+                break;
             }
-            action_system_async(action->options[0]);
+            rc = action_system_async(action->options[0]);
             break;
         case MYGPIOD_ACTION_GPIO_SET:
-            action_gpioset(config, action);
+            rc = action_gpioset(config, action);
             break;
         case MYGPIOD_ACTION_GPIO_TOGGLE:
-            action_gpiotoggle(config, action);
+            rc = action_gpiotoggle(config, action);
             break;
         case MYGPIOD_ACTION_GPIO_BLINK:
-            action_gpioblink(config, action);
+            rc = action_gpioblink(config, action);
             break;
     #ifdef MYGPIOD_ENABLE_ACTION_MPC
         case MYGPIOD_ACTION_MPC:
-            action_mpc(config, action);
+            rc = action_mpc(config, action);
             break;
     #endif
     #ifdef MYGPIOD_ENABLE_ACTION_HTTP
         case MYGPIOD_ACTION_HTTP:
-            action_http_async(action);
+            rc = action_http_async(action);
             break;
         case MYGPIOD_ACTION_MYMPD:
-            action_mympd_async(action);
+            rc = action_mympd_async(action);
             break;
     #endif
     #ifdef MYGPIOD_ENABLE_ACTION_LUA
         case MYGPIOD_ACTION_LUA:
-            action_lua_sync(config, action);
+            rc = action_lua_sync(config, action);
             break;
         case MYGPIOD_ACTION_LUA_ASYNC:
-            action_lua_async(config, action);
+            rc = action_lua_async(config, action);
+            break;
+        case MYGPIOD_ACTION_LUA_CO:
+            rc = action_lua_co(config, action);
             break;
     #endif
         case MYGPIOD_ACTION_NONE:
@@ -101,6 +107,10 @@ void action_execute(struct t_config *config, struct t_action *action) {
             break;
         case MYGPIOD_ACTION_UNKNOWN:
             MYGPIOD_LOG_ERROR("Invalid action");
-            break;
+            return;
+    }
+    METRICS_INC(metrics.actions_executed[action->action]);
+    if (rc == false) {
+        METRICS_INC(metrics.actions_failed[action->action]);
     }
 }
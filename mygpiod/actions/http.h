@@ -12,10 +12,13 @@
 #define MYGPIOD_ACTIONS_HTTP_H
 
 #include "mygpiod/actions/actions.h"
+#include "mygpiod/lib/http_client.h"
 
 #include <stdbool.h>
 
 bool action_http_async(struct t_action *action);
 bool action_http2_async(const char *method, const char *uri, const char *content_type, const char *postdata);
+bool action_http_callback(const char *method, const char *uri, const char *content_type, const char *postdata,
+        http_request_done_cb done_cb, void *done_data);
 
 #endif
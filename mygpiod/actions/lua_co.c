@@ -0,0 +1,35 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Lua coroutine actions
+ */
+
+#include "compile_time.h"
+#include "mygpiod/actions/lua_co.h"
+
+#include "mygpiod/config/lua_async.h"
+#include "mygpiod/lua/co/scheduler.h"
+
+// Public functions
+
+/**
+ * Starts a Lua script from the lua_async directory as coroutine
+ * in the event loop.
+ * @param config Pointer to config
+ * @param action Action struct
+ * @returns true on success, else false
+ */
+bool action_lua_co(struct t_config *config, struct t_action *action) {
+    if (action->options_count == 0) {
+        return false;
+    }
+    struct t_lua_script *script = lua_async_get_script(&config->lua_async_scripts, action->options[0]);
+    if (script == NULL) {
+        return false;
+    }
+    return lua_co_start(script);
+}
@@ -0,0 +1,21 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Lua coroutine actions
+ */
+
+#ifndef MYGPIOD_ACTIONS_LUA_CO_H
+#define MYGPIOD_ACTIONS_LUA_CO_H
+
+#include "mygpiod/config/config.h"
+#include "mygpiod/actions/actions.h"
+
+#include <stdbool.h>
+
+bool action_lua_co(struct t_config *config, struct t_action *action);
+
+#endif
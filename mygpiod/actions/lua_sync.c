@@ -12,17 +12,15 @@
 #include "mygpiod/actions/lua_sync.h"
 
 #include "mygpiod/lib/log.h"
-#include "mygpiod/lua/util.h"
-
-#include <lauxlib.h>
-#include <lua.h>
-#include <lualib.h>
+#include "mygpiod/lua/sync/luavm.h"
+#include "mygpiod/lua/sync/thread.h"
 
 /**
  * Calls a lua function
  * @param config Pointer to config
  * @param action Action struct
- * @returns true on success, else false
+ * @returns true on success, else false.
+ *          With lua_thread true if the call was queued, the Lua thread counts failed calls.
  */
 bool action_lua_sync(struct t_config *config, struct t_action *action) {
     if (config->lua_vm == NULL) {
@@ -32,23 +30,9 @@ bool action_lua_sync(struct t_config *config, struct t_action *action) {
     if (action->options_count == 0) {
         return false;
     }
-    // Push the function on the top of the lua stack
-    int rv = lua_getglobal(config->lua_vm, action->options[0]);
-    if (rv != 6) {
-        clean_up_lua_stack(config->lua_vm);
-        MYGPIOD_LOG_ERROR("\"%s\" is not a valid Lua function", action->options[0]);
-        return false;
-    }
-    // Push the arguments on the top of the lua stack
-    for (int i = 1; i < action->options_count; i++) {
-        lua_pushstring(config->lua_vm, action->options[i]);
-    }
-    // Call the function with arguments, returning no result
-    lua_call(config->lua_vm, action->options_count -1, 0);
-    if (lua_gettop(config->lua_vm) == 1) {
-        //return value on stack
-        MYGPIOD_LOG_ERROR("%s", lua_tostring(config->lua_vm, 1));
-        lua_pop(config->lua_vm, 1);
+    if (config->lua_thread == true) {
+        // The call is executed in order by the Lua thread
+        return lua_sync_thread_push(action);
     }
-    return true;
+    return luavm_sync_call(config, action);
 }
@@ -11,36 +11,15 @@
 #include "compile_time.h"
 #include "mygpiod/actions/system.h"
 
-#include "mygpiod/lib/log.h"
-
-#include <errno.h>
-#include <stdlib.h>
-#include <unistd.h>
+#include "mygpiod/lib/process.h"
 
 /**
- * Runs an executable or script in a new process
+ * Runs an executable or script in a new process.
+ * The command is sent to the executor process, it reaps the child and
+ * the event loop emits a system_done event for the returned result.
  * @param cmd command to execute
  * @returns true on success, else false
  */
 bool action_system_async(const char *cmd) {
-    errno = 0;
-    int pid = fork();
-    if (pid == 0) {
-        // This is the child process
-        errno = 0;
-        execl(cmd, cmd, (char *)NULL);
-        // successful execl call does not return
-        MYGPIOD_LOG_ERROR("Failure executing system command \"%s\"", cmd);
-        MYGPIOD_LOG_ERRNO(errno);
-        exit(EXIT_FAILURE);
-    }
-
-    // Main process
-    if (pid == -1) {
-        MYGPIOD_LOG_ERROR("Forking failed");
-        MYGPIOD_LOG_ERRNO(errno);
-        return false;
-    }
-    MYGPIOD_LOG_DEBUG("Forked process with pid %d", pid);
-    return true;
+    return process_spawn(cmd);
 }
@@ -26,9 +26,15 @@
 #include "mygpiod/lib/list.h"
 #include "mygpiod/lib/log.h"
 #include "mygpiod/lib/mem.h"
+#ifdef MYGPIOD_ENABLE_ACTION_MPC
+    #include "mygpiod/lib/mpd_client.h"
+#endif
 #include "mygpiod/lib/sds_extras.h"
 #ifdef MYGPIOD_ENABLE_HTTPD
+    #include "mygpiod/server_http/cmd_queue.h"
+    #include "mygpiod/server_http/sse.h"
     #include "mygpiod/server_http/util.h"
+    #include "mygpiod/server_http/websocket.h"
 #endif
 #include "mygpiod/server_socket/socket.h"
 
@@ -83,9 +89,10 @@ void config_clear(struct t_config *config) {
     FREE_SDS(config->chip_path);
     FREE_SDS(config->dir_gpio);
     FREE_SDS(config->socket_path);
+    FREE_SDS(config->tcp_ip);
     #ifdef MYGPIOD_ENABLE_ACTION_MPC
-        if (config->mpd_conn != NULL) {
-            mpd_connection_free(config->mpd_conn);
+        if (config->mpd_client != NULL) {
+            mpd_client_free(config->mpd_client);
         }
     #endif
     #ifdef MYGPIOD_ENABLE_ACTION_LUA
@@ -93,6 +100,7 @@ void config_clear(struct t_config *config) {
             lua_close(config->lua_vm);
         }
         FREE_SDS(config->lua_file);
+        FREE_SDS(config->lua_cache_dir);
         // Async Lua scripts
         FREE_SDS(config->lua_async_dir);
         list_clear(&config->lua_async_scripts, lua_async_node_data_clear);
@@ -106,9 +114,20 @@ void config_clear(struct t_config *config) {
                 MHD_resume_connection(request_data->connection);
                 current = current->next;
             }
+            sse_resume_all(config);
+            websocket_close_all(config);
+            if (config->http_cmd_queue != NULL) {
+                // Closes the queued WebSocket connections
+                http_cmd_discard(config->http_cmd_queue);
+            }
             MHD_stop_daemon(config->httpd);
             list_clear(&config->http_suspended, NULL);
         }
+        if (config->http_cmd_queue != NULL) {
+            http_cmd_queue_free(config->http_cmd_queue);
+        }
+        list_clear(&config->sse_clients, NULL);
+        list_clear(&config->sse_history, sse_history_clear);
     #endif
     list_clear(&config->input_devices, input_node_data_clear);
     list_clear(&config->timer_definitions, timer_node_definition_data_clear);
@@ -134,20 +153,33 @@ static struct t_config *config_new(void) {
     config->chip = NULL;
     config->loglevel = loglevel;
     config->syslog = CFG_SYSLOG;
+    config->system_timeout_s = CFG_SYSTEM_TIMEOUT;
     config->dir_gpio = sdsnew(CFG_GPIO_DIR);
     config->socket_path = sdsnew(CFG_SOCKET_PATH);
     config->socket_timeout_s = CFG_SOCKET_TIMEOUT;
     config->client_id = 0;
+    config->tcp_ip = sdsnew(CFG_TCP_IP);
+    config->tcp_port = CFG_TCP_PORT;
     list_init(&config->clients);
     #ifdef MYGPIOD_ENABLE_ACTION_MPC
-        config->mpd_conn = NULL;
+        config->mpd_state = CFG_MPD_STATE;
+        config->mpd_client = NULL;
     #endif
     #ifdef MYGPIOD_ENABLE_ACTION_LUA
         config->lua_vm = NULL;
         config->lua_file = sdsempty();
+        config->lua_cache_dir = sdsnew(CFG_LUA_CACHE_DIR);
+        config->lua_precompile = CFG_LUA_PRECOMPILE;
+        config->lua_timeout = CFG_LUA_TIMEOUT;
+        config->lua_instructions = CFG_LUA_INSTRUCTIONS;
+        config->lua_thread = CFG_LUA_THREAD;
         // Async Lua scripts
         config->lua_async_dir = sdsnew(CFG_LUA_ASYNC_DIR);
         list_init(&config->lua_async_scripts);
+        config->lua_async_workers = CFG_LUA_ASYNC_WORKERS;
+        config->lua_async_queue = CFG_LUA_ASYNC_QUEUE;
+        config->lua_async_overflow = LUA_ASYNC_OVERFLOW_DROP;
+        config->lua_async_timeout = CFG_LUA_ASYNC_TIMEOUT;
     #endif
 
     list_init(&config->input_devices);
@@ -157,9 +189,15 @@ static struct t_config *config_new(void) {
     #ifdef MYGPIOD_ENABLE_HTTPD
         config->http_ip = sdsnew(CFG_HTTP_IP);
         config->http_port = CFG_HTTP_PORT;
+        config->http_threads = CFG_HTTP_THREADS;
+        config->http_cmd_queue = NULL;
         config->httpd = NULL;
         list_init(&config->http_suspended);
         config->http_conn_id = 0;
+        list_init(&config->sse_clients);
+        list_init(&config->sse_history);
+        config->sse_event_id = 0;
+        list_init(&config->ws_clients);
     #endif
     return config;
 }
@@ -273,6 +311,26 @@ static bool parse_config_file_kv(sds key, sds value, struct t_config *config) {
         }
         return false;
     }
+    if (strcmp(key, "system_timeout") == 0) {
+        if (mygpio_parse_int(value, &config->system_timeout_s, NULL, 0, SYSTEM_TIMEOUT_MAX) == true) {
+            MYGPIOD_LOG_DEBUG("Setting system_timeout to \"%d\" seconds", config->system_timeout_s);
+            return true;
+        }
+        return false;
+    }
+    if (strcmp(key, "tcp_ip") == 0) {
+        sdsclear(config->tcp_ip);
+        config->tcp_ip = sdscatsds(config->tcp_ip, value);
+        MYGPIOD_LOG_DEBUG("Setting tcp_ip to \"%s\"", config->tcp_ip);
+        return true;
+    }
+    if (strcmp(key, "tcp_port") == 0) {
+        if (mygpio_parse_uint(value, &config->tcp_port, NULL, 0, 65535) == true) {
+            MYGPIOD_LOG_DEBUG("Setting tcp_port to \"%u\"", config->tcp_port);
+            return true;
+        }
+        return false;
+    }
     #ifdef MYGPIOD_ENABLE_HTTPD
         if (strcmp(key, "http_ip") == 0) {
             sdsclear(config->http_ip);
@@ -287,18 +345,92 @@ static bool parse_config_file_kv(sds key, sds value, struct t_config *config) {
             }
             return false;
         }
+        if (strcmp(key, "http_threads") == 0) {
+            if (mygpio_parse_uint(value, &config->http_threads, NULL, 0, HTTP_THREADS_MAX) == true) {
+                MYGPIOD_LOG_DEBUG("Setting http_threads to \"%u\"", config->http_threads);
+                return true;
+            }
+            return false;
+        }
+    #endif
+    #ifdef MYGPIOD_ENABLE_ACTION_MPC
+        if (strcmp(key, "mpd_state") == 0) {
+            config->mpd_state = mygpio_parse_bool(value);
+            MYGPIOD_LOG_DEBUG("Setting mpd_state to \"%s\"", mygpio_bool_to_str(config->mpd_state));
+            return errno == 0 ? true : false;
+        }
     #endif
     #ifdef MYGPIOD_ENABLE_ACTION_LUA
         if (strcmp(key, "lua_file") == 0) {
             config->lua_file = sdscatsds(config->lua_file, value);
             return true;
         }
+        if (strcmp(key, "lua_cache_dir") == 0) {
+            sdsclear(config->lua_cache_dir);
+            config->lua_cache_dir = sdscat(config->lua_cache_dir, value);
+            MYGPIOD_LOG_DEBUG("Setting lua_cache_dir to \"%s\"", config->lua_cache_dir);
+            return true;
+        }
+        if (strcmp(key, "lua_precompile") == 0) {
+            config->lua_precompile = mygpio_parse_bool(value);
+            MYGPIOD_LOG_DEBUG("Setting lua_precompile to \"%s\"", mygpio_bool_to_str(config->lua_precompile));
+            return errno == 0 ? true : false;
+        }
+        if (strcmp(key, "lua_timeout") == 0) {
+            if (mygpio_parse_uint(value, &config->lua_timeout, NULL, 0, LUA_TIMEOUT_MAX) == true) {
+                MYGPIOD_LOG_DEBUG("Setting lua_timeout to \"%u\"", config->lua_timeout);
+                return true;
+            }
+            return false;
+        }
+        if (strcmp(key, "lua_instructions") == 0) {
+            if (mygpio_parse_uint(value, &config->lua_instructions, NULL, 0, LUA_INSTRUCTIONS_MAX) == true) {
+                MYGPIOD_LOG_DEBUG("Setting lua_instructions to \"%u\"", config->lua_instructions);
+                return true;
+            }
+            return false;
+        }
+        if (strcmp(key, "lua_thread") == 0) {
+            config->lua_thread = mygpio_parse_bool(value);
+            MYGPIOD_LOG_DEBUG("Setting lua_thread to \"%s\"", mygpio_bool_to_str(config->lua_thread));
+            return errno == 0 ? true : false;
+        }
         if (strcmp(key, "lua_async_dir") == 0) {
             sdsclear(config->lua_async_dir);
             config->lua_async_dir = sdscat(config->lua_async_dir, value);
             MYGPIOD_LOG_DEBUG("Setting lua_async_dir to \"%s\"", config->lua_async_dir);
             return true;
         }
+        if (strcmp(key, "lua_async_workers") == 0) {
+            if (mygpio_parse_uint(value, &config->lua_async_workers, NULL, 1, LUA_ASYNC_WORKERS_MAX) == true) {
+                MYGPIOD_LOG_DEBUG("Setting lua_async_workers to \"%u\"", config->lua_async_workers);
+                return true;
+            }
+            return false;
+        }
+        if (strcmp(key, "lua_async_queue") == 0) {
+            if (mygpio_parse_uint(value, &config->lua_async_queue, NULL, 1, LUA_ASYNC_QUEUE_MAX) == true) {
+                MYGPIOD_LOG_DEBUG("Setting lua_async_queue to \"%u\"", config->lua_async_queue);
+                return true;
+            }
+            return false;
+        }
+        if (strcmp(key, "lua_async_overflow") == 0) {
+            config->lua_async_overflow = lua_async_parse_overflow(value);
+            if (config->lua_async_overflow == LUA_ASYNC_OVERFLOW_UNKNOWN) {
+                MYGPIOD_LOG_WARN("Invalid lua_async_overflow \"%s\"", value);
+                return false;
+            }
+            MYGPIOD_LOG_DEBUG("Setting lua_async_overflow to \"%s\"", lua_async_lookup_overflow(config->lua_async_overflow));
+            return true;
+        }
+        if (strcmp(key, "lua_async_timeout") == 0) {
+            if (mygpio_parse_uint(value, &config->lua_async_timeout, NULL, 0, LUA_TIMEOUT_MAX) == true) {
+                MYGPIOD_LOG_DEBUG("Setting lua_async_timeout to \"%u\"", config->lua_async_timeout);
+                return true;
+            }
+            return false;
+        }
     #endif
     if (strcmp(key, "input_ev") == 0) {
         if (parse_input_ev(&config->input_devices, value) == true) {
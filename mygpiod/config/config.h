@@ -16,11 +16,12 @@
 
 #include <stdbool.h>
 
-#ifdef MYGPIOD_ENABLE_ACTION_MPC
-    #include <mpd/client.h>
+#ifdef MYGPIOD_ENABLE_HTTPD
+    #include <stdatomic.h>
 #endif
 
 #ifdef MYGPIOD_ENABLE_ACTION_LUA
+    #include "mygpiod/config/lua_async.h"
     #include <lua.h>
 #endif
 
@@ -32,20 +33,29 @@ struct t_config {
     int loglevel;                         //!< The loglevel
     bool syslog;                          //!< Enable syslog?
     int signal_fd;                        //!< File descriptor for the signal handler
+    int system_timeout_s;                 //!< Timeout for system actions in seconds, 0 = disabled
 
     // Socket Server
     sds socket_path;                      //!< Server socket filepath
     int socket_timeout_s;                 //!< Socket timeout in seconds
     struct t_list clients;                //!< List of connected socket clients
     unsigned client_id;                   //!< Uniq client id
+    sds tcp_ip;                           //!< TCP listening ip
+    unsigned tcp_port;                    //!< TCP listening port, 0 = disabled
 
     #ifdef MYGPIOD_ENABLE_HTTPD
         // HTTP Server
         struct MHD_Daemon *httpd;         //!< HTTPD object
         sds http_ip;                      //!< HTTPD listening ip
         unsigned http_port;               //!< HTTPD listening port
+        unsigned http_threads;            //!< Number of HTTP threads, 0 = run in the event loop
+        struct t_http_cmd_queue *http_cmd_queue;  //!< Commands from the HTTP threads to the event loop
         struct t_list http_suspended;     //!< List of suspended HTTP connections
-        unsigned http_conn_id;            //!< Uniq HTTP connection id
+        atomic_uint http_conn_id;         //!< Uniq HTTP connection id
+        struct t_list sse_clients;        //!< List of connected server-sent events clients
+        struct t_list sse_history;        //!< Last events for Last-Event-ID resume
+        unsigned sse_event_id;            //!< Id of the last event
+        struct t_list ws_clients;         //!< List of connected WebSocket clients
     #endif
 
     // GPIO
@@ -66,7 +76,8 @@ struct t_config {
 
     // MPD
     #ifdef MYGPIOD_ENABLE_ACTION_MPC
-        struct mpd_connection *mpd_conn;  //!< MPD connection
+        bool mpd_state;                   //!< Keep a mirror of the MPD state
+        struct t_mpd_client *mpd_client;  //!< Persistent MPD connection
     #endif
 
     // Lua
@@ -74,10 +85,19 @@ struct t_config {
         // Lua in the main thread
         sds lua_file;                     //!< Lua file to load
         lua_State* lua_vm;                //!< Lua VM
+        sds lua_cache_dir;                //!< Folder for the bytecode cache, empty to disable
+        bool lua_precompile;              //!< Compile the async Lua scripts on startup
+        unsigned lua_timeout;             //!< Wall-clock limit in ms for Lua executions in the main thread, 0 to disable
+        unsigned lua_instructions;        //!< Instruction budget for each Lua execution, 0 to disable
+        bool lua_thread;                  //!< Execute the lua actions in a dedicated thread
 
         // Async Lua scripts
         sds lua_async_dir;                //!< Folder for async Lua scripts
         struct t_list lua_async_scripts;  //!< List of async Lua scripts
+        unsigned lua_async_workers;       //!< Number of worker threads for async Lua scripts
+        unsigned lua_async_queue;         //!< Size of the job queue for async Lua scripts
+        enum lua_async_overflow lua_async_overflow;  //!< Behaviour if the job queue is full
+        unsigned lua_async_timeout;       //!< Wall-clock limit in ms for async Lua scripts, 0 to disable
     #endif
 };
 
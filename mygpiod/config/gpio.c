@@ -259,6 +259,7 @@ struct t_gpio_in_data *gpio_in_data_new(void) {
     data->request = NULL;
     data->event_buffer = NULL;
     data->name = sdsempty();
+    data->edges = 0;
     return data;
 }
 
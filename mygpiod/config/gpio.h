@@ -16,6 +16,7 @@
 
 #include <gpiod.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 /**
  * Config and state data for an input gpio
@@ -40,6 +41,7 @@ struct t_gpio_in_data {
     struct gpiod_edge_event_buffer *event_buffer;  //!< buffer for gpio events
     struct gpiod_line_request *request;            //!< gpio line request struct
     sds name;                                      //!< gpio name
+    uint64_t edges;                                //!< number of edge events
 };
 
 /**
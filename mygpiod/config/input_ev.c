@@ -72,8 +72,13 @@ bool parse_input_ev(struct t_list *input_devices, sds config_value) {
     // Check if device is already added, else add if
     struct t_input_device *device = input_device_get_by_name(input_devices, device_str);
     if (device == NULL) {
-        device = new_device(device_str);
-        list_push(input_devices, 0, device);
+        if (input_devices->length < INPUT_DEVICES_MAX) {
+            device = new_device(device_str);
+            list_push(input_devices, 0, device);
+        }
+        else {
+            MYGPIOD_LOG_WARN("Too many input devices configured");
+        }
     }
     // Free all parsed strings
     FREE_SDS(device_str);
@@ -82,7 +87,8 @@ bool parse_input_ev(struct t_list *input_devices, sds config_value) {
     FREE_SDS(value_str);
     FREE_SDS(action_str);
     // Check if all strings could be parsed
-    if (type == EV_MAX ||
+    if (device == NULL ||
+        type == EV_MAX ||
         code == KEY_MAX ||
         value_parsed == false ||
         action == MYGPIOD_ACTION_UNKNOWN)
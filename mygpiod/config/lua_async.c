@@ -92,6 +92,61 @@ void lua_async_node_data_clear(struct t_list_node *node) {
     lua_async_data_clear(data);
 }
 
+/**
+ * Parses the overflow behaviour
+ * @param str String to parse
+ * @return enum lua_async_overflow
+ */
+enum lua_async_overflow lua_async_parse_overflow(const char *str) {
+    if (strcmp(str, "drop") == 0) {
+        return LUA_ASYNC_OVERFLOW_DROP;
+    }
+    if (strcmp(str, "coalesce") == 0) {
+        return LUA_ASYNC_OVERFLOW_COALESCE;
+    }
+    if (strcmp(str, "block") == 0) {
+        return LUA_ASYNC_OVERFLOW_BLOCK;
+    }
+    return LUA_ASYNC_OVERFLOW_UNKNOWN;
+}
+
+/**
+ * Returns the overflow behaviour as string
+ * @param overflow Overflow behaviour
+ * @return Name of the overflow behaviour
+ */
+const char *lua_async_lookup_overflow(enum lua_async_overflow overflow) {
+    switch(overflow) {
+        case LUA_ASYNC_OVERFLOW_DROP:
+            return "drop";
+        case LUA_ASYNC_OVERFLOW_COALESCE:
+            return "coalesce";
+        case LUA_ASYNC_OVERFLOW_BLOCK:
+            return "block";
+        case LUA_ASYNC_OVERFLOW_UNKNOWN:
+            break;
+    }
+    return "unknown";
+}
+
+/**
+ * Gets a script by name
+ * @param lua_async_scripts Pointer to list of async Lua scripts
+ * @param name Script name
+ * @return struct t_lua_script* or NULL if not found
+ */
+struct t_lua_script *lua_async_get_script(struct t_list *lua_async_scripts, const char *name) {
+    struct t_list_node *current = lua_async_scripts->head;
+    while (current != NULL) {
+        struct t_lua_script *script = (struct t_lua_script *)current->data;
+        if (strcmp(script->name, name) == 0) {
+            return script;
+        }
+        current = current->next;
+    }
+    return NULL;
+}
+
 // Private functions
 
 /**
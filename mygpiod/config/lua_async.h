@@ -17,6 +17,16 @@
 
 #include <stdbool.h>
 
+/**
+ * Behaviour if the job queue for async Lua scripts is full
+ */
+enum lua_async_overflow {
+    LUA_ASYNC_OVERFLOW_UNKNOWN = -1,  //!< Invalid value
+    LUA_ASYNC_OVERFLOW_DROP,          //!< Drop the new job
+    LUA_ASYNC_OVERFLOW_COALESCE,      //!< Queue at most one job per script, drop the new job if full
+    LUA_ASYNC_OVERFLOW_BLOCK          //!< Wait in the event loop until a job was started
+};
+
 /**
  * Config data for hooks
  */
@@ -29,5 +39,8 @@ struct t_lua_script {
 bool lua_async_read_scripts(struct t_list *lua_async_scripts, sds config_value);
 void lua_async_data_clear(struct t_lua_script *data);
 void lua_async_node_data_clear(struct t_list_node *node);
+enum lua_async_overflow lua_async_parse_overflow(const char *str);
+const char *lua_async_lookup_overflow(enum lua_async_overflow overflow);
+struct t_lua_script *lua_async_get_script(struct t_list *lua_async_scripts, const char *name);
 
 #endif
@@ -65,6 +65,11 @@ bool parse_timer_ev(struct t_list *timer_definitions, sds config_value) {
         parsed = false;
     }
 
+    if (timer_definitions->length == TIMER_EV_MAX) {
+        MYGPIOD_LOG_WARN("Too many timer events configured");
+        parsed = false;
+    }
+
     enum mygpiod_actions action = parse_action(action_str);
 
     // Free all parsed strings
@@ -12,14 +12,27 @@
 #include "mygpiod/event_loop/event_loop.h"
 
 #include "mygpiod/config/gpio.h"
+#include "mygpiod/event_loop/signal_handler.h"
 #include "mygpiod/gpio/event.h"
 #include "mygpiod/gpio/timer.h"
 #include "mygpiod/input_ev/event.h"
+#ifdef MYGPIOD_ENABLE_ACTION_HTTP
+    #include "mygpiod/lib/http_multi.h"
+#endif
 #include "mygpiod/lib/list.h"
 #include "mygpiod/lib/log.h"
+#ifdef MYGPIOD_ENABLE_ACTION_MPC
+    #include "mygpiod/lib/mpd_client.h"
+#endif
+#include "mygpiod/lib/process.h"
 #include "mygpiod/lib/timer.h"
 #ifdef MYGPIOD_ENABLE_ACTION_LUA
     #include "mygpiod/lua/async/queue_msg.h"
+    #include "mygpiod/lua/co/scheduler.h"
+#endif
+#ifdef MYGPIOD_ENABLE_HTTPD
+    #include "mygpiod/server_http/cmd_queue.h"
+    #include "mygpiod/server_http/websocket.h"
 #endif
 #include "mygpiod/server_socket/socket.h"
 #include "mygpiod/timer_ev/event.h"
@@ -50,6 +63,8 @@ const char *lookup_pfd_type(enum pfd_types type) {
             return "signal";
         case PFD_TYPE_CONNECT:
             return "server socket";
+        case PFD_TYPE_CONNECT_TCP:
+            return "tcp server socket";
         case PFD_TYPE_CLIENT:
             return "client socket";
         case PFD_TYPE_CLIENT_TIMEOUT:
@@ -57,14 +72,34 @@ const char *lookup_pfd_type(enum pfd_types type) {
     #ifdef MYGPIOD_ENABLE_HTTPD
         case PFD_TYPE_HTTPD:
             return "httpd";
+        case PFD_TYPE_HTTPD_CMD:
+            return "httpd_cmd";
+        case PFD_TYPE_WEBSOCKET:
+            return "websocket";
     #endif
         case PFD_TYPE_INPUT:
             return "input";
         case PFD_TYPE_TIMER_EV:
             return "timer_ev";
+        case PFD_TYPE_EXECUTOR:
+            return "executor";
     #ifdef MYGPIOD_ENABLE_ACTION_LUA
         case PFD_TYPE_LUA_ASYNC:
             return "lua_async";
+        case PFD_TYPE_LUA_CO_TIMER:
+            return "lua_co_timer";
+    #endif
+    #ifdef MYGPIOD_ENABLE_ACTION_HTTP
+        case PFD_TYPE_HTTP_CLIENT:
+            return "http_client";
+        case PFD_TYPE_HTTP_CLIENT_TIMER:
+            return "http_client_timer";
+    #endif
+    #ifdef MYGPIOD_ENABLE_ACTION_MPC
+        case PFD_TYPE_MPD_CLIENT:
+            return "mpd_client";
+        case PFD_TYPE_MPD_CLIENT_TIMER:
+            return "mpd_client_timer";
     #endif
     }
     return "unknown";
@@ -143,6 +178,50 @@ void event_add_client_fds(struct t_config *config, struct t_poll_fds *poll_fds)
     }
 }
 
+#ifdef MYGPIOD_ENABLE_HTTPD
+/**
+ * Adds the WebSocket client fds to the poll_fds
+ * @param config pointer to config
+ * @param poll_fds t_poll_fds struct to populate
+ */
+void event_add_websocket_fds(struct t_config *config, struct t_poll_fds *poll_fds) {
+    struct t_list_node *current = config->ws_clients.head;
+    while (current != NULL) {
+        struct t_ws_client *data = (struct t_ws_client *)current->data;
+        event_poll_fd_add(poll_fds, data->fd, PFD_TYPE_WEBSOCKET, data->events);
+        current = current->next;
+    }
+}
+#endif
+
+#ifdef MYGPIOD_ENABLE_ACTION_HTTP
+/**
+ * Adds the sockets of the running HTTP client requests to the poll_fds
+ * @param poll_fds t_poll_fds struct to populate
+ */
+void event_add_http_client_fds(struct t_poll_fds *poll_fds) {
+    struct t_list_node *current = http_multi_sockets()->head;
+    while (current != NULL) {
+        struct t_http_socket *data = (struct t_http_socket *)current->data;
+        event_poll_fd_add(poll_fds, (int)current->id, PFD_TYPE_HTTP_CLIENT, data->events);
+        current = current->next;
+    }
+}
+#endif
+
+#ifdef MYGPIOD_ENABLE_ACTION_MPC
+/**
+ * Adds the MPD client socket to the poll_fds
+ * @param config pointer to config
+ * @param poll_fds t_poll_fds struct to populate
+ */
+void event_add_mpd_client_fds(struct t_config *config, struct t_poll_fds *poll_fds) {
+    if (config->mpd_client->fd > -1) {
+        event_poll_fd_add(poll_fds, config->mpd_client->fd, PFD_TYPE_MPD_CLIENT, config->mpd_client->events);
+    }
+}
+#endif
+
 /**
  * Closes an open file descriptor.
  * Checks if it is open and sets it to -1.
@@ -181,9 +260,12 @@ bool event_read_delegate(struct t_config *config, struct t_poll_fds *poll_fds) {
                     }
                     return true;
                 case PFD_TYPE_SIGNAL:
-                    return false;
+                    return signal_handle(&poll_fds->fd[i].fd);
                 case PFD_TYPE_CONNECT:
-                    server_client_connection_accept(config, &poll_fds->fd[i].fd);
+                    server_client_connection_accept(config, &poll_fds->fd[i].fd, false);
+                    return true;
+                case PFD_TYPE_CONNECT_TCP:
+                    server_client_connection_accept(config, &poll_fds->fd[i].fd, true);
                     return true;
                 case PFD_TYPE_CLIENT:
                     server_client_connection_handle(config, &poll_fds->fd[i]);
@@ -195,6 +277,12 @@ bool event_read_delegate(struct t_config *config, struct t_poll_fds *poll_fds) {
                 case PFD_TYPE_HTTPD:
                     // MHD is called in each poll loop iteration, no need to do it here explicitly
                     return true;
+                case PFD_TYPE_HTTPD_CMD:
+                    http_cmd_handle(config, &poll_fds->fd[i].fd);
+                    return true;
+                case PFD_TYPE_WEBSOCKET:
+                    websocket_client_handle(config, &poll_fds->fd[i]);
+                    return true;
             #endif
                 case PFD_TYPE_INPUT:
                     input_ev_handle_event(config, &poll_fds->fd[i].fd);
@@ -202,10 +290,32 @@ bool event_read_delegate(struct t_config *config, struct t_poll_fds *poll_fds) {
                 case PFD_TYPE_TIMER_EV:
                     timer_ev_handle_event(config, &poll_fds->fd[i].fd);
                     return true;
+                case PFD_TYPE_EXECUTOR:
+                    process_handle_msg(config, &poll_fds->fd[i]);
+                    return true;
             #ifdef MYGPIOD_ENABLE_ACTION_LUA
                 case PFD_TYPE_LUA_ASYNC:
                     lua_async_handle_msg(&poll_fds->fd[i].fd);
                     return true;
+                case PFD_TYPE_LUA_CO_TIMER:
+                    lua_co_handle_timer(&poll_fds->fd[i].fd);
+                    return true;
+            #endif
+            #ifdef MYGPIOD_ENABLE_ACTION_HTTP
+                case PFD_TYPE_HTTP_CLIENT:
+                    http_multi_handle_socket(config, &poll_fds->fd[i]);
+                    return true;
+                case PFD_TYPE_HTTP_CLIENT_TIMER:
+                    http_multi_handle_timer(config, &poll_fds->fd[i].fd);
+                    return true;
+            #endif
+            #ifdef MYGPIOD_ENABLE_ACTION_MPC
+                case PFD_TYPE_MPD_CLIENT:
+                    mpd_client_handle_socket(config->mpd_client, &poll_fds->fd[i]);
+                    return true;
+                case PFD_TYPE_MPD_CLIENT_TIMER:
+                    mpd_client_handle_timer(config->mpd_client, &poll_fds->fd[i].fd);
+                    return true;
             #endif
             }
         }
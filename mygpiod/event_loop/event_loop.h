@@ -28,22 +28,80 @@ enum pfd_types {
     PFD_TYPE_GPIO_OUT_TIMER,
     PFD_TYPE_SIGNAL,
     PFD_TYPE_CONNECT,
+    PFD_TYPE_CONNECT_TCP,
     PFD_TYPE_CLIENT,
     PFD_TYPE_CLIENT_TIMEOUT,
     #ifdef MYGPIOD_ENABLE_HTTPD
         PFD_TYPE_HTTPD,
+        PFD_TYPE_HTTPD_CMD,
+        PFD_TYPE_WEBSOCKET,
     #endif
     PFD_TYPE_INPUT,
     PFD_TYPE_TIMER_EV,
+    PFD_TYPE_EXECUTOR,
     #ifdef MYGPIOD_ENABLE_ACTION_LUA
         PFD_TYPE_LUA_ASYNC,
+        PFD_TYPE_LUA_CO_TIMER,
+    #endif
+    #ifdef MYGPIOD_ENABLE_ACTION_HTTP
+        PFD_TYPE_HTTP_CLIENT,
+        PFD_TYPE_HTTP_CLIENT_TIMER,
+    #endif
+    #ifdef MYGPIOD_ENABLE_ACTION_MPC
+        PFD_TYPE_MPD_CLIENT,
+        PFD_TYPE_MPD_CLIENT_TIMER,
     #endif
 };
 
+/**
+ * Fixed fds to poll
+ */
+#define MAX_FDS_SIGNAL 1        //!< Signal fd
+#define MAX_FDS_SOCKET 1        //!< Unix socket listener
+#define MAX_FDS_TCP 1           //!< TCP listener for the socket protocol
+#define MAX_FDS_EXECUTOR 1      //!< Socket to the executor process
+#ifdef MYGPIOD_ENABLE_HTTPD
+    #define MAX_FDS_HTTPD 1     //!< MHD epoll fd
+    #define MAX_FDS_HTTPD_CMD 1 //!< HTTP command queue eventfd
+#else
+    #define MAX_FDS_HTTPD 0
+    #define MAX_FDS_HTTPD_CMD 0
+#endif
+#define MAX_FDS_FIXED (MAX_FDS_SIGNAL + MAX_FDS_SOCKET + MAX_FDS_TCP + MAX_FDS_EXECUTOR + MAX_FDS_HTTPD + MAX_FDS_HTTPD_CMD)
+
+/**
+ * Fds per configured or connected object
+ */
+#define MAX_FDS_GPIO (GPIOS_MAX * 2)                        //!< Line request and timer per GPIO
+#define MAX_FDS_CLIENT (CLIENT_CONNECTIONS_MAX * 2)         //!< Socket and timeout timer per socket client
+#ifdef MYGPIOD_ENABLE_HTTPD
+    #define MAX_FDS_WEBSOCKET CLIENT_CONNECTIONS_MAX        //!< Socket per WebSocket client
+#else
+    #define MAX_FDS_WEBSOCKET 0
+#endif
+#define MAX_FDS_INPUT INPUT_DEVICES_MAX                     //!< Input devices
+#define MAX_FDS_TIMER_EV TIMER_EV_MAX                       //!< Timer events
+#ifdef MYGPIOD_ENABLE_ACTION_HTTP
+    #define MAX_FDS_HTTP_CLIENT ((HTTP_CLIENT_PENDING_MAX * 2) + 1)
+#else
+    #define MAX_FDS_HTTP_CLIENT 0
+#endif
+#ifdef MYGPIOD_ENABLE_ACTION_MPC
+    #define MAX_FDS_MPD_CLIENT 2
+#else
+    #define MAX_FDS_MPD_CLIENT 0
+#endif
+#ifdef MYGPIOD_ENABLE_ACTION_LUA
+    #define MAX_FDS_LUA 2
+#else
+    #define MAX_FDS_LUA 0
+#endif
+
 /**
  * Maximum number off fds to poll
  */
-#define MAX_FDS ((GPIOS_MAX * 2) + (CLIENT_CONNECTIONS_MAX * 2) + 1)
+#define MAX_FDS (MAX_FDS_FIXED + MAX_FDS_GPIO + MAX_FDS_CLIENT + MAX_FDS_WEBSOCKET + MAX_FDS_INPUT + MAX_FDS_TIMER_EV + \
+    MAX_FDS_HTTP_CLIENT + MAX_FDS_MPD_CLIENT + MAX_FDS_LUA)
 
 /**
  * Struct to hold poll fd data
@@ -58,6 +116,15 @@ bool event_poll_fd_add(struct t_poll_fds *poll_fds, int fd, enum pfd_types pfd_t
 void event_add_gpio_in_timer_fds(struct t_config *config, struct t_poll_fds *poll_fds);
 void event_add_gpio_out_timer_fds(struct t_config *config, struct t_poll_fds *poll_fds);
 void event_add_client_fds(struct t_config *config, struct t_poll_fds *poll_fds);
+#ifdef MYGPIOD_ENABLE_HTTPD
+    void event_add_websocket_fds(struct t_config *config, struct t_poll_fds *poll_fds);
+#endif
+#ifdef MYGPIOD_ENABLE_ACTION_HTTP
+    void event_add_http_client_fds(struct t_poll_fds *poll_fds);
+#endif
+#ifdef MYGPIOD_ENABLE_ACTION_MPC
+    void event_add_mpd_client_fds(struct t_config *config, struct t_poll_fds *poll_fds);
+#endif
 void close_fd(int *fd);
 bool event_read_delegate(struct t_config *config, struct t_poll_fds *poll_fds);
 const char *lookup_pfd_type(enum pfd_types type);
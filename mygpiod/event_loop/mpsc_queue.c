@@ -0,0 +1,87 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Lock-free multi producer single consumer queue
+ *
+ * Intrusive queue after Dmitry Vyukov. A push is one atomic exchange
+ * and one store, producers never wait for each other or the consumer.
+ */
+
+#include "compile_time.h"
+#include "mygpiod/event_loop/mpsc_queue.h"
+
+#include <stddef.h>
+
+// public functions
+
+/**
+ * Initializes an empty queue
+ * @param queue Queue to initialize
+ */
+void mpsc_queue_init(struct t_mpsc_queue *queue) {
+    atomic_init(&queue->stub.next, NULL);
+    atomic_init(&queue->head, &queue->stub);
+    queue->tail = &queue->stub;
+}
+
+/**
+ * Appends a node, can be called from any thread
+ * @param queue Queue
+ * @param node Node to append
+ */
+void mpsc_queue_push(struct t_mpsc_queue *queue, struct t_mpsc_node *node) {
+    atomic_store_explicit(&node->next, NULL, memory_order_relaxed);
+    struct t_mpsc_node *prev = atomic_exchange_explicit(&queue->head, node, memory_order_acq_rel);
+    // The node is not visible to the consumer until it is linked
+    atomic_store_explicit(&prev->next, node, memory_order_release);
+}
+
+/**
+ * Removes the first node, must only be called from the consumer thread.
+ * Returns NULL if the queue is empty or a concurrent push is not linked yet,
+ * use mpsc_queue_is_empty to distinguish both cases.
+ * @param queue Queue
+ * @return The first node or NULL
+ */
+struct t_mpsc_node *mpsc_queue_pop(struct t_mpsc_queue *queue) {
+    struct t_mpsc_node *tail = queue->tail;
+    struct t_mpsc_node *next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if (tail == &queue->stub) {
+        if (next == NULL) {
+            return NULL;
+        }
+        queue->tail = next;
+        tail = next;
+        next = atomic_load_explicit(&next->next, memory_order_acquire);
+    }
+    if (next != NULL) {
+        queue->tail = next;
+        return tail;
+    }
+    if (tail != atomic_load_explicit(&queue->head, memory_order_acquire)) {
+        // A producer has swapped the head but not linked the node yet
+        return NULL;
+    }
+    // Last node, push the stub behind it to detach it
+    mpsc_queue_push(queue, &queue->stub);
+    next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if (next != NULL) {
+        queue->tail = next;
+        return tail;
+    }
+    return NULL;
+}
+
+/**
+ * Checks if all pushed nodes are consumed, must only be called from the consumer thread
+ * @param queue Queue
+ * @return true if the queue is empty, else false
+ */
+bool mpsc_queue_is_empty(struct t_mpsc_queue *queue) {
+    return queue->tail == &queue->stub &&
+        atomic_load_explicit(&queue->head, memory_order_acquire) == &queue->stub;
+}
@@ -0,0 +1,39 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Lock-free multi producer single consumer queue
+ */
+
+#ifndef MYGPIOD_MPSC_QUEUE_H
+#define MYGPIOD_MPSC_QUEUE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+/**
+ * Queue node, embed it in the struct to enqueue
+ */
+struct t_mpsc_node {
+    _Atomic(struct t_mpsc_node *) next;  //!< Next node
+};
+
+/**
+ * Intrusive lock-free queue.
+ * Any thread can push, only one thread is allowed to pop.
+ */
+struct t_mpsc_queue {
+    _Atomic(struct t_mpsc_node *) head;  //!< Last pushed node, producer side
+    struct t_mpsc_node *tail;            //!< Next node to pop, consumer side
+    struct t_mpsc_node stub;             //!< Placeholder node that keeps the queue non-empty
+};
+
+void mpsc_queue_init(struct t_mpsc_queue *queue);
+void mpsc_queue_push(struct t_mpsc_queue *queue, struct t_mpsc_node *node);
+struct t_mpsc_node *mpsc_queue_pop(struct t_mpsc_queue *queue);
+bool mpsc_queue_is_empty(struct t_mpsc_queue *queue);
+
+#endif
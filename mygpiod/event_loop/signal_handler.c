@@ -12,14 +12,18 @@
 #include "mygpiod/event_loop/signal_handler.h"
 
 #include "mygpiod/lib/log.h"
+#include "mygpiod/lib/process.h"
 
 #include <errno.h>
 #include <signal.h>
 #include <string.h>
 #include <sys/signalfd.h>
+#include <unistd.h>
 
 /**
  * Creates a signalfd to exit on SIGTERM and SIGINT
+ * and to reap the executor on SIGCHLD.
+ * Must be called before any thread is created.
  * @return the created signal fd
  */
 int make_signalfd(void) {
@@ -27,6 +31,7 @@ int make_signalfd(void) {
     sigemptyset(&sigmask);
     sigaddset(&sigmask, SIGTERM);
     sigaddset(&sigmask, SIGINT);
+    sigaddset(&sigmask, SIGCHLD);
 
     errno = 0;
     int rv = sigprocmask(SIG_BLOCK, &sigmask, NULL);
@@ -46,3 +51,31 @@ int make_signalfd(void) {
 
     return sigfd;
 }
+
+/**
+ * Reads the pending signals from the signalfd
+ * @param fd pointer to the signal fd
+ * @return true, false to exit the event loop
+ */
+bool signal_handle(int *fd) {
+    struct signalfd_siginfo info;
+    bool reap = false;
+    ssize_t rc;
+    while ((rc = read(*fd, &info, sizeof(info))) == (ssize_t)sizeof(info)) {
+        if (info.ssi_signo != SIGCHLD) {
+            MYGPIOD_LOG_DEBUG("Received signal %u", info.ssi_signo);
+            return false;
+        }
+        reap = true;
+    }
+    if (rc == -1 &&
+        errno != EAGAIN)
+    {
+        MYGPIOD_LOG_ERROR("Error reading the signalfd");
+        MYGPIOD_LOG_ERRNO(errno);
+    }
+    if (reap == true) {
+        process_reap();
+    }
+    return true;
+}
@@ -11,6 +11,9 @@
 #ifndef MYGPIOD_SIGNAL_HANDLER_H
 #define MYGPIOD_SIGNAL_HANDLER_H
 
+#include <stdbool.h>
+
 int make_signalfd(void);
+bool signal_handle(int *fd);
 
 #endif
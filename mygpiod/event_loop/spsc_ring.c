@@ -0,0 +1,137 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Lock-free single producer single consumer ring buffer
+ *
+ * Head and tail are free running counters, the slot is the counter masked
+ * with the size. A push or pop is one acquire load and one release store.
+ * The consumer sleeps on a futex, the producer wakes it only if it has
+ * announced that it waits.
+ */
+
+#include "compile_time.h"
+#include "mygpiod/event_loop/spsc_ring.h"
+
+#include "mygpiod/lib/log.h"
+#include "mygpiod/lib/mem.h"
+
+#include <errno.h>
+#include <linux/futex.h>
+#include <stddef.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// public functions
+
+/**
+ * Initializes an empty ring
+ * @param ring Ring to initialize
+ * @param size Number of slots, must be a power of two
+ */
+void spsc_ring_init(struct t_spsc_ring *ring, unsigned size) {
+    ring->slots = malloc_assert(sizeof(void *) * size);
+    ring->mask = size - 1;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->seq, 0);
+    atomic_init(&ring->waiting, 0);
+}
+
+/**
+ * Frees the slots, queued entries are dropped
+ * @param ring Ring to clear
+ */
+void spsc_ring_clear(struct t_spsc_ring *ring) {
+    FREE_PTR(ring->slots);
+}
+
+/**
+ * Appends an entry, must only be called from the producer thread
+ * @param ring Ring
+ * @param data Entry to append
+ * @return true on success, false if the ring is full
+ */
+bool spsc_ring_push(struct t_spsc_ring *ring, void *data) {
+    unsigned tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    if (tail - head > ring->mask) {
+        return false;
+    }
+    ring->slots[tail & ring->mask] = data;
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    atomic_fetch_add_explicit(&ring->seq, 1, memory_order_seq_cst);
+    if (atomic_load_explicit(&ring->waiting, memory_order_seq_cst) == 1) {
+        syscall(SYS_futex, &ring->seq, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+    }
+    return true;
+}
+
+/**
+ * Removes the first entry, must only be called from the consumer thread
+ * @param ring Ring
+ * @return The first entry or NULL if the ring is empty
+ */
+void *spsc_ring_pop(struct t_spsc_ring *ring) {
+    unsigned head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head == tail) {
+        return NULL;
+    }
+    void *data = ring->slots[head & ring->mask];
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return data;
+}
+
+/**
+ * Returns the wake up sequence, read it before checking the ring
+ * and pass it to spsc_ring_wait.
+ * @param ring Ring
+ * @return Current sequence
+ */
+unsigned spsc_ring_seq(struct t_spsc_ring *ring) {
+    return atomic_load_explicit(&ring->seq, memory_order_acquire);
+}
+
+/**
+ * Blocks the consumer thread until an entry was pushed or spsc_ring_wake
+ * was called after the sequence was read.
+ * @param ring Ring
+ * @param seq Sequence returned by spsc_ring_seq
+ */
+void spsc_ring_wait(struct t_spsc_ring *ring, unsigned seq) {
+    atomic_store_explicit(&ring->waiting, 1, memory_order_seq_cst);
+    if (atomic_load_explicit(&ring->seq, memory_order_seq_cst) == seq &&
+        syscall(SYS_futex, &ring->seq, FUTEX_WAIT_PRIVATE, seq, NULL, NULL, 0) == -1 &&
+        errno != EAGAIN &&
+        errno != EINTR)
+    {
+        MYGPIOD_LOG_ERROR("Waiting for the ring buffer failed");
+        MYGPIOD_LOG_ERRNO(errno);
+    }
+    atomic_store_explicit(&ring->waiting, 0, memory_order_relaxed);
+}
+
+/**
+ * Wakes the consumer thread, can be called from any thread
+ * @param ring Ring
+ */
+void spsc_ring_wake(struct t_spsc_ring *ring) {
+    atomic_fetch_add_explicit(&ring->seq, 1, memory_order_seq_cst);
+    syscall(SYS_futex, &ring->seq, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+/**
+ * Returns the number of queued entries, can be called from any thread
+ * @param ring Ring
+ * @return Number of entries
+ */
+unsigned spsc_ring_len(struct t_spsc_ring *ring) {
+    // Head first, the tail can not be behind it
+    unsigned head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    unsigned tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    return tail - head;
+}
@@ -0,0 +1,39 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Lock-free single producer single consumer ring buffer
+ */
+
+#ifndef MYGPIOD_SPSC_RING_H
+#define MYGPIOD_SPSC_RING_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+/**
+ * Bounded ring of pointers.
+ * Only one thread is allowed to push and only one thread is allowed to pop.
+ */
+struct t_spsc_ring {
+    void **slots;          //!< Slots, the size is a power of two
+    unsigned mask;         //!< Size - 1
+    atomic_uint head;      //!< Next slot to pop, consumer side
+    atomic_uint tail;      //!< Next slot to push, producer side
+    atomic_uint seq;       //!< Futex word, incremented on each push and wake up
+    atomic_uint waiting;   //!< Consumer waits on seq
+};
+
+void spsc_ring_init(struct t_spsc_ring *ring, unsigned size);
+void spsc_ring_clear(struct t_spsc_ring *ring);
+bool spsc_ring_push(struct t_spsc_ring *ring, void *data);
+void *spsc_ring_pop(struct t_spsc_ring *ring);
+void spsc_ring_wait(struct t_spsc_ring *ring, unsigned seq);
+unsigned spsc_ring_seq(struct t_spsc_ring *ring);
+void spsc_ring_wake(struct t_spsc_ring *ring);
+unsigned spsc_ring_len(struct t_spsc_ring *ring);
+
+#endif
@@ -16,6 +16,10 @@
 #include "mygpiod/lib/list.h"
 #include "mygpiod/lib/log.h"
 
+#ifdef MYGPIOD_ENABLE_ACTION_LUA
+    #include "mygpiod/lua/co/scheduler.h"
+#endif
+
 #include <gpiod.h>
 #include <string.h>
 
@@ -53,9 +57,13 @@ bool gpio_handle_event(struct t_config *config, int *fd) {
             MYGPIOD_LOG_ERROR("Unable to retrieve event from buffer");
             continue;
         }
+        data->edges++;
         gpio_action_delay_abort(data);
         gpio_action_handle(config, node->id, gpiod_edge_event_get_timestamp_ns(event),
             gpiod_edge_event_get_event_type(event), data);
+        #ifdef MYGPIOD_ENABLE_ACTION_LUA
+            lua_co_gpio_edge(node->id, gpiod_edge_event_get_event_type(event));
+        #endif
     }
     return true;
 }
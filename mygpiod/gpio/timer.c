@@ -11,6 +11,7 @@
 #include "mygpiod/gpio/action.h"
 #include "mygpiod/gpio/output.h"
 #include "mygpiod/lib/log.h"
+#include "mygpiod/lib/metrics.h"
 #include "mygpiod/lib/timer.h"
 
 #include <gpiod.h>
@@ -33,6 +34,7 @@ bool gpio_in_timer_handle_event(struct t_config *config, int *fd) {
     if (timerfd_read_value(fd) == false) {
         return false;
     }
+    METRICS_INC(metrics.timer_fires[METRICS_TIMER_GPIO_IN]);
     timer_log_next_expire("GPIO in timer", *fd);
     struct t_list_node *node = get_node_by_gpio_in_timerfd(&config->gpios_in, fd);
     if (node == NULL) {
@@ -56,6 +58,7 @@ bool gpio_out_timer_handle_event(struct t_config *config, int *fd) {
     if (timerfd_read_value(fd) == false) {
         return false;
     }
+    METRICS_INC(metrics.timer_fires[METRICS_TIMER_GPIO_OUT]);
     timer_log_next_expire("GPIO out timer", *fd);
     struct t_list_node *node = get_node_by_gpio_out_timerfd(&config->gpios_out, fd);
     if (node == NULL) {
@@ -22,6 +22,11 @@ enum mygpiod_event_types {
     MYGPIOD_EVENT_INPUT,
     MYGPIOD_EVENT_TIMER_EV,
     MYGPIOD_EVENT_HOOK,
+    MYGPIOD_EVENT_HTTP_DONE,
+    MYGPIOD_EVENT_MPD_PLAYER,
+    MYGPIOD_EVENT_MPD_MIXER,
+    MYGPIOD_EVENT_SYSTEM_DONE,
+    MYGPIOD_EVENT_LUA_TIMEOUT,
 };
 
 #endif
@@ -18,20 +18,82 @@
 #include "mygpiod/lib/list.h"
 #include "mygpiod/lib/log.h"
 #include "mygpiod/lib/mem.h"
+#include "mygpiod/lib/metrics.h"
+#ifdef MYGPIOD_ENABLE_ACTION_MPC
+    #include "mygpiod/lib/mpd_client.h"
+#endif
+#include "mygpiod/lib/sds_extras.h"
 #ifdef MYGPIOD_ENABLE_HTTPD
+    #include "mygpiod/server_http/sse.h"
     #include "mygpiod/server_http/util.h"
+    #include "mygpiod/server_http/websocket.h"
 #endif
 #include "mygpiod/server_socket/idle.h"
 #include "mygpiod/server_socket/socket.h"
 
 #include <stdint.h>
 #include <string.h>
+#include <time.h>
+
+// private definitions
+
+/**
+ * Constructor for the event data enqueued for each socket client
+ */
+typedef struct t_event_data *(*event_data_new_cb)(enum mygpiod_event_types mygpiod_event_type,
+        const void *args, uint64_t timestamp_ns);
+
+/**
+ * Arguments for event_data_new_http_done
+ */
+struct t_http_done_args {
+    const char *uri;       //!< URI of the finished request
+    unsigned http_status;  //!< HTTP response code, 0 on transport error
+    uint64_t duration_ms;  //!< Duration of the request in milliseconds
+};
+
+/**
+ * Arguments for event_data_new_system_done
+ */
+struct t_system_done_args {
+    const char *cmd;       //!< Command of the finished process
+    int exit_code;         //!< Exit code, 128 + signal number if killed
+    uint64_t duration_ms;  //!< Runtime of the process in milliseconds
+};
+
+/**
+ * Arguments for event_data_new_lua_timeout
+ */
+struct t_lua_timeout_args {
+    const char *script;    //!< Name of the Lua function or script
+    const char *vm;        //!< Lua VM type, static string
+    const char *reason;    //!< Exceeded limit, static string
+    uint64_t duration_ms;  //!< Runtime until the abort in milliseconds
+};
 
 // private functions
 
+static uint64_t event_timestamp_now(void);
+static void event_enqueue_clients(struct t_config *config, unsigned id,
+        enum mygpiod_event_types mygpiod_event_type, event_data_new_cb new_cb,
+        const void *args, uint64_t timestamp_ns);
 static struct t_event_data *event_data_new_gpio(enum mygpiod_event_types mygpiod_event_type,
-        uint64_t timestamp_ns);
-static struct t_event_data *event_data_new_input(struct t_mygpiod_input_event *input_event);
+        const void *args, uint64_t timestamp_ns);
+static struct t_event_data *event_data_new_input(enum mygpiod_event_types mygpiod_event_type,
+        const void *args, uint64_t timestamp_ns);
+static struct t_event_data *event_data_new_http_done(enum mygpiod_event_types mygpiod_event_type,
+        const void *args, uint64_t timestamp_ns);
+static struct t_event_data *event_data_new_system_done(enum mygpiod_event_types mygpiod_event_type,
+        const void *args, uint64_t timestamp_ns);
+static struct t_event_data *event_data_new_lua_timeout(enum mygpiod_event_types mygpiod_event_type,
+        const void *args, uint64_t timestamp_ns);
+#ifdef MYGPIOD_ENABLE_ACTION_MPC
+    static struct t_event_data *event_data_new_mpd(enum mygpiod_event_types mygpiod_event_type,
+            const void *args, uint64_t timestamp_ns);
+#endif
+#ifdef MYGPIOD_ENABLE_HTTPD
+    static void http_send_event(struct t_config *config, const char *json);
+#endif
 
 // public functions
 
@@ -45,31 +107,12 @@ static struct t_event_data *event_data_new_input(struct t_mygpiod_input_event *i
 void event_enqueue_gpio(struct t_config *config, unsigned gpio, enum mygpiod_event_types event_type,
         uint64_t timestamp)
 {
-    // Socket clients
-    struct t_list_node *current = config->clients.head;
-    while (current != NULL) {
-        struct t_client_data *data = (struct t_client_data *)current->data;
-        struct t_event_data *event_data = event_data_new_gpio(event_type, timestamp);
-        MYGPIOD_LOG_DEBUG("Enqueuing event %s at gpio %u for client#%u", mygpiod_event_name(event_type), gpio, current->id);
-        list_push(&data->waiting_events, gpio, event_data);
-        if (data->state == CLIENT_SOCKET_STATE_IDLE) {
-            send_idle_events(current, false);
-        }
-        else if (data->waiting_events.length > WAITING_EVENTS_MAX) {
-            struct t_list_node *first = list_shift(&data->waiting_events);
-            list_node_free(first, event_data_clear);
-        }
-        current = current->next;
-    }
+    event_enqueue_clients(config, gpio, event_type, event_data_new_gpio, NULL, timestamp);
 
     #ifdef MYGPIOD_ENABLE_HTTPD
-        // HTTP long polling
-        current = config->http_suspended.head;
-        while (current != NULL) {
-            http_connection_resume_gpio((struct t_request_data *)current->data, gpio, event_type, timestamp);
-            current = current->next;
-        }
-        list_clear(&config->http_suspended, NULL);
+        sds json = http_print_event_gpio(sdsempty(), gpio, event_type, timestamp);
+        http_send_event(config, json);
+        FREE_SDS(json);
     #endif
 }
 
@@ -79,44 +122,118 @@ void event_enqueue_gpio(struct t_config *config, unsigned gpio, enum mygpiod_eve
  * @param input_event Input event
  */
 void event_enqueue_input(struct t_config *config, struct t_mygpiod_input_event *input_event) {
-    // Socket clients
-    struct t_list_node *current = config->clients.head;
-    while (current != NULL) {
-        struct t_client_data *data = (struct t_client_data *)current->data;
-        struct t_event_data *event_data = event_data_new_input(input_event);
-        MYGPIOD_LOG_DEBUG("Enqueuing event %s for %s for client#%u",
-            mygpiod_event_name(MYGPIOD_EVENT_INPUT),
-            input_event->device->name, current->id
-        );
-        list_push(&data->waiting_events, 0, event_data);
-        if (data->state == CLIENT_SOCKET_STATE_IDLE) {
-            send_idle_events(current, false);
-        }
-        else if (data->waiting_events.length > WAITING_EVENTS_MAX) {
-            struct t_list_node *first = list_shift(&data->waiting_events);
-            list_node_free(first, event_data_clear);
-        }
-        current = current->next;
-    }
+    uint64_t timestamp_ns = (uint64_t)(input_event->data.time.tv_sec * 1000000) + (uint64_t)(input_event->data.time.tv_usec * 1000);
+    event_enqueue_clients(config, 0, MYGPIOD_EVENT_INPUT, event_data_new_input, input_event, timestamp_ns);
 
     #ifdef MYGPIOD_ENABLE_HTTPD
-        // HTTP long polling
-        current = config->http_suspended.head;
-        while (current != NULL) {
-            http_connection_resume_input((struct t_request_data *)current->data, input_event);
-            current = current->next;
-        }
-        list_clear(&config->http_suspended, NULL);
+        sds json = http_print_event_input(sdsempty(), input_event);
+        http_send_event(config, json);
+        FREE_SDS(json);
+    #endif
+}
+
+/**
+ * Enqueues the result of an asynchronous HTTP request for all client connections - socket and http
+ * @param config Pointer to config
+ * @param uri URI of the finished request
+ * @param http_status HTTP response code, 0 on transport error
+ * @param duration_ms Duration of the request in milliseconds
+ */
+void event_enqueue_http_done(struct t_config *config, const char *uri, unsigned http_status,
+        uint64_t duration_ms)
+{
+    uint64_t timestamp_ns = event_timestamp_now();
+    struct t_http_done_args args = { uri, http_status, duration_ms };
+    event_enqueue_clients(config, 0, MYGPIOD_EVENT_HTTP_DONE, event_data_new_http_done, &args, timestamp_ns);
+
+    #ifdef MYGPIOD_ENABLE_HTTPD
+        sds json = http_print_event_http_done(sdsempty(), uri, http_status, duration_ms, timestamp_ns);
+        http_send_event(config, json);
+        FREE_SDS(json);
+    #endif
+}
+
+/**
+ * Enqueues a finished system action for all client connections - socket and http
+ * @param config Pointer to config
+ * @param cmd Command of the finished process
+ * @param exit_code Exit code, 128 + signal number if killed
+ * @param duration_ms Runtime of the process in milliseconds
+ */
+void event_enqueue_system_done(struct t_config *config, const char *cmd, int exit_code,
+        uint64_t duration_ms)
+{
+    uint64_t timestamp_ns = event_timestamp_now();
+    struct t_system_done_args args = { cmd, exit_code, duration_ms };
+    event_enqueue_clients(config, 0, MYGPIOD_EVENT_SYSTEM_DONE, event_data_new_system_done, &args, timestamp_ns);
+
+    #ifdef MYGPIOD_ENABLE_HTTPD
+        sds json = http_print_event_system_done(sdsempty(), cmd, exit_code, duration_ms, timestamp_ns);
+        http_send_event(config, json);
+        FREE_SDS(json);
+    #endif
+}
+
+/**
+ * Enqueues an aborted Lua execution for all client connections - socket and http
+ * @param config Pointer to config
+ * @param script Name of the Lua function or script
+ * @param vm Lua VM type: sync, async or co
+ * @param reason Exceeded limit: instructions or timeout
+ * @param duration_ms Runtime until the abort in milliseconds
+ */
+void event_enqueue_lua_timeout(struct t_config *config, const char *script, const char *vm,
+        const char *reason, uint64_t duration_ms)
+{
+    uint64_t timestamp_ns = event_timestamp_now();
+    struct t_lua_timeout_args args = { script, vm, reason, duration_ms };
+    event_enqueue_clients(config, 0, MYGPIOD_EVENT_LUA_TIMEOUT, event_data_new_lua_timeout, &args, timestamp_ns);
+
+    #ifdef MYGPIOD_ENABLE_HTTPD
+        sds json = http_print_event_lua_timeout(sdsempty(), script, vm, reason, duration_ms, timestamp_ns);
+        http_send_event(config, json);
+        FREE_SDS(json);
     #endif
 }
 
+#ifdef MYGPIOD_ENABLE_ACTION_MPC
+/**
+ * Enqueues a MPD state change for all client connections - socket and http
+ * @param config Pointer to config
+ * @param event_type MYGPIOD_EVENT_MPD_PLAYER or MYGPIOD_EVENT_MPD_MIXER
+ * @param state The updated MPD state
+ */
+void event_enqueue_mpd(struct t_config *config, enum mygpiod_event_types event_type,
+        const struct t_mpd_state *state)
+{
+    uint64_t timestamp_ns = event_timestamp_now();
+    event_enqueue_clients(config, 0, event_type, event_data_new_mpd, state, timestamp_ns);
+
+    #ifdef MYGPIOD_ENABLE_HTTPD
+        sds json = event_type == MYGPIOD_EVENT_MPD_PLAYER
+            ? http_print_event_mpd_player(sdsempty(), mpd_client_lookup_state(state->play_state), state->song_pos, timestamp_ns)
+            : http_print_event_mpd_mixer(sdsempty(), state->volume, timestamp_ns);
+        http_send_event(config, json);
+        FREE_SDS(json);
+    #endif
+}
+#endif
+
 /**
  * Clears the event data.
  * @param node pointer to node holding the data to clear
  */
 void event_data_clear(struct t_list_node *node) {
     struct t_event_data *data = (struct t_event_data *)node->data;
-    (void)data;
+    if (data->mygpiod_event_type == MYGPIOD_EVENT_HTTP_DONE) {
+        FREE_SDS(data->uri);
+    }
+    else if (data->mygpiod_event_type == MYGPIOD_EVENT_SYSTEM_DONE) {
+        FREE_SDS(data->cmd);
+    }
+    else if (data->mygpiod_event_type == MYGPIOD_EVENT_LUA_TIMEOUT) {
+        FREE_SDS(data->lua_script);
+    }
 }
 
 /**
@@ -140,21 +257,78 @@ const char *mygpiod_event_name(enum mygpiod_event_types event_type) {
             return "timer_ev";
         case MYGPIOD_EVENT_HOOK:
             return "hook";
+        case MYGPIOD_EVENT_HTTP_DONE:
+            return "http_done";
+        case MYGPIOD_EVENT_MPD_PLAYER:
+            return "mpd_player";
+        case MYGPIOD_EVENT_MPD_MIXER:
+            return "mpd_mixer";
+        case MYGPIOD_EVENT_SYSTEM_DONE:
+            return "system_done";
+        case MYGPIOD_EVENT_LUA_TIMEOUT:
+            return "lua_timeout";
     }
     return "";
 }
 
 // private functions
 
+/**
+ * Returns the current realtime clock
+ * @return Timestamp in nanoseconds
+ */
+static uint64_t event_timestamp_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)((ts.tv_sec * 1000000000) + ts.tv_nsec);
+}
+
+/**
+ * Enqueues an event for all socket clients.
+ * Idle clients are notified immediately, for busy clients the oldest event
+ * is dropped if the queue exceeds WAITING_EVENTS_MAX.
+ * @param config Pointer to config
+ * @param id Node id for the event, the gpio number for gpio events
+ * @param mygpiod_event_type The mygpiod event type
+ * @param new_cb Constructor for the per client event data
+ * @param args Arguments for the constructor
+ * @param timestamp_ns Event timestamp in nanoseconds
+ */
+static void event_enqueue_clients(struct t_config *config, unsigned id,
+        enum mygpiod_event_types mygpiod_event_type, event_data_new_cb new_cb,
+        const void *args, uint64_t timestamp_ns)
+{
+    METRICS_INC(metrics.events);
+    struct t_list_node *current = config->clients.head;
+    while (current != NULL) {
+        struct t_client_data *data = (struct t_client_data *)current->data;
+        struct t_event_data *event_data = new_cb(mygpiod_event_type, args, timestamp_ns);
+        MYGPIOD_LOG_DEBUG("Enqueuing event %s for client#%u", mygpiod_event_name(mygpiod_event_type), current->id);
+        list_push(&data->waiting_events, id, event_data);
+        if (data->state == CLIENT_SOCKET_STATE_IDLE) {
+            send_idle_events(current, false);
+        }
+        else if (data->waiting_events.length > WAITING_EVENTS_MAX) {
+            struct t_list_node *first = list_shift(&data->waiting_events);
+            list_node_free(first, event_data_clear);
+            data->events_dropped++;
+            METRICS_INC(metrics.events_dropped);
+        }
+        current = current->next;
+    }
+}
+
 /**
  * Creates the event data for a GPIO
  * @param mygpiod_event_type event data type
+ * @param args unused
  * @param timestamp_ns event timestamp in nanoseconds
  * @return Newly allocated struct
  */
 static struct t_event_data *event_data_new_gpio(enum mygpiod_event_types mygpiod_event_type,
-        uint64_t timestamp_ns)
+        const void *args, uint64_t timestamp_ns)
 {
+    (void)args;
     struct t_event_data *event_data = malloc_assert(sizeof(struct t_event_data));
     event_data->mygpiod_event_type = mygpiod_event_type;
     event_data->timestamp_ns = timestamp_ns;
@@ -163,14 +337,123 @@ static struct t_event_data *event_data_new_gpio(enum mygpiod_event_types mygpiod
 
 /**
  * Creates the event data for an input device
- * @param input_event Input event
+ * @param mygpiod_event_type MYGPIOD_EVENT_INPUT
+ * @param args Input event, struct t_mygpiod_input_event
+ * @param timestamp_ns Event timestamp in nanoseconds
  * @return Newly allocated struct
  */
-static struct t_event_data *event_data_new_input(struct t_mygpiod_input_event *input_event) {
+static struct t_event_data *event_data_new_input(enum mygpiod_event_types mygpiod_event_type,
+        const void *args, uint64_t timestamp_ns)
+{
+    const struct t_mygpiod_input_event *input_event = args;
     struct t_event_data *event_data = malloc_assert(sizeof(struct t_event_data));
-    event_data->mygpiod_event_type = MYGPIOD_EVENT_INPUT;
-    event_data->timestamp_ns = (uint64_t)(input_event->data.time.tv_sec * 1000000) + (uint64_t)(input_event->data.time.tv_usec * 1000);
+    event_data->mygpiod_event_type = mygpiod_event_type;
+    event_data->timestamp_ns = timestamp_ns;
     event_data->input_event.device = input_event->device;
     memcpy(&event_data->input_event.data, &input_event->data, sizeof(struct t_input_event));
     return event_data;
 }
+
+/**
+ * Creates the event data for a finished HTTP request
+ * @param mygpiod_event_type MYGPIOD_EVENT_HTTP_DONE
+ * @param args Request result, struct t_http_done_args
+ * @param timestamp_ns Event timestamp in nanoseconds
+ * @return Newly allocated struct
+ */
+static struct t_event_data *event_data_new_http_done(enum mygpiod_event_types mygpiod_event_type,
+        const void *args, uint64_t timestamp_ns)
+{
+    const struct t_http_done_args *http_done = args;
+    struct t_event_data *event_data = malloc_assert(sizeof(struct t_event_data));
+    event_data->mygpiod_event_type = mygpiod_event_type;
+    event_data->timestamp_ns = timestamp_ns;
+    event_data->uri = sdsnew(http_done->uri);
+    event_data->http_status = http_done->http_status;
+    event_data->duration_ms = http_done->duration_ms;
+    return event_data;
+}
+
+/**
+ * Creates the event data for a finished system action
+ * @param mygpiod_event_type MYGPIOD_EVENT_SYSTEM_DONE
+ * @param args Process result, struct t_system_done_args
+ * @param timestamp_ns Event timestamp in nanoseconds
+ * @return Newly allocated struct
+ */
+static struct t_event_data *event_data_new_system_done(enum mygpiod_event_types mygpiod_event_type,
+        const void *args, uint64_t timestamp_ns)
+{
+    const struct t_system_done_args *system_done = args;
+    struct t_event_data *event_data = malloc_assert(sizeof(struct t_event_data));
+    event_data->mygpiod_event_type = mygpiod_event_type;
+    event_data->timestamp_ns = timestamp_ns;
+    event_data->cmd = sdsnew(system_done->cmd);
+    event_data->exit_code = system_done->exit_code;
+    event_data->duration_ms = system_done->duration_ms;
+    return event_data;
+}
+
+/**
+ * Creates the event data for an aborted Lua execution
+ * @param mygpiod_event_type MYGPIOD_EVENT_LUA_TIMEOUT
+ * @param args Abort details, struct t_lua_timeout_args
+ * @param timestamp_ns Event timestamp in nanoseconds
+ * @return Newly allocated struct
+ */
+static struct t_event_data *event_data_new_lua_timeout(enum mygpiod_event_types mygpiod_event_type,
+        const void *args, uint64_t timestamp_ns)
+{
+    const struct t_lua_timeout_args *lua_timeout = args;
+    struct t_event_data *event_data = malloc_assert(sizeof(struct t_event_data));
+    event_data->mygpiod_event_type = mygpiod_event_type;
+    event_data->timestamp_ns = timestamp_ns;
+    event_data->lua_script = sdsnew(lua_timeout->script);
+    event_data->lua_vm = lua_timeout->vm;
+    event_data->lua_reason = lua_timeout->reason;
+    event_data->duration_ms = lua_timeout->duration_ms;
+    return event_data;
+}
+
+#ifdef MYGPIOD_ENABLE_ACTION_MPC
+/**
+ * Creates the event data for a MPD state change
+ * @param mygpiod_event_type MYGPIOD_EVENT_MPD_PLAYER or MYGPIOD_EVENT_MPD_MIXER
+ * @param args The updated MPD state, struct t_mpd_state
+ * @param timestamp_ns Event timestamp in nanoseconds
+ * @return Newly allocated struct
+ */
+static struct t_event_data *event_data_new_mpd(enum mygpiod_event_types mygpiod_event_type,
+        const void *args, uint64_t timestamp_ns)
+{
+    const struct t_mpd_state *state = args;
+    struct t_event_data *event_data = malloc_assert(sizeof(struct t_event_data));
+    event_data->mygpiod_event_type = mygpiod_event_type;
+    event_data->timestamp_ns = timestamp_ns;
+    event_data->mpd_state = mpd_client_lookup_state(state->play_state);
+    event_data->mpd_song_pos = state->song_pos;
+    event_data->mpd_volume = state->volume;
+    return event_data;
+}
+#endif
+
+#ifdef MYGPIOD_ENABLE_HTTPD
+/**
+ * Sends the event to all HTTP clients - long polling, server-sent events and WebSockets
+ * @param config Pointer to config
+ * @param json Event as json object
+ */
+static void http_send_event(struct t_config *config, const char *json) {
+    // HTTP long polling
+    struct t_list_node *current = config->http_suspended.head;
+    while (current != NULL) {
+        http_connection_resume((struct t_request_data *)current->data, json);
+        current = current->next;
+    }
+    list_clear(&config->http_suspended, NULL);
+    // Server-sent events
+    sse_send_event(config, json);
+    // WebSockets
+    websocket_send_event(config, json);
+}
+#endif
@@ -26,11 +26,40 @@ struct t_event_data {
     uint64_t timestamp_ns;                        //!< Timestamp of the event in nanoseconds
     // Input event
     struct t_mygpiod_input_event input_event;     //!< Input event struct
+    // HTTP client event
+    sds uri;                                      //!< URI of the finished request
+    unsigned http_status;                         //!< HTTP response code, 0 on transport error
+    uint64_t duration_ms;                         //!< Duration of the request or process
+    // MPD events
+    const char *mpd_state;                        //!< Player state name, static string
+    int mpd_song_pos;                             //!< Queue position of the current song, -1 if none
+    int mpd_volume;                               //!< Volume, -1 if unknown
+    // System action event
+    sds cmd;                                      //!< Command of the finished process
+    int exit_code;                                //!< Exit code, 128 + signal number if killed
+    // Lua timeout event
+    sds lua_script;                               //!< Aborted Lua function or script
+    const char *lua_vm;                           //!< Lua VM type, static string
+    const char *lua_reason;                       //!< Exceeded limit, static string
 };
 
+#ifdef MYGPIOD_ENABLE_ACTION_MPC
+    struct t_mpd_state;
+#endif
+
 void event_enqueue_gpio(struct t_config *config, unsigned gpio, enum mygpiod_event_types event_type,
         uint64_t timestamp);
 void event_enqueue_input(struct t_config *config, struct t_mygpiod_input_event *input_event);
+void event_enqueue_http_done(struct t_config *config, const char *uri, unsigned http_status,
+        uint64_t duration_ms);
+void event_enqueue_system_done(struct t_config *config, const char *cmd, int exit_code,
+        uint64_t duration_ms);
+void event_enqueue_lua_timeout(struct t_config *config, const char *script, const char *vm,
+        const char *reason, uint64_t duration_ms);
+#ifdef MYGPIOD_ENABLE_ACTION_MPC
+    void event_enqueue_mpd(struct t_config *config, enum mygpiod_event_types event_type,
+            const struct t_mpd_state *state);
+#endif
 void event_data_clear(struct t_list_node *node);
 const char *mygpiod_event_name(enum mygpiod_event_types event_type);
 
@@ -0,0 +1,321 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Executor process for the system actions
+ *
+ * The executor is forked at startup while the daemon is still small.
+ * It receives one command per message over a SOCK_SEQPACKET socketpair,
+ * starts it with posix_spawn, reaps it after a SIGCHLD and sends the
+ * exit code back. Children that exceed the timeout are killed with
+ * their process group. The executor exits if the daemon closes its end.
+ */
+
+#include "compile_time.h"
+#include "mygpiod/lib/executor.h"
+
+#include "mygpiod/lib/list.h"
+#include "mygpiod/lib/log.h"
+#include "mygpiod/lib/mem.h"
+#include "mygpiod/lib/metrics.h"
+#include "mygpiod/lib/sds_extras.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+
+// private definitions
+
+/**
+ * A running child process, the list node id is the pid
+ */
+struct t_executor_child {
+    sds cmd;               //!< Executed command
+    uint64_t start_us;     //!< Start time
+    uint64_t deadline_us;  //!< Time to kill the process, 0 for no timeout
+};
+
+/**
+ * State of the executor process
+ */
+struct t_executor {
+    int fd;                  //!< Socket to the daemon
+    int signal_fd;           //!< Signalfd for SIGCHLD
+    int timer_fd;            //!< Timer for the earliest deadline
+    int timeout_s;           //!< Timeout for each child, 0 to disable
+    struct t_list children;  //!< Running children, data is struct t_executor_child
+};
+
+static struct t_executor executor;
+
+static void executor_spawn(const char *cmd);
+static void executor_reap(void);
+static void executor_handle_timer(void);
+static void executor_timer_update(void);
+static void executor_send_result(const char *cmd, int exit_code, uint64_t duration_ms);
+static void executor_child_clear(struct t_list_node *node);
+
+// public functions
+
+/**
+ * Main loop of the executor process.
+ * SIGCHLD must already be blocked, it is inherited from the daemon.
+ * @param fd Executor end of the socketpair
+ * @param timeout_s Timeout for each child in seconds, 0 to disable
+ * @return Exit code for the executor process
+ */
+int executor_run(int fd, int timeout_s) {
+    executor.fd = fd;
+    executor.timeout_s = timeout_s;
+    list_init(&executor.children);
+    sigset_t sigmask;
+    sigemptyset(&sigmask);
+    sigaddset(&sigmask, SIGCHLD);
+    executor.signal_fd = signalfd(-1, &sigmask, SFD_NONBLOCK | SFD_CLOEXEC);
+    executor.timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (executor.signal_fd == -1 ||
+        executor.timer_fd == -1)
+    {
+        MYGPIOD_LOG_ERROR("Executor: Can not create the signal or timer fd");
+        MYGPIOD_LOG_ERRNO(errno);
+        return EXIT_FAILURE;
+    }
+    MYGPIOD_LOG_DEBUG("Executor started with pid %d", getpid());
+
+    struct pollfd pfds[3] = {
+        { .fd = executor.fd, .events = POLLIN },
+        { .fd = executor.signal_fd, .events = POLLIN },
+        { .fd = executor.timer_fd, .events = POLLIN }
+    };
+    char cmd[EXECUTOR_CMD_LEN_MAX + 1];
+    while (true) {
+        if (poll(pfds, 3, -1) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            MYGPIOD_LOG_ERROR("Executor: poll failed");
+            MYGPIOD_LOG_ERRNO(errno);
+            break;
+        }
+        if (pfds[1].revents & POLLIN) {
+            struct signalfd_siginfo info;
+            while (read(executor.signal_fd, &info, sizeof(info)) == (ssize_t)sizeof(info)) {
+                // Signals are merged, one reap run handles all finished children
+            }
+            executor_reap();
+        }
+        if (pfds[2].revents & POLLIN) {
+            executor_handle_timer();
+        }
+        if (pfds[0].revents & POLLIN) {
+            ssize_t len = recv(executor.fd, cmd, EXECUTOR_CMD_LEN_MAX, 0);
+            if (len <= 0) {
+                // The daemon has exited
+                break;
+            }
+            cmd[len] = '\0';
+            executor_spawn(cmd);
+        }
+        else if (pfds[0].revents & (POLLHUP | POLLERR)) {
+            break;
+        }
+    }
+    if (executor.children.length > 0) {
+        MYGPIOD_LOG_WARN("Executor: %u system actions are still running", executor.children.length);
+    }
+    list_clear(&executor.children, executor_child_clear);
+    close(executor.timer_fd);
+    close(executor.signal_fd);
+    close(executor.fd);
+    return EXIT_SUCCESS;
+}
+
+// private functions
+
+/**
+ * Runs an executable or script in a new process.
+ * Failures are reported to the daemon with exit code -1.
+ * @param cmd Command to execute
+ */
+static void executor_spawn(const char *cmd) {
+    if (executor.children.length >= SYSTEM_CHILDREN_MAX) {
+        MYGPIOD_LOG_ERROR("Too many running system actions, not executing \"%s\"", cmd);
+        executor_send_result(cmd, -1, 0);
+        return;
+    }
+    // The child must not inherit the signals blocked for the signalfd
+    sigset_t sigmask;
+    sigemptyset(&sigmask);
+    sigset_t sigdefault;
+    sigemptyset(&sigdefault);
+    sigaddset(&sigdefault, SIGCHLD);
+    sigaddset(&sigdefault, SIGINT);
+    sigaddset(&sigdefault, SIGPIPE);
+    sigaddset(&sigdefault, SIGTERM);
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setsigmask(&attr, &sigmask);
+    posix_spawnattr_setsigdefault(&attr, &sigdefault);
+    // Own process group to kill the whole script on timeout
+    posix_spawnattr_setpgroup(&attr, 0);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETPGROUP);
+
+    struct t_executor_child *child = malloc_assert(sizeof(struct t_executor_child));
+    child->cmd = sdsnew(cmd);
+    char *argv[] = { child->cmd, NULL };
+    pid_t pid;
+    int rc = posix_spawn(&pid, child->cmd, NULL, &attr, argv, environ);
+    posix_spawnattr_destroy(&attr);
+    if (rc != 0) {
+        MYGPIOD_LOG_ERROR("Failure executing system command \"%s\"", cmd);
+        MYGPIOD_LOG_ERRNO(rc);
+        executor_send_result(cmd, -1, 0);
+        FREE_SDS(child->cmd);
+        FREE_PTR(child);
+        return;
+    }
+    MYGPIOD_LOG_DEBUG("Started process with pid %d", pid);
+    child->start_us = metrics_now_us();
+    child->deadline_us = executor.timeout_s > 0
+        ? child->start_us + (uint64_t)executor.timeout_s * 1000000
+        : 0;
+    list_push(&executor.children, (unsigned)pid, child);
+    executor_timer_update();
+}
+
+/**
+ * Reaps the finished children and sends their results
+ */
+static void executor_reap(void) {
+    struct t_list_node *current = executor.children.head;
+    while (current != NULL) {
+        struct t_list_node *next = current->next;
+        int status;
+        pid_t pid = waitpid((pid_t)current->id, &status, WNOHANG);
+        if (pid == 0) {
+            current = next;
+            continue;
+        }
+        struct t_executor_child *child = (struct t_executor_child *)current->data;
+        int exit_code;
+        if (pid == -1) {
+            MYGPIOD_LOG_ERROR("Failure waiting for pid %u", current->id);
+            MYGPIOD_LOG_ERRNO(errno);
+            exit_code = -1;
+        }
+        else if (WIFSIGNALED(status)) {
+            // Same as the shell
+            exit_code = 128 + WTERMSIG(status);
+        }
+        else {
+            exit_code = WEXITSTATUS(status);
+        }
+        executor_send_result(child->cmd, exit_code, (metrics_now_us() - child->start_us) / 1000);
+        list_remove_node(&executor.children, current);
+        list_node_free(current, executor_child_clear);
+        current = next;
+    }
+    executor_timer_update();
+}
+
+/**
+ * Kills the children that have exceeded the timeout.
+ * They are reaped after the SIGCHLD.
+ */
+static void executor_handle_timer(void) {
+    uint64_t exp;
+    if (read(executor.timer_fd, &exp, sizeof(exp)) != (ssize_t)sizeof(exp)) {
+        return;
+    }
+    uint64_t now_us = metrics_now_us();
+    struct t_list_node *current = executor.children.head;
+    while (current != NULL) {
+        struct t_executor_child *child = (struct t_executor_child *)current->data;
+        if (child->deadline_us != 0 &&
+            child->deadline_us <= now_us)
+        {
+            MYGPIOD_LOG_WARN("Killing process %u \"%s\" after %d seconds", current->id, child->cmd, executor.timeout_s);
+            if (kill(-(pid_t)current->id, SIGKILL) == -1) {
+                MYGPIOD_LOG_ERRNO(errno);
+            }
+            // Kill only once
+            child->deadline_us = 0;
+        }
+        current = current->next;
+    }
+    executor_timer_update();
+}
+
+/**
+ * Arms the timer for the earliest deadline or disarms it
+ */
+static void executor_timer_update(void) {
+    uint64_t deadline_us = 0;
+    struct t_list_node *current = executor.children.head;
+    while (current != NULL) {
+        struct t_executor_child *child = (struct t_executor_child *)current->data;
+        if (child->deadline_us != 0 &&
+            (deadline_us == 0 || child->deadline_us < deadline_us))
+        {
+            deadline_us = child->deadline_us;
+        }
+        current = current->next;
+    }
+    struct itimerspec its = { 0 };
+    if (deadline_us != 0) {
+        uint64_t now_us = metrics_now_us();
+        uint64_t timeout_us = deadline_us > now_us
+            ? deadline_us - now_us
+            : 1;
+        its.it_value.tv_sec = (time_t)(timeout_us / 1000000);
+        its.it_value.tv_nsec = (long)((timeout_us % 1000000) * 1000);
+    }
+    if (timerfd_settime(executor.timer_fd, 0, &its, NULL) == -1) {
+        MYGPIOD_LOG_ERROR("Executor: Can not set the timer");
+        MYGPIOD_LOG_ERRNO(errno);
+    }
+}
+
+/**
+ * Sends the result of a command to the daemon
+ * @param cmd The command
+ * @param exit_code Exit code, 128 + signal number if killed, -1 if not started
+ * @param duration_ms Runtime of the process in milliseconds
+ */
+static void executor_send_result(const char *cmd, int exit_code, uint64_t duration_ms) {
+    char msg[sizeof(struct t_executor_result) + EXECUTOR_CMD_LEN_MAX];
+    struct t_executor_result result = {
+        .exit_code = exit_code,
+        .duration_ms = duration_ms
+    };
+    size_t cmd_len = strlen(cmd);
+    memcpy(msg, &result, sizeof(result));
+    memcpy(msg + sizeof(result), cmd, cmd_len);
+    if (send(executor.fd, msg, sizeof(result) + cmd_len, MSG_NOSIGNAL) == -1) {
+        MYGPIOD_LOG_ERROR("Executor: Can not send the result for \"%s\"", cmd);
+        MYGPIOD_LOG_ERRNO(errno);
+    }
+}
+
+/**
+ * Clears the child data
+ * @param node Pointer to node holding the data to clear
+ */
+static void executor_child_clear(struct t_list_node *node) {
+    struct t_executor_child *child = (struct t_executor_child *)node->data;
+    FREE_SDS(child->cmd);
+}
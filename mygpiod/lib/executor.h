@@ -0,0 +1,34 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Executor process for the system actions
+ */
+
+#ifndef MYGPIOD_EXECUTOR_H
+#define MYGPIOD_EXECUTOR_H
+
+#include "compile_time.h"
+
+#include <stdint.h>
+
+/**
+ * Maximum length of a command
+ */
+#define EXECUTOR_CMD_LEN_MAX LINE_LENGTH_MAX
+
+/**
+ * Result of a command, sent from the executor to the daemon.
+ * The command follows the struct in the same message.
+ */
+struct t_executor_result {
+    int exit_code;         //!< Exit code, 128 + signal number if killed, -1 if not started
+    uint64_t duration_ms;  //!< Runtime of the process
+};
+
+int executor_run(int fd, int timeout_s);
+
+#endif
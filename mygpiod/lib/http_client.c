@@ -6,6 +6,8 @@
 
 /*! \file
  * \brief HTTP client implementation
+ *
+ * curl_global_init must be called once at startup.
  */
 
 #include "compile_time.h"
@@ -13,9 +15,10 @@
 
 #include "dist/sds/sds.h"
 #include "mygpiod/lib/log.h"
+#include "mygpiod/lib/mem.h"
+#include "mygpiod/lib/metrics.h"
 #include "mygpiod/lib/sds_extras.h"
 
-#include <curl/curl.h>
 #include <stddef.h>
 #include <string.h>
 
@@ -26,77 +29,148 @@ static size_t catch_output(void *ptr, size_t size, size_t nmemb, sds *output);
 // Public functions
 
 /**
- * Makes a http call in a new thread
+ * Creates a new request, the strings are copied
  * @param method HTTP method
  * @param uri HTTP Uri
  * @param content_type Content-Type or NULL
  * @param postdata data to post or NULL
- * @param response_header Already allocated sds string to populate with the response header
- * @param response_body Already allocated sds string to populate with the response body
- * @returns true on success, else false
+ * @return Allocated request
  */
-bool http_client(const char *method, const char *uri, const char *content_type, const char *postdata,
-        sds *response_header, sds *response_body)
-{
-    // Initialize
-    curl_global_init(CURL_GLOBAL_ALL);
-    CURL *curl;
-    CURLcode res = CURLE_FAILED_INIT;
-    bool rc = false;
-    // Run curl
-    curl = curl_easy_init();
-    if (curl == NULL) {
-        goto out;
+struct t_http_request *http_request_new(const char *method, const char *uri, const char *content_type, const char *postdata) {
+    struct t_http_request *request = malloc_assert(sizeof(struct t_http_request));
+    request->method = sdsnew(method);
+    request->uri = sdsnew(uri);
+    if (content_type != NULL &&
+        postdata != NULL)
+    {
+        request->content_type = sdsnew(content_type);
+        request->postdata = sdsnew(postdata);
     }
-    curl_easy_setopt(curl, CURLOPT_URL, uri);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, (curl_write_callback)catch_output);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, response_body);
-    curl_easy_setopt(curl, CURLOPT_HEADERDATA, response_header);
-    struct curl_slist *slist = NULL;
-    if (postdata != NULL) {
-        sds header = sdscatfmt(sdsempty(), "Content-type: %s", content_type);
-        slist = curl_slist_append(slist, header);
-        if (slist == NULL) {
-            goto out;
+    else {
+        request->content_type = NULL;
+        request->postdata = NULL;
+    }
+    request->response_header = sdsempty();
+    request->response_body = sdsempty();
+    request->headers = NULL;
+    request->file_content = NULL;
+    request->start_us = 0;
+    request->done_cb = NULL;
+    request->done_data = NULL;
+    request->err_buf[0] = '\0';
+    return request;
+}
+
+/**
+ * Frees the request
+ * @param request Request to free
+ */
+void http_request_free(struct t_http_request *request) {
+    FREE_SDS(request->method);
+    FREE_SDS(request->uri);
+    FREE_SDS(request->content_type);
+    FREE_SDS(request->postdata);
+    FREE_SDS(request->response_header);
+    FREE_SDS(request->response_body);
+    FREE_SDS(request->file_content);
+    curl_slist_free_all(request->headers);
+    FREE_PTR(request);
+}
+
+/**
+ * Creates a curl easy handle for the request.
+ * The request must outlive the handle.
+ * @param request The request
+ * @return Configured easy handle or NULL on error
+ */
+CURL *http_request_easy_new(struct t_http_request *request) {
+    if (request->postdata != NULL) {
+        sds header = sdscatfmt(sdsempty(), "Content-type: %S", request->content_type);
+        request->headers = curl_slist_append(request->headers, header);
+        FREE_SDS(header);
+        if (request->headers == NULL) {
+            return NULL;
         }
-        sdsfree(header);
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, slist);
-        if (strncmp(postdata, "<</", 3) == 0) {
+        if (strncmp(request->postdata, "<</", 3) == 0) {
             // read file
-            sds file_path = sdsnew(postdata);
+            sds file_path = sdsdup(request->postdata);
             sdsrange(file_path, 2, -1);
             int nread;
-            sds file_content = sds_getfile(sdsempty(), file_path, &nread);
-            sdsfree(file_path);
+            request->file_content = sds_getfile(sdsempty(), file_path, &nread);
+            FREE_SDS(file_path);
             if (nread == -1) {
-                goto out;
+                return NULL;
             }
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, file_content);
-        }
-        else {
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, postdata);
         }
     }
-    char err_buf[CURL_ERROR_SIZE];
-    curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, err_buf);
-    curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, method);
+    CURL *curl = curl_easy_init();
+    if (curl == NULL) {
+        return NULL;
+    }
+    curl_easy_setopt(curl, CURLOPT_URL, request->uri);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, (curl_write_callback)catch_output);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &request->response_body);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &request->response_header);
+    if (request->postdata != NULL) {
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, request->headers);
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request->file_content != NULL
+            ? request->file_content
+            : request->postdata);
+    }
+    curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, request->err_buf);
+    curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, request->method);
     curl_easy_setopt(curl, CURLOPT_USERAGENT, "myGPIOd");
-    res = curl_easy_perform(curl);
-    curl_slist_free_all(slist);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, (long)HTTP_CLIENT_TIMEOUT_MS);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_PRIVATE, request);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    request->start_us = metrics_now_us();
+    return curl;
+}
+
+/**
+ * Records the duration and logs the result of a finished transfer
+ * @param request The finished request
+ * @param res Result of the transfer
+ * @return true on success, else false
+ */
+bool http_request_done(struct t_http_request *request, CURLcode res) {
+    metrics_observe(&metrics.http_client_duration, request->start_us);
     if (res != CURLE_OK) {
-        MYGPIOD_LOG_ERROR("HTTP call failed: %s", curl_easy_strerror(res));
-        MYGPIOD_LOG_ERROR("Error: %s", err_buf);
-    }
-    else {
-        rc = true;
+        MYGPIOD_LOG_ERROR("HTTP call to \"%s\" failed: %s", request->uri, curl_easy_strerror(res));
+        MYGPIOD_LOG_ERROR("Error: %s", request->err_buf);
+        return false;
     }
+    return true;
+}
 
-    // Cleanup
-    out:
+/**
+ * Makes a blocking http call
+ * @param method HTTP method
+ * @param uri HTTP Uri
+ * @param content_type Content-Type or NULL
+ * @param postdata data to post or NULL
+ * @param response_header Already allocated sds string to populate with the response header
+ * @param response_body Already allocated sds string to populate with the response body
+ * @returns true on success, else false
+ */
+bool http_client(const char *method, const char *uri, const char *content_type, const char *postdata,
+        sds *response_header, sds *response_body)
+{
+    struct t_http_request *request = http_request_new(method, uri, content_type, postdata);
+    bool rc = false;
+    CURL *curl = http_request_easy_new(request);
     if (curl != NULL) {
+        CURLcode res = curl_easy_perform(curl);
+        rc = http_request_done(request, res);
         curl_easy_cleanup(curl);
     }
-    curl_global_cleanup();
+    else {
+        MYGPIOD_LOG_ERROR("HTTP call to \"%s\" failed: Can not create the request", uri);
+    }
+    *response_header = sdscatsds(*response_header, request->response_header);
+    *response_body = sdscatsds(*response_body, request->response_body);
+    http_request_free(request);
     return rc;
 }
 
@@ -13,8 +13,39 @@
 
 #include "dist/sds/sds.h"
 
+#include <curl/curl.h>
 #include <stdbool.h>
+#include <stdint.h>
 
+struct t_http_request;
+
+/**
+ * Called by the event loop if a request has finished
+ */
+typedef void (*http_request_done_cb)(struct t_http_request *request, unsigned status, void *data);
+
+/**
+ * A HTTP request and its response
+ */
+struct t_http_request {
+    sds method;                     //!< HTTP method
+    sds uri;                        //!< URI
+    sds content_type;               //!< Content type of post data or NULL
+    sds postdata;                   //!< Post data or NULL
+    sds response_header;            //!< Response header
+    sds response_body;              //!< Response body
+    struct curl_slist *headers;     //!< Request headers
+    sds file_content;               //!< Post data read from a file or NULL
+    uint64_t start_us;              //!< Start of the transfer
+    http_request_done_cb done_cb;   //!< Completion callback or NULL
+    void *done_data;                //!< Data for the completion callback
+    char err_buf[CURL_ERROR_SIZE];  //!< Curl error buffer
+};
+
+struct t_http_request *http_request_new(const char *method, const char *uri, const char *content_type, const char *postdata);
+void http_request_free(struct t_http_request *request);
+CURL *http_request_easy_new(struct t_http_request *request);
+bool http_request_done(struct t_http_request *request, CURLcode res);
 bool http_client(const char *method, const char *uri, const char *content_type, const char *postdata,
         sds *response_header, sds *response_body);
 
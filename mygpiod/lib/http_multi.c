@@ -0,0 +1,339 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief HTTP client driven by the event loop
+ *
+ * All asynchronous HTTP requests share one curl multi handle. curl reports
+ * the sockets and the timeout it needs through callbacks, they are polled
+ * by the main event loop next to the GPIO fds. No threads are created.
+ * Connections and DNS results are cached by the multi handle and reused
+ * by the following requests.
+ */
+
+#include "compile_time.h"
+#include "mygpiod/lib/http_multi.h"
+
+#include "mygpiod/event_loop/event_loop.h"
+#include "mygpiod/lib/events.h"
+#include "mygpiod/lib/log.h"
+#include "mygpiod/lib/mem.h"
+#include "mygpiod/lib/metrics.h"
+#include "mygpiod/lib/timer.h"
+
+#include <errno.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+// private definitions
+
+/**
+ * State of the HTTP client
+ */
+struct t_http_multi {
+    CURLM *multi;             //!< Curl multi handle
+    int timer_fd;             //!< Timer for the curl timeouts
+    struct t_list sockets;    //!< Sockets to poll, data is struct t_http_socket
+    struct t_list transfers;  //!< Running transfers, data is the easy handle
+};
+
+static struct t_http_multi http_multi = {
+    .multi = NULL,
+    .timer_fd = -1
+};
+
+static int socket_cb(CURL *curl, curl_socket_t s, int what, void *userp, void *socketp);
+static int timer_cb(CURLM *multi, long timeout_ms, void *userp);
+static void read_done(struct t_config *config);
+static void transfer_remove(CURL *curl);
+static void log_response(struct t_http_request *request);
+
+// public functions
+
+/**
+ * Creates the curl multi handle and its timer fd
+ * @return true on success, else false
+ */
+bool http_multi_init(void) {
+    list_init(&http_multi.sockets);
+    list_init(&http_multi.transfers);
+    http_multi.timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (http_multi.timer_fd == -1) {
+        MYGPIOD_LOG_ERROR("Can not create the http client timer");
+        MYGPIOD_LOG_ERRNO(errno);
+        return false;
+    }
+    http_multi.multi = curl_multi_init();
+    if (http_multi.multi == NULL) {
+        MYGPIOD_LOG_ERROR("Can not create the curl multi handle");
+        close_fd(&http_multi.timer_fd);
+        return false;
+    }
+    curl_multi_setopt(http_multi.multi, CURLMOPT_SOCKETFUNCTION, socket_cb);
+    curl_multi_setopt(http_multi.multi, CURLMOPT_TIMERFUNCTION, timer_cb);
+    // Queue concurrent requests to the same host for a warm connection
+    curl_multi_setopt(http_multi.multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long)HTTP_CLIENT_HOST_CONNECTIONS_MAX);
+    return true;
+}
+
+/**
+ * Aborts all running transfers and frees the multi handle
+ */
+void http_multi_clear(void) {
+    if (http_multi.multi == NULL) {
+        return;
+    }
+    struct t_list_node *node;
+    while ((node = list_shift(&http_multi.transfers)) != NULL) {
+        transfer_remove((CURL *)node->data);
+        FREE_PTR(node);
+    }
+    curl_multi_cleanup(http_multi.multi);
+    http_multi.multi = NULL;
+    while ((node = list_shift(&http_multi.sockets)) != NULL) {
+        FREE_PTR(node->data);
+        FREE_PTR(node);
+    }
+    close_fd(&http_multi.timer_fd);
+}
+
+/**
+ * Starts a request, the transfer is driven by the event loop.
+ * Takes the ownership of the request.
+ * @param request Request to start
+ * @return true on success, false if too many requests are running
+ */
+bool http_multi_push(struct t_http_request *request) {
+    if (http_multi.multi == NULL ||
+        http_multi.transfers.length >= HTTP_CLIENT_PENDING_MAX)
+    {
+        MYGPIOD_LOG_ERROR("Too many running HTTP requests, dropping request to \"%s\"", request->uri);
+        http_request_free(request);
+        return false;
+    }
+    CURL *curl = http_request_easy_new(request);
+    if (curl == NULL) {
+        MYGPIOD_LOG_ERROR("HTTP call to \"%s\" failed: Can not create the request", request->uri);
+        http_request_free(request);
+        return false;
+    }
+    MYGPIOD_LOG_DEBUG("Starting HTTP call to \"%s\"", request->uri);
+    // curl arms the timer through timer_cb to start the transfer
+    CURLMcode mc = curl_multi_add_handle(http_multi.multi, curl);
+    if (mc != CURLM_OK) {
+        MYGPIOD_LOG_ERROR("HTTP call to \"%s\" failed: %s", request->uri, curl_multi_strerror(mc));
+        curl_easy_cleanup(curl);
+        http_request_free(request);
+        return false;
+    }
+    list_push(&http_multi.transfers, 0, curl);
+    return true;
+}
+
+/**
+ * Returns the timer fd that must be polled for the curl timeouts
+ * @return Timer fd
+ */
+int http_multi_timer_fd(void) {
+    return http_multi.timer_fd;
+}
+
+/**
+ * Returns the list of sockets to poll, the list node id is the fd
+ * @return Pointer to the list
+ */
+struct t_list *http_multi_sockets(void) {
+    return &http_multi.sockets;
+}
+
+/**
+ * Drives the transfers of a socket with pending events
+ * @param config Pointer to config
+ * @param pfd Polled socket
+ */
+void http_multi_handle_socket(struct t_config *config, struct pollfd *pfd) {
+    int ev_bitmask = 0;
+    if (pfd->revents & POLLIN) {
+        ev_bitmask |= CURL_CSELECT_IN;
+    }
+    if (pfd->revents & POLLOUT) {
+        ev_bitmask |= CURL_CSELECT_OUT;
+    }
+    if (pfd->revents & (POLLERR | POLLHUP | POLLNVAL)) {
+        ev_bitmask |= CURL_CSELECT_ERR;
+    }
+    int running;
+    CURLMcode mc = curl_multi_socket_action(http_multi.multi, pfd->fd, ev_bitmask, &running);
+    if (mc != CURLM_OK) {
+        MYGPIOD_LOG_ERROR("curl_multi_socket_action failed: %s", curl_multi_strerror(mc));
+    }
+    read_done(config);
+}
+
+/**
+ * Drives the transfers after a curl timeout has expired
+ * @param config Pointer to config
+ * @param fd Pointer to the timer fd
+ */
+void http_multi_handle_timer(struct t_config *config, int *fd) {
+    if (timerfd_read_value(fd) == false) {
+        return;
+    }
+    int running;
+    CURLMcode mc = curl_multi_socket_action(http_multi.multi, CURL_SOCKET_TIMEOUT, 0, &running);
+    if (mc != CURLM_OK) {
+        MYGPIOD_LOG_ERROR("curl_multi_socket_action failed: %s", curl_multi_strerror(mc));
+    }
+    read_done(config);
+}
+
+// private functions
+
+/**
+ * Curl callback to update the sockets to poll
+ * @param curl Easy handle, not used
+ * @param s The socket
+ * @param what Events curl waits for or CURL_POLL_REMOVE
+ * @param userp Not used
+ * @param socketp Not used
+ * @return 0
+ */
+static int socket_cb(CURL *curl, curl_socket_t s, int what, void *userp, void *socketp) {
+    (void)curl;
+    (void)userp;
+    (void)socketp;
+    struct t_list_node *node = list_node_by_id(&http_multi.sockets, (unsigned)s);
+    if (what == CURL_POLL_REMOVE) {
+        if (node != NULL) {
+            list_remove_node(&http_multi.sockets, node);
+            FREE_PTR(node->data);
+            FREE_PTR(node);
+        }
+        update_pollfds = true;
+        return 0;
+    }
+    short events = 0;
+    if (what & CURL_POLL_IN) {
+        events |= POLLIN;
+    }
+    if (what & CURL_POLL_OUT) {
+        events |= POLLOUT;
+    }
+    if (node == NULL) {
+        struct t_http_socket *data = malloc_assert(sizeof(struct t_http_socket));
+        data->events = events;
+        list_push(&http_multi.sockets, (unsigned)s, data);
+    }
+    else {
+        ((struct t_http_socket *)node->data)->events = events;
+    }
+    update_pollfds = true;
+    return 0;
+}
+
+/**
+ * Curl callback to update the timeout.
+ * curl_multi_socket_action must not be called from here,
+ * an expired timeout is handled by the event loop.
+ * @param multi Multi handle, not used
+ * @param timeout_ms Timeout in milliseconds, -1 to delete the timer
+ * @param userp Not used
+ * @return 0 on success, -1 on error
+ */
+static int timer_cb(CURLM *multi, long timeout_ms, void *userp) {
+    (void)multi;
+    (void)userp;
+    struct itimerspec its = { 0 };
+    if (timeout_ms > 0) {
+        its.it_value.tv_sec = timeout_ms / 1000;
+        its.it_value.tv_nsec = (timeout_ms % 1000) * 1000000;
+    }
+    else if (timeout_ms == 0) {
+        // Expire as soon as possible, a zero value would disarm the timer
+        its.it_value.tv_nsec = 1;
+    }
+    if (timerfd_settime(http_multi.timer_fd, 0, &its, NULL) == -1) {
+        MYGPIOD_LOG_ERROR("Can not set the http client timer");
+        MYGPIOD_LOG_ERRNO(errno);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Removes the finished transfers and emits the http_done events
+ * @param config Pointer to config
+ */
+static void read_done(struct t_config *config) {
+    CURLMsg *msg;
+    int msgs_left;
+    while ((msg = curl_multi_info_read(http_multi.multi, &msgs_left)) != NULL) {
+        if (msg->msg != CURLMSG_DONE) {
+            continue;
+        }
+        CURL *curl = msg->easy_handle;
+        CURLcode res = msg->data.result;
+        struct t_http_request *request;
+        curl_easy_getinfo(curl, CURLINFO_PRIVATE, (char **)&request);
+        long status = 0;
+        if (http_request_done(request, res) == true) {
+            curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+            log_response(request);
+        }
+        event_enqueue_http_done(config, request->uri, (unsigned)status,
+            (metrics_now_us() - request->start_us) / 1000);
+        struct t_list_node *current = http_multi.transfers.head;
+        while (current != NULL) {
+            if (current->data == curl) {
+                list_remove_node(&http_multi.transfers, current);
+                FREE_PTR(current);
+                break;
+            }
+            current = current->next;
+        }
+        if (request->done_cb != NULL) {
+            // The callback can start new transfers
+            request->done_cb(request, (unsigned)status, request->done_data);
+        }
+        transfer_remove(curl);
+    }
+}
+
+/**
+ * Removes a transfer from the multi handle and frees it
+ * @param curl Easy handle of the transfer
+ */
+static void transfer_remove(CURL *curl) {
+    struct t_http_request *request;
+    curl_easy_getinfo(curl, CURLINFO_PRIVATE, (char **)&request);
+    curl_multi_remove_handle(http_multi.multi, curl);
+    curl_easy_cleanup(curl);
+    http_request_free(request);
+}
+
+/**
+ * Logs the shortened response
+ * @param request Finished request
+ */
+static void log_response(struct t_http_request *request) {
+    sds resp_header = request->response_header;
+    sds resp_body = request->response_body;
+    sdstrim(resp_header, "\r\n");
+    sdstrim(resp_body, "\r\n");
+    resp_header = sdsmapchars(resp_header, "\r\n", "  ", 2);
+    resp_body = sdsmapchars(resp_body, "\r\n", "  ", 2);
+    if (sdslen(resp_header) > 1023) {
+        sdsrange(resp_header, 0, 1020);
+        resp_header = sdscatlen(resp_header, "...", 3);
+    }
+    if (sdslen(resp_body) > 1023) {
+        sdsrange(resp_body, 0, 1020);
+        resp_body = sdscatlen(resp_body, "...", 3);
+    }
+    request->response_header = resp_header;
+    request->response_body = resp_body;
+    MYGPIOD_LOG_DEBUG("Header: %s\nBody: %s", resp_header, resp_body);
+}
@@ -0,0 +1,36 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief HTTP client driven by the event loop
+ */
+
+#ifndef MYGPIOD_HTTP_MULTI_H
+#define MYGPIOD_HTTP_MULTI_H
+
+#include "mygpiod/config/config.h"
+#include "mygpiod/lib/http_client.h"
+#include "mygpiod/lib/list.h"
+
+#include <poll.h>
+#include <stdbool.h>
+
+/**
+ * A socket curl wants to be polled, the list node id is the fd
+ */
+struct t_http_socket {
+    short events;  //!< Events to poll for
+};
+
+bool http_multi_init(void);
+void http_multi_clear(void);
+bool http_multi_push(struct t_http_request *request);
+int http_multi_timer_fd(void);
+struct t_list *http_multi_sockets(void);
+void http_multi_handle_socket(struct t_config *config, struct pollfd *pfd);
+void http_multi_handle_timer(struct t_config *config, int *fd);
+
+#endif
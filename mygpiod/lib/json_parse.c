@@ -0,0 +1,241 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Minimal JSON parsing for flat objects
+ */
+
+#include "compile_time.h"
+#include "mygpiod/lib/json_parse.h"
+
+#include <ctype.h>
+#include <stdbool.h>
+#include <string.h>
+
+// private definitions
+
+static const char *parse_string(const char *p, sds *result);
+static const char *parse_literal(const char *p, sds *result);
+static int hex_value(char c);
+
+// public functions
+
+/**
+ * Skips whitespace
+ * @param p Pointer to json string
+ * @return Pointer to the first non whitespace char
+ */
+const char *json_skip_ws(const char *p) {
+    while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') {
+        p++;
+    }
+    return p;
+}
+
+/**
+ * Parses a flat json object.
+ * Nested objects and arrays are not supported.
+ * @param p Pointer to json string, must point to the opening brace
+ * @param obj Object to populate, must be cleared with json_object_clear
+ * @return Pointer after the closing brace or NULL on error
+ */
+const char *json_parse_object(const char *p, struct t_json_object *obj) {
+    obj->count = 0;
+    p = json_skip_ws(p);
+    if (*p != '{') {
+        return NULL;
+    }
+    p = json_skip_ws(p + 1);
+    if (*p == '}') {
+        return p + 1;
+    }
+    while (true) {
+        if (obj->count == JSON_OBJECT_KEYS_MAX) {
+            return NULL;
+        }
+        sds key = NULL;
+        p = parse_string(p, &key);
+        if (p == NULL) {
+            return NULL;
+        }
+        p = json_skip_ws(p);
+        if (*p != ':') {
+            sdsfree(key);
+            return NULL;
+        }
+        p = json_skip_ws(p + 1);
+        sds value = NULL;
+        p = *p == '"'
+            ? parse_string(p, &value)
+            : parse_literal(p, &value);
+        if (p == NULL) {
+            sdsfree(key);
+            return NULL;
+        }
+        obj->keys[obj->count] = key;
+        obj->values[obj->count] = value;
+        obj->count++;
+        p = json_skip_ws(p);
+        if (*p == '}') {
+            return p + 1;
+        }
+        if (*p != ',') {
+            return NULL;
+        }
+        p = json_skip_ws(p + 1);
+    }
+}
+
+/**
+ * Gets the value of a key
+ * @param obj Parsed json object
+ * @param key Key to lookup
+ * @return The value or NULL if key was not found
+ */
+const char *json_object_get(const struct t_json_object *obj, const char *key) {
+    for (unsigned i = 0; i < obj->count; i++) {
+        if (strcmp(obj->keys[i], key) == 0) {
+            return obj->values[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Frees the keys and values of a parsed json object
+ * @param obj Parsed json object
+ */
+void json_object_clear(struct t_json_object *obj) {
+    for (unsigned i = 0; i < obj->count; i++) {
+        sdsfree(obj->keys[i]);
+        sdsfree(obj->values[i]);
+    }
+    obj->count = 0;
+}
+
+// private functions
+
+/**
+ * Parses and unescapes a json string
+ * @param p Pointer to the opening quote
+ * @param result Pointer to sds to set with the newly allocated string
+ * @return Pointer after the closing quote or NULL on error
+ */
+static const char *parse_string(const char *p, sds *result) {
+    if (*p != '"') {
+        return NULL;
+    }
+    p++;
+    sds s = sdsempty();
+    while (*p != '"') {
+        if (*p == '\0' ||
+            (unsigned char)*p < 0x20)
+        {
+            sdsfree(s);
+            return NULL;
+        }
+        if (*p != '\\') {
+            const char *start = p;
+            while (*p != '"' && *p != '\\' && (unsigned char)*p >= 0x20) {
+                p++;
+            }
+            s = sdscatlen(s, start, (size_t)(p - start));
+            continue;
+        }
+        p++;
+        char c;
+        switch(*p) {
+            case '"':  c = '"'; break;
+            case '\\': c = '\\'; break;
+            case '/':  c = '/'; break;
+            case 'b':  c = '\b'; break;
+            case 'f':  c = '\f'; break;
+            case 'n':  c = '\n'; break;
+            case 'r':  c = '\r'; break;
+            case 't':  c = '\t'; break;
+            case 'u': {
+                // Only the basic multilingual plane is supported
+                unsigned cp = 0;
+                for (int i = 1; i <= 4; i++) {
+                    int v = hex_value(p[i]);
+                    if (v < 0) {
+                        sdsfree(s);
+                        return NULL;
+                    }
+                    cp = (cp << 4) | (unsigned)v;
+                }
+                if (cp == 0) {
+                    // Strings are used as C strings
+                    sdsfree(s);
+                    return NULL;
+                }
+                p += 5;
+                char utf8[3];
+                if (cp < 0x80) {
+                    utf8[0] = (char)cp;
+                    s = sdscatlen(s, utf8, 1);
+                }
+                else if (cp < 0x800) {
+                    utf8[0] = (char)(0xC0 | (cp >> 6));
+                    utf8[1] = (char)(0x80 | (cp & 0x3F));
+                    s = sdscatlen(s, utf8, 2);
+                }
+                else {
+                    utf8[0] = (char)(0xE0 | (cp >> 12));
+                    utf8[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+                    utf8[2] = (char)(0x80 | (cp & 0x3F));
+                    s = sdscatlen(s, utf8, 3);
+                }
+                continue;
+            }
+            default:
+                sdsfree(s);
+                return NULL;
+        }
+        s = sdscatlen(s, &c, 1);
+        p++;
+    }
+    *result = s;
+    return p + 1;
+}
+
+/**
+ * Parses a number or a literal (true, false, null)
+ * @param p Pointer to the first char
+ * @param result Pointer to sds to set with the newly allocated string
+ * @return Pointer after the value or NULL on error
+ */
+static const char *parse_literal(const char *p, sds *result) {
+    const char *start = p;
+    while (isalnum((unsigned char)*p) ||
+           *p == '-' || *p == '+' || *p == '.')
+    {
+        p++;
+    }
+    if (p == start) {
+        return NULL;
+    }
+    *result = sdsnewlen(start, (size_t)(p - start));
+    return p;
+}
+
+/**
+ * Converts a hex char to its value
+ * @param c Char to convert
+ * @return Value or -1 on error
+ */
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
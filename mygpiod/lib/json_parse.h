@@ -0,0 +1,36 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Minimal JSON parsing for flat objects
+ */
+
+#ifndef MYGPIOD_JSON_PARSE_H
+#define MYGPIOD_JSON_PARSE_H
+
+#include "dist/sds/sds.h"
+
+/**
+ * Maximum number of keys in a json object
+ */
+#define JSON_OBJECT_KEYS_MAX 16
+
+/**
+ * A parsed flat json object.
+ * Values are stored as unescaped strings, numbers and literals as they are.
+ */
+struct t_json_object {
+    unsigned count;                      //!< Number of keys
+    sds keys[JSON_OBJECT_KEYS_MAX];      //!< Keys
+    sds values[JSON_OBJECT_KEYS_MAX];    //!< Values
+};
+
+const char *json_skip_ws(const char *p);
+const char *json_parse_object(const char *p, struct t_json_object *obj);
+const char *json_object_get(const struct t_json_object *obj, const char *key);
+void json_object_clear(struct t_json_object *obj);
+
+#endif
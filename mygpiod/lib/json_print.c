@@ -15,22 +15,23 @@
 #include <string.h>
 
 /**
- * JSON escapes special chars
- * @param c char to escape
- * @return escaped char
+ * Escape table for json strings.
+ * 0 = copy the char, 1 = skip the char, 'u' = unicode escape,
+ * everything else is the char for a two char escape sequence.
  */
-static const char *escape_char(char c) {
-    switch(c) {
-        case '\\': return "\\\\";
-        case '"':  return "\\\"";
-        case '\b': return "\\b";
-        case '\f': return "\\f";
-        case '\n': return "\\n";
-        case '\r': return "\\r";
-        case '\t': return "\\t";
-    }
-    return NULL;
-}
+const char json_escape_table[256] = {
+    ['\x00'] = 'u', ['\x01'] = 'u', ['\x02'] = 'u', ['\x03'] = 'u',
+    ['\x04'] = 'u', ['\x05'] = 'u', ['\x06'] = 'u',
+    // skip alert and vertical tabulator, these escapes are not accepted in the unescape function
+    ['\a'] = 1, ['\v'] = 1,
+    ['\b'] = 'b', ['\t'] = 't', ['\n'] = 'n', ['\f'] = 'f', ['\r'] = 'r',
+    ['\x0e'] = 'u', ['\x0f'] = 'u', ['\x10'] = 'u', ['\x11'] = 'u',
+    ['\x12'] = 'u', ['\x13'] = 'u', ['\x14'] = 'u', ['\x15'] = 'u',
+    ['\x16'] = 'u', ['\x17'] = 'u', ['\x18'] = 'u', ['\x19'] = 'u',
+    ['\x1a'] = 'u', ['\x1b'] = 'u', ['\x1c'] = 'u', ['\x1d'] = 'u',
+    ['\x1e'] = 'u', ['\x1f'] = 'u',
+    ['"'] = '"', ['\\'] = '\\'
+};
 
 /**
  * Append to the sds string "s" a json escaped string
@@ -57,43 +58,30 @@ sds sds_catjson_plain_len(sds s, const char *p, size_t len) {
     /* To avoid continuous reallocations, let's start with a buffer that
      * can hold at least stringlength + 10 chars. */
     s = sdsMakeRoomFor(s, len + 10);
-    size_t i = sdslen(s);
-    while (len--) {
-        switch(*p) {
-            case '\\':
-            case '"':
-            case '\b':
-            case '\f':
-            case '\n':
-            case '\r':
-            case '\t': {
-                if (sdsavail(s) == 0) {
-                    s = sdsMakeRoomFor(s, 2);
-                }
-                const char *escape = escape_char(*p);
-                s[i++] = escape[0];
-                s[i++] = escape[1];
-                sdsinclen(s, 2);
-                break;
-            }
-            //ignore vertical tabulator and alert
-            case '\v':
-            case '\a':
-                //this escapes are not accepted in the unescape function
-                break;
-            default:
-                if (sdsavail(s) == 0) {
-                    s = sdsMakeRoomFor(s, 1);
-                }
-                s[i++] = *p;
-                sdsinclen(s, 1);
-                break;
+    const unsigned char *u = (const unsigned char *)p;
+    size_t start = 0;
+    for (size_t i = 0; i < len; i++) {
+        char escape = json_escape_table[u[i]];
+        if (escape == 0) {
+            continue;
+        }
+        // Copy the run of chars that need no escaping at once
+        s = sdscatlen(s, p + start, i - start);
+        start = i + 1;
+        if (escape == 1) {
+            continue;
+        }
+        if (escape == 'u') {
+            static const char hex[] = "0123456789abcdef";
+            char seq[6] = { '\\', 'u', '0', '0', hex[u[i] >> 4], hex[u[i] & 0x0f] };
+            s = sdscatlen(s, seq, 6);
+        }
+        else {
+            char seq[2] = { '\\', escape };
+            s = sdscatlen(s, seq, 2);
         }
-        p++;
     }
-    // Add null-term
-    s[i] = '\0';
-    return s;
+    return sdscatlen(s, p + start, len - start);
 }
 
 /**
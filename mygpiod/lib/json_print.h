@@ -15,6 +15,8 @@
 
 #include <stdbool.h>
 
+extern const char json_escape_table[256];
+
 sds sds_catjson_plain(sds s, const char *p);
 sds sds_catjson(sds s, const char *p);
 sds sds_catjson_plain_len(sds s, const char *p, size_t len);
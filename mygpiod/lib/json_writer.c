@@ -0,0 +1,352 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Streaming JSON writer
+ *
+ * Appends to a caller provided sds buffer, the capacity can be reserved
+ * up front to avoid reallocations while writing.
+ */
+
+#include "compile_time.h"
+#include "mygpiod/lib/json_writer.h"
+
+#include "mygpiod/lib/json_print.h"
+
+#include <string.h>
+
+// private definitions
+
+/**
+ * Maximum length of a 64 bit integer as string including the sign
+ */
+#define INT64_STR_LEN 21
+
+static void reserve(struct t_json_writer *w, size_t len);
+static void write_separator(struct t_json_writer *w);
+static void write_len(struct t_json_writer *w, const char *p, size_t len);
+static void write_char(struct t_json_writer *w, char c);
+static void container_begin(struct t_json_writer *w, char c);
+static void container_end(struct t_json_writer *w, char c);
+static char *format_uint(char *end, uint64_t value);
+
+// public functions
+
+/**
+ * Initializes the writer and reserves capacity in the buffer
+ * @param w Writer to initialize
+ * @param buffer Already allocated buffer to append to
+ * @param capacity Expected number of bytes to write
+ */
+void json_writer_init(struct t_json_writer *w, sds buffer, size_t capacity) {
+    w->buffer = sdsMakeRoomFor(buffer, capacity);
+    w->len = sdslen(w->buffer);
+    w->alloc = sdsalloc(w->buffer);
+    w->depth = 0;
+    w->has_items = 0;
+    w->after_key = false;
+}
+
+/**
+ * Returns the buffer, the writer must not be used afterwards
+ * @param w Writer
+ * @return Pointer to buffer
+ */
+sds json_writer_finish(struct t_json_writer *w) {
+    sds buffer = w->buffer;
+    sdssetlen(buffer, w->len);
+    buffer[w->len] = '\0';
+    w->buffer = NULL;
+    return buffer;
+}
+
+/**
+ * Begins an object
+ * @param w Writer
+ */
+void json_writer_object_begin(struct t_json_writer *w) {
+    container_begin(w, '{');
+}
+
+/**
+ * Ends an object
+ * @param w Writer
+ */
+void json_writer_object_end(struct t_json_writer *w) {
+    container_end(w, '}');
+}
+
+/**
+ * Begins an array
+ * @param w Writer
+ */
+void json_writer_array_begin(struct t_json_writer *w) {
+    container_begin(w, '[');
+}
+
+/**
+ * Ends an array
+ * @param w Writer
+ */
+void json_writer_array_end(struct t_json_writer *w) {
+    container_end(w, ']');
+}
+
+/**
+ * Writes an object key, the key is not escaped
+ * @param w Writer
+ * @param key Key
+ */
+void json_writer_key(struct t_json_writer *w, const char *key) {
+    write_separator(w);
+    size_t len = strlen(key);
+    reserve(w, len + 3);
+    char *p = w->buffer + w->len;
+    *p++ = '"';
+    memcpy(p, key, len);
+    p += len;
+    *p++ = '"';
+    *p = ':';
+    w->len += len + 3;
+    w->after_key = true;
+}
+
+/**
+ * Writes a json escaped string value
+ * @param w Writer
+ * @param value String to escape
+ */
+void json_writer_string(struct t_json_writer *w, const char *value) {
+    write_separator(w);
+    size_t len = strlen(value);
+    reserve(w, len + 2);
+    w->buffer[w->len++] = '"';
+    const unsigned char *u = (const unsigned char *)value;
+    for (size_t i = 0; i < len; i++) {
+        char escape = json_escape_table[u[i]];
+        if (escape == 0) {
+            w->buffer[w->len++] = value[i];
+            continue;
+        }
+        if (escape == 1) {
+            continue;
+        }
+        // Room for the escape sequence, the remaining chars and the closing quote
+        reserve(w, 6 + len - i);
+        w->buffer[w->len++] = '\\';
+        if (escape == 'u') {
+            static const char hex[] = "0123456789abcdef";
+            w->buffer[w->len++] = 'u';
+            w->buffer[w->len++] = '0';
+            w->buffer[w->len++] = '0';
+            w->buffer[w->len++] = hex[u[i] >> 4];
+            w->buffer[w->len++] = hex[u[i] & 0x0f];
+        }
+        else {
+            w->buffer[w->len++] = escape;
+        }
+    }
+    w->buffer[w->len++] = '"';
+}
+
+/**
+ * Writes an unsigned integer value
+ * @param w Writer
+ * @param value Value
+ */
+void json_writer_uint(struct t_json_writer *w, uint64_t value) {
+    write_separator(w);
+    char buf[INT64_STR_LEN];
+    char *end = buf + sizeof(buf);
+    char *start = format_uint(end, value);
+    write_len(w, start, (size_t)(end - start));
+}
+
+/**
+ * Writes a signed integer value
+ * @param w Writer
+ * @param value Value
+ */
+void json_writer_int(struct t_json_writer *w, int64_t value) {
+    write_separator(w);
+    char buf[INT64_STR_LEN];
+    char *end = buf + sizeof(buf);
+    char *start;
+    if (value < 0) {
+        start = format_uint(end, (uint64_t)0 - (uint64_t)value);
+        *--start = '-';
+    }
+    else {
+        start = format_uint(end, (uint64_t)value);
+    }
+    write_len(w, start, (size_t)(end - start));
+}
+
+/**
+ * Writes a bool value
+ * @param w Writer
+ * @param value Value
+ */
+void json_writer_bool(struct t_json_writer *w, bool value) {
+    write_separator(w);
+    if (value == true) {
+        write_len(w, "true", 4);
+    }
+    else {
+        write_len(w, "false", 5);
+    }
+}
+
+/**
+ * Writes an already encoded json value
+ * @param w Writer
+ * @param json Json value
+ */
+void json_writer_raw(struct t_json_writer *w, const char *json) {
+    write_separator(w);
+    write_len(w, json, strlen(json));
+}
+
+/**
+ * Writes a key with a json escaped string value
+ * @param w Writer
+ * @param key Key
+ * @param value String to escape
+ */
+void json_writer_kv_string(struct t_json_writer *w, const char *key, const char *value) {
+    json_writer_key(w, key);
+    json_writer_string(w, value);
+}
+
+/**
+ * Writes a key with an unsigned integer value
+ * @param w Writer
+ * @param key Key
+ * @param value Value
+ */
+void json_writer_kv_uint(struct t_json_writer *w, const char *key, uint64_t value) {
+    json_writer_key(w, key);
+    json_writer_uint(w, value);
+}
+
+/**
+ * Writes a key with a signed integer value
+ * @param w Writer
+ * @param key Key
+ * @param value Value
+ */
+void json_writer_kv_int(struct t_json_writer *w, const char *key, int64_t value) {
+    json_writer_key(w, key);
+    json_writer_int(w, value);
+}
+
+/**
+ * Writes a key with a bool value
+ * @param w Writer
+ * @param key Key
+ * @param value Value
+ */
+void json_writer_kv_bool(struct t_json_writer *w, const char *key, bool value) {
+    json_writer_key(w, key);
+    json_writer_bool(w, value);
+}
+
+// private functions
+
+/**
+ * Ensures that the buffer has room for len more bytes
+ * @param w Writer
+ * @param len Number of bytes to write
+ */
+static void reserve(struct t_json_writer *w, size_t len) {
+    if (w->alloc - w->len >= len) {
+        return;
+    }
+    sdssetlen(w->buffer, w->len);
+    w->buffer = sdsMakeRoomFor(w->buffer, len);
+    w->alloc = sdsalloc(w->buffer);
+}
+
+/**
+ * Writes the comma before a value or key if required
+ * @param w Writer
+ */
+static void write_separator(struct t_json_writer *w) {
+    if (w->after_key == true) {
+        w->after_key = false;
+        return;
+    }
+    uint32_t bit = (uint32_t)1 << w->depth;
+    if (w->has_items & bit) {
+        write_char(w, ',');
+    }
+    else {
+        w->has_items |= bit;
+    }
+}
+
+/**
+ * Appends raw bytes
+ * @param w Writer
+ * @param p Bytes to append
+ * @param len Number of bytes
+ */
+static void write_len(struct t_json_writer *w, const char *p, size_t len) {
+    reserve(w, len);
+    memcpy(w->buffer + w->len, p, len);
+    w->len += len;
+}
+
+/**
+ * Appends a single char
+ * @param w Writer
+ * @param c Char to append
+ */
+static void write_char(struct t_json_writer *w, char c) {
+    reserve(w, 1);
+    w->buffer[w->len++] = c;
+}
+
+/**
+ * Begins a nesting level
+ * @param w Writer
+ * @param c Opening char
+ */
+static void container_begin(struct t_json_writer *w, char c) {
+    write_separator(w);
+    write_char(w, c);
+    if (w->depth < JSON_WRITER_DEPTH_MAX - 1) {
+        w->depth++;
+        w->has_items &= ~((uint32_t)1 << w->depth);
+    }
+}
+
+/**
+ * Ends a nesting level
+ * @param w Writer
+ * @param c Closing char
+ */
+static void container_end(struct t_json_writer *w, char c) {
+    if (w->depth > 0) {
+        w->depth--;
+    }
+    write_char(w, c);
+}
+
+/**
+ * Formats an unsigned integer backwards into a buffer
+ * @param end Pointer after the last char of the buffer
+ * @param value Value to format
+ * @return Pointer to the first char
+ */
+static char *format_uint(char *end, uint64_t value) {
+    char *p = end;
+    do {
+        *--p = (char)('0' + (value % 10));
+        value /= 10;
+    } while (value > 0);
+    return p;
+}
@@ -0,0 +1,58 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Streaming JSON writer
+ */
+
+#ifndef MYGPIOD_JSON_WRITER_H
+#define MYGPIOD_JSON_WRITER_H
+
+#include "dist/sds/sds.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Maximum nesting depth
+ */
+#define JSON_WRITER_DEPTH_MAX 32
+
+/**
+ * JSON writer state.
+ * Tracks the comma placement for each nesting level.
+ * The length of the sds buffer is only updated by json_writer_finish.
+ */
+struct t_json_writer {
+    sds buffer;          //!< Output buffer
+    size_t len;          //!< Bytes written to the buffer
+    size_t alloc;        //!< Allocated size of the buffer
+    unsigned depth;      //!< Current nesting depth
+    uint32_t has_items;  //!< Bitmask of nesting levels with at least one item
+    bool after_key;      //!< The next value belongs to a key
+};
+
+void json_writer_init(struct t_json_writer *w, sds buffer, size_t capacity);
+sds json_writer_finish(struct t_json_writer *w);
+
+void json_writer_object_begin(struct t_json_writer *w);
+void json_writer_object_end(struct t_json_writer *w);
+void json_writer_array_begin(struct t_json_writer *w);
+void json_writer_array_end(struct t_json_writer *w);
+void json_writer_key(struct t_json_writer *w, const char *key);
+
+void json_writer_string(struct t_json_writer *w, const char *value);
+void json_writer_uint(struct t_json_writer *w, uint64_t value);
+void json_writer_int(struct t_json_writer *w, int64_t value);
+void json_writer_bool(struct t_json_writer *w, bool value);
+void json_writer_raw(struct t_json_writer *w, const char *json);
+
+void json_writer_kv_string(struct t_json_writer *w, const char *key, const char *value);
+void json_writer_kv_uint(struct t_json_writer *w, const char *key, uint64_t value);
+void json_writer_kv_int(struct t_json_writer *w, const char *key, int64_t value);
+void json_writer_kv_bool(struct t_json_writer *w, const char *key, bool value);
+
+#endif
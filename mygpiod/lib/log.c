@@ -171,6 +171,10 @@ void mygpiod_log(int level, const char *file, int line, const char *fmt, ...) {
         return;
     }
 
+    if (logline == NULL) {
+        // Threads not created by myGPIOd, e.g. the HTTP threads
+        logline = sdsempty();
+    }
     if (log_type == LOG_TO_TTY) {
         logline = sdscat(logline, loglevel_colors[level]);
         time_t now = time(NULL);
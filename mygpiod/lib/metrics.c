@@ -0,0 +1,63 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Runtime metrics
+ *
+ * The counters are updated lock-free from all threads and
+ * read without synchronization, a scrape is not a consistent snapshot.
+ */
+
+#include "compile_time.h"
+#include "mygpiod/lib/metrics.h"
+
+#include <time.h>
+
+/**
+ * Global metrics, zero initialized
+ */
+struct t_metrics metrics;
+
+/**
+ * Upper bounds of the histogram buckets in microseconds
+ */
+const uint64_t metrics_bucket_bounds_us[METRICS_BUCKETS] = {
+    100, 500, 1000, 5000, 10000, 50000, 100000, 500000, 1000000, 5000000
+};
+
+/**
+ * Upper bounds of the histogram buckets in seconds
+ */
+const char *metrics_bucket_labels[METRICS_BUCKETS] = {
+    "0.0001", "0.0005", "0.001", "0.005", "0.01", "0.05", "0.1", "0.5", "1", "5"
+};
+
+/**
+ * Returns the monotonic time in microseconds
+ * @return Timestamp in microseconds
+ */
+uint64_t metrics_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+/**
+ * Records the duration since start_us, can be called from any thread
+ * @param histogram Histogram to update
+ * @param start_us Start timestamp from metrics_now_us
+ */
+void metrics_observe(struct t_metrics_histogram *histogram, uint64_t start_us) {
+    uint64_t duration_us = metrics_now_us() - start_us;
+    for (unsigned i = 0; i < METRICS_BUCKETS; i++) {
+        if (duration_us <= metrics_bucket_bounds_us[i]) {
+            METRICS_INC(histogram->buckets[i]);
+            break;
+        }
+    }
+    METRICS_INC(histogram->count);
+    atomic_fetch_add_explicit(&histogram->sum_us, duration_us, memory_order_relaxed);
+}
@@ -0,0 +1,89 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Runtime metrics
+ */
+
+#ifndef MYGPIOD_METRICS_H
+#define MYGPIOD_METRICS_H
+
+#include "mygpiod/actions/actions.h"
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+/**
+ * Number of histogram buckets, the +Inf bucket is not included
+ */
+#define METRICS_BUCKETS 10
+
+/**
+ * Number of action types including none
+ */
+#define METRICS_ACTIONS (MYGPIOD_ACTION_NONE + 1)
+
+/**
+ * Increments a counter, can be called from any thread
+ */
+#define METRICS_INC(COUNTER) atomic_fetch_add_explicit(&(COUNTER), 1, memory_order_relaxed)
+
+/**
+ * Timer types
+ */
+enum metrics_timers {
+    METRICS_TIMER_GPIO_IN = 0,  //!< Long press timer
+    METRICS_TIMER_GPIO_OUT,     //!< Blink timer
+    METRICS_TIMER_EV,           //!< Timer event
+    METRICS_TIMERS              //!< Number of timer types
+};
+
+/**
+ * Lua VM types
+ */
+enum metrics_lua {
+    METRICS_LUA_SYNC = 0,       //!< Lua VM in the main thread
+    METRICS_LUA_ASYNC,          //!< Lua VM in its own thread
+    METRICS_LUA_CO,             //!< Lua coroutines in the main thread
+    METRICS_LUA                 //!< Number of Lua VM types
+};
+
+/**
+ * Histogram with fixed buckets, the buckets are not cumulative
+ */
+struct t_metrics_histogram {
+    atomic_uint_fast64_t buckets[METRICS_BUCKETS];  //!< Number of observations per bucket
+    atomic_uint_fast64_t count;                     //!< Number of all observations
+    atomic_uint_fast64_t sum_us;                    //!< Sum of all observations in microseconds
+};
+
+/**
+ * Daemon wide counters, updated with relaxed atomics
+ */
+struct t_metrics {
+    uint64_t started_us;                                    //!< Startup timestamp, set before any thread is created
+    atomic_uint_fast64_t poll_wakeups;                      //!< Returns from poll
+    atomic_uint_fast64_t actions_executed[METRICS_ACTIONS]; //!< Executed actions per type
+    atomic_uint_fast64_t actions_failed[METRICS_ACTIONS];   //!< Failed actions per type
+    atomic_uint_fast64_t events;                            //!< Enqueued GPIO and input events
+    atomic_uint_fast64_t events_dropped;                    //!< Events dropped for slow socket clients
+    atomic_uint_fast64_t timer_fires[METRICS_TIMERS];       //!< Expired timers per type
+    struct t_metrics_histogram lua_duration[METRICS_LUA];   //!< Lua executions per VM type
+    struct t_metrics_histogram lua_async_start;             //!< Time from the trigger to the start of async Lua scripts
+    atomic_uint_fast64_t lua_async_dropped;                 //!< Async Lua scripts dropped because the job queue was full
+    atomic_uint_fast64_t lua_async_coalesced;               //!< Async Lua scripts dropped because the script was already queued
+    atomic_uint_fast64_t lua_timeouts[METRICS_LUA];         //!< Lua executions aborted by the watchdog per VM type
+    struct t_metrics_histogram http_client_duration;        //!< Latency of HTTP calls
+};
+
+extern struct t_metrics metrics;
+extern const uint64_t metrics_bucket_bounds_us[METRICS_BUCKETS];
+extern const char *metrics_bucket_labels[METRICS_BUCKETS];
+
+uint64_t metrics_now_us(void);
+void metrics_observe(struct t_metrics_histogram *histogram, uint64_t start_us);
+
+#endif
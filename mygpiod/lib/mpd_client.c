@@ -0,0 +1,841 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Non-blocking MPD client driven by the event loop
+ *
+ * The connection is opened on the first command and kept open in idle mode.
+ * Queued commands are sent as one command list after a noidle. A broken
+ * connection is reopened with an increasing delay, commands queued while
+ * MPD is unreachable are discarded after MPD_CLIENT_TIMEOUT_MS.
+ * The host is resolved with the blocking getaddrinfo, use an IP address
+ * or a unix socket in MPD_HOST for fully non-blocking operation.
+ *
+ * With mpd_client_subscribe the connection is opened at startup and the
+ * idle command waits for player and mixer changes. Each change queues an
+ * internal status command, its response updates the state mirror and
+ * emits the mpd_player and mpd_mixer events.
+ */
+
+#include "compile_time.h"
+#include "mygpiod/lib/mpd_client.h"
+
+#include "mygpio-common/util.h"
+#include "mygpiod/event_loop/event_loop.h"
+#include "mygpiod/lib/event_types.h"
+#include "mygpiod/lib/events.h"
+#include "mygpiod/lib/log.h"
+#include "mygpiod/lib/mem.h"
+#include "mygpiod/lib/metrics.h"
+#include "mygpiod/lib/sds_extras.h"
+#include "mygpiod/lib/timer.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <netdb.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// private definitions
+
+static void mpc_connect(struct t_mpd_client *client);
+static void mpc_connected(struct t_mpd_client *client);
+static void mpc_fail(struct t_mpd_client *client, const char *reason);
+static bool mpc_read_lines(struct t_mpd_client *client);
+static bool mpc_parse_line(struct t_mpd_client *client, char *line);
+static bool mpc_send_queue(struct t_mpd_client *client);
+static bool mpc_send_idle(struct t_mpd_client *client);
+static void mpc_queue_status(struct t_mpd_client *client);
+static void mpc_command_done(struct t_mpd_client *client, struct t_list_node *node);
+static void mpc_state_update(struct t_mpd_client *client);
+static void mpc_state_invalidate(struct t_mpd_client *client);
+static void mpc_state_emit(struct t_mpd_client *client, unsigned changed);
+static void mpc_parse_status(struct t_mpd_state *state, const char *name, const char *value);
+static void mpd_state_reset(struct t_mpd_state *state);
+static void mpc_queue_expire(struct t_mpd_client *client);
+static bool mpc_send(struct t_mpd_client *client, const char *command);
+static bool mpc_send_command(struct t_mpd_client *client, const struct t_mpd_command *command);
+static bool mpc_send_check(struct t_mpd_client *client, bool rc);
+static void mpc_update_events(struct t_mpd_client *client);
+static void mpc_timer_set(struct t_mpd_client *client, int timeout_ms);
+static struct t_mpd_command *mpd_command_new(int argc, sds *argv);
+static void mpd_command_clear(struct t_list_node *node);
+
+// public functions
+
+/**
+ * Creates the MPD client, the connection is opened on the first command
+ * @param config Pointer to config
+ * @return Allocated client or NULL on error
+ */
+struct t_mpd_client *mpd_client_new(struct t_config *config) {
+    int timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timer_fd == -1) {
+        MYGPIOD_LOG_ERROR("Can not create the MPD client timer");
+        MYGPIOD_LOG_ERRNO(errno);
+        return NULL;
+    }
+    struct t_mpd_client *client = malloc_assert(sizeof(struct t_mpd_client));
+    client->state = MPD_CLIENT_DISCONNECTED;
+    client->fd = -1;
+    client->events = 0;
+    client->timer_fd = timer_fd;
+    client->reconnect = false;
+    client->backoff_ms = 0;
+    client->password = NULL;
+    client->async = NULL;
+    client->parser = NULL;
+    list_init(&client->queue);
+    list_init(&client->sent);
+    client->config = config;
+    client->subscribe = false;
+    client->changed = 0;
+    mpd_state_reset(&client->mirror);
+    mpd_state_reset(&client->pending);
+    return client;
+}
+
+/**
+ * Closes the connection, discards all queued commands and frees the client
+ * @param client Client to free
+ */
+void mpd_client_free(struct t_mpd_client *client) {
+    if (client->async != NULL) {
+        mpd_async_free(client->async);
+    }
+    if (client->parser != NULL) {
+        mpd_parser_free(client->parser);
+    }
+    close_fd(&client->fd);
+    close_fd(&client->timer_fd);
+    FREE_SDS(client->password);
+    list_clear(&client->queue, mpd_command_clear);
+    list_clear(&client->sent, mpd_command_clear);
+    FREE_PTR(client);
+}
+
+/**
+ * Enables the state mirror and connects to MPD
+ * @param client MPD client
+ */
+void mpd_client_subscribe(struct t_mpd_client *client) {
+    client->subscribe = true;
+    if (client->state == MPD_CLIENT_DISCONNECTED &&
+        client->reconnect == false)
+    {
+        mpc_connect(client);
+    }
+}
+
+/**
+ * Queues a MPD command, the arguments are copied
+ * @param client MPD client
+ * @param argc Number of arguments including the command
+ * @param argv Command and arguments
+ * @return true on success, false if the queue is full
+ */
+bool mpd_client_push(struct t_mpd_client *client, int argc, sds *argv) {
+    mpc_queue_expire(client);
+    if (client->queue.length >= MPD_CLIENT_QUEUE_MAX) {
+        MYGPIOD_LOG_ERROR("MPD command queue is full, dropping \"%s\"", argv[0]);
+        return false;
+    }
+    list_push(&client->queue, 0, mpd_command_new(argc, argv));
+
+    switch(client->state) {
+        case MPD_CLIENT_DISCONNECTED:
+            if (client->reconnect == false) {
+                mpc_connect(client);
+            }
+            break;
+        case MPD_CLIENT_IDLE:
+            // Leave the idle mode, the queue is sent after the idle response
+            if (mpc_send(client, "noidle") == true) {
+                client->state = MPD_CLIENT_NOIDLE;
+                mpc_timer_set(client, MPD_CLIENT_TIMEOUT_MS);
+            }
+            break;
+        case MPD_CLIENT_CONNECTING:
+        case MPD_CLIENT_GREETING:
+        case MPD_CLIENT_NOIDLE:
+        case MPD_CLIENT_BUSY:
+            // Sent after the pending response
+            break;
+    }
+    return true;
+}
+
+/**
+ * Handles the events of the MPD socket
+ * @param client MPD client
+ * @param pfd Polled socket
+ */
+void mpd_client_handle_socket(struct t_mpd_client *client, struct pollfd *pfd) {
+    if (client->state == MPD_CLIENT_CONNECTING) {
+        int err = 0;
+        socklen_t len = sizeof(err);
+        if (getsockopt(client->fd, SOL_SOCKET, SO_ERROR, &err, &len) == -1) {
+            err = errno;
+        }
+        if (err != 0) {
+            mpc_fail(client, strerror(err));
+            return;
+        }
+        mpc_connected(client);
+        return;
+    }
+    int events = 0;
+    if (pfd->revents & POLLIN) {
+        events |= MPD_ASYNC_EVENT_READ;
+    }
+    if (pfd->revents & POLLOUT) {
+        events |= MPD_ASYNC_EVENT_WRITE;
+    }
+    if (pfd->revents & POLLHUP) {
+        events |= MPD_ASYNC_EVENT_HUP;
+    }
+    if (pfd->revents & (POLLERR | POLLNVAL)) {
+        events |= MPD_ASYNC_EVENT_ERROR;
+    }
+    if (mpd_async_io(client->async, (enum mpd_async_event)events) == false) {
+        mpc_fail(client, mpd_async_get_error_message(client->async));
+        return;
+    }
+    if (mpc_read_lines(client) == false) {
+        return;
+    }
+    mpc_update_events(client);
+}
+
+/**
+ * Handles the expired timeout or reconnect timer
+ * @param client MPD client
+ * @param fd Pointer to the timer fd
+ */
+void mpd_client_handle_timer(struct t_mpd_client *client, int *fd) {
+    if (timerfd_read_value(fd) == false) {
+        return;
+    }
+    if (client->state == MPD_CLIENT_DISCONNECTED) {
+        client->reconnect = false;
+        mpc_connect(client);
+        return;
+    }
+    mpc_fail(client, "Timeout");
+}
+
+/**
+ * Returns the name of the MPD player state
+ * @param play_state The player state
+ * @return Name of the state
+ */
+const char *mpd_client_lookup_state(enum mpd_state play_state) {
+    switch(play_state) {
+        case MPD_STATE_STOP:
+            return "stop";
+        case MPD_STATE_PLAY:
+            return "play";
+        case MPD_STATE_PAUSE:
+            return "pause";
+        case MPD_STATE_UNKNOWN:
+            break;
+    }
+    return "unknown";
+}
+
+// private functions
+
+/**
+ * Starts a non-blocking connect to MPD with the default libmpdclient settings
+ * @param client MPD client
+ */
+static void mpc_connect(struct t_mpd_client *client) {
+    struct mpd_settings *settings = mpd_settings_new(NULL, 0, 0, NULL, NULL);
+    if (settings == NULL) {
+        mpc_fail(client, "Out of memory");
+        return;
+    }
+    const char *host = mpd_settings_get_host(settings);
+    unsigned port = mpd_settings_get_port(settings);
+    const char *password = mpd_settings_get_password(settings);
+    FREE_SDS(client->password);
+    if (password != NULL) {
+        client->password = sdsnew(password);
+    }
+    MYGPIOD_LOG_DEBUG("Connecting to MPD at \"%s:%u\"", host, port);
+
+    struct sockaddr_storage addr;
+    socklen_t addr_len;
+    memset(&addr, 0, sizeof(addr));
+    if (host[0] == '/' ||
+        host[0] == '@')
+    {
+        // Unix socket, @ is an abstract socket
+        struct sockaddr_un *addr_un = (struct sockaddr_un *)&addr;
+        size_t path_len = strlen(host);
+        if (path_len >= sizeof(addr_un->sun_path)) {
+            mpd_settings_free(settings);
+            mpc_fail(client, "Socket path too long");
+            return;
+        }
+        addr_un->sun_family = AF_UNIX;
+        memcpy(addr_un->sun_path, host, path_len);
+        if (host[0] == '@') {
+            addr_un->sun_path[0] = '\0';
+        }
+        // Abstract socket names are not null terminated
+        addr_len = (socklen_t)(offsetof(struct sockaddr_un, sun_path) + path_len + (host[0] == '@' ? 0 : 1));
+    }
+    else {
+        struct addrinfo hints;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        char service[8];
+        snprintf(service, sizeof(service), "%u", port);
+        struct addrinfo *res;
+        int rc = getaddrinfo(host, service, &hints, &res);
+        if (rc != 0) {
+            mpd_settings_free(settings);
+            mpc_fail(client, gai_strerror(rc));
+            return;
+        }
+        memcpy(&addr, res->ai_addr, res->ai_addrlen);
+        addr_len = res->ai_addrlen;
+        freeaddrinfo(res);
+    }
+    mpd_settings_free(settings);
+
+    client->fd = socket(addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (client->fd == -1) {
+        mpc_fail(client, strerror(errno));
+        return;
+    }
+    update_pollfds = true;
+    if (connect(client->fd, (struct sockaddr *)&addr, addr_len) == 0) {
+        mpc_connected(client);
+        return;
+    }
+    if (errno != EINPROGRESS) {
+        mpc_fail(client, strerror(errno));
+        return;
+    }
+    client->state = MPD_CLIENT_CONNECTING;
+    client->events = POLLOUT;
+    mpc_timer_set(client, MPD_CLIENT_TIMEOUT_MS);
+}
+
+/**
+ * Creates the async connection after the socket is connected
+ * @param client MPD client
+ */
+static void mpc_connected(struct t_mpd_client *client) {
+    client->async = mpd_async_new(client->fd);
+    client->parser = mpd_parser_new();
+    if (client->async == NULL ||
+        client->parser == NULL)
+    {
+        mpc_fail(client, "Out of memory");
+        return;
+    }
+    client->state = MPD_CLIENT_GREETING;
+    mpc_update_events(client);
+    mpc_timer_set(client, MPD_CLIENT_TIMEOUT_MS);
+}
+
+/**
+ * Closes the connection and arms the reconnect timer.
+ * The commands of the running command list are discarded.
+ * @param client MPD client
+ * @param reason Error message to log
+ */
+static void mpc_fail(struct t_mpd_client *client, const char *reason) {
+    MYGPIOD_LOG_ERROR("MPD connection error: %s", reason);
+    if (client->sent.length > 0) {
+        MYGPIOD_LOG_WARN("Discarding %u sent MPD commands", client->sent.length);
+        list_clear(&client->sent, mpd_command_clear);
+    }
+    if (client->async != NULL) {
+        // Closes the socket
+        mpd_async_free(client->async);
+        client->async = NULL;
+        client->fd = -1;
+        update_pollfds = true;
+    }
+    else {
+        close_fd(&client->fd);
+    }
+    if (client->parser != NULL) {
+        mpd_parser_free(client->parser);
+        client->parser = NULL;
+    }
+    client->state = MPD_CLIENT_DISCONNECTED;
+    client->events = 0;
+    mpc_state_invalidate(client);
+    client->backoff_ms = client->backoff_ms == 0
+        ? MPD_CLIENT_BACKOFF_MIN_MS
+        : client->backoff_ms * 2;
+    if (client->backoff_ms > MPD_CLIENT_BACKOFF_MAX_MS) {
+        client->backoff_ms = MPD_CLIENT_BACKOFF_MAX_MS;
+    }
+    MYGPIOD_LOG_INFO("Reconnecting to MPD in %d ms", client->backoff_ms);
+    client->reconnect = true;
+    mpc_timer_set(client, client->backoff_ms);
+}
+
+/**
+ * Processes all received lines
+ * @param client MPD client
+ * @return true on success, false if the connection was closed
+ */
+static bool mpc_read_lines(struct t_mpd_client *client) {
+    char *line;
+    while ((line = mpd_async_recv_line(client->async)) != NULL) {
+        if (mpc_parse_line(client, line) == false) {
+            return false;
+        }
+    }
+    if (mpd_async_get_error(client->async) != MPD_ERROR_SUCCESS) {
+        mpc_fail(client, mpd_async_get_error_message(client->async));
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Processes a received line
+ * @param client MPD client
+ * @param line Line to parse, it is modified
+ * @return true on success, false if the connection was closed
+ */
+static bool mpc_parse_line(struct t_mpd_client *client, char *line) {
+    if (client->state == MPD_CLIENT_GREETING) {
+        if (strncmp(line, "OK MPD ", 7) != 0) {
+            mpc_fail(client, "Invalid welcome message");
+            return false;
+        }
+        MYGPIOD_LOG_INFO("Connected to MPD, protocol version %s", line + 7);
+        client->backoff_ms = 0;
+        if (client->subscribe == true) {
+            // Fetch the initial state
+            client->changed = MPD_CHANGED_PLAYER | MPD_CHANGED_MIXER;
+            mpc_queue_status(client);
+        }
+        if (client->password != NULL) {
+            // Authenticate before the queued commands
+            char cmd[] = "password";
+            sds argv[2] = { cmd, client->password };
+            struct t_mpd_command *command = mpd_command_new(2, argv);
+            list_push(&client->sent, 0, command);
+            if (mpc_send_command(client, command) == false) {
+                return false;
+            }
+            client->state = MPD_CLIENT_BUSY;
+            return true;
+        }
+        return mpc_send_queue(client);
+    }
+
+    enum mpd_parser_result result = mpd_parser_feed(client->parser, line);
+    switch(result) {
+        case MPD_PARSER_PAIR: {
+            const char *name = mpd_parser_get_name(client->parser);
+            const char *value = mpd_parser_get_value(client->parser);
+            if (client->state == MPD_CLIENT_BUSY) {
+                struct t_list_node *node = client->sent.head;
+                if (node != NULL &&
+                    ((struct t_mpd_command *)node->data)->status == true)
+                {
+                    mpc_parse_status(&client->pending, name, value);
+                    return true;
+                }
+                MYGPIOD_LOG_DEBUG("MPD: %s: %s", name, value);
+            }
+            else if (client->subscribe == true &&
+                strcmp(name, "changed") == 0)
+            {
+                // Response of the idle command
+                if (strcmp(value, "player") == 0) {
+                    client->changed |= MPD_CHANGED_PLAYER;
+                }
+                else if (strcmp(value, "mixer") == 0) {
+                    client->changed |= MPD_CHANGED_MIXER;
+                }
+            }
+            return true;
+        }
+        case MPD_PARSER_SUCCESS:
+            if (client->state == MPD_CLIENT_BUSY) {
+                // list_OK for one command of the command list or
+                // OK for the last command
+                bool discrete = mpd_parser_is_discrete(client->parser);
+                struct t_list_node *node;
+                while ((node = list_shift(&client->sent)) != NULL) {
+                    mpc_command_done(client, node);
+                    if (discrete == true) {
+                        return true;
+                    }
+                }
+            }
+            else if (client->subscribe == true &&
+                client->changed != 0)
+            {
+                mpc_queue_status(client);
+            }
+            return mpc_send_queue(client);
+        case MPD_PARSER_ERROR: {
+            struct t_list_node *node = list_shift(&client->sent);
+            MYGPIOD_LOG_ERROR("MPD error for command \"%s\": %s",
+                (node != NULL ? ((struct t_mpd_command *)node->data)->argv[0] : "idle"),
+                mpd_parser_get_message(client->parser));
+            if (node != NULL) {
+                if (((struct t_mpd_command *)node->data)->status == true) {
+                    // Do not retry a failing status command
+                    client->changed = 0;
+                }
+                list_node_free(node, mpd_command_clear);
+            }
+            mpd_state_reset(&client->pending);
+            if (client->sent.length > 0) {
+                MYGPIOD_LOG_WARN("Skipped %u MPD commands after the error", client->sent.length);
+                list_clear(&client->sent, mpd_command_clear);
+            }
+            if (client->changed != 0) {
+                // The status command was skipped
+                mpc_queue_status(client);
+            }
+            return mpc_send_queue(client);
+        }
+        case MPD_PARSER_MALFORMED:
+            break;
+    }
+    mpc_fail(client, "Malformed response");
+    return false;
+}
+
+/**
+ * Sends the queued commands as command list or enters the idle mode
+ * @param client MPD client
+ * @return true on success, false if the connection was closed
+ */
+static bool mpc_send_queue(struct t_mpd_client *client) {
+    mpc_queue_expire(client);
+    if (client->queue.length == 0) {
+        return mpc_send_idle(client);
+    }
+    // Pipeline the queued commands
+    struct t_list_node *node;
+    unsigned count = 0;
+    while (count < MPD_CLIENT_BATCH_MAX &&
+        (node = list_shift(&client->queue)) != NULL)
+    {
+        list_push(&client->sent, 0, node->data);
+        FREE_PTR(node);
+        count++;
+    }
+    bool list = count > 1;
+    if (list == true &&
+        mpc_send(client, "command_list_ok_begin") == false)
+    {
+        return false;
+    }
+    struct t_list_node *current = client->sent.head;
+    while (current != NULL) {
+        struct t_mpd_command *command = (struct t_mpd_command *)current->data;
+        MYGPIOD_LOG_DEBUG("Sending MPD command \"%s\"", command->argv[0]);
+        if (mpc_send_command(client, command) == false) {
+            return false;
+        }
+        current = current->next;
+    }
+    if (list == true &&
+        mpc_send(client, "command_list_end") == false)
+    {
+        return false;
+    }
+    client->state = MPD_CLIENT_BUSY;
+    mpc_timer_set(client, MPD_CLIENT_TIMEOUT_MS);
+    return true;
+}
+
+/**
+ * Enters the idle mode, with the state mirror only player and mixer changes are relevant
+ * @param client MPD client
+ * @return true on success, false if the connection was closed
+ */
+static bool mpc_send_idle(struct t_mpd_client *client) {
+    bool rc = client->subscribe == true
+        ? mpc_send_check(client, mpd_async_send_command(client->async, "idle", "player", "mixer", NULL))
+        : mpc_send(client, "idle");
+    if (rc == false) {
+        return false;
+    }
+    client->state = MPD_CLIENT_IDLE;
+    mpc_timer_set(client, 0);
+    return true;
+}
+
+/**
+ * Queues the internal status command, if it is not already queued
+ * @param client MPD client
+ */
+static void mpc_queue_status(struct t_mpd_client *client) {
+    struct t_list_node *current = client->queue.head;
+    while (current != NULL) {
+        if (((struct t_mpd_command *)current->data)->status == true) {
+            return;
+        }
+        current = current->next;
+    }
+    char cmd[] = "status";
+    sds argv[1] = { cmd };
+    struct t_mpd_command *command = mpd_command_new(1, argv);
+    command->status = true;
+    // Not limited by MPD_CLIENT_QUEUE_MAX
+    list_push(&client->queue, 0, command);
+}
+
+/**
+ * Frees a successfully finished command, the response of the
+ * status command updates the state mirror
+ * @param client MPD client
+ * @param node Pointer to node holding the finished command
+ */
+static void mpc_command_done(struct t_mpd_client *client, struct t_list_node *node) {
+    if (((struct t_mpd_command *)node->data)->status == true) {
+        mpc_state_update(client);
+    }
+    list_node_free(node, mpd_command_clear);
+}
+
+/**
+ * Replaces the state mirror with the parsed status and emits the events
+ * for the changed subsystems
+ * @param client MPD client
+ */
+static void mpc_state_update(struct t_mpd_client *client) {
+    client->mirror = client->pending;
+    client->mirror.valid = true;
+    mpd_state_reset(&client->pending);
+    unsigned changed = client->changed;
+    client->changed = 0;
+    mpc_state_emit(client, changed);
+}
+
+/**
+ * Resets the state mirror after the connection was closed
+ * @param client MPD client
+ */
+static void mpc_state_invalidate(struct t_mpd_client *client) {
+    mpd_state_reset(&client->pending);
+    client->changed = 0;
+    if (client->mirror.valid == false) {
+        return;
+    }
+    mpd_state_reset(&client->mirror);
+    mpc_state_emit(client, MPD_CHANGED_PLAYER | MPD_CHANGED_MIXER);
+}
+
+/**
+ * Emits the events for the changed subsystems
+ * @param client MPD client
+ * @param changed Bitmask of enum mpd_client_changed
+ */
+static void mpc_state_emit(struct t_mpd_client *client, unsigned changed) {
+    if (changed & MPD_CHANGED_PLAYER) {
+        MYGPIOD_LOG_DEBUG("MPD player state: %s", mpd_client_lookup_state(client->mirror.play_state));
+        event_enqueue_mpd(client->config, MYGPIOD_EVENT_MPD_PLAYER, &client->mirror);
+    }
+    if (changed & MPD_CHANGED_MIXER) {
+        MYGPIOD_LOG_DEBUG("MPD volume: %d", client->mirror.volume);
+        event_enqueue_mpd(client->config, MYGPIOD_EVENT_MPD_MIXER, &client->mirror);
+    }
+}
+
+/**
+ * Parses a line of the status response
+ * @param state State to populate
+ * @param name Name of the pair
+ * @param value Value of the pair
+ */
+static void mpc_parse_status(struct t_mpd_state *state, const char *name, const char *value) {
+    if (strcmp(name, "state") == 0) {
+        if (strcmp(value, "play") == 0) {
+            state->play_state = MPD_STATE_PLAY;
+        }
+        else if (strcmp(value, "pause") == 0) {
+            state->play_state = MPD_STATE_PAUSE;
+        }
+        else if (strcmp(value, "stop") == 0) {
+            state->play_state = MPD_STATE_STOP;
+        }
+    }
+    else if (strcmp(name, "volume") == 0) {
+        mygpio_parse_int(value, &state->volume, NULL, -1, 100);
+    }
+    else if (strcmp(name, "song") == 0) {
+        mygpio_parse_int(value, &state->song_pos, NULL, 0, INT_MAX);
+    }
+    else if (strcmp(name, "songid") == 0) {
+        mygpio_parse_int(value, &state->song_id, NULL, 0, INT_MAX);
+    }
+    else if (strcmp(name, "elapsed") == 0) {
+        // Seconds with milliseconds resolution
+        state->elapsed_ms = (unsigned)(strtod(value, NULL) * 1000);
+    }
+    else if (strcmp(name, "duration") == 0) {
+        state->duration_ms = (unsigned)(strtod(value, NULL) * 1000);
+    }
+    else if (strcmp(name, "repeat") == 0) {
+        state->repeat = mygpio_parse_bool(value);
+    }
+    else if (strcmp(name, "random") == 0) {
+        state->random = mygpio_parse_bool(value);
+    }
+}
+
+/**
+ * Resets the state to unknown
+ * @param state State to reset
+ */
+static void mpd_state_reset(struct t_mpd_state *state) {
+    state->valid = false;
+    state->play_state = MPD_STATE_UNKNOWN;
+    state->volume = -1;
+    state->song_pos = -1;
+    state->song_id = -1;
+    state->elapsed_ms = 0;
+    state->duration_ms = 0;
+    state->repeat = false;
+    state->random = false;
+}
+
+/**
+ * Discards the commands that waited too long for a connection
+ * @param client MPD client
+ */
+static void mpc_queue_expire(struct t_mpd_client *client) {
+    uint64_t now_us = metrics_now_us();
+    while (client->queue.head != NULL &&
+        now_us - ((struct t_mpd_command *)client->queue.head->data)->queued_us > (uint64_t)MPD_CLIENT_TIMEOUT_MS * 1000)
+    {
+        struct t_list_node *node = list_shift(&client->queue);
+        MYGPIOD_LOG_WARN("Discarding expired MPD command \"%s\"", ((struct t_mpd_command *)node->data)->argv[0]);
+        list_node_free(node, mpd_command_clear);
+    }
+}
+
+/**
+ * Appends a command without arguments to the output buffer
+ * @param client MPD client
+ * @param command Command to send
+ * @return true on success, false if the connection was closed
+ */
+static bool mpc_send(struct t_mpd_client *client, const char *command) {
+    return mpc_send_check(client,
+        mpd_async_send_command(client->async, command, NULL));
+}
+
+/**
+ * Appends a command with its arguments to the output buffer
+ * @param client MPD client
+ * @param command Command to send
+ * @return true on success, false if the connection was closed
+ */
+static bool mpc_send_command(struct t_mpd_client *client, const struct t_mpd_command *command) {
+    // The unused arguments are NULL and terminate the list
+    return mpc_send_check(client,
+        mpd_async_send_command(client->async, command->argv[0], command->argv[1], command->argv[2],
+            command->argv[3], command->argv[4], command->argv[5], command->argv[6], command->argv[7],
+            command->argv[8], command->argv[9], NULL));
+}
+
+/**
+ * Checks the result of mpd_async_send_command
+ * @param client MPD client
+ * @param rc Return value of mpd_async_send_command
+ * @return true on success, false if the connection was closed
+ */
+static bool mpc_send_check(struct t_mpd_client *client, bool rc) {
+    if (rc == false) {
+        mpc_fail(client, mpd_async_get_error(client->async) != MPD_ERROR_SUCCESS
+            ? mpd_async_get_error_message(client->async)
+            : "Output buffer is full");
+        return false;
+    }
+    mpc_update_events(client);
+    return true;
+}
+
+/**
+ * Updates the events to poll from the async connection state
+ * @param client MPD client
+ */
+static void mpc_update_events(struct t_mpd_client *client) {
+    enum mpd_async_event async_events = mpd_async_events(client->async);
+    short events = 0;
+    if (async_events & MPD_ASYNC_EVENT_READ) {
+        events |= POLLIN;
+    }
+    if (async_events & MPD_ASYNC_EVENT_WRITE) {
+        events |= POLLOUT;
+    }
+    if (events != client->events) {
+        client->events = events;
+        update_pollfds = true;
+    }
+}
+
+/**
+ * Arms or disarms the timer
+ * @param client MPD client
+ * @param timeout_ms Timeout in milliseconds, 0 disarms the timer
+ */
+static void mpc_timer_set(struct t_mpd_client *client, int timeout_ms) {
+    struct itimerspec its = { 0 };
+    its.it_value.tv_sec = timeout_ms / 1000;
+    its.it_value.tv_nsec = (long)((timeout_ms % 1000) * 1000000);
+    if (timerfd_settime(client->timer_fd, 0, &its, NULL) == -1) {
+        MYGPIOD_LOG_ERROR("Can not set the MPD client timer");
+        MYGPIOD_LOG_ERRNO(errno);
+    }
+}
+
+/**
+ * Creates a new command, the arguments are copied
+ * @param argc Number of arguments including the command
+ * @param argv Command and arguments
+ * @return Newly allocated struct
+ */
+static struct t_mpd_command *mpd_command_new(int argc, sds *argv) {
+    struct t_mpd_command *command = malloc_assert(sizeof(struct t_mpd_command));
+    command->argc = argc;
+    for (int i = 0; i < MPD_COMMAND_ARGS_MAX; i++) {
+        command->argv[i] = i < argc
+            ? sdsnew(argv[i])
+            : NULL;
+    }
+    command->queued_us = metrics_now_us();
+    command->status = false;
+    return command;
+}
+
+/**
+ * Clears a queued command
+ * @param node Pointer to node holding the command to clear
+ */
+static void mpd_command_clear(struct t_list_node *node) {
+    struct t_mpd_command *command = (struct t_mpd_command *)node->data;
+    for (int i = 0; i < command->argc; i++) {
+        FREE_SDS(command->argv[i]);
+    }
+}
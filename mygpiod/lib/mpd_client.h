@@ -0,0 +1,103 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Non-blocking MPD client driven by the event loop
+ */
+
+#ifndef MYGPIOD_MPD_CLIENT_H
+#define MYGPIOD_MPD_CLIENT_H
+
+#include "dist/sds/sds.h"
+#include "mygpiod/config/config.h"
+#include "mygpiod/lib/list.h"
+
+#include <mpd/client.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Maximum number of arguments of a MPD command including the command
+ */
+#define MPD_COMMAND_ARGS_MAX 10
+
+/**
+ * Subsystems that changed since the last state update
+ */
+enum mpd_client_changed {
+    MPD_CHANGED_PLAYER = 1,  //!< Player state or current song
+    MPD_CHANGED_MIXER = 2    //!< Volume
+};
+
+/**
+ * MPD connection states
+ */
+enum mpd_client_state {
+    MPD_CLIENT_DISCONNECTED = 0,  //!< Not connected, the reconnect timer can be armed
+    MPD_CLIENT_CONNECTING,        //!< Non-blocking connect is in progress
+    MPD_CLIENT_GREETING,          //!< Waiting for the MPD welcome message
+    MPD_CLIENT_IDLE,              //!< Idle command was sent
+    MPD_CLIENT_NOIDLE,            //!< Noidle command was sent, waiting for the idle response
+    MPD_CLIENT_BUSY               //!< Command list was sent, waiting for the response
+};
+
+/**
+ * A queued MPD command
+ */
+struct t_mpd_command {
+    int argc;                           //!< Number of arguments including the command
+    sds argv[MPD_COMMAND_ARGS_MAX];     //!< Command and arguments
+    uint64_t queued_us;                 //!< Time the command was queued
+    bool status;                        //!< Internal status command, the response updates the state mirror
+};
+
+/**
+ * Cached MPD status
+ */
+struct t_mpd_state {
+    bool valid;                  //!< Status was received on the current connection
+    enum mpd_state play_state;   //!< Player state
+    int volume;                  //!< Volume, -1 if there is no mixer
+    int song_pos;                //!< Queue position of the current song, -1 if none
+    int song_id;                 //!< Id of the current song, -1 if none
+    unsigned elapsed_ms;         //!< Elapsed time of the current song at the last update
+    unsigned duration_ms;        //!< Duration of the current song
+    bool repeat;                 //!< Repeat mode
+    bool random;                 //!< Random mode
+};
+
+/**
+ * Persistent MPD connection
+ */
+struct t_mpd_client {
+    enum mpd_client_state state;  //!< Connection state
+    int fd;                       //!< Socket, -1 if disconnected
+    short events;                 //!< Events to poll for
+    int timer_fd;                 //!< Timer for timeouts and reconnects
+    bool reconnect;               //!< Reconnect timer is armed
+    int backoff_ms;               //!< Current reconnect delay
+    sds password;                 //!< MPD password or NULL
+    struct mpd_async *async;      //!< libmpdclient async connection
+    struct mpd_parser *parser;    //!< Response parser
+    struct t_list queue;          //!< Queued commands, data is struct t_mpd_command
+    struct t_list sent;           //!< Commands of the running command list
+    struct t_config *config;      //!< Pointer to config to emit the state events
+    bool subscribe;               //!< Keep the state mirror up to date
+    unsigned changed;             //!< Bitmask of enum mpd_client_changed
+    struct t_mpd_state mirror;    //!< State mirror
+    struct t_mpd_state pending;   //!< State that is parsed from the running status command
+};
+
+struct t_mpd_client *mpd_client_new(struct t_config *config);
+void mpd_client_free(struct t_mpd_client *client);
+void mpd_client_subscribe(struct t_mpd_client *client);
+bool mpd_client_push(struct t_mpd_client *client, int argc, sds *argv);
+void mpd_client_handle_socket(struct t_mpd_client *client, struct pollfd *pfd);
+void mpd_client_handle_timer(struct t_mpd_client *client, int *fd);
+const char *mpd_client_lookup_state(enum mpd_state play_state);
+
+#endif
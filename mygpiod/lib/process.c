@@ -0,0 +1,175 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Child processes of the system action
+ *
+ * The daemon does not fork on the hot path. A small executor process
+ * is forked at startup, before the GPIO chip is opened and before any
+ * thread is created. Commands are sent to it over a socketpair and the
+ * results come back as messages that are read by the event loop.
+ *
+ * The executor is not respawned if it dies. Forking the multithreaded
+ * daemon is not safe, system actions fail until myGPIOd is restarted.
+ */
+
+#include "compile_time.h"
+#include "mygpiod/lib/process.h"
+
+#include "mygpiod/event_loop/event_loop.h"
+#include "mygpiod/lib/events.h"
+#include "mygpiod/lib/executor.h"
+#include "mygpiod/lib/log.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// private definitions
+
+/**
+ * Connection to the executor process
+ */
+struct t_process {
+    pid_t pid;  //!< Pid of the executor, -1 if not running
+    int fd;     //!< Daemon end of the socketpair
+};
+
+static struct t_process process = {
+    .pid = -1,
+    .fd = -1
+};
+
+// public functions
+
+/**
+ * Forks the executor process.
+ * Must be called before any thread is created.
+ * @param config Pointer to config
+ * @return true on success, else false
+ */
+bool process_init(struct t_config *config) {
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sv) == -1) {
+        MYGPIOD_LOG_ERROR("Can not create the executor socket");
+        MYGPIOD_LOG_ERRNO(errno);
+        return false;
+    }
+    errno = 0;
+    pid_t pid = fork();
+    if (pid == 0) {
+        // This is the executor process
+        close(sv[0]);
+        close_fd(&config->signal_fd);
+        _exit(executor_run(sv[1], config->system_timeout_s));
+    }
+    close(sv[1]);
+    if (pid == -1) {
+        MYGPIOD_LOG_ERROR("Forking the executor failed");
+        MYGPIOD_LOG_ERRNO(errno);
+        close(sv[0]);
+        return false;
+    }
+    process.pid = pid;
+    process.fd = sv[0];
+    return true;
+}
+
+/**
+ * Closes the connection to the executor and waits for its exit.
+ * Running children are not killed.
+ */
+void process_clear(void) {
+    close_fd(&process.fd);
+    if (process.pid > 0) {
+        waitpid(process.pid, NULL, 0);
+        process.pid = -1;
+    }
+}
+
+/**
+ * Sends a command to the executor.
+ * The result is received as message and emits a system_done event.
+ * @param cmd Command to execute
+ * @return true on success, false if the command could not be sent
+ */
+bool process_spawn(const char *cmd) {
+    if (process.fd == -1) {
+        MYGPIOD_LOG_ERROR("Executor is not running, not executing \"%s\"", cmd);
+        return false;
+    }
+    size_t len = strlen(cmd);
+    if (len == 0 ||
+        len > EXECUTOR_CMD_LEN_MAX)
+    {
+        MYGPIOD_LOG_ERROR("Invalid system command \"%s\"", cmd);
+        return false;
+    }
+    if (send(process.fd, cmd, len, MSG_NOSIGNAL | MSG_DONTWAIT) == -1) {
+        MYGPIOD_LOG_ERROR("Can not send \"%s\" to the executor", cmd);
+        MYGPIOD_LOG_ERRNO(errno);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Returns the socket that must be polled for the results
+ * @return Socket fd
+ */
+int process_fd(void) {
+    return process.fd;
+}
+
+/**
+ * Reaps the executor if it has exited
+ */
+void process_reap(void) {
+    if (process.pid <= 0) {
+        return;
+    }
+    int status;
+    pid_t pid = waitpid(process.pid, &status, WNOHANG);
+    if (pid == process.pid) {
+        MYGPIOD_LOG_ERROR("Executor has exited with status %d", status);
+        process.pid = -1;
+    }
+}
+
+/**
+ * Reads the results from the executor and emits the system_done events.
+ * If the connection is lost, the executor is not respawned and all
+ * further system actions fail.
+ * @param config Pointer to config
+ * @param pfd Polled socket
+ */
+void process_handle_msg(struct t_config *config, struct pollfd *pfd) {
+    char msg[sizeof(struct t_executor_result) + EXECUTOR_CMD_LEN_MAX + 1];
+    ssize_t len;
+    while ((len = recv(pfd->fd, msg, sizeof(msg) - 1, MSG_DONTWAIT)) >= (ssize_t)sizeof(struct t_executor_result)) {
+        struct t_executor_result result;
+        memcpy(&result, msg, sizeof(result));
+        msg[len] = '\0';
+        const char *cmd = msg + sizeof(result);
+        if (result.exit_code == -1) {
+            MYGPIOD_LOG_ERROR("System command \"%s\" could not be executed", cmd);
+        }
+        else {
+            MYGPIOD_LOG_DEBUG("System command \"%s\" exited with %d after %llu ms",
+                cmd, result.exit_code, (unsigned long long)result.duration_ms);
+        }
+        event_enqueue_system_done(config, cmd, result.exit_code, result.duration_ms);
+    }
+    if (len == 0 ||
+        (len == -1 && errno != EAGAIN))
+    {
+        MYGPIOD_LOG_ERROR("Lost connection to the executor, system actions are disabled until myGPIOd is restarted");
+        close_fd(&pfd->fd);
+        process.fd = -1;
+    }
+}
@@ -0,0 +1,26 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Child processes of the system action
+ */
+
+#ifndef MYGPIOD_PROCESS_H
+#define MYGPIOD_PROCESS_H
+
+#include "mygpiod/config/config.h"
+
+#include <poll.h>
+#include <stdbool.h>
+
+bool process_init(struct t_config *config);
+void process_clear(void);
+bool process_spawn(const char *cmd);
+int process_fd(void);
+void process_reap(void);
+void process_handle_msg(struct t_config *config, struct pollfd *pfd);
+
+#endif
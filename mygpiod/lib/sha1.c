@@ -0,0 +1,153 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief SHA-1 hash function
+ *
+ * Only used for the WebSocket handshake, it is not meant for security purposes.
+ */
+
+#include "compile_time.h"
+#include "mygpiod/lib/sha1.h"
+
+#include <string.h>
+
+// private definitions
+
+/**
+ * SHA-1 state
+ */
+struct t_sha1_ctx {
+    uint32_t h[5];          //!< Hash state
+    uint8_t block[64];      //!< Current block
+    size_t block_len;       //!< Bytes in current block
+    uint64_t total_len;     //!< Total message length in bytes
+};
+
+static void sha1_transform(struct t_sha1_ctx *ctx);
+static void sha1_update(struct t_sha1_ctx *ctx, const uint8_t *data, size_t len);
+
+/**
+ * Rotates a 32 bit value left
+ */
+#define ROTL32(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+// public functions
+
+/**
+ * Calculates the SHA-1 digest of data
+ * @param data Data to hash
+ * @param len Length of data
+ * @param digest Buffer for the digest
+ */
+void sha1(const void *data, size_t len, uint8_t digest[SHA1_DIGEST_LEN]) {
+    struct t_sha1_ctx ctx = {
+        .h = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 },
+        .block_len = 0,
+        .total_len = 0
+    };
+    sha1_update(&ctx, (const uint8_t *)data, len);
+
+    // Padding
+    uint64_t bit_len = ctx.total_len * 8;
+    uint8_t pad = 0x80;
+    sha1_update(&ctx, &pad, 1);
+    pad = 0x00;
+    while (ctx.block_len != 56) {
+        sha1_update(&ctx, &pad, 1);
+    }
+    uint8_t len_be[8];
+    for (int i = 0; i < 8; i++) {
+        len_be[i] = (uint8_t)(bit_len >> (56 - i * 8));
+    }
+    sha1_update(&ctx, len_be, 8);
+
+    for (int i = 0; i < 5; i++) {
+        digest[i * 4] = (uint8_t)(ctx.h[i] >> 24);
+        digest[i * 4 + 1] = (uint8_t)(ctx.h[i] >> 16);
+        digest[i * 4 + 2] = (uint8_t)(ctx.h[i] >> 8);
+        digest[i * 4 + 3] = (uint8_t)ctx.h[i];
+    }
+}
+
+// private functions
+
+/**
+ * Adds data to the hash
+ * @param ctx SHA-1 state
+ * @param data Data to add
+ * @param len Length of data
+ */
+static void sha1_update(struct t_sha1_ctx *ctx, const uint8_t *data, size_t len) {
+    ctx->total_len += len;
+    while (len > 0) {
+        size_t n = 64 - ctx->block_len;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(ctx->block + ctx->block_len, data, n);
+        ctx->block_len += n;
+        data += n;
+        len -= n;
+        if (ctx->block_len == 64) {
+            sha1_transform(ctx);
+            ctx->block_len = 0;
+        }
+    }
+}
+
+/**
+ * Processes a 64 byte block
+ * @param ctx SHA-1 state
+ */
+static void sha1_transform(struct t_sha1_ctx *ctx) {
+    uint32_t w[80];
+    for (int i = 0; i < 16; i++) {
+        w[i] = ((uint32_t)ctx->block[i * 4] << 24) |
+               ((uint32_t)ctx->block[i * 4 + 1] << 16) |
+               ((uint32_t)ctx->block[i * 4 + 2] << 8) |
+               ((uint32_t)ctx->block[i * 4 + 3]);
+    }
+    for (int i = 16; i < 80; i++) {
+        w[i] = ROTL32(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+    }
+    uint32_t a = ctx->h[0];
+    uint32_t b = ctx->h[1];
+    uint32_t c = ctx->h[2];
+    uint32_t d = ctx->h[3];
+    uint32_t e = ctx->h[4];
+    for (int i = 0; i < 80; i++) {
+        uint32_t f;
+        uint32_t k;
+        if (i < 20) {
+            f = (b & c) | ((~b) & d);
+            k = 0x5A827999;
+        }
+        else if (i < 40) {
+            f = b ^ c ^ d;
+            k = 0x6ED9EBA1;
+        }
+        else if (i < 60) {
+            f = (b & c) | (b & d) | (c & d);
+            k = 0x8F1BBCDC;
+        }
+        else {
+            f = b ^ c ^ d;
+            k = 0xCA62C1D6;
+        }
+        uint32_t temp = ROTL32(a, 5) + f + e + k + w[i];
+        e = d;
+        d = c;
+        c = ROTL32(b, 30);
+        b = a;
+        a = temp;
+    }
+    ctx->h[0] += a;
+    ctx->h[1] += b;
+    ctx->h[2] += c;
+    ctx->h[3] += d;
+    ctx->h[4] += e;
+}
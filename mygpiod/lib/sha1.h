@@ -0,0 +1,24 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief SHA-1 hash function
+ */
+
+#ifndef MYGPIOD_SHA1_H
+#define MYGPIOD_SHA1_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Length of a SHA-1 digest in bytes
+ */
+#define SHA1_DIGEST_LEN 20
+
+void sha1(const void *data, size_t len, uint8_t digest[SHA1_DIGEST_LEN]);
+
+#endif
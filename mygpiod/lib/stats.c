@@ -0,0 +1,130 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Runtime statistics
+ */
+
+#include "compile_time.h"
+#include "mygpiod/lib/stats.h"
+
+#include "mygpiod/config/gpio.h"
+#include "mygpiod/config/timer_ev.h"
+#include "mygpiod/lib/metrics.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <unistd.h>
+
+// private definitions
+
+static uint64_t count_timers(struct t_config *config);
+static uint64_t count_fds(void);
+static uint64_t get_rss(void);
+
+// public functions
+
+/**
+ * Populates the statistics struct
+ * @param config Pointer to config
+ * @param stats Struct to populate
+ */
+void stats_get(struct t_config *config, struct t_stats *stats) {
+    stats->uptime = (metrics_now_us() - metrics.started_us) / 1000000;
+    stats->events = atomic_load_explicit(&metrics.events, memory_order_relaxed);
+    stats->actions = 0;
+    stats->actions_failed = 0;
+    for (unsigned i = 0; i < METRICS_ACTIONS; i++) {
+        stats->actions += atomic_load_explicit(&metrics.actions_executed[i], memory_order_relaxed);
+        stats->actions_failed += atomic_load_explicit(&metrics.actions_failed[i], memory_order_relaxed);
+    }
+    stats->events_dropped = atomic_load_explicit(&metrics.events_dropped, memory_order_relaxed);
+    stats->timers = count_timers(config);
+    stats->fds = count_fds();
+    stats->poll_wakeups = atomic_load_explicit(&metrics.poll_wakeups, memory_order_relaxed);
+    stats->memory = get_rss();
+}
+
+// private functions
+
+/**
+ * Counts the armed long press, blink and timer event timers
+ * @param config Pointer to config
+ * @return Number of active timers
+ */
+static uint64_t count_timers(struct t_config *config) {
+    uint64_t timers = 0;
+    struct t_list_node *current = config->gpios_in.head;
+    while (current != NULL) {
+        struct t_gpio_in_data *data = (struct t_gpio_in_data *)current->data;
+        if (data->timer_fd > -1) {
+            timers++;
+        }
+        current = current->next;
+    }
+    current = config->gpios_out.head;
+    while (current != NULL) {
+        struct t_gpio_out_data *data = (struct t_gpio_out_data *)current->data;
+        if (data->timer_fd > -1) {
+            timers++;
+        }
+        current = current->next;
+    }
+    current = config->timer_definitions.head;
+    while (current != NULL) {
+        struct t_timer_definition *data = (struct t_timer_definition *)current->data;
+        if (data->fd > -1) {
+            timers++;
+        }
+        current = current->next;
+    }
+    return timers;
+}
+
+/**
+ * Counts the open file descriptors of this process
+ * @return Number of open file descriptors
+ */
+static uint64_t count_fds(void) {
+    DIR *dir = opendir("/proc/self/fd");
+    if (dir == NULL) {
+        return 0;
+    }
+    uint64_t fds = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] != '.') {
+            fds++;
+        }
+    }
+    closedir(dir);
+    // Do not count the directory handle itself
+    return fds > 0
+        ? fds - 1
+        : 0;
+}
+
+/**
+ * Gets the resident set size of this process
+ * @return Resident set size in bytes
+ */
+static uint64_t get_rss(void) {
+    FILE *fp = fopen("/proc/self/statm", OPEN_FLAGS_READ);
+    if (fp == NULL) {
+        return 0;
+    }
+    unsigned long size;
+    unsigned long resident;
+    int rc = fscanf(fp, "%lu %lu", &size, &resident);
+    (void)fclose(fp);
+    if (rc != 2) {
+        return 0;
+    }
+    long page_size = sysconf(_SC_PAGESIZE);
+    return page_size > 0
+        ? (uint64_t)resident * (uint64_t)page_size
+        : 0;
+}
@@ -0,0 +1,35 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Runtime statistics
+ */
+
+#ifndef MYGPIOD_STATS_H
+#define MYGPIOD_STATS_H
+
+#include "mygpiod/config/config.h"
+
+#include <stdint.h>
+
+/**
+ * Snapshot of the runtime statistics
+ */
+struct t_stats {
+    uint64_t uptime;          //!< Uptime in seconds
+    uint64_t events;          //!< Enqueued GPIO and input events
+    uint64_t actions;         //!< Executed actions
+    uint64_t actions_failed;  //!< Failed actions
+    uint64_t events_dropped;  //!< Events dropped for slow socket clients
+    uint64_t timers;          //!< Active timers
+    uint64_t fds;             //!< Open file descriptors
+    uint64_t poll_wakeups;    //!< Returns from poll
+    uint64_t memory;          //!< Resident set size in bytes
+};
+
+void stats_get(struct t_config *config, struct t_stats *stats);
+
+#endif
@@ -13,49 +13,78 @@
 
 #include "mygpiod/lib/log.h"
 #include "mygpiod/lib/sds_extras.h"
-#include "mygpiod/lua/async/functions/gpio.h"
-#include "mygpiod/lua/async/functions/http.h"
-#include "mygpiod/lua/async/functions/input_ev.h"
-#include "mygpiod/lua/async/functions/mpc.h"
-#include "mygpiod/lua/async/functions/system.h"
+#include "mygpiod/lua/async/pool.h"
+#include "mygpiod/lua/cache.h"
 #include "mygpiod/lua/util.h"
 
-// Private definitions
-static int save_bytecode(lua_State *lua_vm, struct t_lua_script *script);
-static lua_State *create_lua_vm(struct t_config *config);
-
 // Public functions
 
 /**
- * Loads the script from a string
+ * Reads the bytecode of all async scripts from the cache.
+ * Compiles the remaining scripts if lua_precompile is enabled.
+ * @param config Pointer to config
+ */
+void lua_async_bytecode_init(struct t_config *config) {
+    lua_State *lua_vm = NULL;
+    unsigned cached = 0;
+    unsigned compiled = 0;
+    struct t_list_node *current = config->lua_async_scripts.head;
+    while (current != NULL) {
+        struct t_lua_script *script = (struct t_lua_script *)current->data;
+        script->bytecode = lua_cache_get(config->lua_cache_dir, script->name,
+            script->script, sdslen(script->script));
+        if (script->bytecode != NULL) {
+            cached++;
+        }
+        else if (config->lua_precompile == true) {
+            if (lua_vm == NULL) {
+                // Compiling needs no libraries
+                lua_vm = luaL_newstate();
+                if (lua_vm == NULL) {
+                    MYGPIOD_LOG_ERROR("Memory allocation error in luaL_newstate");
+                    return;
+                }
+            }
+            if (lua_async_compile(lua_vm, config, script) == true) {
+                compiled++;
+            }
+            lua_settop(lua_vm, 0);
+        }
+        current = current->next;
+    }
+    if (lua_vm != NULL) {
+        lua_close(lua_vm);
+    }
+    MYGPIOD_LOG_INFO("Read bytecode of %u async Lua script(s) from cache, compiled %u", cached, compiled);
+}
+
+/**
+ * Loads the script from a string into a pooled Lua VM
  * @param config Pointer to config
  * @param script Pointer to t_lua_script
  * @return lua_State* or NULL on error
  */
 lua_State *lua_async_load_source(struct t_config *config, struct t_lua_script *script) {
-    lua_State *lua_vm = create_lua_vm(config);
+    lua_State *lua_vm = lua_async_pool_acquire(config);
     if (lua_vm == NULL) {
         return NULL;
     }
-    int rc = luaL_loadstring(lua_vm, script->script);
-    lua_log_result(lua_vm, rc, script->name);
-    if (rc == 0) {
-        save_bytecode(lua_vm, script);
+    if (lua_async_compile(lua_vm, config, script) == true) {
         return lua_vm;
     }
-    lua_close(lua_vm);
+    lua_async_pool_release(lua_vm);
     return NULL;
 }
 
 /**
- * Loads the cached bytecode
+ * Loads the cached bytecode into a pooled Lua VM
  * This should be faster than compiling the script on each execution.
  * @param config Pointer to config
  * @param script Pointer to t_lua_script
  * @return lua_State* or NULL on error
  */
 lua_State *lua_async_load_bytecode(struct t_config *config, struct t_lua_script *script) {
-    lua_State *lua_vm = create_lua_vm(config);
+    lua_State *lua_vm = lua_async_pool_acquire(config);
     if (lua_vm == NULL) {
         return NULL;
     }
@@ -63,68 +92,36 @@ lua_State *lua_async_load_bytecode(struct t_config *config, struct t_lua_script
     if (rc == 0) {
         return lua_vm;
     }
-    lua_log_result(lua_vm, rc, script->name);
-    lua_close(lua_vm);
+    // Bytecode from the cache of another Lua build, compile the source
+    MYGPIOD_LOG_WARN("Invalid bytecode for Lua script \"%s\", compiling the source", script->name);
+    lua_settop(lua_vm, 0);
+    if (lua_async_compile(lua_vm, config, script) == true) {
+        return lua_vm;
+    }
+    lua_async_pool_release(lua_vm);
     return NULL;
 }
 
-// Private functions
-
 /**
- * Creates the lua instance and opens the standard libraries and registers custom functions.
+ * Compiles the script, saves the bytecode in the script struct and
+ * in the cache. The compiled function is left on the stack.
+ * @param lua_vm Lua VM
  * @param config Pointer to config
- * @return lua_State* or NULL on error
+ * @param script Pointer to t_lua_script
+ * @return true on success, else false
  */
-static lua_State *create_lua_vm(struct t_config *config) {
-    lua_State *lua_vm = luaL_newstate();
-    if (lua_vm == NULL) {
-        MYGPIOD_LOG_ERROR("Memory allocation error in luaL_newstate");
+bool lua_async_compile(lua_State *lua_vm, struct t_config *config, struct t_lua_script *script) {
+    int rc = luaL_loadbuffer(lua_vm, script->script, sdslen(script->script), script->name);
+    if (rc != LUA_OK) {
+        lua_log_result(lua_vm, rc, script->name);
+        lua_settop(lua_vm, 0);
         return false;
     }
-    luaL_openlibs(lua_vm);
-    // Set config as a global
-    lua_pushlightuserdata(lua_vm, config);
-    lua_setglobal(lua_vm, "mygpiodConfig");
-    // Register functions
-    lua_register(lua_vm, "gpioBlink", lua_gpio_blink_async);
-    lua_register(lua_vm, "gpioGet", lua_gpio_get_async);
-    lua_register(lua_vm, "gpioSet", lua_gpio_set_async);
-    lua_register(lua_vm, "gpioToggle", lua_gpio_toggle_async);
-    lua_register(lua_vm, "inputEvGet", lua_input_ev_get_async);
-    lua_register(lua_vm, "system", lua_system_sync);
-    #ifdef MYGPIOD_ENABLE_ACTION_MPC
-        lua_register(lua_vm, "mpc", lua_mpc_async);
-    #endif
-    #ifdef MYGPIOD_ENABLE_ACTION_HTTP
-        lua_register(lua_vm, "http", lua_mympd_sync);
-        lua_register(lua_vm, "http", lua_http_sync);
-    #endif
-    return lua_vm;
-}
-
-/**
- * Callback function for lua_dump to save the lua script bytecode
- * @param lua_vm lua state
- * @param p chunk to write
- * @param sz chunk size
- * @param ud user data
- * @return 0 on success
- */
-static int dump_cb(lua_State *lua_vm, const void* p, size_t sz, void* ud) {
-    (void)lua_vm;
-    struct t_lua_script *script = (struct t_lua_script *)ud;
-    script->bytecode = sdscatlen(script->bytecode, p, sz);
-    return 0;
-}
-
-/**
- * Saves the lua bytecode
- * @param lua_vm Lua state
- * @param script Pointer to t_lua_script
- * @return 0 on success
- */
-static int save_bytecode(lua_State *lua_vm, struct t_lua_script *script) {
     FREE_SDS(script->bytecode);
-    script->bytecode = sdsempty();
-    return lua_dump(lua_vm, dump_cb, script, false);
+    script->bytecode = lua_cache_dump(lua_vm);
+    if (script->bytecode != NULL) {
+        lua_cache_put(config->lua_cache_dir, script->name,
+            script->script, sdslen(script->script), script->bytecode);
+    }
+    return true;
 }
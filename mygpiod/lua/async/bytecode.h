@@ -20,7 +20,9 @@
 #include <lualib.h>
 #include <stdbool.h>
 
+void lua_async_bytecode_init(struct t_config *config);
 lua_State *lua_async_load_source(struct t_config *config, struct t_lua_script *script);
 lua_State *lua_async_load_bytecode(struct t_config *config, struct t_lua_script *script);
+bool lua_async_compile(lua_State *lua_vm, struct t_config *config, struct t_lua_script *script);
 
 #endif
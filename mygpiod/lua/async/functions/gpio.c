@@ -14,6 +14,16 @@
 #include "mygpiod/lua/async/queue_msg.h"
 #include "mygpiod/lua/sync/functions/gpio.h"
 
+/**
+ * Async wrapper for lua_gpio_batch,
+ * all operations are executed with one round trip to the main thread
+ * @param lua_vm pointer to lua vm
+ * @return Number of values on the stack
+ */
+int lua_gpio_batch_async(lua_State *lua_vm) {
+    return lua_async_send_msg(lua_vm, lua_gpio_batch);
+}
+
 /**
  * Async wrapper for lua_gpio_blink
  * @param lua_vm pointer to lua vm
@@ -15,6 +15,7 @@
 #include <lua.h>
 #include <lualib.h>
 
+int lua_gpio_batch_async(lua_State *lua_vm);
 int lua_gpio_blink_async(lua_State *lua_vm);
 int lua_gpio_get_async(lua_State *lua_vm);
 int lua_gpio_set_async(lua_State *lua_vm);
@@ -0,0 +1,225 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Pool of Lua VMs for async scripts
+ *
+ * Creating a Lua VM, opening the standard libraries and registering the
+ * myGPIOd functions is the largest part of the start latency of an async
+ * script. The pool keeps up to LUA_ASYNC_POOL_SIZE initialized VMs.
+ * A shallow copy of the globals is saved in the registry after the
+ * initialization. After each run the globals are reset to this copy, new
+ * globals are removed. Changes inside the tables of the standard
+ * libraries are not reverted.
+ */
+
+#include "compile_time.h"
+#include "mygpiod/lua/async/pool.h"
+
+#include "mygpiod/lib/log.h"
+#include "mygpiod/lua/async/functions/gpio.h"
+#include "mygpiod/lua/async/functions/http.h"
+#include "mygpiod/lua/async/functions/input_ev.h"
+#include "mygpiod/lua/async/functions/mpc.h"
+#include "mygpiod/lua/async/functions/system.h"
+#include "mygpiod/lua/watchdog.h"
+
+#include <lauxlib.h>
+#include <lualib.h>
+#include <pthread.h>
+
+// Private definitions
+
+/**
+ * Registry key of the saved globals
+ */
+#define POOL_GLOBALS_KEY "mygpiodGlobals"
+
+/**
+ * Idle Lua VMs, shared by the main thread and the async Lua threads
+ */
+struct t_lua_async_pool {
+    pthread_mutex_t lock;                      //!< Protects the VMs
+    lua_State *vms[LUA_ASYNC_POOL_SIZE];       //!< Idle VMs
+    unsigned len;                              //!< Number of idle VMs
+    bool closed;                               //!< Pool was cleared, released VMs are closed
+};
+
+static struct t_lua_async_pool pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .len = 0,
+    .closed = false
+};
+
+static lua_State *create_lua_vm(struct t_config *config);
+static void save_globals(lua_State *lua_vm);
+static void reset_globals(lua_State *lua_vm);
+
+// Public functions
+
+/**
+ * Creates the initial Lua VMs
+ * @param config Pointer to config
+ * @return true on success, else false
+ */
+bool lua_async_pool_init(struct t_config *config) {
+    if (config->lua_async_scripts.length == 0) {
+        return true;
+    }
+    for (unsigned i = 0; i < LUA_ASYNC_POOL_SIZE; i++) {
+        lua_State *lua_vm = create_lua_vm(config);
+        if (lua_vm == NULL) {
+            return false;
+        }
+        pool.vms[pool.len++] = lua_vm;
+    }
+    MYGPIOD_LOG_DEBUG("Created %u Lua VMs for async scripts", pool.len);
+    return true;
+}
+
+/**
+ * Closes the idle Lua VMs.
+ * VMs that are released afterwards are closed immediately.
+ */
+void lua_async_pool_clear(void) {
+    pthread_mutex_lock(&pool.lock);
+    while (pool.len > 0) {
+        lua_close(pool.vms[--pool.len]);
+    }
+    pool.closed = true;
+    pthread_mutex_unlock(&pool.lock);
+}
+
+/**
+ * Takes an idle Lua VM from the pool or creates a new one
+ * @param config Pointer to config
+ * @return lua_State* or NULL on error
+ */
+lua_State *lua_async_pool_acquire(struct t_config *config) {
+    lua_State *lua_vm = NULL;
+    pthread_mutex_lock(&pool.lock);
+    if (pool.len > 0) {
+        lua_vm = pool.vms[--pool.len];
+    }
+    pthread_mutex_unlock(&pool.lock);
+    if (lua_vm != NULL) {
+        return lua_vm;
+    }
+    MYGPIOD_LOG_DEBUG("Lua VM pool is empty, creating a new VM");
+    return create_lua_vm(config);
+}
+
+/**
+ * Resets the globals of the Lua VM and puts it back to the pool.
+ * The VM is closed if the pool is full.
+ * Can be called from any thread.
+ * @param lua_vm Lua VM to release
+ */
+void lua_async_pool_release(lua_State *lua_vm) {
+    reset_globals(lua_vm);
+    pthread_mutex_lock(&pool.lock);
+    if (pool.closed == false &&
+        pool.len < LUA_ASYNC_POOL_SIZE)
+    {
+        pool.vms[pool.len++] = lua_vm;
+        lua_vm = NULL;
+    }
+    pthread_mutex_unlock(&pool.lock);
+    if (lua_vm != NULL) {
+        lua_close(lua_vm);
+    }
+}
+
+// Private functions
+
+/**
+ * Creates the lua instance and opens the standard libraries and registers custom functions.
+ * @param config Pointer to config
+ * @return lua_State* or NULL on error
+ */
+static lua_State *create_lua_vm(struct t_config *config) {
+    lua_State *lua_vm = luaL_newstate();
+    if (lua_vm == NULL) {
+        MYGPIOD_LOG_ERROR("Memory allocation error in luaL_newstate");
+        return NULL;
+    }
+    luaL_openlibs(lua_vm);
+    // Applies the watchdog to coroutines
+    lua_watchdog_install(lua_vm);
+    // Set config as a global
+    lua_pushlightuserdata(lua_vm, config);
+    lua_setglobal(lua_vm, "mygpiodConfig");
+    // Register functions
+    lua_register(lua_vm, "gpioBatch", lua_gpio_batch_async);
+    lua_register(lua_vm, "gpioBlink", lua_gpio_blink_async);
+    lua_register(lua_vm, "gpioGet", lua_gpio_get_async);
+    lua_register(lua_vm, "gpioSet", lua_gpio_set_async);
+    lua_register(lua_vm, "gpioToggle", lua_gpio_toggle_async);
+    lua_register(lua_vm, "inputEvGet", lua_input_ev_get_async);
+    lua_register(lua_vm, "system", lua_system_sync);
+    #ifdef MYGPIOD_ENABLE_ACTION_MPC
+        lua_register(lua_vm, "mpc", lua_mpc_async);
+    #endif
+    #ifdef MYGPIOD_ENABLE_ACTION_HTTP
+        lua_register(lua_vm, "http", lua_mympd_sync);
+        lua_register(lua_vm, "http", lua_http_sync);
+    #endif
+    save_globals(lua_vm);
+    return lua_vm;
+}
+
+/**
+ * Saves a shallow copy of the globals in the registry
+ * @param lua_vm Lua VM
+ */
+static void save_globals(lua_State *lua_vm) {
+    lua_pushglobaltable(lua_vm);
+    lua_newtable(lua_vm);
+    lua_pushnil(lua_vm);
+    while (lua_next(lua_vm, -3) != 0) {
+        // Stack: globals, copy, key, value
+        lua_pushvalue(lua_vm, -2);
+        lua_insert(lua_vm, -2);
+        lua_rawset(lua_vm, -4);
+    }
+    lua_setfield(lua_vm, LUA_REGISTRYINDEX, POOL_GLOBALS_KEY);
+    lua_pop(lua_vm, 1);
+}
+
+/**
+ * Restores the globals from the saved copy, removes new globals
+ * and runs a full garbage collection.
+ * @param lua_vm Lua VM
+ */
+static void reset_globals(lua_State *lua_vm) {
+    lua_settop(lua_vm, 0);
+    lua_pushglobaltable(lua_vm);
+    lua_getfield(lua_vm, LUA_REGISTRYINDEX, POOL_GLOBALS_KEY);
+    // Remove new globals, clearing fields is allowed while traversing
+    lua_pushnil(lua_vm);
+    while (lua_next(lua_vm, 1) != 0) {
+        // Stack: globals, saved, key, value
+        lua_pop(lua_vm, 1);
+        lua_pushvalue(lua_vm, -1);
+        lua_rawget(lua_vm, 2);
+        bool is_new = lua_isnil(lua_vm, -1);
+        lua_pop(lua_vm, 1);
+        if (is_new == true) {
+            lua_pushvalue(lua_vm, -1);
+            lua_pushnil(lua_vm);
+            lua_rawset(lua_vm, 1);
+        }
+    }
+    // Restore the saved globals
+    lua_pushnil(lua_vm);
+    while (lua_next(lua_vm, 2) != 0) {
+        lua_pushvalue(lua_vm, -2);
+        lua_insert(lua_vm, -2);
+        lua_rawset(lua_vm, 1);
+    }
+    lua_settop(lua_vm, 0);
+    lua_gc(lua_vm, LUA_GCCOLLECT, 0);
+}
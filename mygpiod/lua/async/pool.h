@@ -0,0 +1,24 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Pool of Lua VMs for async scripts
+ */
+
+#ifndef MYGPIOD_LUA_ASYNC_POOL_H
+#define MYGPIOD_LUA_ASYNC_POOL_H
+
+#include "mygpiod/config/config.h"
+
+#include <lua.h>
+#include <stdbool.h>
+
+bool lua_async_pool_init(struct t_config *config);
+void lua_async_pool_clear(void);
+lua_State *lua_async_pool_acquire(struct t_config *config);
+void lua_async_pool_release(lua_State *lua_vm);
+
+#endif
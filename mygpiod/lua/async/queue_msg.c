@@ -6,23 +6,90 @@
 
 /*! \file
  * \brief Message handling from async lua thread
+ *
+ * The Lua threads push their requests to a lock-free queue that is read
+ * by the event loop. The request lives on the stack of the waiting thread
+ * and is also its completion slot: the event loop stores the result and
+ * wakes only this thread through a futex on the done flag.
  */
 
 #include "compile_time.h"
 #include "mygpiod/lua/async/queue_msg.h"
 
 #include "mygpiod/event_loop/eventfd_wrap.h"
-#include "mygpiod/event_loop/msg_queue.h"
-#include "mygpiod/lib/mem.h"
+#include "mygpiod/event_loop/mpsc_queue.h"
+#include "mygpiod/lib/log.h"
 
+#include <errno.h>
+#include <linux/futex.h>
 #include <pthread.h>
+#include <stdatomic.h>
 #include <sys/syscall.h>
-#include <sys/types.h>
 #include <unistd.h>
 
+// Private definitions
+
+/**
+ * Request from a Lua thread to the event loop
+ */
+struct t_lua_async_request {
+    struct t_mpsc_node node;  //!< Queue node, must be the first member
+    lua_State *lua_vm;        //!< Lua VM from thread
+    t_lua_func lua_func;      //!< C function to call from Lua
+    int rc;                   //!< Number of values on the stack, set by the event loop
+    atomic_uint done;         //!< Futex word, set to 1 if rc is valid
+};
+
+/**
+ * Requests for the event loop with the eventfd to wake it up
+ */
+struct t_lua_async_queue {
+    struct t_mpsc_queue queue;  //!< Lock-free queue of struct t_lua_async_request
+    int event_fd;               //!< Eventfd polled by the event loop
+    pthread_t event_loop;       //!< Thread of the event loop
+};
+
+static struct t_lua_async_queue lua_queue = {
+    .event_fd = -1
+};
+
+static void request_wait(struct t_lua_async_request *req);
+static void request_done(struct t_lua_async_request *req, int rc);
+
+// Public functions
+
+/**
+ * Creates the request queue
+ * @return true on success, else false
+ */
+bool lua_async_queue_init(void) {
+    mpsc_queue_init(&lua_queue.queue);
+    lua_queue.event_loop = pthread_self();
+    lua_queue.event_fd = event_eventfd_create();
+    return lua_queue.event_fd > -1;
+}
+
+/**
+ * Closes the eventfd of the request queue.
+ * Pending requests are owned by the waiting threads.
+ */
+void lua_async_queue_clear(void) {
+    if (lua_queue.event_fd > -1) {
+        event_fd_close(lua_queue.event_fd);
+        lua_queue.event_fd = -1;
+    }
+}
+
 /**
- * Reads the message from the main_queue and executes the requested Lua function.
- * Pushes the number of values on the Lua stack back to the script_queue.
+ * Returns the eventfd that must be polled by the event loop
+ * @return Eventfd
+ */
+int lua_async_queue_fd(void) {
+    return lua_queue.event_fd;
+}
+
+/**
+ * Reads the eventfd and executes the requested Lua functions.
  * @param fd Pointer to eventfd to read from
  * @return true on success, else false
  */
@@ -30,78 +97,81 @@ bool lua_async_handle_msg(int *fd) {
     if (event_eventfd_read(*fd) == false) {
         return false;
     }
-    struct t_mygpiod_msg *msg = mygpiod_queue_shift(main_queue, -1, 0);
-    struct t_lua_async_request *req = (struct t_lua_async_request *)msg->data;
-    // Execute Lua function in main thread
-    int rc = req->lua_func(req->lua_vm);
-    // Respond
-    struct t_lua_async_response *resp = lua_async_response_new(rc);
-    mygpiod_queue_push(script_queue, resp, lua_async_response_free, msg->id);
-    free_queue_node(msg);
+    lua_async_handle_pending();
     return true;
 }
 
 /**
- * Sends the message from the Lua thread to the main_queue and waits for the
- * response.
- * @param lua_vm Pointer to Lua VM.
- * @param lua_func Pointer to function that should be executed in the main thread.
- * @return Number of values on the Lua stack, or 0 on error.
+ * Executes all requested Lua functions and wakes the waiting threads.
+ * Must be called from the event loop thread.
  */
-int lua_async_send_msg(lua_State *lua_vm, t_lua_func lua_func) {
-    struct t_lua_async_request *req = lua_async_request_new(lua_vm, lua_func);
-    unsigned request_id = (unsigned)syscall(SYS_gettid);
-    mygpiod_queue_push(main_queue, req, lua_async_request_free, request_id);
-    struct t_mygpiod_msg *msg = mygpiod_queue_shift(script_queue, 0, request_id);
-    if (msg == NULL) {
-        MYGPIOD_LOG_ERROR("Invalid response for lua_async_send_msg");
-        return 0;
+void lua_async_handle_pending(void) {
+    struct t_mpsc_node *node;
+    while ((node = mpsc_queue_pop(&lua_queue.queue)) != NULL) {
+        struct t_lua_async_request *req = (struct t_lua_async_request *)node;
+        // Execute Lua function in main thread
+        int rc = req->lua_func(req->lua_vm);
+        request_done(req, rc);
+    }
+    if (mpsc_queue_is_empty(&lua_queue.queue) == false) {
+        // A push is in progress, poll again
+        MYGPIOD_LOG_DEBUG("Lua request queue: push in progress");
+        event_eventfd_write(lua_queue.event_fd);
     }
-    struct t_lua_async_response *resp = (struct t_lua_async_response *)msg->data;
-    int rc = resp->rc;
-    msg->data_free(msg->data);
-    MYGPIOD_LOG_DEBUG("Lua function finished, pushed %d values on stack", rc);
-    return rc;
 }
 
 /**
- * Creates a new request struct.
- * @param lua_vm Pointer to Lua VM
- * @param lua_func Pointer to function to execute
- * @return struct t_lua_async_request* 
+ * Sends the request from the Lua thread to the event loop and waits for the
+ * response. The function is called directly if called from the event loop.
+ * @param lua_vm Pointer to Lua VM.
+ * @param lua_func Pointer to function that should be executed in the main thread.
+ * @return Number of values on the Lua stack, or 0 on error.
  */
-struct t_lua_async_request *lua_async_request_new(lua_State *lua_vm, t_lua_func lua_func) {
-    struct t_lua_async_request *req = malloc_assert(sizeof(struct t_lua_async_request));
-    req->lua_vm = lua_vm;
-    req->lua_func = lua_func;
-    return req;
+int lua_async_send_msg(lua_State *lua_vm, t_lua_func lua_func) {
+    if (pthread_equal(pthread_self(), lua_queue.event_loop) != 0) {
+        return lua_func(lua_vm);
+    }
+    struct t_lua_async_request req = {
+        .lua_vm = lua_vm,
+        .lua_func = lua_func,
+        .rc = 0
+    };
+    atomic_init(&req.done, 0);
+    mpsc_queue_push(&lua_queue.queue, &req.node);
+    if (event_eventfd_write(lua_queue.event_fd) == false) {
+        MYGPIOD_LOG_ERROR("Can not wake up the event loop for lua_async_send_msg");
+    }
+    request_wait(&req);
+    MYGPIOD_LOG_DEBUG("Lua function finished, pushed %d values on stack", req.rc);
+    return req.rc;
 }
 
-/**
- * Frees the request struct.
- * @param data Pointer to data to free.
- */
-void lua_async_request_free(void *data) {
-    struct t_lua_async_request *req = (struct t_lua_async_request *)data;
-    free(req);
-}
+// Private functions
 
 /**
- * Creates a new response struct.
- * @param rc Number of values pushed to Lua stack.
- * @return struct t_lua_async_response* 
+ * Blocks the calling thread until the event loop has completed the request
+ * @param req Request to wait for
  */
-struct t_lua_async_response *lua_async_response_new(int rc) {
-    struct t_lua_async_response *resp = malloc_assert(sizeof(struct t_lua_async_response));
-    resp->rc = rc;
-    return resp;
+static void request_wait(struct t_lua_async_request *req) {
+    while (atomic_load_explicit(&req->done, memory_order_acquire) == 0) {
+        if (syscall(SYS_futex, &req->done, FUTEX_WAIT_PRIVATE, 0, NULL, NULL, 0) == -1 &&
+            errno != EAGAIN &&
+            errno != EINTR)
+        {
+            MYGPIOD_LOG_ERROR("Waiting for the Lua request failed");
+            MYGPIOD_LOG_ERRNO(errno);
+        }
+    }
 }
 
 /**
- * Frees the response struct.
- * @param data Pointer to data to free.
+ * Stores the result and wakes the waiting thread.
+ * The request must not be accessed afterwards, it is on the stack of the waiting thread.
+ * @param req Request to complete
+ * @param rc Number of values on the Lua stack
  */
-void lua_async_response_free(void *data) {
-    struct t_lua_async_response *resp = (struct t_lua_async_response *)data;
-    free(resp);
+static void request_done(struct t_lua_async_request *req, int rc) {
+    req->rc = rc;
+    atomic_store_explicit(&req->done, 1, memory_order_release);
+    syscall(SYS_futex, &req->done, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
 }
@@ -19,27 +19,11 @@
  */
 typedef int (*t_lua_func) (lua_State *);
 
-/**
- * Request struct from Lua thread to main thread
- */
-struct t_lua_async_request {
-    lua_State *lua_vm;    //!< Lua VM from thread
-    t_lua_func lua_func;  //!< C function to call from Lua
-};
-
-/**
- * Response struct from main thread to Lua thread
- */
-struct t_lua_async_response {
-    int rc;  //!< Number of values on the stack
-};
-
+bool lua_async_queue_init(void);
+void lua_async_queue_clear(void);
+int lua_async_queue_fd(void);
 bool lua_async_handle_msg(int *fd);
+void lua_async_handle_pending(void);
 int lua_async_send_msg(lua_State *lua_vm, t_lua_func lua_func);
 
-struct t_lua_async_request *lua_async_request_new(lua_State *lua_vm, t_lua_func lua_func);
-void lua_async_request_free(void *data);
-struct t_lua_async_response *lua_async_response_new(int rc);
-void lua_async_response_free(void *data);
-
 #endif
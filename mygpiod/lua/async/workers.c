@@ -0,0 +1,290 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Worker threads for async Lua scripts
+ *
+ * A fixed number of threads executes the async Lua scripts from a bounded
+ * job queue. Only the event loop enqueues jobs, the Lua VM is loaded by
+ * the event loop before the job is queued. The behaviour for a full queue
+ * is configured with lua_async_overflow.
+ */
+
+#include "compile_time.h"
+#include "mygpiod/lua/async/workers.h"
+
+#include "mygpiod/lib/log.h"
+#include "mygpiod/lib/mem.h"
+#include "mygpiod/lib/metrics.h"
+#include "mygpiod/lib/sds_extras.h"
+#include "mygpiod/lua/async/pool.h"
+#include "mygpiod/lua/async/queue_msg.h"
+#include "mygpiod/lua/util.h"
+#include "mygpiod/lua/watchdog.h"
+
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+
+// Private definitions
+
+/**
+ * A queued script
+ */
+struct t_lua_async_job {
+    struct t_lua_script *script;  //!< Script to execute
+    lua_State *lua_vm;            //!< Lua VM with the loaded script
+    uint64_t start_us;            //!< Time the action was triggered
+};
+
+/**
+ * Bounded job queue, implemented as ring buffer
+ */
+struct t_lua_async_workers {
+    pthread_mutex_t lock;             //!< Protects the queue
+    pthread_cond_t not_empty;         //!< Signaled if a job was queued
+    pthread_cond_t not_full;          //!< Signaled if a job was started
+    struct t_lua_async_job *jobs;     //!< Job slots
+    unsigned size;                    //!< Number of job slots
+    unsigned head;                    //!< Next job to start
+    unsigned len;                     //!< Number of queued jobs
+    enum lua_async_overflow overflow; //!< Behaviour if the queue is full
+    unsigned timeout_ms;              //!< Wall-clock limit for each script, 0 for none
+    unsigned instructions;            //!< Instruction budget for each script, 0 for none
+    bool stop;                        //!< Workers should exit
+    pthread_t threads[LUA_ASYNC_WORKERS_MAX];  //!< Worker threads
+    unsigned threads_len;             //!< Number of started worker threads
+    atomic_uint running;              //!< Number of worker threads that have not exited
+};
+
+static struct t_lua_async_workers workers = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .not_empty = PTHREAD_COND_INITIALIZER,
+    .not_full = PTHREAD_COND_INITIALIZER,
+    .jobs = NULL,
+    .size = 0,
+    .head = 0,
+    .len = 0,
+    .overflow = LUA_ASYNC_OVERFLOW_DROP,
+    .timeout_ms = 0,
+    .instructions = 0,
+    .stop = false,
+    .threads_len = 0,
+    .running = 0
+};
+
+static void *worker_run(void *arg);
+static void script_run(struct t_lua_async_job *job);
+static bool job_pending(struct t_lua_script *script);
+
+// Public functions
+
+/**
+ * Creates the job queue and starts the worker threads
+ * @param config Pointer to config
+ * @return true on success, else false
+ */
+bool lua_async_workers_init(struct t_config *config) {
+    if (config->lua_async_scripts.length == 0) {
+        return true;
+    }
+    workers.size = config->lua_async_queue;
+    workers.jobs = malloc_assert(sizeof(struct t_lua_async_job) * workers.size);
+    workers.overflow = config->lua_async_overflow;
+    workers.timeout_ms = config->lua_async_timeout;
+    workers.instructions = config->lua_instructions;
+    for (unsigned i = 0; i < config->lua_async_workers; i++) {
+        atomic_fetch_add_explicit(&workers.running, 1, memory_order_relaxed);
+        if (pthread_create(&workers.threads[i], NULL, worker_run, NULL) != 0) {
+            atomic_fetch_sub_explicit(&workers.running, 1, memory_order_relaxed);
+            MYGPIOD_LOG_ERROR("Failure creating Lua worker thread.");
+            return false;
+        }
+        workers.threads_len++;
+    }
+    MYGPIOD_LOG_DEBUG("Started %u Lua worker threads", config->lua_async_workers);
+    return true;
+}
+
+/**
+ * Stops the worker threads and drops the queued jobs.
+ * Running scripts are not interrupted, this function waits until they have
+ * finished. Must be called from the event loop thread, the Lua functions
+ * requested by the running scripts are executed while waiting.
+ */
+void lua_async_workers_clear(void) {
+    pthread_mutex_lock(&workers.lock);
+    workers.stop = true;
+    while (workers.len > 0) {
+        lua_async_pool_release(workers.jobs[workers.head].lua_vm);
+        workers.head = (workers.head + 1) % workers.size;
+        workers.len--;
+    }
+    FREE_PTR(workers.jobs);
+    workers.size = 0;
+    pthread_cond_broadcast(&workers.not_empty);
+    pthread_cond_broadcast(&workers.not_full);
+    pthread_mutex_unlock(&workers.lock);
+    while (atomic_load_explicit(&workers.running, memory_order_acquire) > 0) {
+        lua_async_handle_pending();
+        poll(NULL, 0, 1);
+    }
+    for (unsigned i = 0; i < workers.threads_len; i++) {
+        pthread_join(workers.threads[i], NULL);
+    }
+    workers.threads_len = 0;
+}
+
+/**
+ * Checks if a job for the script can be queued.
+ * Must be called from the event loop before the Lua VM is loaded.
+ * It waits for a free slot if the overflow behaviour is block.
+ * @param script Script to execute
+ * @return true if a slot is free, false if the job should be dropped
+ */
+bool lua_async_workers_accept(struct t_lua_script *script) {
+    pthread_mutex_lock(&workers.lock);
+    if (workers.size == 0) {
+        pthread_mutex_unlock(&workers.lock);
+        return false;
+    }
+    if (workers.overflow == LUA_ASYNC_OVERFLOW_COALESCE &&
+        job_pending(script) == true)
+    {
+        pthread_mutex_unlock(&workers.lock);
+        MYGPIOD_LOG_DEBUG("Lua script \"%s\" is already queued", script->name);
+        METRICS_INC(metrics.lua_async_coalesced);
+        return false;
+    }
+    if (workers.overflow == LUA_ASYNC_OVERFLOW_BLOCK) {
+        while (workers.len == workers.size &&
+               workers.stop == false)
+        {
+            // The scripts may wait for Lua functions that must be
+            // executed by the event loop, handle them while waiting.
+            pthread_mutex_unlock(&workers.lock);
+            lua_async_handle_pending();
+            pthread_mutex_lock(&workers.lock);
+            if (workers.len < workers.size) {
+                break;
+            }
+            struct timespec max_wait;
+            clock_gettime(CLOCK_REALTIME, &max_wait);
+            max_wait.tv_nsec += 10000000;
+            if (max_wait.tv_nsec >= 1000000000) {
+                max_wait.tv_sec++;
+                max_wait.tv_nsec -= 1000000000;
+            }
+            pthread_cond_timedwait(&workers.not_full, &workers.lock, &max_wait);
+        }
+    }
+    bool rc = workers.len < workers.size;
+    pthread_mutex_unlock(&workers.lock);
+    if (rc == false) {
+        MYGPIOD_LOG_WARN("Lua job queue is full, dropping script \"%s\"", script->name);
+        METRICS_INC(metrics.lua_async_dropped);
+    }
+    return rc;
+}
+
+/**
+ * Queues a job, lua_async_workers_accept must have returned true
+ * @param script Script to execute
+ * @param lua_vm Lua VM with the loaded script
+ * @param start_us Time the action was triggered
+ */
+void lua_async_workers_push(struct t_lua_script *script, lua_State *lua_vm, uint64_t start_us) {
+    pthread_mutex_lock(&workers.lock);
+    unsigned tail = (workers.head + workers.len) % workers.size;
+    workers.jobs[tail].script = script;
+    workers.jobs[tail].lua_vm = lua_vm;
+    workers.jobs[tail].start_us = start_us;
+    workers.len++;
+    pthread_cond_signal(&workers.not_empty);
+    pthread_mutex_unlock(&workers.lock);
+}
+
+/**
+ * Returns the number of queued jobs
+ * @return Queue depth
+ */
+unsigned lua_async_workers_depth(void) {
+    pthread_mutex_lock(&workers.lock);
+    unsigned len = workers.len;
+    pthread_mutex_unlock(&workers.lock);
+    return len;
+}
+
+// Private functions
+
+/**
+ * Main function of a worker thread
+ * @param arg Not used
+ * @return NULL
+ */
+static void *worker_run(void *arg) {
+    (void)arg;
+    logline = sdsempty();
+    pthread_mutex_lock(&workers.lock);
+    while (true) {
+        while (workers.len == 0 &&
+               workers.stop == false)
+        {
+            pthread_cond_wait(&workers.not_empty, &workers.lock);
+        }
+        if (workers.stop == true) {
+            break;
+        }
+        struct t_lua_async_job job = workers.jobs[workers.head];
+        workers.head = (workers.head + 1) % workers.size;
+        workers.len--;
+        pthread_cond_signal(&workers.not_full);
+        pthread_mutex_unlock(&workers.lock);
+        script_run(&job);
+        pthread_mutex_lock(&workers.lock);
+    }
+    pthread_mutex_unlock(&workers.lock);
+    FREE_SDS(logline);
+    atomic_fetch_sub_explicit(&workers.running, 1, memory_order_release);
+    return NULL;
+}
+
+/**
+ * Executes a script and puts the Lua VM back to the pool
+ * @param job The job
+ */
+static void script_run(struct t_lua_async_job *job) {
+    MYGPIOD_LOG_DEBUG("Start async Lua script \"%s\"", job->script->name);
+    metrics_observe(&metrics.lua_async_start, job->start_us);
+    struct t_lua_watchdog watchdog;
+    lua_watchdog_start(job->lua_vm, &watchdog, workers.timeout_ms, workers.instructions);
+    int rc = lua_pcall(job->lua_vm, 0, 1, 0);
+    enum lua_watchdog_reason reason = lua_watchdog_stop(job->lua_vm, &watchdog);
+    metrics_observe(&metrics.lua_duration[METRICS_LUA_ASYNC], watchdog.start_us);
+    MYGPIOD_LOG_DEBUG("End async Lua script \"%s\"", job->script->name);
+    if (rc != LUA_OK) {
+        lua_log_result(job->lua_vm, rc, job->script->name);
+        if (reason != LUA_WATCHDOG_OK) {
+            lua_watchdog_report_async(job->lua_vm, &watchdog, job->script->name, METRICS_LUA_ASYNC);
+        }
+    }
+    lua_async_pool_release(job->lua_vm);
+}
+
+/**
+ * Checks if a job for the script is queued, the lock must be held
+ * @param script Script to check
+ * @return true if a job is queued, else false
+ */
+static bool job_pending(struct t_lua_script *script) {
+    for (unsigned i = 0; i < workers.len; i++) {
+        if (workers.jobs[(workers.head + i) % workers.size].script == script) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,27 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Worker threads for async Lua scripts
+ */
+
+#ifndef MYGPIOD_LUA_ASYNC_WORKERS_H
+#define MYGPIOD_LUA_ASYNC_WORKERS_H
+
+#include "mygpiod/config/config.h"
+#include "mygpiod/config/lua_async.h"
+
+#include <lua.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+bool lua_async_workers_init(struct t_config *config);
+void lua_async_workers_clear(void);
+bool lua_async_workers_accept(struct t_lua_script *script);
+void lua_async_workers_push(struct t_lua_script *script, lua_State *lua_vm, uint64_t start_us);
+unsigned lua_async_workers_depth(void);
+
+#endif
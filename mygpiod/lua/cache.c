@@ -0,0 +1,238 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Bytecode cache for Lua scripts
+ *
+ * The compiled scripts are saved as <cache_dir>/<cache_name>.luac.
+ * The first line of the file is the key: the Lua release and the SHA-1
+ * of the script source. The bytecode is only used if the key matches.
+ * Lua does not verify bytecode, the cache directory must be writable
+ * only by myGPIOd.
+ */
+
+#include "compile_time.h"
+#include "mygpiod/lua/cache.h"
+
+#include "mygpiod/lib/log.h"
+#include "mygpiod/lib/sds_extras.h"
+#include "mygpiod/lib/sha1.h"
+
+#include <errno.h>
+#include <lauxlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+// Private definitions
+
+static sds get_key(sds key, const char *source, size_t len);
+static sds get_path(sds path, const char *cache_dir, const char *cache_name);
+static int dump_cb(lua_State *lua_vm, const void *p, size_t sz, void *ud);
+
+// Public functions
+
+/**
+ * Reads the cached bytecode of a script
+ * @param cache_dir Cache directory, empty to disable the cache
+ * @param cache_name Name of the cache file without extension
+ * @param source Script source
+ * @param len Length of the script source
+ * @return Bytecode or NULL if not cached or the source has changed
+ */
+sds lua_cache_get(const char *cache_dir, const char *cache_name, const char *source, size_t len) {
+    if (cache_dir[0] == '\0') {
+        return NULL;
+    }
+    sds path = get_path(sdsempty(), cache_dir, cache_name);
+    errno = 0;
+    FILE *fp = fopen(path, OPEN_FLAGS_READ);
+    if (fp == NULL) {
+        if (errno != ENOENT) {
+            MYGPIOD_LOG_WARN("Unable to open Lua cache file \"%s\"", path);
+            MYGPIOD_LOG_ERRNO(errno);
+        }
+        FREE_SDS(path);
+        return NULL;
+    }
+    sds content = sdsempty();
+    const size_t buffer_size = 10240;
+    content = sdsMakeRoomFor(content, buffer_size);
+    size_t nread;
+    while ((nread = fread(content + sdslen(content), sizeof(char), buffer_size, fp)) > 0) {
+        sdsIncrLen(content, (ssize_t)nread);
+        content = sdsMakeRoomFor(content, buffer_size);
+    }
+    bool read_error = ferror(fp) != 0;
+    (void)fclose(fp);
+    sds key = get_key(sdsempty(), source, len);
+    if (read_error == true ||
+        sdslen(content) <= sdslen(key) ||
+        memcmp(content, key, sdslen(key)) != 0)
+    {
+        MYGPIOD_LOG_DEBUG("Lua cache file \"%s\" is outdated", path);
+        FREE_SDS(content);
+        FREE_SDS(key);
+        FREE_SDS(path);
+        return NULL;
+    }
+    sdsrange(content, (ssize_t)sdslen(key), -1);
+    MYGPIOD_LOG_DEBUG("Read bytecode from \"%s\"", path);
+    FREE_SDS(key);
+    FREE_SDS(path);
+    return content;
+}
+
+/**
+ * Saves the bytecode of a script.
+ * The file is written to a temporary file and renamed.
+ * @param cache_dir Cache directory, empty to disable the cache
+ * @param cache_name Name of the cache file without extension
+ * @param source Script source
+ * @param len Length of the script source
+ * @param bytecode Bytecode to save
+ * @return true on success, else false
+ */
+bool lua_cache_put(const char *cache_dir, const char *cache_name, const char *source, size_t len, sds bytecode) {
+    if (cache_dir[0] == '\0') {
+        return false;
+    }
+    sds path = get_path(sdsempty(), cache_dir, cache_name);
+    sds tmp_path = sdscatfmt(sdsempty(), "%S.tmp", path);
+    errno = 0;
+    FILE *fp = fopen(tmp_path, OPEN_FLAGS_WRITE);
+    if (fp == NULL &&
+        errno == ENOENT &&
+        mkdir(cache_dir, 0750) == 0)
+    {
+        fp = fopen(tmp_path, OPEN_FLAGS_WRITE);
+    }
+    if (fp == NULL) {
+        MYGPIOD_LOG_WARN("Unable to write Lua cache file \"%s\"", tmp_path);
+        MYGPIOD_LOG_ERRNO(errno);
+        FREE_SDS(tmp_path);
+        FREE_SDS(path);
+        return false;
+    }
+    sds key = get_key(sdsempty(), source, len);
+    bool rc = fwrite(key, 1, sdslen(key), fp) == sdslen(key) &&
+        fwrite(bytecode, 1, sdslen(bytecode), fp) == sdslen(bytecode);
+    if (fclose(fp) != 0) {
+        rc = false;
+    }
+    if (rc == true &&
+        rename(tmp_path, path) == 0)
+    {
+        MYGPIOD_LOG_DEBUG("Saved bytecode to \"%s\"", path);
+    }
+    else {
+        MYGPIOD_LOG_WARN("Unable to write Lua cache file \"%s\"", path);
+        MYGPIOD_LOG_ERRNO(errno);
+        (void)remove(tmp_path);
+        rc = false;
+    }
+    FREE_SDS(key);
+    FREE_SDS(tmp_path);
+    FREE_SDS(path);
+    return rc;
+}
+
+/**
+ * Dumps the function on the top of the stack as bytecode
+ * @param lua_vm Lua VM
+ * @return Bytecode or NULL on error
+ */
+sds lua_cache_dump(lua_State *lua_vm) {
+    sds bytecode = sdsempty();
+    if (lua_dump(lua_vm, dump_cb, &bytecode, false) != 0) {
+        FREE_SDS(bytecode);
+        return NULL;
+    }
+    return bytecode;
+}
+
+/**
+ * Loads a script as function on the top of the stack.
+ * It uses the cached bytecode or compiles the source and updates the cache.
+ * @param lua_vm Lua VM
+ * @param cache_dir Cache directory, empty to disable the cache
+ * @param cache_name Name of the cache file without extension
+ * @param source Script source
+ * @param len Length of the script source
+ * @param chunk_name Name of the chunk for error messages
+ * @return Lua status code
+ */
+int lua_cache_load(lua_State *lua_vm, const char *cache_dir, const char *cache_name,
+        const char *source, size_t len, const char *chunk_name)
+{
+    sds bytecode = lua_cache_get(cache_dir, cache_name, source, len);
+    if (bytecode != NULL) {
+        int rc = luaL_loadbufferx(lua_vm, bytecode, sdslen(bytecode), chunk_name, "b");
+        FREE_SDS(bytecode);
+        if (rc == LUA_OK) {
+            return rc;
+        }
+        // Bytecode of another Lua build, compile the source
+        lua_pop(lua_vm, 1);
+    }
+    int rc = luaL_loadbufferx(lua_vm, source, len, chunk_name, "t");
+    if (rc != LUA_OK ||
+        cache_dir[0] == '\0')
+    {
+        return rc;
+    }
+    bytecode = lua_cache_dump(lua_vm);
+    if (bytecode != NULL) {
+        lua_cache_put(cache_dir, cache_name, source, len, bytecode);
+        FREE_SDS(bytecode);
+    }
+    return rc;
+}
+
+// Private functions
+
+/**
+ * Creates the cache key: Lua release and SHA-1 of the source
+ * @param key sds string to append the key
+ * @param source Script source
+ * @param len Length of the script source
+ * @return pointer to key
+ */
+static sds get_key(sds key, const char *source, size_t len) {
+    uint8_t digest[SHA1_DIGEST_LEN];
+    sha1(source, len, digest);
+    key = sdscat(key, LUA_RELEASE " ");
+    for (size_t i = 0; i < SHA1_DIGEST_LEN; i++) {
+        key = sdscatprintf(key, "%02x", digest[i]);
+    }
+    return sdscatlen(key, "\n", 1);
+}
+
+/**
+ * Creates the path of the cache file
+ * @param path sds string to append the path
+ * @param cache_dir Cache directory
+ * @param cache_name Name of the cache file without extension
+ * @return pointer to path
+ */
+static sds get_path(sds path, const char *cache_dir, const char *cache_name) {
+    return sdscatfmt(path, "%s/%s.luac", cache_dir, cache_name);
+}
+
+/**
+ * Callback function for lua_dump to save the lua script bytecode
+ * @param lua_vm lua state
+ * @param p chunk to write
+ * @param sz chunk size
+ * @param ud pointer to the sds string
+ * @return 0 on success
+ */
+static int dump_cb(lua_State *lua_vm, const void *p, size_t sz, void *ud) {
+    (void)lua_vm;
+    sds *bytecode = (sds *)ud;
+    *bytecode = sdscatlen(*bytecode, p, sz);
+    return 0;
+}
@@ -0,0 +1,25 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Bytecode cache for Lua scripts
+ */
+
+#ifndef MYGPIOD_LUA_CACHE_H
+#define MYGPIOD_LUA_CACHE_H
+
+#include "dist/sds/sds.h"
+
+#include <lua.h>
+#include <stdbool.h>
+
+sds lua_cache_get(const char *cache_dir, const char *cache_name, const char *source, size_t len);
+bool lua_cache_put(const char *cache_dir, const char *cache_name, const char *source, size_t len, sds bytecode);
+sds lua_cache_dump(lua_State *lua_vm);
+int lua_cache_load(lua_State *lua_vm, const char *cache_dir, const char *cache_name,
+        const char *source, size_t len, const char *chunk_name);
+
+#endif
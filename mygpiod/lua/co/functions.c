@@ -0,0 +1,164 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Lua functions that suspend the coroutine
+ *
+ * The functions register the wait condition and yield. The scheduler
+ * pushes the return values and resumes the coroutine.
+ */
+
+#include "compile_time.h"
+#include "mygpiod/lua/co/functions.h"
+
+#include "mygpiod/lib/log.h"
+#include "mygpiod/lua/co/scheduler.h"
+#include "mygpiod/lua/util.h"
+
+#ifdef MYGPIOD_ENABLE_ACTION_HTTP
+    #include "mygpiod/actions/http.h"
+#endif
+
+#include <limits.h>
+
+// Private definitions
+
+static struct t_lua_co *get_coroutine(lua_State *lua_vm, const char *cmd);
+#ifdef MYGPIOD_ENABLE_ACTION_HTTP
+    static void http_done(struct t_http_request *request, unsigned status, void *data);
+#endif
+
+// Public functions
+
+/**
+ * Suspends the coroutine for the given time.
+ * @param lua_vm pointer to lua vm
+ * @return Number of values on the stack
+ */
+int lua_sleep_co(lua_State *lua_vm) {
+    struct t_lua_co *co = get_coroutine(lua_vm, "sleep");
+    if (check_lua_arg_count(lua_vm, "sleep", 1) == false) {
+        return set_lua_rc(lua_vm, false);
+    }
+    if (lua_isinteger(lua_vm, 1) == 0) {
+        MYGPIOD_LOG_ERROR("Argument timeout is not a number");
+        clean_up_lua_stack(lua_vm);
+        return set_lua_rc(lua_vm, false);
+    }
+    lua_Integer timeout_ms = lua_tointeger(lua_vm, 1);
+    clean_up_lua_stack(lua_vm);
+    // The minimum sleep is one event loop iteration
+    lua_co_wait(co, LUA_CO_WAIT_SLEEP, timeout_ms > 0 && timeout_ms < INT_MAX
+        ? (int)timeout_ms
+        : 1);
+    return lua_yield(lua_vm, 0);
+}
+
+/**
+ * Suspends the coroutine until an edge event of an input GPIO occurs.
+ * Returns true and the event type or false and "timeout".
+ * @param lua_vm pointer to lua vm
+ * @return Number of values on the stack
+ */
+int lua_gpio_wait_edge_co(lua_State *lua_vm) {
+    struct t_lua_co *co = get_coroutine(lua_vm, "gpioWaitEdge");
+    struct t_config *config = get_lua_global_config(lua_vm);
+    if (check_lua_arg_count(lua_vm, "gpioWaitEdge", 2) == false) {
+        return set_lua_rc(lua_vm, false);
+    }
+    if (lua_isinteger(lua_vm, 1) == 0) {
+        MYGPIOD_LOG_ERROR("Argument GPIO is not a number");
+        clean_up_lua_stack(lua_vm);
+        return set_lua_rc(lua_vm, false);
+    }
+    if (lua_isinteger(lua_vm, 2) == 0) {
+        MYGPIOD_LOG_ERROR("Argument timeout is not a number");
+        clean_up_lua_stack(lua_vm);
+        return set_lua_rc(lua_vm, false);
+    }
+    unsigned gpio = (unsigned)lua_tointeger(lua_vm, 1);
+    lua_Integer timeout_ms = lua_tointeger(lua_vm, 2);
+    clean_up_lua_stack(lua_vm);
+    if (list_node_by_id(&config->gpios_in, gpio) == NULL) {
+        MYGPIOD_LOG_ERROR("GPIO %u is not configured as input", gpio);
+        return set_lua_rc(lua_vm, false);
+    }
+    co->gpio = gpio;
+    // A timeout of 0 waits forever
+    lua_co_wait(co, LUA_CO_WAIT_GPIO, timeout_ms > 0 && timeout_ms < INT_MAX
+        ? (int)timeout_ms
+        : 0);
+    return lua_yield(lua_vm, 0);
+}
+
+#ifdef MYGPIOD_ENABLE_ACTION_HTTP
+/**
+ * Submits a HTTP request and suspends the coroutine until the response is received.
+ * Returns the HTTP status code, the response header and body.
+ * @param lua_vm pointer to lua vm
+ * @return Number of values on the stack
+ */
+int lua_http_co(lua_State *lua_vm) {
+    struct t_lua_co *co = get_coroutine(lua_vm, "http");
+    if (check_lua_arg_count(lua_vm, "http", 4) == false) {
+        return set_lua_rc(lua_vm, false);
+    }
+    const char *method = lua_tostring(lua_vm, 1);
+    if (method == NULL) {
+        MYGPIOD_LOG_ERROR("Invalid method");
+        clean_up_lua_stack(lua_vm);
+        return set_lua_rc(lua_vm, false);
+    }
+    const char *uri = lua_tostring(lua_vm, 2);
+    if (uri == NULL) {
+        MYGPIOD_LOG_ERROR("Invalid uri");
+        clean_up_lua_stack(lua_vm);
+        return set_lua_rc(lua_vm, false);
+    }
+    const char *content_type = lua_tostring(lua_vm, 3);
+    const char *postdata = lua_tostring(lua_vm, 4);
+    bool rc = action_http_callback(method, uri, content_type, postdata, http_done, co);
+    clean_up_lua_stack(lua_vm);
+    if (rc == false) {
+        return set_lua_rc(lua_vm, false);
+    }
+    lua_co_wait(co, LUA_CO_WAIT_HTTP, 0);
+    return lua_yield(lua_vm, 0);
+}
+#endif
+
+// Private functions
+
+/**
+ * Returns the coroutine of the Lua thread or raises an error
+ * @param lua_vm pointer to lua vm
+ * @param cmd Function name for the error message
+ * @return The coroutine
+ */
+static struct t_lua_co *get_coroutine(lua_State *lua_vm, const char *cmd) {
+    struct t_lua_co *co = lua_co_current(lua_vm);
+    if (co == NULL) {
+        luaL_error(lua_vm, "%s can not be called from a nested coroutine", cmd);
+    }
+    return co;
+}
+
+#ifdef MYGPIOD_ENABLE_ACTION_HTTP
+/**
+ * Resumes the coroutine with the HTTP response
+ * @param request The finished request
+ * @param status HTTP status code, 0 on error
+ * @param data The coroutine
+ */
+static void http_done(struct t_http_request *request, unsigned status, void *data) {
+    struct t_lua_co *co = (struct t_lua_co *)data;
+    lua_pushinteger(co->thread, status);
+    lua_pushlstring(co->thread, request->response_header, sdslen(request->response_header));
+    lua_pushlstring(co->thread, request->response_body, sdslen(request->response_body));
+    lua_co_wake(co, 3);
+    lua_co_run();
+}
+#endif
@@ -0,0 +1,24 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Lua functions that suspend the coroutine
+ */
+
+#ifndef MYGPIOD_LUA_CO_FUNCTIONS_H
+#define MYGPIOD_LUA_CO_FUNCTIONS_H
+
+#include <lauxlib.h>
+#include <lua.h>
+#include <lualib.h>
+
+int lua_sleep_co(lua_State *lua_vm);
+int lua_gpio_wait_edge_co(lua_State *lua_vm);
+#ifdef MYGPIOD_ENABLE_ACTION_HTTP
+    int lua_http_co(lua_State *lua_vm);
+#endif
+
+#endif
@@ -0,0 +1,447 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Lua scripts as coroutines in the event loop
+ *
+ * All scripts share one Lua VM that is only used by the event loop thread.
+ * Each run is a Lua thread with its own global environment, that falls
+ * back to the shared globals. Functions that wait, e.g. sleep, register
+ * the wait condition and yield. The event loop resumes the coroutine if
+ * the condition is met: one timerfd for all timeouts, GPIO edge events and
+ * the completion callbacks of HTTP requests.
+ */
+
+#include "compile_time.h"
+#include "mygpiod/lua/co/scheduler.h"
+
+#include "mygpiod/event_loop/event_loop.h"
+#include "mygpiod/gpio/util.h"
+#include "mygpiod/lib/list.h"
+#include "mygpiod/lib/log.h"
+#include "mygpiod/lib/mem.h"
+#include "mygpiod/lib/metrics.h"
+#include "mygpiod/lib/timer.h"
+#include "mygpiod/lua/async/bytecode.h"
+#include "mygpiod/lua/co/functions.h"
+#include "mygpiod/lua/sync/functions/gpio.h"
+#include "mygpiod/lua/sync/functions/input_ev.h"
+#include "mygpiod/lua/sync/functions/system.h"
+#include "mygpiod/lua/util.h"
+#include "mygpiod/lua/watchdog.h"
+
+#ifdef MYGPIOD_ENABLE_ACTION_MPC
+    #include "mygpiod/lua/sync/functions/mpc.h"
+#endif
+#ifdef MYGPIOD_ENABLE_ACTION_HTTP
+    #include "mygpiod/lua/sync/functions/http.h"
+#endif
+
+#include <lauxlib.h>
+#include <lualib.h>
+#include <stdatomic.h>
+
+// Private definitions
+
+/**
+ * Registry key of the metatable for the environment of each run
+ */
+#define CO_ENV_KEY "mygpiodCoEnv"
+
+/**
+ * Scheduler state, only accessed by the event loop thread
+ */
+struct t_lua_co_scheduler {
+    struct t_config *config; //!< Pointer to config
+    lua_State *lua_vm;       //!< Shared Lua VM
+    int timer_fd;            //!< Timer for all timeouts
+    struct t_list coroutines;  //!< List of struct t_lua_co
+    atomic_uint count;       //!< Number of coroutines, read by the metrics
+    bool running;            //!< Guard against nested runs
+};
+
+static struct t_lua_co_scheduler scheduler = {
+    .config = NULL,
+    .lua_vm = NULL,
+    .timer_fd = -1,
+    .coroutines = { .head = NULL, .tail = NULL, .length = 0 },
+    .count = 0,
+    .running = false
+};
+
+static void run_ready(void);
+static void co_resume(struct t_lua_co *co);
+static void co_remove(struct t_lua_co *co);
+static void arm_timer(void);
+static uint64_t now_ms(void);
+
+// Public functions
+
+/**
+ * Creates the shared Lua VM and the timer
+ * @param config Pointer to config
+ * @return true on success, else false
+ */
+bool lua_co_init(struct t_config *config) {
+    if (config->lua_async_scripts.length == 0) {
+        return true;
+    }
+    scheduler.timer_fd = timer_new(0, 0);
+    if (scheduler.timer_fd == -1) {
+        return false;
+    }
+    lua_State *lua_vm = luaL_newstate();
+    if (lua_vm == NULL) {
+        MYGPIOD_LOG_ERROR("Memory allocation error in luaL_newstate");
+        return false;
+    }
+    // New threads inherit the extra space of the main thread,
+    // coroutines created by the scripts have no struct t_lua_co.
+    *(struct t_lua_co **)lua_getextraspace(lua_vm) = NULL;
+    luaL_openlibs(lua_vm);
+    // Applies the watchdog to coroutines
+    lua_watchdog_install(lua_vm);
+    lua_pushlightuserdata(lua_vm, config);
+    lua_setglobal(lua_vm, "mygpiodConfig");
+    // Functions executed directly in the event loop
+    lua_register(lua_vm, "gpioBatch", lua_gpio_batch);
+    lua_register(lua_vm, "gpioBlink", lua_gpio_blink);
+    lua_register(lua_vm, "gpioGet", lua_gpio_get);
+    lua_register(lua_vm, "gpioSet", lua_gpio_set);
+    lua_register(lua_vm, "gpioToggle", lua_gpio_toggle);
+    lua_register(lua_vm, "inputEvGet", lua_input_ev_get);
+    lua_register(lua_vm, "system", lua_system_async);
+    #ifdef MYGPIOD_ENABLE_ACTION_MPC
+        lua_register(lua_vm, "mpc", lua_mpc);
+        lua_register(lua_vm, "mpdState", lua_mpd_state);
+    #endif
+    #ifdef MYGPIOD_ENABLE_ACTION_HTTP
+        lua_register(lua_vm, "mympd", lua_mympd_async);
+        lua_register(lua_vm, "http", lua_http_co);
+    #endif
+    // Functions that suspend the coroutine
+    lua_register(lua_vm, "sleep", lua_sleep_co);
+    lua_register(lua_vm, "gpioWaitEdge", lua_gpio_wait_edge_co);
+    // Metatable for the environment of each run
+    lua_newtable(lua_vm);
+    lua_pushglobaltable(lua_vm);
+    lua_setfield(lua_vm, -2, "__index");
+    lua_setfield(lua_vm, LUA_REGISTRYINDEX, CO_ENV_KEY);
+    scheduler.config = config;
+    scheduler.lua_vm = lua_vm;
+    list_init(&scheduler.coroutines);
+    return true;
+}
+
+/**
+ * Closes the Lua VM and drops the running coroutines.
+ * The HTTP requests must be stopped before.
+ */
+void lua_co_clear(void) {
+    struct t_list_node *node;
+    while ((node = list_shift(&scheduler.coroutines)) != NULL) {
+        FREE_PTR(node->data);
+        FREE_PTR(node);
+    }
+    atomic_store_explicit(&scheduler.count, 0, memory_order_relaxed);
+    if (scheduler.lua_vm != NULL) {
+        lua_close(scheduler.lua_vm);
+        scheduler.lua_vm = NULL;
+    }
+    close_fd(&scheduler.timer_fd);
+}
+
+/**
+ * Returns the timer fd that must be polled
+ * @return Timer fd
+ */
+int lua_co_timer_fd(void) {
+    return scheduler.timer_fd;
+}
+
+/**
+ * Starts the script as new coroutine, it runs until its first wait
+ * @param script Script to start
+ * @return true on success, else false
+ */
+bool lua_co_start(struct t_lua_script *script) {
+    if (scheduler.lua_vm == NULL) {
+        return false;
+    }
+    if (scheduler.coroutines.length >= LUA_CO_MAX) {
+        MYGPIOD_LOG_ERROR("Too many running Lua coroutines, not starting \"%s\"", script->name);
+        return false;
+    }
+    lua_State *thread = lua_newthread(scheduler.lua_vm);
+    int ref = luaL_ref(scheduler.lua_vm, LUA_REGISTRYINDEX);
+    bool rc;
+    if (script->bytecode != NULL) {
+        int load_rc = luaL_loadbuffer(thread, script->bytecode, sdslen(script->bytecode), script->name);
+        lua_log_result(thread, load_rc, script->name);
+        rc = load_rc == LUA_OK;
+    }
+    else {
+        // Compiles and caches the bytecode
+        rc = lua_async_compile(thread, scheduler.config, script);
+    }
+    if (rc == false) {
+        luaL_unref(scheduler.lua_vm, LUA_REGISTRYINDEX, ref);
+        return false;
+    }
+    // Own environment for the globals of this run
+    lua_newtable(thread);
+    lua_getfield(thread, LUA_REGISTRYINDEX, CO_ENV_KEY);
+    lua_setmetatable(thread, -2);
+    lua_setupvalue(thread, -2, 1);
+
+    struct t_lua_co *co = malloc_assert(sizeof(struct t_lua_co));
+    co->thread = thread;
+    co->ref = ref;
+    co->name = script->name;
+    co->wait = LUA_CO_WAIT_NONE;
+    co->deadline_ms = 0;
+    co->gpio = 0;
+    co->nargs = 0;
+    co->ready = true;
+    *(struct t_lua_co **)lua_getextraspace(thread) = co;
+    list_push(&scheduler.coroutines, 0, co);
+    atomic_store_explicit(&scheduler.count, scheduler.coroutines.length, memory_order_relaxed);
+    MYGPIOD_LOG_DEBUG("Start Lua coroutine \"%s\"", co->name);
+    run_ready();
+    return true;
+}
+
+/**
+ * Resumes the coroutines with an expired timeout
+ * @param fd Pointer to the timer fd
+ */
+void lua_co_handle_timer(int *fd) {
+    if (timerfd_read_value(fd) == false) {
+        return;
+    }
+    uint64_t now = now_ms();
+    struct t_list_node *current = scheduler.coroutines.head;
+    while (current != NULL) {
+        struct t_lua_co *co = (struct t_lua_co *)current->data;
+        if (co->ready == false &&
+            co->deadline_ms > 0 &&
+            co->deadline_ms <= now)
+        {
+            if (co->wait == LUA_CO_WAIT_SLEEP) {
+                lua_pushboolean(co->thread, true);
+                lua_co_wake(co, 1);
+            }
+            else {
+                lua_pushboolean(co->thread, false);
+                lua_pushstring(co->thread, "timeout");
+                lua_co_wake(co, 2);
+            }
+        }
+        current = current->next;
+    }
+    run_ready();
+}
+
+/**
+ * Resumes the coroutines waiting for an edge event of this GPIO
+ * @param gpio GPIO number
+ * @param event_type Type of the edge event
+ */
+void lua_co_gpio_edge(unsigned gpio, enum gpiod_edge_event_type event_type) {
+    bool found = false;
+    struct t_list_node *current = scheduler.coroutines.head;
+    while (current != NULL) {
+        struct t_lua_co *co = (struct t_lua_co *)current->data;
+        if (co->ready == false &&
+            co->wait == LUA_CO_WAIT_GPIO &&
+            co->gpio == gpio)
+        {
+            lua_pushboolean(co->thread, true);
+            lua_pushstring(co->thread, lookup_event_type(event_type));
+            lua_co_wake(co, 2);
+            found = true;
+        }
+        current = current->next;
+    }
+    if (found == true) {
+        run_ready();
+    }
+}
+
+/**
+ * Returns the coroutine of a Lua thread
+ * @param lua_vm Lua thread
+ * @return The coroutine or NULL if called from a nested coroutine
+ */
+struct t_lua_co *lua_co_current(lua_State *lua_vm) {
+    return *(struct t_lua_co **)lua_getextraspace(lua_vm);
+}
+
+/**
+ * Registers the wait condition, the caller must yield afterwards
+ * @param co The coroutine
+ * @param wait What to wait for
+ * @param timeout_ms Timeout in milliseconds, 0 for none
+ */
+void lua_co_wait(struct t_lua_co *co, enum lua_co_wait wait, int timeout_ms) {
+    co->wait = wait;
+    co->deadline_ms = timeout_ms > 0
+        ? now_ms() + (uint64_t)timeout_ms
+        : 0;
+}
+
+/**
+ * Marks the coroutine as ready, the values for the resume must be pushed
+ * on the thread before. lua_co_run resumes the ready coroutines.
+ * @param co The coroutine
+ * @param nargs Number of values pushed on the thread
+ */
+void lua_co_wake(struct t_lua_co *co, int nargs) {
+    co->wait = LUA_CO_WAIT_NONE;
+    co->deadline_ms = 0;
+    co->nargs = nargs;
+    co->ready = true;
+}
+
+/**
+ * Returns the number of running coroutines
+ * @return Number of coroutines
+ */
+unsigned lua_co_running(void) {
+    return atomic_load_explicit(&scheduler.count, memory_order_relaxed);
+}
+
+/**
+ * Resumes the ready coroutines, can be called from HTTP callbacks
+ */
+void lua_co_run(void) {
+    run_ready();
+}
+
+// Private functions
+
+/**
+ * Resumes all ready coroutines.
+ * Coroutines that become ready while running are also resumed.
+ */
+static void run_ready(void) {
+    if (scheduler.running == true) {
+        return;
+    }
+    scheduler.running = true;
+    // Coroutines that got ready before the scan position are resumed in the next pass
+    bool found = true;
+    while (found == true) {
+        found = false;
+        struct t_list_node *current = scheduler.coroutines.head;
+        while (current != NULL) {
+            // Resuming removes only the resumed coroutine, new ones are appended
+            struct t_list_node *next = current->next;
+            struct t_lua_co *co = (struct t_lua_co *)current->data;
+            if (co->ready == true) {
+                co_resume(co);
+                found = true;
+            }
+            current = next;
+        }
+    }
+    scheduler.running = false;
+    arm_timer();
+}
+
+/**
+ * Resumes a coroutine and removes it if it has finished
+ * @param co The coroutine
+ */
+static void co_resume(struct t_lua_co *co) {
+    co->ready = false;
+    int nargs = co->nargs;
+    co->nargs = 0;
+    int nres;
+    struct t_lua_watchdog watchdog;
+    lua_watchdog_start(co->thread, &watchdog, scheduler.config->lua_timeout, scheduler.config->lua_instructions);
+    int rc = lua_resume(co->thread, NULL, nargs, &nres);
+    enum lua_watchdog_reason reason = lua_watchdog_stop(co->thread, &watchdog);
+    metrics_observe(&metrics.lua_duration[METRICS_LUA_CO], watchdog.start_us);
+    if (rc == LUA_YIELD) {
+        lua_pop(co->thread, nres);
+        if (co->wait == LUA_CO_WAIT_NONE &&
+            co->ready == false)
+        {
+            // coroutine.yield from the script, continue in the next loop iteration
+            lua_co_wait(co, LUA_CO_WAIT_SLEEP, 1);
+        }
+        return;
+    }
+    if (rc == LUA_OK) {
+        MYGPIOD_LOG_DEBUG("End Lua coroutine \"%s\"", co->name);
+    }
+    else {
+        // Keep only the error message
+        lua_insert(co->thread, 1);
+        lua_settop(co->thread, 1);
+        lua_log_result(co->thread, rc, co->name);
+        if (reason != LUA_WATCHDOG_OK) {
+            lua_watchdog_report(scheduler.config, &watchdog, co->name, METRICS_LUA_CO);
+        }
+    }
+    co_remove(co);
+}
+
+/**
+ * Frees a finished coroutine, the Lua thread is garbage collected
+ * @param co The coroutine
+ */
+static void co_remove(struct t_lua_co *co) {
+    luaL_unref(scheduler.lua_vm, LUA_REGISTRYINDEX, co->ref);
+    struct t_list_node *current = scheduler.coroutines.head;
+    while (current != NULL) {
+        if (current->data == co) {
+            list_remove_node(&scheduler.coroutines, current);
+            FREE_PTR(current);
+            atomic_store_explicit(&scheduler.count, scheduler.coroutines.length, memory_order_relaxed);
+            break;
+        }
+        current = current->next;
+    }
+    FREE_PTR(co);
+}
+
+/**
+ * Sets the timer to the nearest deadline or disarms it
+ */
+static void arm_timer(void) {
+    if (scheduler.timer_fd == -1) {
+        return;
+    }
+    uint64_t next = 0;
+    struct t_list_node *current = scheduler.coroutines.head;
+    while (current != NULL) {
+        struct t_lua_co *co = (struct t_lua_co *)current->data;
+        if (co->deadline_ms > 0 &&
+            (next == 0 || co->deadline_ms < next))
+        {
+            next = co->deadline_ms;
+        }
+        current = current->next;
+    }
+    int timeout_ms = 0;
+    if (next > 0) {
+        uint64_t now = now_ms();
+        timeout_ms = next > now
+            ? (int)(next - now)
+            : 1;
+    }
+    timer_set(scheduler.timer_fd, timeout_ms, 0);
+}
+
+/**
+ * Returns the monotonic time in milliseconds
+ * @return Milliseconds
+ */
+static uint64_t now_ms(void) {
+    return metrics_now_us() / 1000;
+}
@@ -0,0 +1,58 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Lua scripts as coroutines in the event loop
+ */
+
+#ifndef MYGPIOD_LUA_CO_SCHEDULER_H
+#define MYGPIOD_LUA_CO_SCHEDULER_H
+
+#include "mygpiod/config/config.h"
+#include "mygpiod/config/lua_async.h"
+
+#include <gpiod.h>
+#include <lua.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * What a suspended coroutine is waiting for
+ */
+enum lua_co_wait {
+    LUA_CO_WAIT_NONE = 0,  //!< Not waiting, running or ready to resume
+    LUA_CO_WAIT_SLEEP,     //!< Waiting for the timeout
+    LUA_CO_WAIT_GPIO,      //!< Waiting for an edge event or the timeout
+    LUA_CO_WAIT_HTTP       //!< Waiting for a HTTP response
+};
+
+/**
+ * A running script
+ */
+struct t_lua_co {
+    lua_State *thread;      //!< Lua thread of the coroutine
+    int ref;                //!< Registry reference that keeps the thread alive
+    const char *name;       //!< Script name
+    enum lua_co_wait wait;  //!< What the coroutine is waiting for
+    uint64_t deadline_ms;   //!< Timeout, 0 for none
+    unsigned gpio;          //!< GPIO for LUA_CO_WAIT_GPIO
+    int nargs;              //!< Number of values pushed for the next resume
+    bool ready;             //!< Should be resumed
+};
+
+bool lua_co_init(struct t_config *config);
+void lua_co_clear(void);
+int lua_co_timer_fd(void);
+bool lua_co_start(struct t_lua_script *script);
+void lua_co_handle_timer(int *fd);
+void lua_co_gpio_edge(unsigned gpio, enum gpiod_edge_event_type event_type);
+struct t_lua_co *lua_co_current(lua_State *lua_vm);
+void lua_co_wait(struct t_lua_co *co, enum lua_co_wait wait, int timeout_ms);
+void lua_co_wake(struct t_lua_co *co, int nargs);
+void lua_co_run(void);
+unsigned lua_co_running(void);
+
+#endif
@@ -21,6 +21,13 @@
 #include <lauxlib.h>
 #include <lua.h>
 #include <lualib.h>
+#include <string.h>
+
+// Private definitions
+static bool batch_op(struct t_config *config, lua_State *lua_vm, int op_idx);
+static bool batch_get_integer(lua_State *lua_vm, int op_idx, int n, lua_Integer *value);
+
+// Public functions
 
 /**
  * Toggle the value of the GPIO in given timeout and interval.
@@ -129,3 +136,120 @@ int lua_gpio_toggle(lua_State *lua_vm) {
     clean_up_lua_stack(lua_vm);
     return set_lua_rc(lua_vm, rc);
 }
+
+/**
+ * Executes a list of GPIO operations with one call.
+ * Each operation is a table: {"get", gpio}, {"set", gpio, value},
+ * {"toggle", gpio} or {"blink", gpio, timeout_ms, interval_ms}.
+ * Returns true if all operations succeeded and a table with the result of each
+ * operation: the value for get, else a boolean.
+ * @param lua_vm pointer to lua vm
+ * @return Number of values on the stack
+ */
+int lua_gpio_batch(lua_State *lua_vm) {
+    struct t_config *config = get_lua_global_config(lua_vm);
+    if (check_lua_arg_count(lua_vm, "gpioBatch", 1) == false) {
+        return set_lua_rc(lua_vm, false);
+    }
+    if (lua_istable(lua_vm, 1) == 0) {
+        MYGPIOD_LOG_ERROR("Argument operations is not a table");
+        clean_up_lua_stack(lua_vm);
+        return set_lua_rc(lua_vm, false);
+    }
+    lua_Integer count = (lua_Integer)lua_rawlen(lua_vm, 1);
+    bool rc = true;
+    lua_createtable(lua_vm, (int)count, 0);
+    for (lua_Integer i = 1; i <= count; i++) {
+        lua_rawgeti(lua_vm, 1, i);
+        if (batch_op(config, lua_vm, 3) == false) {
+            rc = false;
+        }
+        lua_rawseti(lua_vm, 2, i);
+        lua_pop(lua_vm, 1);
+    }
+    // Stack: operations, results
+    lua_remove(lua_vm, 1);
+    lua_pushboolean(lua_vm, rc);
+    lua_insert(lua_vm, 1);
+    return 2;
+}
+
+// Private functions
+
+/**
+ * Executes one operation of a gpioBatch call and pushes its result
+ * @param config Pointer to config
+ * @param lua_vm pointer to lua vm
+ * @param op_idx Stack index of the operation table
+ * @return true on success, else false
+ */
+static bool batch_op(struct t_config *config, lua_State *lua_vm, int op_idx) {
+    if (lua_istable(lua_vm, op_idx) == 0) {
+        MYGPIOD_LOG_ERROR("gpioBatch: operation is not a table");
+        lua_pushboolean(lua_vm, false);
+        return false;
+    }
+    lua_rawgeti(lua_vm, op_idx, 1);
+    const char *op = lua_tostring(lua_vm, -1);
+    lua_pop(lua_vm, 1);
+    lua_Integer gpio;
+    if (op == NULL ||
+        batch_get_integer(lua_vm, op_idx, 2, &gpio) == false)
+    {
+        MYGPIOD_LOG_ERROR("gpioBatch: invalid operation");
+        lua_pushboolean(lua_vm, false);
+        return false;
+    }
+    bool rc = false;
+    if (strcmp(op, "get") == 0) {
+        enum gpiod_line_value value = gpio_get_value(config, (unsigned)gpio);
+        lua_pushstring(lua_vm, lookup_gpio_value(value));
+        return value != GPIOD_LINE_VALUE_ERROR;
+    }
+    if (strcmp(op, "set") == 0) {
+        lua_rawgeti(lua_vm, op_idx, 3);
+        const char *value_str = lua_tostring(lua_vm, -1);
+        enum gpiod_line_value value = value_str != NULL
+            ? parse_gpio_value(value_str)
+            : GPIOD_LINE_VALUE_ERROR;
+        lua_pop(lua_vm, 1);
+        if (value != GPIOD_LINE_VALUE_ERROR) {
+            rc = gpio_set_value(config, (unsigned)gpio, value);
+        }
+    }
+    else if (strcmp(op, "toggle") == 0) {
+        rc = gpio_toggle_value(config, (unsigned)gpio);
+    }
+    else if (strcmp(op, "blink") == 0) {
+        lua_Integer timeout;
+        lua_Integer interval;
+        if (batch_get_integer(lua_vm, op_idx, 3, &timeout) == true &&
+            batch_get_integer(lua_vm, op_idx, 4, &interval) == true)
+        {
+            rc = gpio_blink(config, (unsigned)gpio, (int)timeout, (int)interval);
+        }
+    }
+    else {
+        MYGPIOD_LOG_ERROR("gpioBatch: unknown operation \"%s\"", op);
+    }
+    lua_pushboolean(lua_vm, rc);
+    return rc;
+}
+
+/**
+ * Reads an integer from the operation table
+ * @param lua_vm pointer to lua vm
+ * @param op_idx Stack index of the operation table
+ * @param n Index in the operation table
+ * @param value Pointer to the integer to set
+ * @return true on success, else false
+ */
+static bool batch_get_integer(lua_State *lua_vm, int op_idx, int n, lua_Integer *value) {
+    lua_rawgeti(lua_vm, op_idx, n);
+    bool rc = lua_isinteger(lua_vm, -1) != 0;
+    if (rc == true) {
+        *value = lua_tointeger(lua_vm, -1);
+    }
+    lua_pop(lua_vm, 1);
+    return rc;
+}
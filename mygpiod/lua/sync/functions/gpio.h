@@ -15,6 +15,7 @@
 #include <lua.h>
 #include <lualib.h>
 
+int lua_gpio_batch(lua_State *lua_vm);
 int lua_gpio_blink(lua_State *lua_vm);
 int lua_gpio_get(lua_State *lua_vm);
 int lua_gpio_set(lua_State *lua_vm);
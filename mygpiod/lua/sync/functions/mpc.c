@@ -15,6 +15,7 @@
 #include "mygpiod/actions/actions.h"
 #include "mygpiod/actions/mpc.h"
 #include "mygpiod/lib/log.h"
+#include "mygpiod/lib/mpd_client.h"
 #include "mygpiod/lua/util.h"
 
 #include <gpiod.h>
@@ -46,3 +47,35 @@ int lua_mpc(lua_State *lua_vm) {
     sdsfreesplitres(action.options, action.options_count);
     return set_lua_rc(lua_vm, rc);
 }
+
+/**
+ * Returns the cached MPD state
+ * @param lua_vm pointer to lua vm
+ * @return Number of values on the stack
+ */
+int lua_mpd_state(lua_State *lua_vm) {
+    struct t_config *config = get_lua_global_config(lua_vm);
+    if (check_lua_arg_count(lua_vm, "mpdState", 0) == false) {
+        return set_lua_rc(lua_vm, false);
+    }
+    const struct t_mpd_state *state = &config->mpd_client->mirror;
+    lua_pushboolean(lua_vm, state->valid);
+    lua_newtable(lua_vm);
+    lua_pushstring(lua_vm, mpd_client_lookup_state(state->play_state));
+    lua_setfield(lua_vm, -2, "state");
+    lua_pushinteger(lua_vm, state->volume);
+    lua_setfield(lua_vm, -2, "volume");
+    lua_pushinteger(lua_vm, state->song_pos);
+    lua_setfield(lua_vm, -2, "song_pos");
+    lua_pushinteger(lua_vm, state->song_id);
+    lua_setfield(lua_vm, -2, "song_id");
+    lua_pushinteger(lua_vm, state->elapsed_ms);
+    lua_setfield(lua_vm, -2, "elapsed_ms");
+    lua_pushinteger(lua_vm, state->duration_ms);
+    lua_setfield(lua_vm, -2, "duration_ms");
+    lua_pushboolean(lua_vm, state->repeat);
+    lua_setfield(lua_vm, -2, "repeat");
+    lua_pushboolean(lua_vm, state->random);
+    lua_setfield(lua_vm, -2, "random");
+    return 2;
+}
@@ -16,5 +16,6 @@
 #include <lualib.h>
 
 int lua_mpc(lua_State *lua_vm);
+int lua_mpd_state(lua_State *lua_vm);
 
 #endif
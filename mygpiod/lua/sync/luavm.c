@@ -12,10 +12,15 @@
 #include "mygpiod/lua/sync/luavm.h"
 
 #include "mygpiod/lib/log.h"
+#include "mygpiod/lib/metrics.h"
+#include "mygpiod/lib/sds_extras.h"
+#include "mygpiod/lua/async/queue_msg.h"
+#include "mygpiod/lua/cache.h"
 #include "mygpiod/lua/sync/functions/gpio.h"
 #include "mygpiod/lua/sync/functions/input_ev.h"
 #include "mygpiod/lua/sync/functions/system.h"
 #include "mygpiod/lua/util.h"
+#include "mygpiod/lua/watchdog.h"
 
 #ifdef MYGPIOD_ENABLE_ACTION_MPC
     #include "mygpiod/lua/sync/functions/mpc.h"
@@ -28,6 +33,20 @@
 #include <lauxlib.h>
 #include <lua.h>
 #include <lualib.h>
+#include <string.h>
+
+// Private definitions
+
+/**
+ * Name of the cache file for the lua_file
+ */
+#define SYNC_CACHE_NAME "mygpiod_lua_file"
+
+static void register_function(struct t_config *config, const char *name, lua_CFunction func);
+static int call_in_event_loop(lua_State *lua_vm);
+static int load_file(struct t_config *config);
+
+// Public functions
 
 /**
  * Initializes the lua vm and loads the lua file with user defined functions
@@ -46,25 +65,35 @@ bool luavm_sync_init(struct t_config *config) {
     }
     // Load Lua base libraries
     luaL_openlibs(config->lua_vm);
+    // Applies the watchdog to coroutines
+    lua_watchdog_install(config->lua_vm);
     // Set config as a global
     lua_pushlightuserdata(config->lua_vm, config);
     lua_setglobal(config->lua_vm, "mygpiodConfig");
     // Register functions
-    lua_register(config->lua_vm, "gpioBlink", lua_gpio_blink);
-    lua_register(config->lua_vm, "gpioGet", lua_gpio_get);
-    lua_register(config->lua_vm, "gpioSet", lua_gpio_set);
-    lua_register(config->lua_vm, "gpioToggle", lua_gpio_toggle);
-    lua_register(config->lua_vm, "inputEvGet", lua_input_ev_get);
-    lua_register(config->lua_vm, "system", lua_system_async);
+    register_function(config, "gpioBatch", lua_gpio_batch);
+    register_function(config, "gpioBlink", lua_gpio_blink);
+    register_function(config, "gpioGet", lua_gpio_get);
+    register_function(config, "gpioSet", lua_gpio_set);
+    register_function(config, "gpioToggle", lua_gpio_toggle);
+    register_function(config, "inputEvGet", lua_input_ev_get);
+    register_function(config, "system", lua_system_async);
     #ifdef MYGPIOD_ENABLE_ACTION_MPC
-        lua_register(config->lua_vm, "mpc", lua_mpc);
+        register_function(config, "mpc", lua_mpc);
+        register_function(config, "mpdState", lua_mpd_state);
     #endif
     #ifdef MYGPIOD_ENABLE_ACTION_HTTP
-        lua_register(config->lua_vm, "mympd", lua_mympd_async);
-        lua_register(config->lua_vm, "http", lua_http_async);
+        register_function(config, "mympd", lua_mympd_async);
+        register_function(config, "http", lua_http_async);
     #endif
     // Load user defined lua file
-    int rc = luaL_dofile(config->lua_vm, config->lua_file);
+    int rc = load_file(config);
+    if (rc == LUA_OK) {
+        struct t_lua_watchdog watchdog;
+        lua_watchdog_start(config->lua_vm, &watchdog, config->lua_timeout, config->lua_instructions);
+        rc = lua_pcall(config->lua_vm, 0, LUA_MULTRET, 0);
+        lua_watchdog_stop(config->lua_vm, &watchdog);
+    }
     if (rc != 0) {
         lua_log_result(config->lua_vm, rc, config->lua_file);
         lua_close(config->lua_vm);
@@ -74,3 +103,105 @@ bool luavm_sync_init(struct t_config *config) {
     MYGPIOD_LOG_INFO("Lua initialized successfully");
     return true;
 }
+
+/**
+ * Calls the Lua function of a lua action
+ * @param config Pointer to config
+ * @param action Action struct, the first option is the function name
+ * @return true on success, else false
+ */
+bool luavm_sync_call(struct t_config *config, struct t_action *action) {
+    // Push the function on the top of the lua stack
+    int rv = lua_getglobal(config->lua_vm, action->options[0]);
+    if (rv != 6) {
+        clean_up_lua_stack(config->lua_vm);
+        MYGPIOD_LOG_ERROR("\"%s\" is not a valid Lua function", action->options[0]);
+        return false;
+    }
+    // Push the arguments on the top of the lua stack
+    for (int i = 1; i < action->options_count; i++) {
+        lua_pushstring(config->lua_vm, action->options[i]);
+    }
+    // Call the function with arguments, returning no result
+    struct t_lua_watchdog watchdog;
+    lua_watchdog_start(config->lua_vm, &watchdog, config->lua_timeout, config->lua_instructions);
+    int rc = lua_pcall(config->lua_vm, action->options_count -1, 0, 0);
+    enum lua_watchdog_reason reason = lua_watchdog_stop(config->lua_vm, &watchdog);
+    metrics_observe(&metrics.lua_duration[METRICS_LUA_SYNC], watchdog.start_us);
+    if (rc != LUA_OK) {
+        lua_log_result(config->lua_vm, rc, action->options[0]);
+        clean_up_lua_stack(config->lua_vm);
+        if (reason != LUA_WATCHDOG_OK) {
+            lua_watchdog_report_async(config->lua_vm, &watchdog, action->options[0], METRICS_LUA_SYNC);
+        }
+        return false;
+    }
+    return true;
+}
+
+// Private functions
+
+/**
+ * Registers a C function in the Lua VM.
+ * With lua_thread the function is executed through the event loop.
+ * @param config Pointer to config
+ * @param name Name of the Lua function
+ * @param func C function
+ */
+static void register_function(struct t_config *config, const char *name, lua_CFunction func) {
+    if (config->lua_thread == true) {
+        lua_pushcfunction(config->lua_vm, func);
+        lua_pushcclosure(config->lua_vm, call_in_event_loop, 1);
+        lua_setglobal(config->lua_vm, name);
+        return;
+    }
+    lua_register(config->lua_vm, name, func);
+}
+
+/**
+ * Executes the C function from the upvalue in the event loop thread
+ * @param lua_vm Lua VM
+ * @return Number of values on the stack
+ */
+static int call_in_event_loop(lua_State *lua_vm) {
+    lua_CFunction func = lua_tocfunction(lua_vm, lua_upvalueindex(1));
+    return lua_async_send_msg(lua_vm, func);
+}
+
+/**
+ * Loads the lua file from the bytecode cache or compiles it.
+ * Precompiled chunks (luac output) are loaded directly, bypassing the cache.
+ * @param config pointer to config
+ * @return Lua status code
+ */
+static int load_file(struct t_config *config) {
+    int nread;
+    sds source = sds_getfile(sdsempty(), config->lua_file, &nread);
+    if (nread < 0) {
+        FREE_SDS(source);
+        return LUA_ERRFILE;
+    }
+    size_t start = 0;
+    if (source[0] == '#') {
+        // Skip the shebang line like luaL_loadfile
+        char *eol = memchr(source, '\n', sdslen(source));
+        size_t eol_pos = eol != NULL ? (size_t)(eol - source) : sdslen(source);
+        if (eol != NULL &&
+            eol[1] == LUA_SIGNATURE[0])
+        {
+            start = eol_pos + 1;
+        }
+        else {
+            // Blank it out to keep the line numbers
+            memset(source, ' ', eol_pos);
+        }
+    }
+    sds chunk_name = sdscatfmt(sdsempty(), "@%S", config->lua_file);
+    int rc = source[start] == LUA_SIGNATURE[0]
+        ? luaL_loadbufferx(config->lua_vm, source + start, sdslen(source) - start, chunk_name, "b")
+        : lua_cache_load(config->lua_vm, config->lua_cache_dir, SYNC_CACHE_NAME,
+            source, sdslen(source), chunk_name);
+    FREE_SDS(chunk_name);
+    FREE_SDS(source);
+    return rc;
+}
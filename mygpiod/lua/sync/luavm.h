@@ -11,10 +11,12 @@
 #ifndef MYGPIOD_LUA_LUAVM_H
 #define MYGPIOD_LUA_LUAVM_H
 
+#include "mygpiod/actions/actions.h"
 #include "mygpiod/config/config.h"
 
 #include <stdbool.h>
 
 bool luavm_sync_init(struct t_config *config);
+bool luavm_sync_call(struct t_config *config, struct t_action *action);
 
 #endif
@@ -0,0 +1,151 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Dedicated thread for the lua actions
+ *
+ * With lua_thread the Lua VM of the lua_file is owned by one thread.
+ * The event loop pushes the lua actions to a single producer single
+ * consumer ring, the thread calls them in the order of the events.
+ * The registered C functions are executed in the event loop thread.
+ */
+
+#include "compile_time.h"
+#include "mygpiod/lua/sync/thread.h"
+
+#include "mygpiod/event_loop/spsc_ring.h"
+#include "mygpiod/lib/log.h"
+#include "mygpiod/lib/metrics.h"
+#include "mygpiod/lib/sds_extras.h"
+#include "mygpiod/lua/async/queue_msg.h"
+#include "mygpiod/lua/sync/luavm.h"
+
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+// Private definitions
+
+_Static_assert(LUA_SYNC_QUEUE_SIZE > 0 && (LUA_SYNC_QUEUE_SIZE & (LUA_SYNC_QUEUE_SIZE - 1)) == 0,
+    "LUA_SYNC_QUEUE_SIZE must be a power of two");
+
+/**
+ * State of the Lua thread
+ */
+struct t_lua_sync_thread {
+    struct t_config *config;   //!< Pointer to config
+    struct t_spsc_ring ring;   //!< Queued actions
+    pthread_t thread;          //!< Thread handle
+    bool started;              //!< Thread was started
+    atomic_bool stop;          //!< Thread should exit
+    atomic_bool done;          //!< Thread has exited
+};
+
+static struct t_lua_sync_thread sync_thread = {
+    .config = NULL,
+    .started = false
+};
+
+static void *thread_run(void *arg);
+
+// Public functions
+
+/**
+ * Starts the Lua thread if lua_thread is enabled
+ * @param config Pointer to config
+ * @return true on success, else false
+ */
+bool lua_sync_thread_init(struct t_config *config) {
+    if (config->lua_thread == false ||
+        config->lua_vm == NULL)
+    {
+        return true;
+    }
+    sync_thread.config = config;
+    atomic_init(&sync_thread.stop, false);
+    atomic_init(&sync_thread.done, false);
+    spsc_ring_init(&sync_thread.ring, LUA_SYNC_QUEUE_SIZE);
+    if (pthread_create(&sync_thread.thread, NULL, thread_run, NULL) != 0) {
+        MYGPIOD_LOG_ERROR("Failure creating Lua thread.");
+        spsc_ring_clear(&sync_thread.ring);
+        return false;
+    }
+    sync_thread.started = true;
+    MYGPIOD_LOG_DEBUG("Started Lua thread");
+    return true;
+}
+
+/**
+ * Stops the Lua thread and drops the queued actions.
+ * Must be called from the event loop thread, the Lua functions requested
+ * by the running action are executed while waiting.
+ */
+void lua_sync_thread_clear(void) {
+    if (sync_thread.started == false) {
+        return;
+    }
+    atomic_store_explicit(&sync_thread.stop, true, memory_order_release);
+    spsc_ring_wake(&sync_thread.ring);
+    while (atomic_load_explicit(&sync_thread.done, memory_order_acquire) == false) {
+        lua_async_handle_pending();
+        poll(NULL, 0, 1);
+    }
+    pthread_join(sync_thread.thread, NULL);
+    spsc_ring_clear(&sync_thread.ring);
+    sync_thread.started = false;
+}
+
+/**
+ * Queues a lua action for the Lua thread.
+ * Must be called from the event loop thread.
+ * @param action Action struct, must be valid until the thread is stopped
+ * @return true on success, false if the queue is full
+ */
+bool lua_sync_thread_push(struct t_action *action) {
+    if (spsc_ring_push(&sync_thread.ring, action) == false) {
+        MYGPIOD_LOG_WARN("Lua thread queue is full, dropping call of \"%s\"", action->options[0]);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Returns the number of queued lua actions
+ * @return Number of queued actions
+ */
+unsigned lua_sync_thread_depth(void) {
+    return sync_thread.started == true
+        ? spsc_ring_len(&sync_thread.ring)
+        : 0;
+}
+
+// Private functions
+
+/**
+ * Calls the queued actions until the thread is stopped.
+ * The event loop counts the action as executed when it is queued,
+ * failed calls are counted here.
+ * @param arg Not used
+ * @return NULL
+ */
+static void *thread_run(void *arg) {
+    (void)arg;
+    logline = sdsempty();
+    while (atomic_load_explicit(&sync_thread.stop, memory_order_acquire) == false) {
+        unsigned seq = spsc_ring_seq(&sync_thread.ring);
+        struct t_action *action = spsc_ring_pop(&sync_thread.ring);
+        if (action != NULL) {
+            if (luavm_sync_call(sync_thread.config, action) == false) {
+                METRICS_INC(metrics.actions_failed[action->action]);
+            }
+            continue;
+        }
+        spsc_ring_wait(&sync_thread.ring, seq);
+    }
+    FREE_SDS(logline);
+    atomic_store_explicit(&sync_thread.done, true, memory_order_release);
+    return NULL;
+}
@@ -0,0 +1,24 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Dedicated thread for the lua actions
+ */
+
+#ifndef MYGPIOD_LUA_SYNC_THREAD_H
+#define MYGPIOD_LUA_SYNC_THREAD_H
+
+#include "mygpiod/actions/actions.h"
+#include "mygpiod/config/config.h"
+
+#include <stdbool.h>
+
+bool lua_sync_thread_init(struct t_config *config);
+void lua_sync_thread_clear(void);
+bool lua_sync_thread_push(struct t_action *action);
+unsigned lua_sync_thread_depth(void);
+
+#endif
@@ -0,0 +1,291 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Instruction budget and wall-clock limit for Lua executions
+ *
+ * A count hook is called every LUA_WATCHDOG_INTERVAL instructions. It adds
+ * the interval to the instruction counter and checks the deadline. If a
+ * limit is exceeded, the hook raises an error on every following
+ * instruction, so that pcall inside the script can not catch it.
+ * Blocking C functions are not interrupted, the deadline is checked as
+ * soon as the script continues.
+ * Hooks are set per Lua thread, coroutine.resume and coroutine.wrap are
+ * replaced to apply the hook to coroutines that were created before the
+ * watchdog was started.
+ * Aborted executions are published as lua_timeout event.
+ */
+
+#include "compile_time.h"
+#include "mygpiod/lua/watchdog.h"
+
+#include "mygpiod/lib/events.h"
+#include "mygpiod/lib/log.h"
+#include "mygpiod/lua/async/queue_msg.h"
+#include "mygpiod/lua/util.h"
+
+#include <lauxlib.h>
+#include <stddef.h>
+
+// Private definitions
+
+/**
+ * Watchdog of the Lua execution in this thread
+ */
+static _Thread_local struct t_lua_watchdog *current = NULL;
+
+/**
+ * Names of the Lua VM types for the lua_timeout event
+ */
+static const char *vm_names[METRICS_LUA] = {
+    [METRICS_LUA_SYNC] = "sync",
+    [METRICS_LUA_ASYNC] = "async",
+    [METRICS_LUA_CO] = "co"
+};
+
+static void watchdog_hook(lua_State *lua_vm, lua_Debug *ar);
+static void watchdog_sethook(lua_State *thread);
+static int watchdog_co_resume(lua_State *lua_vm);
+static int watchdog_co_wrap(lua_State *lua_vm);
+static int watchdog_co_wrapped(lua_State *lua_vm);
+static int watchdog_report_main(lua_State *lua_vm);
+
+// Public functions
+
+/**
+ * Replaces coroutine.resume and coroutine.wrap of the Lua VM.
+ * The replacements set the hook of the current watchdog on the resumed coroutine.
+ * Must be called after luaL_openlibs.
+ * @param lua_vm Lua VM
+ */
+void lua_watchdog_install(lua_State *lua_vm) {
+    lua_getglobal(lua_vm, "coroutine");
+    if (lua_istable(lua_vm, -1)) {
+        lua_getfield(lua_vm, -1, "resume");
+        lua_pushcclosure(lua_vm, watchdog_co_resume, 1);
+        lua_setfield(lua_vm, -2, "resume");
+        lua_getfield(lua_vm, -1, "wrap");
+        lua_pushcclosure(lua_vm, watchdog_co_wrap, 1);
+        lua_setfield(lua_vm, -2, "wrap");
+    }
+    lua_pop(lua_vm, 1);
+}
+
+/**
+ * Starts the watchdog for a Lua execution, must be stopped in the same thread.
+ * Does nothing if both limits are 0.
+ * @param lua_vm Lua thread that executes
+ * @param watchdog Watchdog struct, must be valid until stopped
+ * @param timeout_ms Wall-clock limit in milliseconds, 0 for none
+ * @param instructions_max Instruction budget, 0 for none
+ */
+void lua_watchdog_start(lua_State *lua_vm, struct t_lua_watchdog *watchdog,
+        unsigned timeout_ms, unsigned instructions_max)
+{
+    watchdog->start_us = metrics_now_us();
+    watchdog->deadline_us = timeout_ms > 0
+        ? watchdog->start_us + ((uint64_t)timeout_ms * 1000)
+        : 0;
+    watchdog->instructions = 0;
+    watchdog->instructions_max = instructions_max;
+    watchdog->reason = LUA_WATCHDOG_OK;
+    watchdog->previous = current;
+    if (timeout_ms == 0 &&
+        instructions_max == 0)
+    {
+        return;
+    }
+    current = watchdog;
+    lua_sethook(lua_vm, watchdog_hook, LUA_MASKCOUNT, LUA_WATCHDOG_INTERVAL);
+}
+
+/**
+ * Stops the watchdog and removes the hook
+ * @param lua_vm Lua thread that was executed
+ * @param watchdog Watchdog struct
+ * @return Why the execution was aborted
+ */
+enum lua_watchdog_reason lua_watchdog_stop(lua_State *lua_vm, struct t_lua_watchdog *watchdog) {
+    if (watchdog->deadline_us == 0 &&
+        watchdog->instructions_max == 0)
+    {
+        return LUA_WATCHDOG_OK;
+    }
+    lua_sethook(lua_vm, NULL, 0, 0);
+    current = watchdog->previous;
+    return watchdog->reason;
+}
+
+/**
+ * Returns the name of the abort reason
+ * @param reason Abort reason
+ * @return Name of the reason
+ */
+const char *lua_watchdog_reason_name(enum lua_watchdog_reason reason) {
+    switch(reason) {
+        case LUA_WATCHDOG_INSTRUCTIONS:
+            return "instructions";
+        case LUA_WATCHDOG_TIMEOUT:
+            return "timeout";
+        case LUA_WATCHDOG_OK:
+            break;
+    }
+    return "";
+}
+
+/**
+ * Logs and counts an aborted Lua execution and enqueues the lua_timeout event.
+ * Must be called from the event loop thread.
+ * @param config Pointer to config
+ * @param watchdog Stopped watchdog of the aborted execution
+ * @param script Name of the Lua function or script
+ * @param vm Lua VM type
+ */
+void lua_watchdog_report(struct t_config *config, struct t_lua_watchdog *watchdog,
+        const char *script, enum metrics_lua vm)
+{
+    uint64_t duration_ms = (metrics_now_us() - watchdog->start_us) / 1000;
+    const char *reason = lua_watchdog_reason_name(watchdog->reason);
+    MYGPIOD_LOG_WARN("Lua %s \"%s\" aborted after %llu ms, %s limit exceeded",
+        vm_names[vm], script, (unsigned long long)duration_ms, reason);
+    METRICS_INC(metrics.lua_timeouts[vm]);
+    event_enqueue_lua_timeout(config, script, vm_names[vm], reason, duration_ms);
+}
+
+/**
+ * Reports an aborted Lua execution through the event loop thread.
+ * Clears the stack of the Lua VM.
+ * @param lua_vm Lua VM of the aborted execution
+ * @param watchdog Stopped watchdog of the aborted execution
+ * @param script Name of the Lua function or script
+ * @param vm Lua VM type
+ */
+void lua_watchdog_report_async(lua_State *lua_vm, struct t_lua_watchdog *watchdog,
+        const char *script, enum metrics_lua vm)
+{
+    lua_settop(lua_vm, 0);
+    lua_pushlightuserdata(lua_vm, watchdog);
+    lua_pushstring(lua_vm, script);
+    lua_pushinteger(lua_vm, vm);
+    lua_async_send_msg(lua_vm, watchdog_report_main);
+    lua_settop(lua_vm, 0);
+}
+
+// Private functions
+
+/**
+ * Count hook that enforces the limits of the current watchdog
+ * @param lua_vm Lua thread
+ * @param ar Debug information, not used
+ */
+static void watchdog_hook(lua_State *lua_vm, lua_Debug *ar) {
+    (void)ar;
+    struct t_lua_watchdog *watchdog = current;
+    if (watchdog == NULL) {
+        return;
+    }
+    if (watchdog->reason == LUA_WATCHDOG_OK) {
+        watchdog->instructions += LUA_WATCHDOG_INTERVAL;
+        if (watchdog->instructions_max > 0 &&
+            watchdog->instructions > watchdog->instructions_max)
+        {
+            watchdog->reason = LUA_WATCHDOG_INSTRUCTIONS;
+        }
+        else if (watchdog->deadline_us > 0 &&
+                 metrics_now_us() > watchdog->deadline_us)
+        {
+            watchdog->reason = LUA_WATCHDOG_TIMEOUT;
+        }
+        else {
+            return;
+        }
+        // Raise the error on each instruction until the script has ended
+        lua_sethook(lua_vm, watchdog_hook, LUA_MASKCOUNT, 1);
+    }
+    luaL_error(lua_vm, "Lua execution aborted: %s", lua_watchdog_reason_name(watchdog->reason));
+}
+
+/**
+ * Sets the hook of the current watchdog on a coroutine or removes it
+ * @param thread Lua thread of the coroutine
+ */
+static void watchdog_sethook(lua_State *thread) {
+    struct t_lua_watchdog *watchdog = current;
+    if (watchdog == NULL) {
+        lua_sethook(thread, NULL, 0, 0);
+        return;
+    }
+    lua_sethook(thread, watchdog_hook, LUA_MASKCOUNT,
+        watchdog->reason == LUA_WATCHDOG_OK ? LUA_WATCHDOG_INTERVAL : 1);
+}
+
+/**
+ * Replacement for coroutine.resume, the original function is the first upvalue
+ * @param lua_vm Lua thread
+ * @return Number of values on the stack
+ */
+static int watchdog_co_resume(lua_State *lua_vm) {
+    lua_State *thread = lua_tothread(lua_vm, 1);
+    if (thread != NULL) {
+        watchdog_sethook(thread);
+    }
+    lua_pushvalue(lua_vm, lua_upvalueindex(1));
+    lua_insert(lua_vm, 1);
+    lua_call(lua_vm, lua_gettop(lua_vm) - 1, LUA_MULTRET);
+    // Abort the caller immediately if the limit was exceeded in the coroutine
+    watchdog_sethook(lua_vm);
+    return lua_gettop(lua_vm);
+}
+
+/**
+ * Replacement for coroutine.wrap, the original function is the first upvalue
+ * @param lua_vm Lua thread
+ * @return Number of values on the stack
+ */
+static int watchdog_co_wrap(lua_State *lua_vm) {
+    lua_pushvalue(lua_vm, lua_upvalueindex(1));
+    lua_insert(lua_vm, 1);
+    lua_call(lua_vm, lua_gettop(lua_vm) - 1, 1);
+    // The wrapped function holds the coroutine as upvalue
+    if (lua_getupvalue(lua_vm, -1, 1) == NULL) {
+        lua_pushnil(lua_vm);
+    }
+    lua_pushcclosure(lua_vm, watchdog_co_wrapped, 2);
+    return 1;
+}
+
+/**
+ * Function returned by coroutine.wrap, the upvalues are the
+ * original wrapped function and the coroutine
+ * @param lua_vm Lua thread
+ * @return Number of values on the stack
+ */
+static int watchdog_co_wrapped(lua_State *lua_vm) {
+    lua_State *thread = lua_tothread(lua_vm, lua_upvalueindex(2));
+    if (thread != NULL) {
+        watchdog_sethook(thread);
+    }
+    lua_pushvalue(lua_vm, lua_upvalueindex(1));
+    lua_insert(lua_vm, 1);
+    lua_call(lua_vm, lua_gettop(lua_vm) - 1, LUA_MULTRET);
+    return lua_gettop(lua_vm);
+}
+
+/**
+ * Executed in the event loop thread for lua_watchdog_report_async
+ * @param lua_vm Lua VM of the aborted script, the worker thread waits
+ * @return Number of values on the stack
+ */
+static int watchdog_report_main(lua_State *lua_vm) {
+    struct t_config *config = get_lua_global_config(lua_vm);
+    struct t_lua_watchdog *watchdog = (struct t_lua_watchdog *)lua_touserdata(lua_vm, 1);
+    const char *script = lua_tostring(lua_vm, 2);
+    enum metrics_lua vm = (enum metrics_lua)lua_tointeger(lua_vm, 3);
+    if (config != NULL) {
+        lua_watchdog_report(config, watchdog, script, vm);
+    }
+    return 0;
+}
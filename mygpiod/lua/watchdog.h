@@ -0,0 +1,51 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Instruction budget and wall-clock limit for Lua executions
+ */
+
+#ifndef MYGPIOD_LUA_WATCHDOG_H
+#define MYGPIOD_LUA_WATCHDOG_H
+
+#include "mygpiod/config/config.h"
+#include "mygpiod/lib/metrics.h"
+
+#include <lua.h>
+#include <stdint.h>
+
+/**
+ * Why a Lua execution was aborted
+ */
+enum lua_watchdog_reason {
+    LUA_WATCHDOG_OK = 0,         //!< Not aborted
+    LUA_WATCHDOG_INSTRUCTIONS,   //!< Instruction budget exceeded
+    LUA_WATCHDOG_TIMEOUT         //!< Wall-clock limit exceeded
+};
+
+/**
+ * Limits of one Lua execution
+ */
+struct t_lua_watchdog {
+    uint64_t start_us;                   //!< Start of the execution
+    uint64_t deadline_us;                //!< Wall-clock limit, 0 for none
+    uint64_t instructions;               //!< Executed instructions, counted in steps of the hook interval
+    uint64_t instructions_max;           //!< Instruction budget, 0 for none
+    enum lua_watchdog_reason reason;     //!< Why the execution was aborted
+    struct t_lua_watchdog *previous;     //!< Watchdog of the interrupted execution in this thread
+};
+
+void lua_watchdog_install(lua_State *lua_vm);
+void lua_watchdog_start(lua_State *lua_vm, struct t_lua_watchdog *watchdog,
+        unsigned timeout_ms, unsigned instructions_max);
+enum lua_watchdog_reason lua_watchdog_stop(lua_State *lua_vm, struct t_lua_watchdog *watchdog);
+const char *lua_watchdog_reason_name(enum lua_watchdog_reason reason);
+void lua_watchdog_report(struct t_config *config, struct t_lua_watchdog *watchdog,
+        const char *script, enum metrics_lua vm);
+void lua_watchdog_report_async(lua_State *lua_vm, struct t_lua_watchdog *watchdog,
+        const char *script, enum metrics_lua vm);
+
+#endif
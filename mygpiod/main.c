@@ -13,17 +13,31 @@
 #include "mygpiod/lib/list.h"
 #include "mygpiod/lib/log.h"
 #include "mygpiod/lib/mem.h"
+#include "mygpiod/lib/metrics.h"
+#include "mygpiod/lib/process.h"
 #include "mygpiod/lib/sds_extras.h"
 #include "mygpiod/timer_ev/timer_ev.h"
 
 #ifdef MYGPIOD_ENABLE_HTTPD
+    #include "mygpiod/server_http/cmd_queue.h"
     #include "mygpiod/server_http/httpd.h"
 #endif
 #include "mygpiod/server_socket/socket.h"
 
+#ifdef MYGPIOD_ENABLE_ACTION_HTTP
+    #include "mygpiod/lib/http_multi.h"
+#endif
+#ifdef MYGPIOD_ENABLE_ACTION_MPC
+    #include "mygpiod/lib/mpd_client.h"
+#endif
 #ifdef MYGPIOD_ENABLE_ACTION_LUA
-    #include "mygpiod/event_loop/msg_queue.h"
+    #include "mygpiod/lua/async/bytecode.h"
+    #include "mygpiod/lua/async/pool.h"
+    #include "mygpiod/lua/async/queue_msg.h"
+    #include "mygpiod/lua/async/workers.h"
+    #include "mygpiod/lua/co/scheduler.h"
     #include "mygpiod/lua/sync/luavm.h"
+    #include "mygpiod/lua/sync/thread.h"
 #endif
 
 #include <poll.h>
@@ -58,11 +72,8 @@ const char *__asan_default_options(void) {
  */
 int main(int argc, char **argv) {
     // Set initial states
-    #ifdef MYGPIOD_ENABLE_ACTION_LUA
-        main_queue = NULL;
-        script_queue = NULL;
-    #endif
     int rc = EXIT_SUCCESS;
+    metrics.started_us = metrics_now_us();
     logline = sdsempty();
     log_init();
     umask(0077);  // Only owner should have rw access
@@ -120,6 +131,14 @@ int main(int argc, char **argv) {
     memset(&poll_fds, 0, sizeof(poll_fds));
     update_pollfds = true;
 
+    // fork the executor for the system actions while the daemon is small
+    if (process_init(config) == false ||
+        event_poll_fd_add(&poll_fds, process_fd(), PFD_TYPE_EXECUTOR, POLLIN | POLLPRI) == false)
+    {
+        rc = EXIT_FAILURE;
+        goto out;
+    }
+
     // open the chip, set output gpios and request input gpios
     if (gpio_init(config, &poll_fds) == false) {
         rc = EXIT_FAILURE;
@@ -144,14 +163,51 @@ int main(int argc, char **argv) {
         goto out;
     }
 
+    #ifdef MYGPIOD_ENABLE_ACTION_HTTP
+        // Must be called before any thread is created
+        if (curl_global_init(CURL_GLOBAL_ALL) != CURLE_OK ||
+            http_multi_init() == false ||
+            event_poll_fd_add(&poll_fds, http_multi_timer_fd(), PFD_TYPE_HTTP_CLIENT_TIMER, POLLIN | POLLPRI) == false)
+        {
+            rc = EXIT_FAILURE;
+            goto out;
+        }
+    #endif
+
+    #ifdef MYGPIOD_ENABLE_ACTION_MPC
+        config->mpd_client = mpd_client_new(config);
+        if (config->mpd_client == NULL ||
+            event_poll_fd_add(&poll_fds, config->mpd_client->timer_fd, PFD_TYPE_MPD_CLIENT_TIMER, POLLIN | POLLPRI) == false)
+        {
+            rc = EXIT_FAILURE;
+            goto out;
+        }
+        if (config->mpd_state == true) {
+            mpd_client_subscribe(config->mpd_client);
+        }
+    #endif
+
     #ifdef MYGPIOD_ENABLE_ACTION_LUA
-        if (luavm_sync_init(config) == false) {
+        // The request queue must be created before the Lua VMs
+        if (lua_async_queue_init() == false ||
+            event_poll_fd_add(&poll_fds, lua_async_queue_fd(), PFD_TYPE_LUA_ASYNC, POLLIN | POLLPRI) == false)
+        {
+            rc = EXIT_FAILURE;
+            goto out;
+        }
+        lua_async_bytecode_init(config);
+        if (luavm_sync_init(config) == false ||
+            lua_sync_thread_init(config) == false ||
+            lua_async_pool_init(config) == false ||
+            lua_async_workers_init(config) == false)
+        {
             rc = EXIT_FAILURE;
             goto out;
         }
-        main_queue = mygpiod_queue_create("main", true);
-        script_queue = mygpiod_queue_create("lua_async", false);
-        if (event_poll_fd_add(&poll_fds, main_queue->event_fd, PFD_TYPE_LUA_ASYNC, POLLIN | POLLPRI) == false) {
+        if (lua_co_init(config) == false ||
+            (lua_co_timer_fd() > -1 &&
+             event_poll_fd_add(&poll_fds, lua_co_timer_fd(), PFD_TYPE_LUA_CO_TIMER, POLLIN | POLLPRI) == false))
+        {
             rc = EXIT_FAILURE;
             goto out;
         }
@@ -168,6 +224,20 @@ int main(int argc, char **argv) {
         goto out;
     }
 
+    // create tcp server socket
+    if (config->tcp_port > 0) {
+        int server_tcp_fd = server_socket_tcp_create(config);
+        if (server_tcp_fd == -1) {
+            rc = EXIT_FAILURE;
+            goto out;
+        }
+        if (event_poll_fd_add(&poll_fds, server_tcp_fd, PFD_TYPE_CONNECT_TCP, POLLIN | POLLPRI) == false) {
+            close_fd(&server_tcp_fd);
+            rc = EXIT_FAILURE;
+            goto out;
+        }
+    }
+
     #ifdef MYGPIOD_ENABLE_HTTPD
         // create http server
         if (config->http_port > 0) {
@@ -177,15 +247,24 @@ int main(int argc, char **argv) {
                 rc = EXIT_FAILURE;
                 goto out;
             }
-            const union MHD_DaemonInfo *httpd_fd = MHD_get_daemon_info(config->httpd, MHD_DAEMON_INFO_EPOLL_FD);
-            if (httpd_fd == NULL ||
-                httpd_fd->epoll_fd == -1)
-            {
-                MYGPIOD_LOG_EMERG("Failure getting MHD epoll fd.");
-                rc = EXIT_FAILURE;
-                goto out;
+            if (config->http_threads > 0) {
+                // MHD runs in its own threads and sends commands to the event loop
+                if (event_poll_fd_add(&poll_fds, config->http_cmd_queue->event_fd, PFD_TYPE_HTTPD_CMD, POLLIN | POLLPRI) == false) {
+                    rc = EXIT_FAILURE;
+                    goto out;
+                }
+            }
+            else {
+                const union MHD_DaemonInfo *httpd_fd = MHD_get_daemon_info(config->httpd, MHD_DAEMON_INFO_EPOLL_FD);
+                if (httpd_fd == NULL ||
+                    httpd_fd->epoll_fd == -1)
+                {
+                    MYGPIOD_LOG_EMERG("Failure getting MHD epoll fd.");
+                    rc = EXIT_FAILURE;
+                    goto out;
+                }
+                event_poll_fd_add(&poll_fds, httpd_fd->epoll_fd, PFD_TYPE_HTTPD, POLLIN | POLLOUT | POLLPRI);
             }
-            event_poll_fd_add(&poll_fds, httpd_fd->epoll_fd, PFD_TYPE_HTTPD, POLLIN | POLLOUT | POLLPRI);
         }
     #endif
 
@@ -202,6 +281,15 @@ int main(int argc, char **argv) {
             event_add_gpio_in_timer_fds(config, &poll_fds);
             event_add_gpio_out_timer_fds(config, &poll_fds);
             event_add_client_fds(config, &poll_fds);
+            #ifdef MYGPIOD_ENABLE_HTTPD
+                event_add_websocket_fds(config, &poll_fds);
+            #endif
+            #ifdef MYGPIOD_ENABLE_ACTION_HTTP
+                event_add_http_client_fds(&poll_fds);
+            #endif
+            #ifdef MYGPIOD_ENABLE_ACTION_MPC
+                event_add_mpd_client_fds(config, &poll_fds);
+            #endif
             update_pollfds = false;
         }
 
@@ -210,12 +298,11 @@ int main(int argc, char **argv) {
         #ifdef MYGPIOD_ENABLE_HTTPD
             // Use timeout from MHD
             // This is required for MHD connection suspend and resume
-            int timeout;
+            int timeout = -1;
             MHD_UNSIGNED_LONG_LONG to;
-            if (MHD_get_timeout (config->httpd, &to) != MHD_YES) {
-                timeout = -1;
-            }
-            else {
+            if (config->http_threads == 0 &&
+                MHD_get_timeout (config->httpd, &to) == MHD_YES)
+            {
                 timeout = (to < INT_MAX - 1) ? (int) to : (INT_MAX - 1);
             }
         #else
@@ -227,9 +314,12 @@ int main(int argc, char **argv) {
             rc = EXIT_FAILURE;
             goto out;
         }
+        METRICS_INC(metrics.poll_wakeups);
         #ifdef MYGPIOD_ENABLE_HTTPD
             // MHD must be always called, even on poll timeout
-            if (MHD_run(config->httpd) != MHD_YES) {
+            if (config->http_threads == 0 &&
+                MHD_run(config->httpd) != MHD_YES)
+            {
                 MYGPIOD_LOG_ERROR("Failure running MHD");
                 rc = EXIT_FAILURE;
                 goto out;
@@ -247,17 +337,29 @@ int main(int argc, char **argv) {
     }
 
 out:
+    #ifdef MYGPIOD_ENABLE_ACTION_LUA
+        // Executes pending Lua requests, HTTP must not be stopped before
+        lua_sync_thread_clear();
+    #endif
+    #ifdef MYGPIOD_ENABLE_ACTION_HTTP
+        http_multi_clear();
+    #endif
+    process_clear();
+    #ifdef MYGPIOD_ENABLE_ACTION_LUA
+        lua_async_workers_clear();
+        // HTTP requests must be stopped before
+        lua_co_clear();
+    #endif
     if (config != NULL) {
         config_clear(config);
         FREE_PTR(config);
     }
     #ifdef MYGPIOD_ENABLE_ACTION_LUA
-        if (main_queue != NULL) {
-            mygpiod_queue_free(main_queue);
-        }
-        if (script_queue != NULL) {
-            mygpiod_queue_free(script_queue);
-        }
+        lua_async_pool_clear();
+        lua_async_queue_clear();
+    #endif
+    #ifdef MYGPIOD_ENABLE_ACTION_HTTP
+        curl_global_cleanup();
     #endif
     if (rc == EXIT_SUCCESS) {
         MYGPIOD_LOG_INFO("Exiting gracefully, thank you for using myGPIOd");
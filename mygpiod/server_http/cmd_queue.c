@@ -0,0 +1,117 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Commands from the HTTP threads to the event loop
+ *
+ * If MHD runs in its own threads, all access to the config is done
+ * through this queue. The HTTP threads never block on the event loop.
+ */
+
+#include "compile_time.h"
+#include "mygpiod/server_http/cmd_queue.h"
+
+#include "mygpiod/event_loop/eventfd_wrap.h"
+#include "mygpiod/lib/log.h"
+#include "mygpiod/lib/mem.h"
+
+#include <stddef.h>
+
+// private definitions
+
+/**
+ * A queued command
+ */
+struct t_http_cmd {
+    struct t_mpsc_node node;       //!< Queue node, must be the first member
+    http_cmd_callback callback;    //!< Function to execute
+    void *data;                    //!< Data for the callback
+    http_cmd_data_free data_free;  //!< Frees the data if the command is discarded, can be NULL
+};
+
+// public functions
+
+/**
+ * Creates the command queue
+ * @return Allocated queue or NULL on error
+ */
+struct t_http_cmd_queue *http_cmd_queue_new(void) {
+    int fd = event_eventfd_create();
+    if (fd == -1) {
+        return NULL;
+    }
+    struct t_http_cmd_queue *cmd_queue = malloc_assert(sizeof(struct t_http_cmd_queue));
+    mpsc_queue_init(&cmd_queue->queue);
+    cmd_queue->event_fd = fd;
+    return cmd_queue;
+}
+
+/**
+ * Discards all pending commands and frees the queue.
+ * The HTTP threads must be stopped.
+ * @param cmd_queue Queue to free
+ */
+void http_cmd_queue_free(struct t_http_cmd_queue *cmd_queue) {
+    http_cmd_discard(cmd_queue);
+    event_fd_close(cmd_queue->event_fd);
+    FREE_PTR(cmd_queue);
+}
+
+/**
+ * Discards all pending commands, must be called from the event loop thread
+ * @param cmd_queue Queue to discard the commands from
+ */
+void http_cmd_discard(struct t_http_cmd_queue *cmd_queue) {
+    struct t_mpsc_node *node;
+    while ((node = mpsc_queue_pop(&cmd_queue->queue)) != NULL) {
+        struct t_http_cmd *cmd = (struct t_http_cmd *)node;
+        if (cmd->data_free != NULL) {
+            cmd->data_free(cmd->data);
+        }
+        FREE_PTR(cmd);
+    }
+}
+
+/**
+ * Queues a command for the event loop thread, can be called from any thread
+ * @param config Pointer to config
+ * @param callback Function to execute
+ * @param data Data for the callback
+ * @param data_free Frees the data if the command is discarded, can be NULL
+ */
+void http_cmd_push(struct t_config *config, http_cmd_callback callback, void *data, http_cmd_data_free data_free) {
+    struct t_http_cmd *cmd = malloc_assert(sizeof(struct t_http_cmd));
+    cmd->callback = callback;
+    cmd->data = data;
+    cmd->data_free = data_free;
+    mpsc_queue_push(&config->http_cmd_queue->queue, &cmd->node);
+    event_eventfd_write(config->http_cmd_queue->event_fd);
+}
+
+/**
+ * Executes all queued commands
+ * @param config Pointer to config
+ * @param fd Pointer to the eventfd
+ * @return true on success, else false
+ */
+bool http_cmd_handle(struct t_config *config, int *fd) {
+    if (event_eventfd_read(*fd) == false) {
+        return false;
+    }
+    struct t_mpsc_queue *queue = &config->http_cmd_queue->queue;
+    struct t_mpsc_node *node;
+    while ((node = mpsc_queue_pop(queue)) != NULL) {
+        struct t_http_cmd *cmd = (struct t_http_cmd *)node;
+        cmd->callback(config, cmd->data);
+        FREE_PTR(cmd);
+    }
+    if (mpsc_queue_is_empty(queue) == false) {
+        // A push is in progress, poll again
+        MYGPIOD_LOG_DEBUG("HTTP command queue: push in progress");
+        event_eventfd_write(*fd);
+    }
+    return true;
+}
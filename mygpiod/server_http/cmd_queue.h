@@ -0,0 +1,41 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Commands from the HTTP threads to the event loop
+ */
+
+#ifndef MYGPIOD_SERVER_HTTP_CMD_QUEUE_H
+#define MYGPIOD_SERVER_HTTP_CMD_QUEUE_H
+
+#include "mygpiod/config/config.h"
+#include "mygpiod/event_loop/mpsc_queue.h"
+
+/**
+ * Callback that is executed in the event loop thread
+ */
+typedef void (*http_cmd_callback)(struct t_config *config, void *data);
+
+/**
+ * Function to free the command data if the command is discarded
+ */
+typedef void (*http_cmd_data_free)(void *data);
+
+/**
+ * Queue with its wakeup fd
+ */
+struct t_http_cmd_queue {
+    struct t_mpsc_queue queue;  //!< Lock-free queue of struct t_http_cmd
+    int event_fd;               //!< Eventfd polled by the event loop
+};
+
+struct t_http_cmd_queue *http_cmd_queue_new(void);
+void http_cmd_queue_free(struct t_http_cmd_queue *cmd_queue);
+void http_cmd_discard(struct t_http_cmd_queue *cmd_queue);
+void http_cmd_push(struct t_config *config, http_cmd_callback callback, void *data, http_cmd_data_free data_free);
+bool http_cmd_handle(struct t_config *config, int *fd);
+
+#endif
@@ -20,14 +20,12 @@
 
 /**
  * Handler for REST API Requests
- * @param connection HTTP connection
- * @param http_conn_id HTTP connection id
+ * @param request_data User data from a MHD connection
  * @param url URL
  * @param config Pointer to config
  * @return enum MHD_Result 
  */
-enum MHD_Result hook_handler(struct MHD_Connection *connection,
-                                 unsigned http_conn_id,
+enum MHD_Result hook_handler(struct t_request_data *request_data,
                                  const char *url,
                                  struct t_config *config)
 {
@@ -41,7 +39,7 @@ enum MHD_Result hook_handler(struct MHD_Connection *connection,
     }
     else {
         // Request was not handled
-        MYGPIOD_LOG_ERROR("HTTP connection %u: Invalid hook: %s", http_conn_id, url);
+        MYGPIOD_LOG_ERROR("HTTP connection %u: Invalid hook: %s", request_data->conn_id, url);
         rc = false;
         buffer = sdscat(buffer,"{\"error\":\"Invalid hook\"}");
     }
@@ -51,7 +49,5 @@ enum MHD_Result hook_handler(struct MHD_Connection *connection,
         : MHD_HTTP_OK;
     struct MHD_Response *response = MHD_create_response_from_buffer_with_free_callback(sdslen(buffer), (void *)buffer, http_response_free);
     MHD_add_response_header(response, "Content-Type", "application/json");
-    enum MHD_Result result = MHD_queue_response(connection, http_response_code, response);
-    MHD_destroy_response(response);
-    return result;
+    return http_queue_response(request_data, http_response_code, response);
 }
@@ -12,11 +12,11 @@
 #define MYGPIOD_SERVER_HTTPD_HOOK_H
 
 #include "mygpiod/config/config.h"
+#include "mygpiod/server_http/util.h"
 
 #include <microhttpd.h>
 
-enum MHD_Result hook_handler(struct MHD_Connection *connection,
-                             unsigned http_conn_id,
+enum MHD_Result hook_handler(struct t_request_data *request_data,
                              const char *url,
                              struct t_config *config);
 
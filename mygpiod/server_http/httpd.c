@@ -14,16 +14,27 @@
 #include "mygpiod/lib/log.h"
 #include "mygpiod/lib/mem.h"
 #include "mygpiod/lib/sds_extras.h"
+#include "mygpiod/server_http/cmd_queue.h"
 #include "mygpiod/server_http/hook.h"
+#include "mygpiod/server_http/prometheus.h"
 #include "mygpiod/server_http/rest_api.h"
+#include "mygpiod/server_http/sse.h"
 #include "mygpiod/server_http/util.h"
 #include "mygpiod/server_http/webui.h"
+#include "mygpiod/server_http/websocket.h"
 
 #include <arpa/inet.h>
 #include <microhttpd.h>
 #include <netinet/in.h>
+#include <stdatomic.h>
 #include <string.h>
 
+// private definitions
+
+static enum MHD_Result request_dispatch(struct t_config *config, struct t_request_data *request_data);
+static bool request_in_event_loop(const char *url);
+static void request_deferred(struct t_config *config, void *data);
+
 /**
  * Central HTTP Request Handler
  * @param cls User data
@@ -46,30 +57,65 @@ static enum MHD_Result request_handler(void *cls,
                                        void **con_cls)
 {
     (void)version;
-    (void)upload_data;
     struct t_config *config = (struct t_config *)cls;
 
     // The first call is with headers only, do not respond,
     // but allocate connection specific user data
     if (*con_cls == NULL) {
-        config->http_conn_id++;
         struct t_request_data *request_data = malloc_assert(sizeof(struct t_request_data));
         request_data->connection = connection;
         request_data->resume_buffer = NULL;
-        request_data->conn_id = config->http_conn_id;
+        request_data->body = NULL;
+        request_data->body_too_large = false;
+        request_data->conn_id = atomic_fetch_add(&config->http_conn_id, 1) + 1;
+        request_data->url = url;
+        request_data->method = http_parse_method(method_str);
+        request_data->deferred = false;
+        request_data->response = NULL;
+        request_data->status_code = 0;
+        request_data->no_timeout = false;
         *con_cls = request_data;
         MYGPIOD_LOG_DEBUG("HTTP connection %u: Headers received for %s %s", request_data->conn_id, method_str, url);
         return MHD_YES;
     }
     struct t_request_data *request_data = (struct t_request_data *)*con_cls;
 
-    // Ignoring post data
+    // Accumulate the request body
     if (*upload_data_size) {
-        MYGPIOD_LOG_DEBUG("HTTP connection %u: Ignoring POST data for %s %s (%lu bytes)",
-                request_data->conn_id, method_str, url, (unsigned long)upload_data_size);
+        MYGPIOD_LOG_DEBUG("HTTP connection %u: Received %lu bytes of body data for %s %s",
+                request_data->conn_id, (unsigned long)*upload_data_size, method_str, url);
+        if (request_data->body == NULL) {
+            request_data->body = sdsempty();
+        }
+        if (request_data->body_too_large == false &&
+            sdslen(request_data->body) + *upload_data_size <= HTTP_BODY_MAX)
+        {
+            request_data->body = sdscatlen(request_data->body, upload_data, *upload_data_size);
+        }
+        else {
+            // Discard the remaining data and respond after the upload is complete
+            request_data->body_too_large = true;
+        }
         *upload_data_size = 0;
         return MHD_YES;
     }
+    if (request_data->body_too_large == true) {
+        MYGPIOD_LOG_ERROR("HTTP connection %u: Request body too large for %s %s", request_data->conn_id, method_str, url);
+        return http_respond(request_data, MHD_HTTP_CONTENT_TOO_LARGE, "text/plain; charset=utf-8", "413 Content Too Large");
+    }
+
+    // Resumed connection, the event loop thread has created the response
+    if (request_data->response != NULL) {
+        MYGPIOD_LOG_DEBUG("HTTP connection %u: Sending deferred response for %s %s", request_data->conn_id, method_str, url);
+        if (request_data->no_timeout == true) {
+            MHD_set_connection_option(connection, MHD_CONNECTION_OPTION_TIMEOUT, 0);
+        }
+        struct MHD_Response *response = request_data->response;
+        request_data->response = NULL;
+        enum MHD_Result result = MHD_queue_response(connection, request_data->status_code, response);
+        MHD_destroy_response(response);
+        return result;
+    }
 
     // Resumed connection
     if (request_data->resume_buffer != NULL) {
@@ -83,40 +129,110 @@ static enum MHD_Result request_handler(void *cls,
     }
 
     // Second call - process the request
-    enum http_method method = http_parse_method(method_str);
     // Restrict allowed HTTP methods
-    switch(method) {
+    switch(request_data->method) {
         case HTTP_GET:
         case HTTP_OPTIONS:
         case HTTP_PATCH:
             break;
         default: {
-            return http_respond(connection, 405, "text/plain; charset=utf-8", "405 Method Not Allowed");
+            return http_respond(request_data, 405, "text/plain; charset=utf-8", "405 Method Not Allowed");
         }
     }
 
     MYGPIOD_LOG_DEBUG("HTTP connection %u: %s %s", request_data->conn_id, method_str, url);
+    // Hand over requests that access the config to the event loop thread
+    if (config->http_threads > 0 &&
+        request_in_event_loop(url) == true)
+    {
+        MYGPIOD_LOG_DEBUG("HTTP connection %u: Deferring %s %s to the event loop", request_data->conn_id, method_str, url);
+        request_data->deferred = true;
+        MHD_suspend_connection(connection);
+        http_cmd_push(config, request_deferred, request_data, NULL);
+        return MHD_YES;
+    }
+    return request_dispatch(config, request_data);
+}
+
+/**
+ * Calls the handler for the request url
+ * @param config Pointer to config
+ * @param request_data User data from a MHD connection
+ * @return enum MHD_Result
+ */
+static enum MHD_Result request_dispatch(struct t_config *config, struct t_request_data *request_data) {
+    const char *url = request_data->url;
+    const char *method_str = http_lookup_method(request_data->method);
     // REST-API
     if (strncmp(url, "/api/v1/", 8) == 0) {
         MYGPIOD_LOG_DEBUG("HTTP connection %u: Calling REST-API handler for %s %s", request_data->conn_id, method_str, url);
-        return rest_api_handler(connection, request_data->conn_id, url, method, config);
+        return rest_api_handler(request_data, url, request_data->method, request_data->body, config);
     }
     // Long polling: Suspend connection until an GPIO event occurs
     if (strcmp(url, "/poll") == 0) {
         MYGPIOD_LOG_DEBUG("HTTP connection %u: Suspending connection for %s %s", request_data->conn_id, method_str, url);
-        MHD_set_connection_option(connection, MHD_CONNECTION_OPTION_TIMEOUT, 0);
-        MHD_suspend_connection(connection);
+        http_connection_disable_timeout(request_data);
+        http_connection_suspend(request_data);
         list_push(&config->http_suspended, 0, request_data);
         return MHD_YES;
     }
+    // Server-sent events: Stream all events over a persistent connection
+    if (strcmp(url, "/events") == 0) {
+        MYGPIOD_LOG_DEBUG("HTTP connection %u: Calling SSE handler for %s %s", request_data->conn_id, method_str, url);
+        return sse_handler(request_data, config);
+    }
+    // WebSocket: Bidirectional command and event channel
+    if (strcmp(url, "/ws") == 0) {
+        MYGPIOD_LOG_DEBUG("HTTP connection %u: Calling WebSocket handler for %s %s", request_data->conn_id, method_str, url);
+        return websocket_handler(request_data, config);
+    }
+    // Prometheus metrics
+    if (strcmp(url, "/metrics") == 0) {
+        MYGPIOD_LOG_DEBUG("HTTP connection %u: Calling metrics handler for %s %s", request_data->conn_id, method_str, url);
+        return prometheus_handler(request_data, config);
+    }
     // Hooks
     if (strncmp(url, "/hook/", 6) == 0) {
         MYGPIOD_LOG_DEBUG("HTTP connection %u: Calling hook handler for %s %s", request_data->conn_id, method_str, url);
-        return hook_handler(connection, request_data->conn_id, url, config);
+        return hook_handler(request_data, url, config);
     }
     // Serve embedded files
     MYGPIOD_LOG_DEBUG("HTTP connection %u: Serve embedded files for %s %s", request_data->conn_id, method_str, url);
-    return webui_handler(connection, url);
+    return webui_handler(request_data, url);
+}
+
+/**
+ * Checks if the request must be handled in the event loop thread.
+ * Only the embedded files are served directly by the HTTP threads.
+ * @param url URL
+ * @return true if the handler accesses the config, else false
+ */
+static bool request_in_event_loop(const char *url) {
+    return strncmp(url, "/api/", 5) == 0 ||
+        strncmp(url, "/hook/", 6) == 0 ||
+        strcmp(url, "/poll") == 0 ||
+        strcmp(url, "/events") == 0 ||
+        strcmp(url, "/ws") == 0 ||
+        strcmp(url, "/metrics") == 0;
+}
+
+/**
+ * Handles a deferred request in the event loop thread.
+ * The connection is resumed as soon as a response was created,
+ * long polling connections stay suspended until the next event.
+ * @param config Pointer to config
+ * @param data User data from a MHD connection
+ */
+static void request_deferred(struct t_config *config, void *data) {
+    struct t_request_data *request_data = (struct t_request_data *)data;
+    if (request_dispatch(config, request_data) == MHD_NO &&
+        request_data->response == NULL)
+    {
+        http_respond(request_data, MHD_HTTP_INTERNAL_SERVER_ERROR, "text/plain; charset=utf-8", "500 Internal Server Error");
+    }
+    if (request_data->response != NULL) {
+        MHD_resume_connection(request_data->connection);
+    }
 }
 
 /**
@@ -139,12 +255,29 @@ static void error_log(void *arg, const char *fmt, va_list ap) {
  */
 struct MHD_Daemon *httpd_start(struct t_config *config) {
     MYGPIOD_LOG_INFO("HTTP: Listening on %s:%u", config->http_ip, config->http_port);
-    unsigned mhd_flags = MHD_USE_EPOLL | \
-                         MHD_USE_ERROR_LOG | \
+    unsigned mhd_flags = MHD_USE_ERROR_LOG | \
                          MHD_USE_PEDANTIC_CHECKS | \
                          MHD_USE_TCP_FASTOPEN | \
-                         MHD_ALLOW_SUSPEND_RESUME;
-    
+                         MHD_ALLOW_SUSPEND_RESUME | \
+                         MHD_ALLOW_UPGRADE;
+    if (config->http_threads > 0) {
+        // MHD runs in its own threads, all config access is done through the command queue
+        MYGPIOD_LOG_INFO("HTTP: Using %u threads", config->http_threads);
+        config->http_cmd_queue = http_cmd_queue_new();
+        if (config->http_cmd_queue == NULL) {
+            return NULL;
+        }
+        mhd_flags |= MHD_USE_EPOLL_INTERNAL_THREAD;
+    }
+    else {
+        // MHD is called from the event loop
+        mhd_flags |= MHD_USE_EPOLL;
+    }
+    // A pool size of 1 is the same as a single internal thread
+    unsigned thread_pool_size = config->http_threads > 1
+        ? config->http_threads
+        : 0;
+
     struct sockaddr_in server_addr;
     server_addr.sin_family = AF_INET;
     server_addr.sin_port = htons((uint16_t)config->http_port);  // Convert port number to network byte order
@@ -159,5 +292,7 @@ struct MHD_Daemon *httpd_start(struct t_config *config) {
                             MHD_OPTION_EXTERNAL_LOGGER, &error_log, NULL,
                             MHD_OPTION_SOCK_ADDR, &server_addr,
                             MHD_OPTION_NOTIFY_COMPLETED, &http_connection_done, NULL,
+                            MHD_OPTION_NOTIFY_CONNECTION, &http_socket_notify, NULL,
+                            MHD_OPTION_THREAD_POOL_SIZE, thread_pool_size,
                             MHD_OPTION_END);
 }
@@ -0,0 +1,274 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief HTTP server Prometheus metrics in the text exposition format
+ */
+
+#include "compile_time.h"
+#include "mygpiod/server_http/prometheus.h"
+
+#include "mygpiod/config/gpio.h"
+#include "mygpiod/lib/mem.h"
+#include "mygpiod/lib/metrics.h"
+#include "mygpiod/lib/sds_extras.h"
+#ifdef MYGPIOD_ENABLE_ACTION_LUA
+    #include "mygpiod/lua/async/workers.h"
+    #include "mygpiod/lua/co/scheduler.h"
+    #include "mygpiod/lua/sync/thread.h"
+#endif
+#include "mygpiod/raspberry/vcgencmd.h"
+#include "mygpiod/server_socket/socket.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// private definitions
+
+/**
+ * Videocore device, vcio metrics are only rendered if it exists
+ */
+#define VCIO_DEVICE "/dev/vcio"
+
+static sds print_header(sds buffer, const char *name, const char *type, const char *help);
+static sds print_histogram(sds buffer, const char *name, const char *labels,
+        struct t_metrics_histogram *histogram);
+static sds print_clients(sds buffer, struct t_config *config);
+static sds print_vcio(sds buffer);
+
+// public functions
+
+/**
+ * Handler for GET /metrics
+ * @param request_data User data from a MHD connection
+ * @param config Pointer to config
+ * @return enum MHD_Result
+ */
+enum MHD_Result prometheus_handler(struct t_request_data *request_data,
+                                   struct t_config *config)
+{
+    struct t_socket_data *socket_data = http_get_socket_data(request_data->connection);
+    sds buffer = socket_data->buffer;
+
+    // GPIOs
+    buffer = print_header(buffer, "mygpiod_gpio_edges_total", "counter", "Edge events per input GPIO");
+    struct t_list_node *current = config->gpios_in.head;
+    while (current != NULL) {
+        struct t_gpio_in_data *data = (struct t_gpio_in_data *)current->data;
+        buffer = sdscatfmt(buffer, "mygpiod_gpio_edges_total{gpio=\"%u\"} %U\n", current->id, (unsigned long long)data->edges);
+        current = current->next;
+    }
+
+    // Actions
+    buffer = print_header(buffer, "mygpiod_actions_executed_total", "counter", "Executed actions per type");
+    for (int i = 0; i < METRICS_ACTIONS; i++) {
+        buffer = sdscatfmt(buffer, "mygpiod_actions_executed_total{action=\"%s\"} %U\n", lookup_action(i),
+            (unsigned long long)atomic_load_explicit(&metrics.actions_executed[i], memory_order_relaxed));
+    }
+    buffer = print_header(buffer, "mygpiod_actions_failed_total", "counter", "Failed actions per type");
+    for (int i = 0; i < METRICS_ACTIONS; i++) {
+        buffer = sdscatfmt(buffer, "mygpiod_actions_failed_total{action=\"%s\"} %U\n", lookup_action(i),
+            (unsigned long long)atomic_load_explicit(&metrics.actions_failed[i], memory_order_relaxed));
+    }
+
+    // Event loop
+    buffer = print_header(buffer, "mygpiod_poll_wakeups_total", "counter", "Returns from poll in the event loop");
+    buffer = sdscatfmt(buffer, "mygpiod_poll_wakeups_total %U\n",
+        (unsigned long long)atomic_load_explicit(&metrics.poll_wakeups, memory_order_relaxed));
+    buffer = print_header(buffer, "mygpiod_timer_fires_total", "counter", "Expired timers per type");
+    const char *timer_names[METRICS_TIMERS] = { "gpio_in", "gpio_out", "timer_ev" };
+    for (unsigned i = 0; i < METRICS_TIMERS; i++) {
+        buffer = sdscatfmt(buffer, "mygpiod_timer_fires_total{type=\"%s\"} %U\n", timer_names[i],
+            (unsigned long long)atomic_load_explicit(&metrics.timer_fires[i], memory_order_relaxed));
+    }
+
+    // Clients
+    buffer = print_clients(buffer, config);
+
+    // Durations
+    buffer = print_header(buffer, "mygpiod_lua_duration_seconds", "histogram", "Duration of Lua executions per VM type");
+    buffer = print_histogram(buffer, "mygpiod_lua_duration_seconds", "vm=\"sync\",", &metrics.lua_duration[METRICS_LUA_SYNC]);
+    buffer = print_histogram(buffer, "mygpiod_lua_duration_seconds", "vm=\"async\",", &metrics.lua_duration[METRICS_LUA_ASYNC]);
+    buffer = print_histogram(buffer, "mygpiod_lua_duration_seconds", "vm=\"co\",", &metrics.lua_duration[METRICS_LUA_CO]);
+    buffer = print_header(buffer, "mygpiod_lua_async_start_seconds", "histogram", "Time from the trigger to the start of async Lua scripts");
+    buffer = print_histogram(buffer, "mygpiod_lua_async_start_seconds", "", &metrics.lua_async_start);
+    #ifdef MYGPIOD_ENABLE_ACTION_LUA
+        buffer = print_header(buffer, "mygpiod_lua_sync_queue_depth", "gauge", "Queued lua actions for the Lua thread");
+        buffer = sdscatfmt(buffer, "mygpiod_lua_sync_queue_depth %u\n", lua_sync_thread_depth());
+        buffer = print_header(buffer, "mygpiod_lua_async_queue_depth", "gauge", "Queued async Lua scripts");
+        buffer = sdscatfmt(buffer, "mygpiod_lua_async_queue_depth %u\n", lua_async_workers_depth());
+        buffer = print_header(buffer, "mygpiod_lua_async_dropped_total", "counter", "Dropped async Lua scripts");
+        buffer = sdscatfmt(buffer, "mygpiod_lua_async_dropped_total{reason=\"full\"} %U\n",
+            (unsigned long long)atomic_load_explicit(&metrics.lua_async_dropped, memory_order_relaxed));
+        buffer = sdscatfmt(buffer, "mygpiod_lua_async_dropped_total{reason=\"coalesced\"} %U\n",
+            (unsigned long long)atomic_load_explicit(&metrics.lua_async_coalesced, memory_order_relaxed));
+        buffer = print_header(buffer, "mygpiod_lua_timeouts_total", "counter", "Lua executions aborted by the watchdog");
+        buffer = sdscatfmt(buffer, "mygpiod_lua_timeouts_total{vm=\"sync\"} %U\n",
+            (unsigned long long)atomic_load_explicit(&metrics.lua_timeouts[METRICS_LUA_SYNC], memory_order_relaxed));
+        buffer = sdscatfmt(buffer, "mygpiod_lua_timeouts_total{vm=\"async\"} %U\n",
+            (unsigned long long)atomic_load_explicit(&metrics.lua_timeouts[METRICS_LUA_ASYNC], memory_order_relaxed));
+        buffer = sdscatfmt(buffer, "mygpiod_lua_timeouts_total{vm=\"co\"} %U\n",
+            (unsigned long long)atomic_load_explicit(&metrics.lua_timeouts[METRICS_LUA_CO], memory_order_relaxed));
+        buffer = print_header(buffer, "mygpiod_lua_co_running", "gauge", "Running Lua coroutines");
+        buffer = sdscatfmt(buffer, "mygpiod_lua_co_running %u\n", lua_co_running());
+    #endif
+    buffer = print_header(buffer, "mygpiod_http_client_duration_seconds", "histogram", "Latency of HTTP calls from actions");
+    buffer = print_histogram(buffer, "mygpiod_http_client_duration_seconds", "", &metrics.http_client_duration);
+
+    // Raspberry Pi
+    buffer = print_vcio(buffer);
+
+    // The buffer is owned by the socket data and reused for the next request
+    socket_data->buffer = buffer;
+    struct MHD_Response *response = MHD_create_response_from_buffer(sdslen(buffer), (void *)buffer, MHD_RESPMEM_PERSISTENT);
+    MHD_add_response_header(response, "Content-Type", "text/plain; version=0.0.4; charset=utf-8");
+    return http_queue_response(request_data, MHD_HTTP_OK, response);
+}
+
+// private functions
+
+/**
+ * Prints the HELP and TYPE lines of a metric
+ * @param buffer Already allocated buffer to append
+ * @param name Metric name
+ * @param type Metric type
+ * @param help Description
+ * @return Pointer to buffer
+ */
+static sds print_header(sds buffer, const char *name, const char *type, const char *help) {
+    return sdscatfmt(buffer, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+/**
+ * Prints a histogram with cumulative buckets
+ * @param buffer Already allocated buffer to append
+ * @param name Metric name
+ * @param labels Additional labels, each followed by a comma
+ * @param histogram Histogram to print
+ * @return Pointer to buffer
+ */
+static sds print_histogram(sds buffer, const char *name, const char *labels,
+        struct t_metrics_histogram *histogram)
+{
+    // Read the count first, the +Inf bucket must not be smaller than the others
+    uint64_t count = atomic_load_explicit(&histogram->count, memory_order_relaxed);
+    uint64_t sum_us = atomic_load_explicit(&histogram->sum_us, memory_order_relaxed);
+    uint64_t cumulative = 0;
+    for (unsigned i = 0; i < METRICS_BUCKETS; i++) {
+        cumulative += atomic_load_explicit(&histogram->buckets[i], memory_order_relaxed);
+        if (cumulative > count) {
+            cumulative = count;
+        }
+        buffer = sdscatfmt(buffer, "%s_bucket{%sle=\"%s\"} %U\n", name, labels, metrics_bucket_labels[i],
+            (unsigned long long)cumulative);
+    }
+    buffer = sdscatfmt(buffer, "%s_bucket{%sle=\"+Inf\"} %U\n", name, labels, (unsigned long long)count);
+    size_t labels_len = strlen(labels);
+    if (labels_len > 0) {
+        // Strip the trailing comma
+        buffer = sdscatfmt(buffer, "%s_sum{", name);
+        buffer = sdscatlen(buffer, labels, labels_len - 1);
+        buffer = sdscatprintf(buffer, "} %.6f\n", (double)sum_us / 1000000);
+        buffer = sdscatfmt(buffer, "%s_count{", name);
+        buffer = sdscatlen(buffer, labels, labels_len - 1);
+        buffer = sdscatfmt(buffer, "} %U\n", (unsigned long long)count);
+    }
+    else {
+        buffer = sdscatprintf(buffer, "%s_sum %.6f\n", name, (double)sum_us / 1000000);
+        buffer = sdscatfmt(buffer, "%s_count %U\n", name, (unsigned long long)count);
+    }
+    return buffer;
+}
+
+/**
+ * Prints the client gauges
+ * @param buffer Already allocated buffer to append
+ * @param config Pointer to config
+ * @return Pointer to buffer
+ */
+static sds print_clients(sds buffer, struct t_config *config) {
+    buffer = print_header(buffer, "mygpiod_clients", "gauge", "Connected clients per type");
+    buffer = sdscatfmt(buffer, "mygpiod_clients{type=\"socket\"} %u\n", config->clients.length);
+    buffer = sdscatfmt(buffer, "mygpiod_clients{type=\"websocket\"} %u\n", config->ws_clients.length);
+    buffer = sdscatfmt(buffer, "mygpiod_clients{type=\"sse\"} %u\n", config->sse_clients.length);
+    buffer = sdscatfmt(buffer, "mygpiod_clients{type=\"longpoll\"} %u\n", config->http_suspended.length);
+
+    buffer = print_header(buffer, "mygpiod_client_queue_depth", "gauge", "Waiting events per socket client");
+    struct t_list_node *current = config->clients.head;
+    while (current != NULL) {
+        struct t_client_data *data = (struct t_client_data *)current->data;
+        buffer = sdscatfmt(buffer, "mygpiod_client_queue_depth{client=\"%u\"} %u\n", current->id, data->waiting_events.length);
+        current = current->next;
+    }
+    buffer = print_header(buffer, "mygpiod_client_events_dropped_total", "counter", "Dropped events per socket client");
+    current = config->clients.head;
+    while (current != NULL) {
+        struct t_client_data *data = (struct t_client_data *)current->data;
+        buffer = sdscatfmt(buffer, "mygpiod_client_events_dropped_total{client=\"%u\"} %u\n", current->id, data->events_dropped);
+        current = current->next;
+    }
+    buffer = print_header(buffer, "mygpiod_events_dropped_total", "counter", "Events dropped for slow socket clients");
+    buffer = sdscatfmt(buffer, "mygpiod_events_dropped_total %U\n",
+        (unsigned long long)atomic_load_explicit(&metrics.events_dropped, memory_order_relaxed));
+    return buffer;
+}
+
+/**
+ * Prints the Raspberry Pi videocore readings
+ * @param buffer Already allocated buffer to append
+ * @return Pointer to buffer
+ */
+static sds print_vcio(sds buffer) {
+    if (access(VCIO_DEVICE, F_OK) != 0) {
+        // Not a Raspberry Pi
+        return buffer;
+    }
+    const char *commands[] = {
+        "measure_temp",
+        "measure_volts core",
+        "measure_clock arm",
+        "get_throttled",
+        NULL
+    };
+    const char *names[] = {
+        "mygpiod_vcio_temperature_celsius",
+        "mygpiod_vcio_core_volts",
+        "mygpiod_vcio_arm_clock_hertz",
+        "mygpiod_vcio_throttled",
+        NULL
+    };
+    const char *helps[] = {
+        "SoC temperature",
+        "Core voltage",
+        "ARM clock frequency",
+        "Throttled state bitmask",
+        NULL
+    };
+    sds result = sdsempty();
+    for (unsigned i = 0; commands[i] != NULL; i++) {
+        bool rc;
+        sdsclear(result);
+        result = vcgencmd(commands[i], result, &rc);
+        // Format is name=value, e.g. temp=45.2'C or throttled=0x0
+        const char *value = strchr(result, '=');
+        if (rc == false ||
+            value == NULL)
+        {
+            continue;
+        }
+        value++;
+        buffer = print_header(buffer, names[i], "gauge", helps[i]);
+        if (strcmp(commands[i], "get_throttled") == 0) {
+            buffer = sdscatfmt(buffer, "%s %U\n", names[i], (unsigned long long)strtoull(value, NULL, 0));
+        }
+        else {
+            buffer = sdscatprintf(buffer, "%s %g\n", names[i], strtod(value, NULL));
+        }
+    }
+    FREE_SDS(result);
+    return buffer;
+}
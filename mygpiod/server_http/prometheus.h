@@ -0,0 +1,22 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief HTTP server Prometheus metrics
+ */
+
+#ifndef MYGPIOD_SERVER_HTTPD_PROMETHEUS_H
+#define MYGPIOD_SERVER_HTTPD_PROMETHEUS_H
+
+#include "mygpiod/config/config.h"
+#include "mygpiod/server_http/util.h"
+
+#include <microhttpd.h>
+
+enum MHD_Result prometheus_handler(struct t_request_data *request_data,
+                                   struct t_config *config);
+
+#endif
@@ -12,116 +12,179 @@
 #include "mygpiod/server_http/rest_api.h"
 
 #include "dist/sds/sds.h"
-#include "mygpio-common/util.h"
 #include "mygpiod/lib/log.h"
-#include "mygpiod/lib/sds_extras.h"
 #include "mygpiod/server_http/rest_api_gpio.h"
+#ifdef MYGPIOD_ENABLE_ACTION_MPC
+    #include "mygpiod/server_http/rest_api_mpd.h"
+#endif
 #include "mygpiod/server_http/rest_api_raspberry.h"
+#include "mygpiod/server_http/rest_api_stats.h"
 #include "mygpiod/server_http/rest_api_timerev.h"
 
 #include <microhttpd.h>
+#include <stdint.h>
 #include <string.h>
 
+// private definitions
+
 /**
- * Parses REST API request url
- * @param url URL
- * @param pattern Pattern to match 
- * @param gpio Pointer to GPIO variable to populate
- * @return true on success, else false
+ * Maximum number of path parameters
  */
-static bool match_url_gpio(const char *url,
-                           const char *pattern,
-                           unsigned *gpio)
-{
-    size_t pattern_len = strlen(pattern);
-    // Match prefix
-    size_t i = 0;
-    for (; i < pattern_len; i++) {
-        if (pattern[i] == '*') {
-            break;
-        }
-        if (pattern[i] != url[i]) {
-            return false;
-        }
-    }
-    // Catch gpio number
-    sds match = sdsempty();
-    size_t j = i;
-    for (; url[j] != '\0' && url[j] != '/'; j++) {
-        match = sds_catchar(match, url[j]);
-    }
-    if (mygpio_parse_uint(match, gpio, NULL, 1, GPIOS_MAX) == false) {
-        FREE_SDS(match);
-        return false;
-    }
-    FREE_SDS(match);
-    // Match suffix
-    i++;
-    for (; i < pattern_len; i++, j++) {
-        if (pattern[i] != url[j]) {
-            return false;
-        }
-    }
-    return true;
-}
+#define ROUTE_PARAMS_MAX 2
+
+/**
+ * Number of supported HTTP methods
+ */
+#define ROUTE_METHODS (HTTP_PATCH + 1)
+
+/**
+ * Parsed REST API request
+ */
+struct t_rest_api_request {
+    struct MHD_Connection *connection;  //!< HTTP connection
+    struct t_config *config;            //!< Pointer to config
+    const char *body;                   //!< Request body or NULL
+    unsigned params[ROUTE_PARAMS_MAX];  //!< Numeric path parameters
+    unsigned params_count;              //!< Number of path parameters
+};
+
+/**
+ * Route handler callback
+ */
+typedef sds (*rest_api_route_handler)(struct t_rest_api_request *request, sds buffer, bool *rc);
+
+/**
+ * Route segment types
+ */
+enum route_segment_types {
+    ROUTE_LITERAL = 0,  //!< Literal path segment
+    ROUTE_PARAM_GPIO    //!< GPIO number path parameter
+};
+
+/**
+ * Node of the route trie
+ */
+struct t_route_node {
+    const char *segment;                               //!< Path segment for literal nodes
+    enum route_segment_types type;                     //!< Segment type
+    const struct t_route_node *children;               //!< Child nodes
+    size_t children_count;                             //!< Number of child nodes
+    rest_api_route_handler handlers[ROUTE_METHODS];    //!< Handlers by HTTP method
+};
+
+/**
+ * Macro to set the children of a route node
+ */
+#define ROUTE_CHILDREN(CHILDREN) CHILDREN, (sizeof(CHILDREN) / sizeof(CHILDREN[0]))
+
+/**
+ * Macro for a route node without children
+ */
+#define ROUTE_LEAF NULL, 0
+
+static sds route_gpio_list(struct t_rest_api_request *request, sds buffer, bool *rc);
+static sds route_gpio_patch(struct t_rest_api_request *request, sds buffer, bool *rc);
+static sds route_gpio_get(struct t_rest_api_request *request, sds buffer, bool *rc);
+static sds route_gpio_options(struct t_rest_api_request *request, sds buffer, bool *rc);
+static sds route_gpio_blink(struct t_rest_api_request *request, sds buffer, bool *rc);
+static sds route_gpio_set(struct t_rest_api_request *request, sds buffer, bool *rc);
+static sds route_gpio_toggle(struct t_rest_api_request *request, sds buffer, bool *rc);
+static sds route_vcio_all(struct t_rest_api_request *request, sds buffer, bool *rc);
+static sds route_vcio_temp(struct t_rest_api_request *request, sds buffer, bool *rc);
+static sds route_vcio_volts(struct t_rest_api_request *request, sds buffer, bool *rc);
+static sds route_vcio_clock(struct t_rest_api_request *request, sds buffer, bool *rc);
+static sds route_vcio_throttled(struct t_rest_api_request *request, sds buffer, bool *rc);
+static sds route_timerev_list(struct t_rest_api_request *request, sds buffer, bool *rc);
+static sds route_stats(struct t_rest_api_request *request, sds buffer, bool *rc);
+#ifdef MYGPIOD_ENABLE_ACTION_MPC
+    static sds route_mpd(struct t_rest_api_request *request, sds buffer, bool *rc);
+#endif
+
+/**
+ * Routes for /api/v1/gpio/{gpio}/
+ */
+static const struct t_route_node routes_gpio_nr[] = {
+    { "blink", ROUTE_LITERAL, ROUTE_LEAF, { [HTTP_PATCH] = route_gpio_blink } },
+    { "set", ROUTE_LITERAL, ROUTE_LEAF, { [HTTP_PATCH] = route_gpio_set } },
+    { "toggle", ROUTE_LITERAL, ROUTE_LEAF, { [HTTP_PATCH] = route_gpio_toggle } }
+};
+
+/**
+ * Routes for /api/v1/gpio/
+ */
+static const struct t_route_node routes_gpio[] = {
+    { NULL, ROUTE_PARAM_GPIO, ROUTE_CHILDREN(routes_gpio_nr), { [HTTP_GET] = route_gpio_get, [HTTP_OPTIONS] = route_gpio_options } }
+};
+
+/**
+ * Routes for /api/v1/vcio/
+ */
+static const struct t_route_node routes_vcio[] = {
+    { "clock", ROUTE_LITERAL, ROUTE_LEAF, { [HTTP_GET] = route_vcio_clock } },
+    { "temp", ROUTE_LITERAL, ROUTE_LEAF, { [HTTP_GET] = route_vcio_temp } },
+    { "throttled", ROUTE_LITERAL, ROUTE_LEAF, { [HTTP_GET] = route_vcio_throttled } },
+    { "volts", ROUTE_LITERAL, ROUTE_LEAF, { [HTTP_GET] = route_vcio_volts } }
+};
+
+/**
+ * Routes for /api/v1/
+ */
+static const struct t_route_node routes_api_v1[] = {
+    { "gpio", ROUTE_LITERAL, ROUTE_CHILDREN(routes_gpio), { [HTTP_GET] = route_gpio_list, [HTTP_PATCH] = route_gpio_patch } },
+    #ifdef MYGPIOD_ENABLE_ACTION_MPC
+        { "mpd", ROUTE_LITERAL, ROUTE_LEAF, { [HTTP_GET] = route_mpd } },
+    #endif
+    { "stats", ROUTE_LITERAL, ROUTE_LEAF, { [HTTP_GET] = route_stats } },
+    { "timerev", ROUTE_LITERAL, ROUTE_LEAF, { [HTTP_GET] = route_timerev_list } },
+    { "vcio", ROUTE_LITERAL, ROUTE_CHILDREN(routes_vcio), { [HTTP_GET] = route_vcio_all } }
+};
+
+/**
+ * Root of the route trie
+ */
+static const struct t_route_node route_root = {
+    NULL, ROUTE_LITERAL, ROUTE_CHILDREN(routes_api_v1), { NULL }
+};
+
+static rest_api_route_handler route_lookup(const char *path, enum http_method method,
+        struct t_rest_api_request *request);
+static bool parse_segment_uint(const char *segment, size_t len, unsigned min, unsigned max, unsigned *result);
+
+// public functions
 
 /**
  * Handler for REST API Requests
- * @param connection HTTP connection
- * @param http_conn_id HTTP connection id
+ * @param request_data User data from a MHD connection
  * @param url URL
  * @param method HTTP method
+ * @param body Request body or NULL if not set
  * @param config Pointer to config
  * @return enum MHD_Result 
  */
-enum MHD_Result rest_api_handler(struct MHD_Connection *connection,
-                                 unsigned http_conn_id,
+enum MHD_Result rest_api_handler(struct t_request_data *request_data,
                                  const char *url,
                                  enum http_method method,
+                                 const char *body,
                                  struct t_config *config)
 {
-    sds buffer = sdsempty();
+    struct MHD_Connection *connection = request_data->connection;
+    struct t_socket_data *socket_data = http_get_socket_data(connection);
+    sds buffer = socket_data->buffer;
     bool rc = false;
-    unsigned gpio_nr = UINT_MAX;
-    if (method == HTTP_GET && strcmp(url, "/api/v1/gpio") == 0) {
-        buffer = rest_api_gpio_get(config, buffer, &rc);
-    }
-    else if (method == HTTP_GET && match_url_gpio(url, "/api/v1/gpio/*", &gpio_nr)) {
-        buffer = rest_api_gpio_gpio_get(config, buffer, gpio_nr, &rc);
-    }
-    else if (method == HTTP_OPTIONS && match_url_gpio(url, "/api/v1/gpio/*", &gpio_nr)) {
-        buffer = rest_api_gpio_gpio_options(config, buffer, gpio_nr, &rc);
-    }
-    else if (method == HTTP_PATCH && match_url_gpio(url, "/api/v1/gpio/*/blink", &gpio_nr)) {
-        buffer = rest_api_gpio_gpio_blink(config, buffer, gpio_nr, connection, &rc);
-    }
-    else if (method == HTTP_PATCH && match_url_gpio(url, "/api/v1/gpio/*/set", &gpio_nr)) {
-        buffer = rest_api_gpio_gpio_set(config, buffer, gpio_nr, connection, &rc);
-    }
-    else if (method == HTTP_PATCH && match_url_gpio(url, "/api/v1/gpio/*/toggle", &gpio_nr)) {
-        buffer = rest_api_gpio_gpio_toggle(config, buffer, gpio_nr, &rc);
-    }
-    else if (method == HTTP_GET && strcmp(url, "/api/v1/vcio") == 0) {
-        buffer = rest_api_raspberry_vcio_all(buffer, &rc);
-    }
-    else if (method == HTTP_GET && strcmp(url, "/api/v1/vcio/temp") == 0) {
-        buffer = rest_api_raspberry_vcio(buffer, "measure_temp", &rc);
-    }
-    else if (method == HTTP_GET && strcmp(url, "/api/v1/vcio/volts") == 0) {
-        buffer = rest_api_raspberry_vcio(buffer, "measure_volts core", &rc);
-    }
-    else if (method == HTTP_GET && strcmp(url, "/api/v1/vcio/clock") == 0) {
-        buffer = rest_api_raspberry_vcio(buffer, "measure_clock arm", &rc);
-    }
-    else if (method == HTTP_GET && strcmp(url, "/api/v1/vcio/throttled") == 0) {
-        buffer = rest_api_raspberry_vcio(buffer, "get_throttled", &rc);
-    }
-    else if (method == HTTP_GET && strcmp(url, "/api/v1/timerev") == 0) {
-        buffer = rest_api_timerev_list(config, buffer, &rc);
+    struct t_rest_api_request request = {
+        .connection = connection,
+        .config = config,
+        .body = body,
+        .params_count = 0
+    };
+    // The caller has already matched the /api/v1/ prefix
+    rest_api_route_handler handler = route_lookup(url + 8, method, &request);
+    if (handler != NULL) {
+        buffer = handler(&request, buffer, &rc);
     }
     else {
         // Request was not handled
-        MYGPIOD_LOG_ERROR("HTTP connection %u: Invalid API request: %s %s", http_conn_id, http_lookup_method(method), url);
+        MYGPIOD_LOG_ERROR("HTTP connection %u: Invalid API request: %s %s", request_data->conn_id, http_lookup_method(method), url);
         rc = false;
         buffer = sdscat(buffer,"{\"error\":\"Invalid API request\"}");
     }
@@ -129,9 +192,282 @@ enum MHD_Result rest_api_handler(struct MHD_Connection *connection,
     unsigned http_response_code = rc == false
         ? MHD_HTTP_INTERNAL_SERVER_ERROR
         : MHD_HTTP_OK;
-    struct MHD_Response *response = MHD_create_response_from_buffer_with_free_callback(sdslen(buffer), (void *)buffer, http_response_free);
+    // The buffer is owned by the socket data and reused for the next request
+    socket_data->buffer = buffer;
+    struct MHD_Response *response = MHD_create_response_from_buffer(sdslen(buffer), (void *)buffer, MHD_RESPMEM_PERSISTENT);
     MHD_add_response_header(response, "Content-Type", "application/json");
-    enum MHD_Result result = MHD_queue_response(connection, http_response_code, response);
-    MHD_destroy_response(response);
-    return result;
+    return http_queue_response(request_data, http_response_code, response);
+}
+
+// private functions
+
+/**
+ * Walks the route trie segment by segment.
+ * Literal segments take precedence over parameters.
+ * @param path URL path after the /api/v1/ prefix
+ * @param method HTTP method
+ * @param request Request struct to populate with the path parameters
+ * @return The route handler or NULL if no route matches
+ */
+static rest_api_route_handler route_lookup(const char *path, enum http_method method,
+        struct t_rest_api_request *request)
+{
+    if (method == HTTP_UNKNOWN) {
+        return NULL;
+    }
+    const struct t_route_node *node = &route_root;
+    while (*path != '\0') {
+        const char *end = strchr(path, '/');
+        size_t len = end == NULL
+            ? strlen(path)
+            : (size_t)(end - path);
+        const struct t_route_node *next = NULL;
+        const struct t_route_node *param = NULL;
+        for (size_t i = 0; i < node->children_count; i++) {
+            const struct t_route_node *child = &node->children[i];
+            if (child->type == ROUTE_LITERAL) {
+                if (strncmp(child->segment, path, len) == 0 &&
+                    child->segment[len] == '\0')
+                {
+                    next = child;
+                    break;
+                }
+            }
+            else {
+                param = child;
+            }
+        }
+        if (next == NULL) {
+            if (param == NULL ||
+                request->params_count == ROUTE_PARAMS_MAX ||
+                parse_segment_uint(path, len, 1, GPIOS_MAX, &request->params[request->params_count]) == false)
+            {
+                return NULL;
+            }
+            request->params_count++;
+            next = param;
+        }
+        node = next;
+        if (end == NULL) {
+            break;
+        }
+        path = end + 1;
+        if (*path == '\0') {
+            // Trailing slash
+            return NULL;
+        }
+    }
+    return node->handlers[method];
+}
+
+/**
+ * Parses a numeric path segment without copying it
+ * @param segment Start of the path segment
+ * @param len Length of the path segment
+ * @param min Minimum value
+ * @param max Maximum value
+ * @param result Pointer to unsigned to set the parsed value
+ * @return true on success, else false
+ */
+static bool parse_segment_uint(const char *segment, size_t len, unsigned min, unsigned max, unsigned *result) {
+    if (len == 0 ||
+        len > 10)
+    {
+        return false;
+    }
+    uint64_t value = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (segment[i] < '0' ||
+            segment[i] > '9')
+        {
+            return false;
+        }
+        value = value * 10 + (uint64_t)(segment[i] - '0');
+    }
+    if (value < min ||
+        value > max)
+    {
+        return false;
+    }
+    *result = (unsigned)value;
+    return true;
+}
+
+/**
+ * Route handler for GET /api/v1/gpio
+ * @param request Parsed request
+ * @param buffer Already allocated buffer to populate with the response
+ * @param rc Pointer to bool to set the result code
+ * @return Pointer to buffer
+ */
+static sds route_gpio_list(struct t_rest_api_request *request, sds buffer, bool *rc) {
+    return rest_api_gpio_get(request->config, buffer,
+        MHD_lookup_connection_value(request->connection, MHD_GET_ARGUMENT_KIND, "gpios"),
+        rc);
+}
+
+/**
+ * Route handler for PATCH /api/v1/gpio
+ * @param request Parsed request
+ * @param buffer Already allocated buffer to populate with the response
+ * @param rc Pointer to bool to set the result code
+ * @return Pointer to buffer
+ */
+static sds route_gpio_patch(struct t_rest_api_request *request, sds buffer, bool *rc) {
+    return rest_api_gpio_patch(request->config, buffer, request->body, rc);
+}
+
+/**
+ * Route handler for GET /api/v1/gpio/{gpio}
+ * @param request Parsed request
+ * @param buffer Already allocated buffer to populate with the response
+ * @param rc Pointer to bool to set the result code
+ * @return Pointer to buffer
+ */
+static sds route_gpio_get(struct t_rest_api_request *request, sds buffer, bool *rc) {
+    return rest_api_gpio_gpio_get(request->config, buffer, request->params[0], rc);
+}
+
+/**
+ * Route handler for OPTIONS /api/v1/gpio/{gpio}
+ * @param request Parsed request
+ * @param buffer Already allocated buffer to populate with the response
+ * @param rc Pointer to bool to set the result code
+ * @return Pointer to buffer
+ */
+static sds route_gpio_options(struct t_rest_api_request *request, sds buffer, bool *rc) {
+    return rest_api_gpio_gpio_options(request->config, buffer, request->params[0], rc);
+}
+
+/**
+ * Route handler for PATCH /api/v1/gpio/{gpio}/blink
+ * @param request Parsed request
+ * @param buffer Already allocated buffer to populate with the response
+ * @param rc Pointer to bool to set the result code
+ * @return Pointer to buffer
+ */
+static sds route_gpio_blink(struct t_rest_api_request *request, sds buffer, bool *rc) {
+    return rest_api_gpio_gpio_blink(request->config, buffer, request->params[0],
+        MHD_lookup_connection_value(request->connection, MHD_GET_ARGUMENT_KIND, "timeout"),
+        MHD_lookup_connection_value(request->connection, MHD_GET_ARGUMENT_KIND, "interval"),
+        rc);
+}
+
+/**
+ * Route handler for PATCH /api/v1/gpio/{gpio}/set
+ * @param request Parsed request
+ * @param buffer Already allocated buffer to populate with the response
+ * @param rc Pointer to bool to set the result code
+ * @return Pointer to buffer
+ */
+static sds route_gpio_set(struct t_rest_api_request *request, sds buffer, bool *rc) {
+    return rest_api_gpio_gpio_set(request->config, buffer, request->params[0],
+        MHD_lookup_connection_value(request->connection, MHD_GET_ARGUMENT_KIND, "value"),
+        rc);
+}
+
+/**
+ * Route handler for PATCH /api/v1/gpio/{gpio}/toggle
+ * @param request Parsed request
+ * @param buffer Already allocated buffer to populate with the response
+ * @param rc Pointer to bool to set the result code
+ * @return Pointer to buffer
+ */
+static sds route_gpio_toggle(struct t_rest_api_request *request, sds buffer, bool *rc) {
+    return rest_api_gpio_gpio_toggle(request->config, buffer, request->params[0], rc);
+}
+
+/**
+ * Route handler for GET /api/v1/vcio
+ * @param request Parsed request
+ * @param buffer Already allocated buffer to populate with the response
+ * @param rc Pointer to bool to set the result code
+ * @return Pointer to buffer
+ */
+static sds route_vcio_all(struct t_rest_api_request *request, sds buffer, bool *rc) {
+    (void)request;
+    return rest_api_raspberry_vcio_all(buffer, rc);
+}
+
+/**
+ * Route handler for GET /api/v1/vcio/temp
+ * @param request Parsed request
+ * @param buffer Already allocated buffer to populate with the response
+ * @param rc Pointer to bool to set the result code
+ * @return Pointer to buffer
+ */
+static sds route_vcio_temp(struct t_rest_api_request *request, sds buffer, bool *rc) {
+    (void)request;
+    return rest_api_raspberry_vcio(buffer, "measure_temp", rc);
+}
+
+/**
+ * Route handler for GET /api/v1/vcio/volts
+ * @param request Parsed request
+ * @param buffer Already allocated buffer to populate with the response
+ * @param rc Pointer to bool to set the result code
+ * @return Pointer to buffer
+ */
+static sds route_vcio_volts(struct t_rest_api_request *request, sds buffer, bool *rc) {
+    (void)request;
+    return rest_api_raspberry_vcio(buffer, "measure_volts core", rc);
+}
+
+/**
+ * Route handler for GET /api/v1/vcio/clock
+ * @param request Parsed request
+ * @param buffer Already allocated buffer to populate with the response
+ * @param rc Pointer to bool to set the result code
+ * @return Pointer to buffer
+ */
+static sds route_vcio_clock(struct t_rest_api_request *request, sds buffer, bool *rc) {
+    (void)request;
+    return rest_api_raspberry_vcio(buffer, "measure_clock arm", rc);
+}
+
+/**
+ * Route handler for GET /api/v1/vcio/throttled
+ * @param request Parsed request
+ * @param buffer Already allocated buffer to populate with the response
+ * @param rc Pointer to bool to set the result code
+ * @return Pointer to buffer
+ */
+static sds route_vcio_throttled(struct t_rest_api_request *request, sds buffer, bool *rc) {
+    (void)request;
+    return rest_api_raspberry_vcio(buffer, "get_throttled", rc);
+}
+
+/**
+ * Route handler for GET /api/v1/timerev
+ * @param request Parsed request
+ * @param buffer Already allocated buffer to populate with the response
+ * @param rc Pointer to bool to set the result code
+ * @return Pointer to buffer
+ */
+static sds route_timerev_list(struct t_rest_api_request *request, sds buffer, bool *rc) {
+    return rest_api_timerev_list(request->config, buffer, rc);
+}
+
+/**
+ * Route handler for GET /api/v1/stats
+ * @param request Parsed request
+ * @param buffer Already allocated buffer to populate with the response
+ * @param rc Pointer to bool to set the result code
+ * @return Pointer to buffer
+ */
+static sds route_stats(struct t_rest_api_request *request, sds buffer, bool *rc) {
+    return rest_api_stats(request->config, buffer, rc);
+}
+
+#ifdef MYGPIOD_ENABLE_ACTION_MPC
+/**
+ * Route handler for GET /api/v1/mpd
+ * @param request Parsed request
+ * @param buffer Already allocated buffer to populate with the response
+ * @param rc Pointer to bool to set the result code
+ * @return Pointer to buffer
+ */
+static sds route_mpd(struct t_rest_api_request *request, sds buffer, bool *rc) {
+    return rest_api_mpd(request->config, buffer, rc);
 }
+#endif
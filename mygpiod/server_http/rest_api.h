@@ -16,10 +16,10 @@
 
 #include <microhttpd.h>
 
-enum MHD_Result rest_api_handler(struct MHD_Connection *connection,
-                                 unsigned http_conn_id,
+enum MHD_Result rest_api_handler(struct t_request_data *request_data,
                                  const char *url,
                                  enum http_method method,
+                                 const char *body,
                                  struct t_config *config);
 
 #endif
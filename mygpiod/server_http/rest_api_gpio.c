@@ -16,60 +16,181 @@
 #include "mygpiod/gpio/gpio.h"
 #include "mygpiod/gpio/output.h"
 #include "mygpiod/gpio/util.h"
-#include "mygpiod/lib/json_print.h"
+#include "mygpiod/lib/json_parse.h"
+#include "mygpiod/lib/json_writer.h"
+#include "mygpiod/lib/list.h"
+#include "mygpiod/lib/mem.h"
 
 #include <errno.h>
 #include <stdlib.h>
+#include <string.h>
+
+// private definitions
+
+/**
+ * Expected length of a json object for a gpio
+ */
+#define JSON_GPIO_ENTRY_LEN 96
+
+static void print_gpio_in(struct t_json_writer *w, unsigned gpio_nr, struct t_gpio_in_data *data);
+static void print_gpio_out(struct t_json_writer *w, unsigned gpio_nr, struct t_gpio_out_data *data);
+static sds gpio_patch_operation(struct t_config *config, sds buffer, struct t_json_object *op, bool *rc);
+static void patch_op_clear(struct t_list_node *node);
+
+// public functions
 
 /**
  * Handles the REST API request for GET /api/v1/gpio
  * @param config pointer to config
  * @param buffer already allocated buffer to populate with the response
+ * @param gpios comma separated list of gpio numbers or NULL for all gpios
  * @param rc pointer to bool to set the result code
  * @return sds pointer to buffer
  */
 sds rest_api_gpio_get(struct t_config *config,
                       sds buffer,
+                      const char *gpios,
                       bool *rc)
 {
-    buffer = sdscat(buffer, "{\"data\":[");
+    size_t buffer_len = sdslen(buffer);
+    struct t_json_writer w;
+    json_writer_init(&w, buffer, (config->gpios_in.length + config->gpios_out.length) * JSON_GPIO_ENTRY_LEN + 32);
+    json_writer_object_begin(&w);
+    json_writer_key(&w, "data");
+    json_writer_array_begin(&w);
     unsigned i = 0;
-    struct t_list_node *current = config->gpios_in.head;
-    while (current != NULL) {
-        struct t_gpio_in_data *data = (struct t_gpio_in_data *)current->data;
-        if (i++) {
-            buffer = sdscatlen(buffer, ",", 1);
+    if (gpios != NULL) {
+        const char *p = gpios;
+        while (*p != '\0') {
+            unsigned gpio_nr;
+            char *rest;
+            if (i == GPIOS_MAX ||
+                mygpio_parse_uint(p, &gpio_nr, &rest, 1, GPIOS_MAX) == false ||
+                (*rest != ',' && *rest != '\0'))
+            {
+                buffer = json_writer_finish(&w);
+                sdssubstr(buffer, 0, buffer_len);
+                *rc = false;
+                return sdscat(buffer, "{\"error\":\"Invalid GPIO list\"}");
+            }
+            struct t_list_node *node = list_node_by_id(&config->gpios_in, gpio_nr);
+            if (node != NULL) {
+                print_gpio_in(&w, gpio_nr, (struct t_gpio_in_data *)node->data);
+            }
+            else if ((node = list_node_by_id(&config->gpios_out, gpio_nr)) != NULL) {
+                print_gpio_out(&w, gpio_nr, (struct t_gpio_out_data *)node->data);
+            }
+            else {
+                buffer = json_writer_finish(&w);
+                sdssubstr(buffer, 0, buffer_len);
+                *rc = false;
+                return sdscatfmt(buffer, "{\"error\":\"GPIO %u not configured\"}", gpio_nr);
+            }
+            i++;
+            p = *rest == ',' ? rest + 1 : rest;
         }
-        buffer = sdscatlen(buffer, "{", 1);
-        buffer = sdscatfmt(buffer, "\"gpio\":%u,", current->id);
-        buffer = sdscat(buffer, "\"name\":");
-        buffer = sds_catjson(buffer, data->name);
-        buffer = sdscatlen(buffer, ",", 1);
-        buffer = sdscat(buffer, "\"direction\":\"in\",");
-        buffer = sdscat(buffer, "\"value\":");
-        buffer = sds_catjson(buffer, lookup_gpio_value(gpio_get_value(config, current->id)));
-        buffer = sdscatlen(buffer, "}", 1);
-        current = current->next;
     }
-    current = config->gpios_out.head;
+    else {
+        struct t_list_node *current = config->gpios_in.head;
+        while (current != NULL) {
+            print_gpio_in(&w, current->id, (struct t_gpio_in_data *)current->data);
+            i++;
+            current = current->next;
+        }
+        current = config->gpios_out.head;
+        while (current != NULL) {
+            print_gpio_out(&w, current->id, (struct t_gpio_out_data *)current->data);
+            i++;
+            current = current->next;
+        }
+    }
+    json_writer_array_end(&w);
+    json_writer_kv_uint(&w, "entries", i);
+    json_writer_object_end(&w);
+    *rc = true;
+    return json_writer_finish(&w);
+}
+
+/**
+ * Handles the REST API request for PATCH /api/v1/gpio.
+ * The body is a json array of operations, e.g.
+ * [{"gpio":5,"action":"set","value":"active"},{"gpio":6,"action":"toggle"}]
+ * The body is parsed completely before the operations are executed,
+ * nothing is executed if it is invalid. The result of each operation is returned.
+ * @param config pointer to config
+ * @param buffer already allocated buffer to populate with the response
+ * @param body request body or NULL if not set
+ * @param rc pointer to bool to set the result code, false if any operation failed
+ * @return sds pointer to buffer
+ */
+sds rest_api_gpio_patch(struct t_config *config,
+                        sds buffer,
+                        const char *body,
+                        bool *rc)
+{
+    const char *p = body == NULL
+        ? NULL
+        : json_skip_ws(body);
+    if (p == NULL ||
+        *p != '[')
+    {
+        *rc = false;
+        return sdscat(buffer, "{\"error\":\"Expected a json array of operations\"}");
+    }
+    // Parse all operations first, a malformed body changes nothing
+    struct t_list ops;
+    list_init(&ops);
+    p = json_skip_ws(p + 1);
+    while (*p != ']') {
+        struct t_json_object *op = malloc_assert(sizeof(struct t_json_object));
+        op->count = 0;
+        list_push(&ops, 0, op);
+        p = ops.length <= GPIOS_MAX
+            ? json_parse_object(p, op)
+            : NULL;
+        if (p != NULL) {
+            p = json_skip_ws(p);
+            if (*p == ',') {
+                p = json_skip_ws(p + 1);
+                if (*p == ']') {
+                    p = NULL;
+                }
+            }
+            else if (*p != ']') {
+                p = NULL;
+            }
+        }
+        if (p == NULL) {
+            break;
+        }
+    }
+    if (p == NULL ||
+        *json_skip_ws(p + 1) != '\0')
+    {
+        list_clear(&ops, patch_op_clear);
+        *rc = false;
+        return sdscat(buffer, "{\"error\":\"Invalid json\"}");
+    }
+    if (ops.length == 0) {
+        *rc = false;
+        return sdscat(buffer, "{\"error\":\"No operations\"}");
+    }
+    buffer = sdscat(buffer, "{\"data\":[");
+    *rc = true;
+    struct t_list_node *current = ops.head;
     while (current != NULL) {
-        struct t_gpio_out_data *data = (struct t_gpio_out_data *)current->data;
-        if (i++) {
+        if (current != ops.head) {
             buffer = sdscatlen(buffer, ",", 1);
         }
-        buffer = sdscatlen(buffer, "{", 1);
-        buffer = sdscatfmt(buffer, "\"gpio\":%u,", current->id);
-        buffer = sdscat(buffer, "\"name\":");
-        buffer = sds_catjson(buffer, data->name);
-        buffer = sdscatlen(buffer, ",", 1);
-        buffer = sdscat(buffer, "\"direction\":\"out\",");
-        buffer = sdscat(buffer, "\"value\":");
-        buffer = sds_catjson(buffer, lookup_gpio_value(gpio_get_value(config, current->id)));
-        buffer = sdscatlen(buffer, "}", 1);
+        bool op_rc;
+        buffer = gpio_patch_operation(config, buffer, (struct t_json_object *)current->data, &op_rc);
+        if (op_rc == false) {
+            *rc = false;
+        }
         current = current->next;
     }
-    buffer = sdscatfmt(buffer, "],\"entries\":%u}", i);
-    *rc = true;
+    buffer = sdscatfmt(buffer, "],\"entries\":%u}", ops.length);
+    list_clear(&ops, patch_op_clear);
     return buffer;
 }
 
@@ -92,12 +213,14 @@ sds rest_api_gpio_gpio_get(struct t_config *config,
         return sdscat(buffer,"{\"error\":\"Getting GPIO value failed\"}");
     }
 
-    buffer = sdscatlen(buffer, "{", 1);
-    buffer = sdscatfmt(buffer, "\"gpio\": %u,", gpio_nr);
-    buffer = sdscatfmt(buffer, "\"value\":\"%s\"", lookup_gpio_value(value));
-    buffer = sdscatlen(buffer, "}", 1);
+    struct t_json_writer w;
+    json_writer_init(&w, buffer, JSON_GPIO_ENTRY_LEN);
+    json_writer_object_begin(&w);
+    json_writer_kv_uint(&w, "gpio", gpio_nr);
+    json_writer_kv_string(&w, "value", lookup_gpio_value(value));
+    json_writer_object_end(&w);
     *rc = true;
-    return buffer;
+    return json_writer_finish(&w);
 }
 
 /**
@@ -130,47 +253,35 @@ sds rest_api_gpio_gpio_options(struct t_config *config,
         return sdscat(buffer,"{\"error\":\"Failure geeting GPIO info\"}");
     }
 
-    buffer = sdscat(buffer, "{\"data\":");
-    buffer = sdscatlen(buffer, "{", 1);
-    buffer = sdscatfmt(buffer, "\"gpio\":%u", gpio_nr);
-    buffer = sdscatlen(buffer, ",", 1);
-    buffer = sdscat(buffer, "\"value\":");
-    buffer = sds_catjson(buffer, lookup_gpio_value(gpio_get_value(config, gpio_nr)));
-    buffer = sdscatlen(buffer, ",", 1);
+    struct t_json_writer w;
+    json_writer_init(&w, buffer, JSON_GPIO_ENTRY_LEN * 3);
+    json_writer_object_begin(&w);
+    json_writer_key(&w, "data");
+    json_writer_object_begin(&w);
+    json_writer_kv_uint(&w, "gpio", gpio_nr);
+    json_writer_kv_string(&w, "value", lookup_gpio_value(gpio_get_value(config, gpio_nr)));
     if (gpio_direction == GPIOD_LINE_DIRECTION_INPUT) {
         struct t_gpio_in_data *data = (struct t_gpio_in_data *)node->data;
-        buffer = sdscat(buffer, "\"name\":");
-        buffer = sds_catjson(buffer, data->name);
-        buffer = sdscatlen(buffer, ",", 1);
-        buffer = sdscat(buffer, "\"direction\":\"in\",");
-        buffer = sdscatfmt(buffer, "\"active_low\":%s", bool_to_str(gpiod_line_info_is_active_low(info)));
-        buffer = sdscatlen(buffer, ",", 1);
-        buffer = sdscat(buffer, "\"bias\":");
-        buffer = sds_catjson(buffer, lookup_bias(gpiod_line_info_get_bias(info)));
-        buffer = sdscatlen(buffer, ",", 1);
-        buffer = sdscat(buffer, "\"event_request\":");
-        buffer = sds_catjson(buffer, lookup_event_request(gpiod_line_info_get_edge_detection(info)));
-        buffer = sdscatlen(buffer, ",", 1);
-        buffer = sdscatfmt(buffer, "\"is_debounced\":%s", bool_to_str(gpiod_line_info_is_debounced(info)));
-        buffer = sdscatlen(buffer, ",", 1);
-        buffer = sdscatfmt(buffer, "\"debounce_period_us\":%I", (int64_t)gpiod_line_info_get_debounce_period_us(info));
-        buffer = sdscatlen(buffer, ",", 1);
-        buffer = sdscat(buffer, "\"event_clock\":");
-        buffer = sds_catjson(buffer, lookup_event_clock(gpiod_line_info_get_event_clock(info)));
+        json_writer_kv_string(&w, "name", data->name);
+        json_writer_kv_string(&w, "direction", "in");
+        json_writer_kv_bool(&w, "active_low", gpiod_line_info_is_active_low(info));
+        json_writer_kv_string(&w, "bias", lookup_bias(gpiod_line_info_get_bias(info)));
+        json_writer_kv_string(&w, "event_request", lookup_event_request(gpiod_line_info_get_edge_detection(info)));
+        json_writer_kv_bool(&w, "is_debounced", gpiod_line_info_is_debounced(info));
+        json_writer_kv_uint(&w, "debounce_period_us", gpiod_line_info_get_debounce_period_us(info));
+        json_writer_kv_string(&w, "event_clock", lookup_event_clock(gpiod_line_info_get_event_clock(info)));
     }
     else if (gpio_direction == GPIOD_LINE_DIRECTION_OUTPUT) {
         struct t_gpio_out_data *data = (struct t_gpio_out_data *)node->data;
-        buffer = sdscat(buffer, "\"name\":");
-        buffer = sds_catjson(buffer, data->name);
-        buffer = sdscatlen(buffer, ",", 1);
-        buffer = sdscat(buffer, "\"direction\":\"out\",");
-        buffer = sdscat(buffer, "\"drive\":");
-        buffer = sds_catjson(buffer, lookup_drive(gpiod_line_info_get_drive(info)));
+        json_writer_kv_string(&w, "name", data->name);
+        json_writer_kv_string(&w, "direction", "out");
+        json_writer_kv_string(&w, "drive", lookup_drive(gpiod_line_info_get_drive(info)));
     }
-    buffer = sdscatlen(buffer, "}}", 2);
+    json_writer_object_end(&w);
+    json_writer_object_end(&w);
     gpiod_line_info_free(info);
     *rc = true;
-    return buffer;
+    return json_writer_finish(&w);
 }
 
 /**
@@ -178,19 +289,18 @@ sds rest_api_gpio_gpio_options(struct t_config *config,
  * @param config pointer to config
  * @param buffer already allocated buffer to populate with the response
  * @param gpio_nr gpio number
- * @param connection HTTP connection
+ * @param timeout timeout argument or NULL if not set
+ * @param interval interval argument or NULL if not set
  * @param rc pointer to bool to set the result code
  * @return sds pointer to buffer
  */
 sds rest_api_gpio_gpio_blink(struct t_config *config,
                              sds buffer,
                              unsigned gpio_nr,
-                             struct MHD_Connection *connection,
+                             const char *timeout,
+                             const char *interval,
                              bool *rc)
 {
-
-    const char *timeout = MHD_lookup_connection_value(connection, MHD_GET_ARGUMENT_KIND, "timeout");
-    const char *interval = MHD_lookup_connection_value(connection, MHD_GET_ARGUMENT_KIND, "interval");
     int timeout_i;
     int interval_i;
     if (timeout == NULL ||
@@ -217,17 +327,16 @@ sds rest_api_gpio_gpio_blink(struct t_config *config,
  * @param config pointer to config
  * @param buffer already allocated buffer to populate with the response
  * @param gpio_nr gpio number
- * @param connection HTTP connection
+ * @param value value argument or NULL if not set
  * @param rc pointer to bool to set the result code
  * @return sds pointer to buffer
  */
 sds rest_api_gpio_gpio_set(struct t_config *config,
                             sds buffer,
                             unsigned gpio_nr,
-                            struct MHD_Connection *connection,
+                            const char *value,
                             bool *rc)
 {
-    const char *value = MHD_lookup_connection_value(connection, MHD_GET_ARGUMENT_KIND, "value");
     if (value == NULL) {
         *rc = false;
         return sdscat(buffer,"{\"error\":\"Parameter \"value\" not found\"}");
@@ -272,3 +381,84 @@ sds rest_api_gpio_gpio_toggle(struct t_config *config,
     }
     return buffer;
 }
+
+// private functions
+
+/**
+ * Prints a json object for an input gpio
+ * @param w json writer
+ * @param gpio_nr gpio number
+ * @param data gpio data
+ */
+static void print_gpio_in(struct t_json_writer *w, unsigned gpio_nr, struct t_gpio_in_data *data) {
+    json_writer_object_begin(w);
+    json_writer_kv_uint(w, "gpio", gpio_nr);
+    json_writer_kv_string(w, "name", data->name);
+    json_writer_kv_string(w, "direction", "in");
+    // Read the value from the line request directly, avoids the list lookup of gpio_get_value
+    json_writer_kv_string(w, "value", lookup_gpio_value(gpiod_line_request_get_value(data->request, gpio_nr)));
+    json_writer_object_end(w);
+}
+
+/**
+ * Prints a json object for an output gpio
+ * @param w json writer
+ * @param gpio_nr gpio number
+ * @param data gpio data
+ */
+static void print_gpio_out(struct t_json_writer *w, unsigned gpio_nr, struct t_gpio_out_data *data) {
+    json_writer_object_begin(w);
+    json_writer_kv_uint(w, "gpio", gpio_nr);
+    json_writer_kv_string(w, "name", data->name);
+    json_writer_kv_string(w, "direction", "out");
+    json_writer_kv_string(w, "value", lookup_gpio_value(gpiod_line_request_get_value(data->request, gpio_nr)));
+    json_writer_object_end(w);
+}
+
+/**
+ * Executes a single operation of PATCH /api/v1/gpio
+ * @param config pointer to config
+ * @param buffer already allocated buffer to append the result
+ * @param op parsed operation
+ * @param rc pointer to bool to set the result code
+ * @return sds pointer to buffer
+ */
+static sds gpio_patch_operation(struct t_config *config, sds buffer, struct t_json_object *op, bool *rc) {
+    unsigned gpio_nr;
+    const char *gpio = json_object_get(op, "gpio");
+    if (gpio == NULL ||
+        mygpio_parse_uint(gpio, &gpio_nr, NULL, 1, GPIOS_MAX) == false)
+    {
+        *rc = false;
+        return sdscat(buffer, "{\"result\":{\"error\":\"Invalid GPIO number\"}}");
+    }
+    buffer = sdscatfmt(buffer, "{\"gpio\":%u,\"result\":", gpio_nr);
+    const char *action = json_object_get(op, "action");
+    if (action == NULL) {
+        *rc = false;
+        buffer = sdscat(buffer, "{\"error\":\"Missing action\"}");
+    }
+    else if (strcmp(action, "set") == 0) {
+        buffer = rest_api_gpio_gpio_set(config, buffer, gpio_nr, json_object_get(op, "value"), rc);
+    }
+    else if (strcmp(action, "toggle") == 0) {
+        buffer = rest_api_gpio_gpio_toggle(config, buffer, gpio_nr, rc);
+    }
+    else if (strcmp(action, "blink") == 0) {
+        buffer = rest_api_gpio_gpio_blink(config, buffer, gpio_nr,
+            json_object_get(op, "timeout"), json_object_get(op, "interval"), rc);
+    }
+    else {
+        *rc = false;
+        buffer = sdscat(buffer, "{\"error\":\"Invalid action\"}");
+    }
+    return sdscatlen(buffer, "}", 1);
+}
+
+/**
+ * Frees the keys and values of a parsed operation
+ * @param node List node holding the parsed json object
+ */
+static void patch_op_clear(struct t_list_node *node) {
+    json_object_clear((struct t_json_object *)node->data);
+}
@@ -17,7 +17,12 @@
 
 sds rest_api_gpio_get(struct t_config *config,
                       sds buffer,
+                      const char *gpios,
                       bool *rc);
+sds rest_api_gpio_patch(struct t_config *config,
+                        sds buffer,
+                        const char *body,
+                        bool *rc);
 sds rest_api_gpio_gpio_get(struct t_config *config,
                            sds buffer,
                            unsigned gpio_nr,
@@ -29,12 +34,13 @@ sds rest_api_gpio_gpio_options(struct t_config *config,
 sds rest_api_gpio_gpio_blink(struct t_config *config,
                              sds buffer,
                              unsigned gpio_nr,
-                             struct MHD_Connection *connection,
+                             const char *timeout,
+                             const char *interval,
                              bool *rc);
 sds rest_api_gpio_gpio_set(struct t_config *config,
                            sds buffer,
                            unsigned gpio_nr,
-                           struct MHD_Connection *connection,
+                           const char *value,
                            bool *rc);
 sds rest_api_gpio_gpio_toggle(struct t_config *config,
                               sds buffer,
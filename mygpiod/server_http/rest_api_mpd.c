@@ -0,0 +1,44 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief MPD state REST API
+ */
+
+#include "compile_time.h"
+#include "mygpiod/server_http/rest_api_mpd.h"
+
+#include "mygpiod/lib/json_writer.h"
+#include "mygpiod/lib/mpd_client.h"
+
+/**
+ * Handles the REST API request for GET /api/v1/mpd
+ * @param config pointer to config
+ * @param buffer Already allocated buffer to populate with the response
+ * @param rc Pointer to bool to set the result code
+ * @return Pointer to buffer
+ */
+sds rest_api_mpd(struct t_config *config,
+                 sds buffer,
+                 bool *rc)
+{
+    const struct t_mpd_state *state = &config->mpd_client->mirror;
+    struct t_json_writer w;
+    json_writer_init(&w, buffer, 256);
+    json_writer_object_begin(&w);
+    json_writer_kv_bool(&w, "valid", state->valid);
+    json_writer_kv_string(&w, "state", mpd_client_lookup_state(state->play_state));
+    json_writer_kv_int(&w, "volume", state->volume);
+    json_writer_kv_int(&w, "song_pos", state->song_pos);
+    json_writer_kv_int(&w, "song_id", state->song_id);
+    json_writer_kv_uint(&w, "elapsed_ms", state->elapsed_ms);
+    json_writer_kv_uint(&w, "duration_ms", state->duration_ms);
+    json_writer_kv_bool(&w, "repeat", state->repeat);
+    json_writer_kv_bool(&w, "random", state->random);
+    json_writer_object_end(&w);
+    *rc = true;
+    return json_writer_finish(&w);
+}
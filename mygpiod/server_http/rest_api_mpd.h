@@ -0,0 +1,23 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief MPD state REST API
+ */
+
+#ifndef MYGPIOD_SERVER_HTTPD_REST_API_MPD_H
+#define MYGPIOD_SERVER_HTTPD_REST_API_MPD_H
+
+#include "dist/sds/sds.h"
+#include "mygpiod/config/config.h"
+
+#include <stdbool.h>
+
+sds rest_api_mpd(struct t_config *config,
+                 sds buffer,
+                 bool *rc);
+
+#endif
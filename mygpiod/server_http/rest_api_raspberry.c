@@ -11,7 +11,7 @@
 #include "compile_time.h"
 #include "mygpiod/server_http/rest_api_raspberry.h"
 
-#include "mygpiod/lib/json_print.h"
+#include "mygpiod/lib/json_writer.h"
 #include "mygpiod/lib/sds_extras.h"
 #include "mygpiod/raspberry/vcgencmd.h"
 
@@ -29,17 +29,13 @@ sds rest_api_raspberry_vcio(sds buffer,
                             bool *rc)
 {
     sds result = vcgencmd(command, sdsempty(), rc);
-    if (*rc == true) {
-        buffer = sdscat(buffer, "{\"value\":");
-        buffer = sds_catjson(buffer, result);
-        buffer = sdscatlen(buffer, "}", 1);
-    }
-    else {
-        buffer = sdscat(buffer, "{\"error\":");
-        buffer = sds_catjson(buffer, result);
-        buffer = sdscatlen(buffer, "}", 1);
-    }
-    return buffer;
+    struct t_json_writer w;
+    json_writer_init(&w, buffer, sdslen(result) + 16);
+    json_writer_object_begin(&w);
+    json_writer_kv_string(&w, (*rc == true ? "value" : "error"), result);
+    json_writer_object_end(&w);
+    FREE_SDS(result);
+    return json_writer_finish(&w);
 }
 
 /**
@@ -65,31 +61,29 @@ sds rest_api_raspberry_vcio_all(sds buffer,
         "throttled",
         NULL
     };
-    sds result;
-    buffer = sdscat(buffer, "{\"values\":{");
-    const char **p = commands;
-    unsigned i = 0;
-    while(*p != NULL) {
-        result = vcgencmd(*p, sdsempty(), rc);
+    size_t buffer_len = sdslen(buffer);
+    struct t_json_writer w;
+    json_writer_init(&w, buffer, 128);
+    json_writer_object_begin(&w);
+    json_writer_key(&w, "values");
+    json_writer_object_begin(&w);
+    for (unsigned i = 0; commands[i] != NULL; i++) {
+        sds result = vcgencmd(commands[i], sdsempty(), rc);
         if (*rc == false) {
-            break;
+            // Failure
+            buffer = json_writer_finish(&w);
+            sdssubstr(buffer, 0, buffer_len);
+            json_writer_init(&w, buffer, sdslen(result) + 16);
+            json_writer_object_begin(&w);
+            json_writer_kv_string(&w, "error", result);
+            json_writer_object_end(&w);
+            FREE_SDS(result);
+            return json_writer_finish(&w);
         }
-        if (i++) {
-            buffer = sdscatlen(buffer, ",", 1);
-        }
-        buffer = sdscatfmt(buffer, "\"%s\":", keys[i - 1]);
-        buffer = sds_catjson(buffer, result);
+        json_writer_kv_string(&w, keys[i], result);
         FREE_SDS(result);
-        p++;
-    }
-    if (*rc == true) {
-        return sdscatlen(buffer, "}}", 2);
     }
-    // Failure
-    sdsclear(buffer);
-    buffer = sdscat(buffer, "{\"error\":");
-    buffer = sds_catjson(buffer, result);
-    buffer = sdscatlen(buffer, "}", 1);
-    FREE_SDS(result);
-    return buffer;
+    json_writer_object_end(&w);
+    json_writer_object_end(&w);
+    return json_writer_finish(&w);
 }
@@ -0,0 +1,45 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief HTTP server stats REST API
+ */
+
+#include "compile_time.h"
+#include "mygpiod/server_http/rest_api_stats.h"
+
+#include "mygpiod/lib/json_writer.h"
+#include "mygpiod/lib/stats.h"
+
+/**
+ * Handles the REST API request for GET /api/v1/stats
+ * @param config pointer to config
+ * @param buffer Already allocated buffer to populate with the response
+ * @param rc Pointer to bool to set the result code
+ * @return Pointer to buffer
+ */
+sds rest_api_stats(struct t_config *config,
+                   sds buffer,
+                   bool *rc)
+{
+    struct t_stats stats;
+    stats_get(config, &stats);
+    struct t_json_writer w;
+    json_writer_init(&w, buffer, 256);
+    json_writer_object_begin(&w);
+    json_writer_kv_uint(&w, "uptime", stats.uptime);
+    json_writer_kv_uint(&w, "events", stats.events);
+    json_writer_kv_uint(&w, "actions", stats.actions);
+    json_writer_kv_uint(&w, "actions_failed", stats.actions_failed);
+    json_writer_kv_uint(&w, "events_dropped", stats.events_dropped);
+    json_writer_kv_uint(&w, "timers", stats.timers);
+    json_writer_kv_uint(&w, "fds", stats.fds);
+    json_writer_kv_uint(&w, "poll_wakeups", stats.poll_wakeups);
+    json_writer_kv_uint(&w, "memory", stats.memory);
+    json_writer_object_end(&w);
+    *rc = true;
+    return json_writer_finish(&w);
+}
@@ -0,0 +1,23 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief HTTP server stats REST API
+ */
+
+#ifndef MYGPIOD_SERVER_HTTPD_REST_API_STATS_H
+#define MYGPIOD_SERVER_HTTPD_REST_API_STATS_H
+
+#include "dist/sds/sds.h"
+#include "mygpiod/config/config.h"
+
+#include <stdbool.h>
+
+sds rest_api_stats(struct t_config *config,
+                   sds buffer,
+                   bool *rc);
+
+#endif
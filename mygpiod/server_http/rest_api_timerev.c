@@ -12,11 +12,16 @@
 #include "mygpiod/server_http/rest_api_timerev.h"
 
 #include "mygpiod/config/timer_ev.h"
-#include "mygpiod/lib/json_print.h"
+#include "mygpiod/lib/json_writer.h"
 #include "mygpiod/lib/timer.h"
 
 #include <stdlib.h>
 
+/**
+ * Expected length of a json object for a timer
+ */
+#define JSON_TIMER_ENTRY_LEN 64
+
 /**
  * Handles the REST API request for GET /api/v1/timerev
  * @param config pointer to config
@@ -28,22 +33,25 @@ sds rest_api_timerev_list(struct t_config *config,
                           sds buffer,
                           bool *rc)
 {
-    *rc = true;
-    buffer = sdscat(buffer, "{\"timers\":[");
+    struct t_json_writer w;
+    json_writer_init(&w, buffer, config->timer_definitions.length * JSON_TIMER_ENTRY_LEN + 32);
+    json_writer_object_begin(&w);
+    json_writer_key(&w, "timers");
+    json_writer_array_begin(&w);
     struct t_list_node *current = config->timer_definitions.head;
     unsigned i = 0;
     while (current != NULL) {
         struct t_timer_definition *data = (struct t_timer_definition *)current->data;
-        if (i++) {
-            buffer = sdscatlen(buffer, ",", 1);
-        }
-        buffer = sdscatfmt(buffer, "{\"name\":");
-        buffer = sds_catjson(buffer, data->name);
-        buffer = sdscatlen(buffer, ",", 1);
-        buffer = sdscatprintf(buffer, "\"next\":%lld", (long long)timer_get_next_expire_ts(data->name, data->fd));
-        buffer = sdscatlen(buffer, "}", 1);
+        json_writer_object_begin(&w);
+        json_writer_kv_string(&w, "name", data->name);
+        json_writer_kv_int(&w, "next", (int64_t)timer_get_next_expire_ts(data->name, data->fd));
+        json_writer_object_end(&w);
+        i++;
         current = current->next;
     }
-    buffer = sdscatfmt(buffer, "],\"entries\":%u}", i);
-    return buffer;
+    json_writer_array_end(&w);
+    json_writer_kv_uint(&w, "entries", i);
+    json_writer_object_end(&w);
+    *rc = true;
+    return json_writer_finish(&w);
 }
@@ -0,0 +1,259 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Server-sent events endpoint
+ */
+
+#include "compile_time.h"
+#include "mygpiod/server_http/sse.h"
+
+#include "mygpio-common/util.h"
+#include "mygpiod/lib/list.h"
+#include "mygpiod/lib/log.h"
+#include "mygpiod/lib/mem.h"
+#include "mygpiod/lib/sds_extras.h"
+#include "mygpiod/server_http/cmd_queue.h"
+#include "mygpiod/server_http/util.h"
+
+#include <limits.h>
+#include <string.h>
+
+// private definitions
+
+/**
+ * State of a SSE client connection
+ */
+struct t_sse_client {
+    struct t_config *config;            //!< Pointer to config
+    struct MHD_Connection *connection;  //!< MHD connection
+    unsigned conn_id;                   //!< Uniq connection id
+    unsigned last_id;                   //!< Id of the last event sent to this client
+    sds buffer;                         //!< Pending frames
+    size_t buffer_pos;                  //!< Bytes of buffer already sent
+    bool suspended;                     //!< Connection is suspended until the next event
+};
+
+static ssize_t sse_reader(void *cls, uint64_t pos, char *buf, size_t max);
+static void sse_client_free(void *cls);
+static void sse_client_remove(struct t_config *config, void *data);
+static void sse_client_data_free(void *data);
+static void sse_fill_buffer(struct t_sse_client *client);
+static void sse_fill_cmd(struct t_config *config, void *data);
+
+// public functions
+
+/**
+ * Handles a request to the server-sent events endpoint.
+ * The connection is kept open and events are streamed as they occur.
+ * Only GET is allowed.
+ * @param request_data User data from a MHD connection
+ * @param config Pointer to config
+ * @return enum MHD_Result
+ */
+enum MHD_Result sse_handler(struct t_request_data *request_data,
+                            struct t_config *config)
+{
+    struct MHD_Connection *connection = request_data->connection;
+    unsigned http_conn_id = request_data->conn_id;
+    if (request_data->method != HTTP_GET) {
+        MYGPIOD_LOG_ERROR("HTTP connection %u: Invalid method %s for SSE", http_conn_id, http_lookup_method(request_data->method));
+        return http_respond(request_data, MHD_HTTP_METHOD_NOT_ALLOWED, "text/plain; charset=utf-8", "405 Method Not Allowed");
+    }
+    if (config->sse_clients.length >= CLIENT_CONNECTIONS_MAX) {
+        MYGPIOD_LOG_ERROR("HTTP connection %u: SSE client limit reached", http_conn_id);
+        return http_respond(request_data, MHD_HTTP_SERVICE_UNAVAILABLE, "text/plain; charset=utf-8", "503 Service Unavailable");
+    }
+    struct t_sse_client *client = malloc_assert(sizeof(struct t_sse_client));
+    client->config = config;
+    client->connection = connection;
+    client->conn_id = http_conn_id;
+    client->last_id = config->sse_event_id;
+    client->buffer_pos = 0;
+    client->suspended = false;
+
+    // Resume the stream after a reconnect
+    const char *last_event_id = MHD_lookup_connection_value(connection, MHD_HEADER_KIND, "Last-Event-ID");
+    if (last_event_id != NULL) {
+        unsigned id;
+        if (mygpio_parse_uint(last_event_id, &id, NULL, 0, UINT_MAX) == true) {
+            // A greater id than the current one is from before a restart, send the whole history
+            client->last_id = id <= config->sse_event_id
+                ? id
+                : 0;
+            MYGPIOD_LOG_DEBUG("HTTP connection %u: Resuming SSE stream after event id %u", http_conn_id, client->last_id);
+        }
+    }
+    client->buffer = sdscatfmt(sdsempty(), "retry: %u\n\n", SSE_RETRY_MS);
+
+    http_connection_disable_timeout(request_data);
+    struct MHD_Response *response = MHD_create_response_from_callback(MHD_SIZE_UNKNOWN, SSE_BLOCK_SIZE,
+            &sse_reader, client, &sse_client_free);
+    MHD_add_response_header(response, "Content-Type", "text/event-stream");
+    MHD_add_response_header(response, "Cache-Control", "no-cache");
+    list_push(&config->sse_clients, http_conn_id, client);
+    MYGPIOD_LOG_INFO("HTTP connection %u: SSE client connected", http_conn_id);
+    return http_queue_response(request_data, MHD_HTTP_OK, response);
+}
+
+/**
+ * Adds an event to the history and wakes up all waiting SSE clients
+ * @param config Pointer to config
+ * @param json Event as json object
+ */
+void sse_send_event(struct t_config *config, const char *json) {
+    config->sse_event_id++;
+    sds frame = sdscatfmt(sdsempty(), "id: %u\ndata: %s\n\n", config->sse_event_id, json);
+    list_push(&config->sse_history, config->sse_event_id, frame);
+    if (config->sse_history.length > SSE_HISTORY_MAX) {
+        struct t_list_node *first = list_shift(&config->sse_history);
+        list_node_free(first, sse_history_clear);
+    }
+    sse_resume_all(config);
+}
+
+/**
+ * Resumes all suspended SSE connections.
+ * The buffer is filled before, the reader of a suspended connection does not access it.
+ * @param config Pointer to config
+ */
+void sse_resume_all(struct t_config *config) {
+    struct t_list_node *current = config->sse_clients.head;
+    while (current != NULL) {
+        struct t_sse_client *client = (struct t_sse_client *)current->data;
+        if (client->suspended == true) {
+            sse_fill_buffer(client);
+            client->suspended = false;
+            MHD_resume_connection(client->connection);
+        }
+        current = current->next;
+    }
+}
+
+/**
+ * Frees a SSE history entry
+ * @param node Pointer to node holding the data to clear
+ */
+void sse_history_clear(struct t_list_node *node) {
+    FREE_SDS(node->data);
+}
+
+// private functions
+
+/**
+ * MHD content reader callback.
+ * Sends the pending frames or suspends the connection until the next event.
+ * If MHD runs in its own threads, the buffer is filled by the event loop thread.
+ * @param cls SSE client
+ * @param pos Position in the stream
+ * @param buf Buffer to fill
+ * @param max Size of buf
+ * @return Number of bytes written to buf
+ */
+static ssize_t sse_reader(void *cls, uint64_t pos, char *buf, size_t max) {
+    (void)pos;
+    struct t_sse_client *client = (struct t_sse_client *)cls;
+    if (client->buffer_pos == sdslen(client->buffer)) {
+        sdsclear(client->buffer);
+        client->buffer_pos = 0;
+        if (client->config->http_threads > 0) {
+            MHD_suspend_connection(client->connection);
+            http_cmd_push(client->config, sse_fill_cmd, client, NULL);
+            return 0;
+        }
+        sse_fill_buffer(client);
+        if (sdslen(client->buffer) == 0) {
+            // Nothing to send, wait for the next event
+            client->suspended = true;
+            MHD_suspend_connection(client->connection);
+            return 0;
+        }
+    }
+    size_t len = sdslen(client->buffer) - client->buffer_pos;
+    if (len > max) {
+        len = max;
+    }
+    memcpy(buf, client->buffer + client->buffer_pos, len);
+    client->buffer_pos += len;
+    return (ssize_t)len;
+}
+
+/**
+ * Appends all events newer than the last sent event to the client buffer
+ * @param client SSE client
+ */
+static void sse_fill_buffer(struct t_sse_client *client) {
+    struct t_list_node *current = client->config->sse_history.head;
+    while (current != NULL) {
+        if (current->id > client->last_id) {
+            client->buffer = sdscatsds(client->buffer, (sds)current->data);
+            client->last_id = current->id;
+        }
+        current = current->next;
+    }
+}
+
+/**
+ * Fills the buffer of a suspended connection in the event loop thread.
+ * Resumes the connection or waits for the next event if there is nothing to send.
+ * @param config Pointer to config
+ * @param data SSE client
+ */
+static void sse_fill_cmd(struct t_config *config, void *data) {
+    (void)config;
+    struct t_sse_client *client = (struct t_sse_client *)data;
+    sse_fill_buffer(client);
+    if (sdslen(client->buffer) == 0) {
+        client->suspended = true;
+        return;
+    }
+    MHD_resume_connection(client->connection);
+}
+
+/**
+ * MHD content reader free callback.
+ * Removes the client from the list of SSE clients.
+ * @param cls SSE client
+ */
+static void sse_client_free(void *cls) {
+    struct t_sse_client *client = (struct t_sse_client *)cls;
+    if (client->config->http_threads > 0) {
+        http_cmd_push(client->config, sse_client_remove, client, sse_client_data_free);
+        return;
+    }
+    sse_client_remove(client->config, client);
+}
+
+/**
+ * Removes the client from the list of SSE clients and frees it
+ * @param config Pointer to config
+ * @param data SSE client
+ */
+static void sse_client_remove(struct t_config *config, void *data) {
+    struct t_sse_client *client = (struct t_sse_client *)data;
+    struct t_list *clients = &config->sse_clients;
+    struct t_list_node *current = clients->head;
+    while (current != NULL) {
+        if (current->data == client) {
+            list_remove_node(clients, current);
+            FREE_PTR(current);
+            break;
+        }
+        current = current->next;
+    }
+    MYGPIOD_LOG_INFO("HTTP connection %u: SSE client disconnected", client->conn_id);
+    sse_client_data_free(client);
+}
+
+/**
+ * Frees the SSE client
+ * @param data SSE client
+ */
+static void sse_client_data_free(void *data) {
+    struct t_sse_client *client = (struct t_sse_client *)data;
+    FREE_SDS(client->buffer);
+    FREE_PTR(client);
+}
@@ -0,0 +1,40 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Server-sent events endpoint
+ */
+
+#ifndef MYGPIOD_SERVER_HTTPD_SSE_H
+#define MYGPIOD_SERVER_HTTPD_SSE_H
+
+#include "mygpiod/config/config.h"
+#include "mygpiod/server_http/util.h"
+
+#include <microhttpd.h>
+
+/**
+ * Number of events to keep for Last-Event-ID resume
+ */
+#define SSE_HISTORY_MAX 32
+
+/**
+ * Reconnection time for the browser in milliseconds
+ */
+#define SSE_RETRY_MS 3000
+
+/**
+ * Block size for the MHD content reader
+ */
+#define SSE_BLOCK_SIZE 1024
+
+enum MHD_Result sse_handler(struct t_request_data *request_data,
+                            struct t_config *config);
+void sse_send_event(struct t_config *config, const char *json);
+void sse_resume_all(struct t_config *config);
+void sse_history_clear(struct t_list_node *node);
+
+#endif
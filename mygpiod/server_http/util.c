@@ -15,6 +15,9 @@
 #include "mygpiod/input_ev/event_code.h"
 #include "mygpiod/input_ev/event_type.h"
 #include "mygpiod/lib/events.h"
+#include "mygpiod/lib/json_print.h"
+#include "mygpiod/lib/mem.h"
+#include "mygpiod/lib/sds_extras.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -27,24 +30,68 @@ void http_response_free(void *cls) {
     sdsfree((sds)cls);
 }
 
+/**
+ * Queues the response and releases it.
+ * Deferred requests are handled in the event loop thread, the response
+ * is saved and queued by the HTTP thread after the connection is resumed.
+ * @param request_data User data from a MHD connection
+ * @param status_code HTTP status code
+ * @param response Response to queue
+ * @return enum MHD_Result
+ */
+enum MHD_Result http_queue_response(struct t_request_data *request_data,
+                                    unsigned int status_code,
+                                    struct MHD_Response *response)
+{
+    if (request_data->deferred == true) {
+        request_data->response = response;
+        request_data->status_code = status_code;
+        return MHD_YES;
+    }
+    enum MHD_Result result = MHD_queue_response(request_data->connection, status_code, response);
+    MHD_destroy_response(response);
+    return result;
+}
+
 /**
  * Simple HTTP response
- * @param connection MHD connection
+ * @param request_data User data from a MHD connection
  * @param status_code HTTP status code
  * @param content_type HTTP Content-type
  * @param message HTTP body
  * @return enum MHD_Result
  */
-enum MHD_Result http_respond(struct MHD_Connection *connection,
+enum MHD_Result http_respond(struct t_request_data *request_data,
                              unsigned int status_code,
                              const char *content_type,
                              const char *message)
 {
     struct MHD_Response *response = MHD_create_response_from_buffer(strlen(message), (void *)message, MHD_RESPMEM_MUST_COPY);
     MHD_add_response_header(response, "Content-Type", content_type);
-    enum MHD_Result result = MHD_queue_response(connection, status_code, response);
-    MHD_destroy_response(response);
-    return result;
+    return http_queue_response(request_data, status_code, response);
+}
+
+/**
+ * Suspends the connection until it is resumed by an event.
+ * Deferred requests are already suspended by the HTTP thread.
+ * @param request_data User data from a MHD connection
+ */
+void http_connection_suspend(struct t_request_data *request_data) {
+    if (request_data->deferred == false) {
+        MHD_suspend_connection(request_data->connection);
+    }
+}
+
+/**
+ * Disables the connection timeout for long living connections
+ * @param request_data User data from a MHD connection
+ */
+void http_connection_disable_timeout(struct t_request_data *request_data) {
+    if (request_data->deferred == true) {
+        request_data->no_timeout = true;
+        return;
+    }
+    MHD_set_connection_option(request_data->connection, MHD_CONNECTION_OPTION_TIMEOUT, 0);
 }
 
 /**
@@ -81,19 +128,19 @@ const char *http_lookup_method(enum http_method method) {
 }
 
 /**
- * Creates the response message and resumes a suspended connection
- * for the long poll endpoint and an GPIO event
- * @param request_data User data from a MHD connection
+ * Prints a GPIO event as json object
+ * @param buffer Already allocated sds string to append the json object
  * @param gpio GPIO number
  * @param event_type GPIO event
- * @param timestamp Event timestamp
+ * @param timestamp Event timestamp in nanoseconds
+ * @return Pointer to buffer
  */
-void http_connection_resume_gpio(struct t_request_data *request_data,
-                                 unsigned gpio,
-                                 enum mygpiod_event_types event_type,
-                                 uint64_t timestamp)
+sds http_print_event_gpio(sds buffer,
+                          unsigned gpio,
+                          enum mygpiod_event_types event_type,
+                          uint64_t timestamp)
 {
-    request_data->resume_buffer = sdscatprintf(sdsempty(),
+    return sdscatprintf(buffer,
         "{"
           "\"event\":\"%s\","
           "\"gpio\":%u,"
@@ -103,21 +150,20 @@ void http_connection_resume_gpio(struct t_request_data *request_data,
         gpio,
         (long long unsigned)(timestamp / 1000000)
     );
-    MHD_resume_connection(request_data->connection);
 }
 
 /**
- * Creates the response message and resumes a suspended connection
- * for the long poll endpoint and an input event
- * @param request_data User data from a MHD connection
+ * Prints an input event as json object
+ * @param buffer Already allocated sds string to append the json object
  * @param input_event Input event
+ * @return Pointer to buffer
  */
-void http_connection_resume_input(struct t_request_data *request_data,
-                                  struct t_mygpiod_input_event *input_event)
+sds http_print_event_input(sds buffer,
+                           struct t_mygpiod_input_event *input_event)
 {
-    uint64_t timestamp_ms = (uint64_t)(input_event->data.time.tv_sec * 1000) + (uint64_t)(input_event->data.time.tv_usec);
+    uint64_t timestamp_ms = (uint64_t)(input_event->data.time.tv_sec * 1000) + (uint64_t)(input_event->data.time.tv_usec / 1000);
 
-    request_data->resume_buffer = sdscatprintf(sdsempty(),
+    return sdscatprintf(buffer,
         "{"
           "\"event\":\"%s\","
           "\"device\":\"%s\","
@@ -133,6 +179,173 @@ void http_connection_resume_input(struct t_request_data *request_data,
         input_event_code_name(input_event->data.type, input_event->data.code),
         input_event->data.value
     );
+}
+
+/**
+ * Prints a finished HTTP client request as json object
+ * @param buffer Already allocated sds string to append the json object
+ * @param uri URI of the finished request
+ * @param http_status HTTP response code, 0 on transport error
+ * @param duration_ms Duration of the request in milliseconds
+ * @param timestamp Event timestamp in nanoseconds
+ * @return Pointer to buffer
+ */
+sds http_print_event_http_done(sds buffer,
+                               const char *uri,
+                               unsigned http_status,
+                               uint64_t duration_ms,
+                               uint64_t timestamp)
+{
+    buffer = sdscatprintf(buffer,
+        "{"
+          "\"event\":\"%s\","
+          "\"timestamp_ms\":%llu,"
+          "\"uri\":",
+        mygpiod_event_name(MYGPIOD_EVENT_HTTP_DONE),
+        (long long unsigned)(timestamp / 1000000)
+    );
+    buffer = sds_catjson(buffer, uri);
+    return sdscatprintf(buffer,
+          ","
+          "\"status\":%u,"
+          "\"duration_ms\":%llu"
+        "}",
+        http_status,
+        (long long unsigned)duration_ms
+    );
+}
+
+/**
+ * Prints a finished system action as json object
+ * @param buffer Already allocated sds string to append the json object
+ * @param cmd Command of the finished process
+ * @param exit_code Exit code, 128 + signal number if killed
+ * @param duration_ms Runtime of the process in milliseconds
+ * @param timestamp Event timestamp in nanoseconds
+ * @return Pointer to buffer
+ */
+sds http_print_event_system_done(sds buffer,
+                                 const char *cmd,
+                                 int exit_code,
+                                 uint64_t duration_ms,
+                                 uint64_t timestamp)
+{
+    buffer = sdscatprintf(buffer,
+        "{"
+          "\"event\":\"%s\","
+          "\"timestamp_ms\":%llu,"
+          "\"command\":",
+        mygpiod_event_name(MYGPIOD_EVENT_SYSTEM_DONE),
+        (long long unsigned)(timestamp / 1000000)
+    );
+    buffer = sds_catjson(buffer, cmd);
+    return sdscatprintf(buffer,
+          ","
+          "\"exit_code\":%d,"
+          "\"duration_ms\":%llu"
+        "}",
+        exit_code,
+        (long long unsigned)duration_ms
+    );
+}
+
+/**
+ * Prints an aborted Lua execution as json object
+ * @param buffer Already allocated sds string to append the json object
+ * @param script Name of the Lua function or script
+ * @param vm Lua VM type
+ * @param reason Exceeded limit
+ * @param duration_ms Runtime until the abort in milliseconds
+ * @param timestamp Event timestamp in nanoseconds
+ * @return Pointer to buffer
+ */
+sds http_print_event_lua_timeout(sds buffer,
+                                 const char *script,
+                                 const char *vm,
+                                 const char *reason,
+                                 uint64_t duration_ms,
+                                 uint64_t timestamp)
+{
+    buffer = sdscatprintf(buffer,
+        "{"
+          "\"event\":\"%s\","
+          "\"timestamp_ms\":%llu,"
+          "\"script\":",
+        mygpiod_event_name(MYGPIOD_EVENT_LUA_TIMEOUT),
+        (long long unsigned)(timestamp / 1000000)
+    );
+    buffer = sds_catjson(buffer, script);
+    return sdscatprintf(buffer,
+          ","
+          "\"vm\":\"%s\","
+          "\"reason\":\"%s\","
+          "\"duration_ms\":%llu"
+        "}",
+        vm,
+        reason,
+        (long long unsigned)duration_ms
+    );
+}
+
+/**
+ * Prints a MPD player state change as json object
+ * @param buffer Already allocated sds string to append the json object
+ * @param state Player state name
+ * @param song_pos Queue position of the current song, -1 if none
+ * @param timestamp Event timestamp in nanoseconds
+ * @return Pointer to buffer
+ */
+sds http_print_event_mpd_player(sds buffer,
+                                const char *state,
+                                int song_pos,
+                                uint64_t timestamp)
+{
+    return sdscatprintf(buffer,
+        "{"
+          "\"event\":\"%s\","
+          "\"timestamp_ms\":%llu,"
+          "\"state\":\"%s\","
+          "\"song_pos\":%d"
+        "}",
+        mygpiod_event_name(MYGPIOD_EVENT_MPD_PLAYER),
+        (long long unsigned)(timestamp / 1000000),
+        state,
+        song_pos
+    );
+}
+
+/**
+ * Prints a MPD volume change as json object
+ * @param buffer Already allocated sds string to append the json object
+ * @param volume Volume, -1 if unknown
+ * @param timestamp Event timestamp in nanoseconds
+ * @return Pointer to buffer
+ */
+sds http_print_event_mpd_mixer(sds buffer,
+                               int volume,
+                               uint64_t timestamp)
+{
+    return sdscatprintf(buffer,
+        "{"
+          "\"event\":\"%s\","
+          "\"timestamp_ms\":%llu,"
+          "\"volume\":%d"
+        "}",
+        mygpiod_event_name(MYGPIOD_EVENT_MPD_MIXER),
+        (long long unsigned)(timestamp / 1000000),
+        volume
+    );
+}
+
+/**
+ * Resumes a suspended connection for the long poll endpoint
+ * @param request_data User data from a MHD connection
+ * @param json Event as json object
+ */
+void http_connection_resume(struct t_request_data *request_data,
+                            const char *json)
+{
+    request_data->resume_buffer = sdsnew(json);
     MHD_resume_connection(request_data->connection);
 }
 
@@ -152,6 +365,59 @@ void http_connection_done(void *cls,
     (void)connection;
     (void)toe;
     struct t_request_data *request_data = *req_cls;
+    if (request_data->response != NULL) {
+        // Connection was closed before the deferred response was queued
+        MHD_destroy_response(request_data->response);
+    }
     sdsfree(request_data->resume_buffer);
+    sdsfree(request_data->body);
     free(request_data);
 }
+
+/**
+ * Callback for socket open and close, manages the socket specific data
+ * @param cls User data
+ * @param connection Connection
+ * @param socket_context Socket specific user data
+ * @param toe Notification code
+ */
+void http_socket_notify(void *cls,
+                        struct MHD_Connection *connection,
+                        void **socket_context,
+                        enum MHD_ConnectionNotificationCode toe)
+{
+    (void)cls;
+    (void)connection;
+    if (toe == MHD_CONNECTION_NOTIFY_STARTED) {
+        struct t_socket_data *socket_data = malloc_assert(sizeof(struct t_socket_data));
+        socket_data->buffer = sdsMakeRoomFor(sdsempty(), HTTP_BUFFER_SIZE);
+        *socket_context = socket_data;
+        return;
+    }
+    struct t_socket_data *socket_data = *socket_context;
+    if (socket_data != NULL) {
+        FREE_SDS(socket_data->buffer);
+        FREE_PTR(socket_data);
+        *socket_context = NULL;
+    }
+}
+
+/**
+ * Returns the socket specific data with a cleared response buffer.
+ * A response created from the buffer must be sent before the next
+ * request of this connection is handled, MHD ensures this.
+ * @param connection Connection
+ * @return Socket specific data
+ */
+struct t_socket_data *http_get_socket_data(struct MHD_Connection *connection) {
+    const union MHD_ConnectionInfo *info = MHD_get_connection_info(connection, MHD_CONNECTION_INFO_SOCKET_CONTEXT);
+    struct t_socket_data *socket_data = (struct t_socket_data *)info->socket_context;
+    if (sdsalloc(socket_data->buffer) > HTTP_BUFFER_SIZE_MAX) {
+        FREE_SDS(socket_data->buffer);
+        socket_data->buffer = sdsMakeRoomFor(sdsempty(), HTTP_BUFFER_SIZE);
+    }
+    else {
+        sdsclear(socket_data->buffer);
+    }
+    return socket_data;
+}
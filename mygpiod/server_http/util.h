@@ -28,34 +28,98 @@ enum http_method {
     HTTP_PATCH,
 };
 
+/**
+ * Maximum size of a request body
+ */
+#define HTTP_BODY_MAX 16384
+
+/**
+ * Initial size of the per socket response buffer
+ */
+#define HTTP_BUFFER_SIZE 4096
+
+/**
+ * The per socket response buffer is shrunk if it grew larger
+ */
+#define HTTP_BUFFER_SIZE_MAX 65536
+
+/**
+ * MHD socket specific data, valid as long as the TCP connection is open
+ */
+struct t_socket_data {
+    sds buffer;                         //!< Response buffer, reused for all requests of the connection
+};
+
 /**
  * MHD connection specific data
  */
 struct t_request_data {
     sds resume_buffer;                  //!< Message buffer for resumed connections
+    sds body;                           //!< Request body
+    bool body_too_large;                //!< Request body exceeded HTTP_BODY_MAX
     struct MHD_Connection *connection;  //!< Pointer to MHD connection
     unsigned conn_id;              //!< Uniq connection id
+    const char *url;                    //!< Request URL, valid until the request is completed
+    enum http_method method;            //!< HTTP method
+    bool deferred;                      //!< Request is handled in the event loop thread
+    struct MHD_Response *response;      //!< Response from the event loop thread, queued by the HTTP thread
+    unsigned status_code;               //!< HTTP status code for response
+    bool no_timeout;                    //!< Disable the connection timeout before queuing response
 };
 
 void http_response_free(void *cls);
-enum MHD_Result http_respond(struct MHD_Connection *connection,
+enum MHD_Result http_queue_response(struct t_request_data *request_data,
+                                    unsigned int status_code,
+                                    struct MHD_Response *response);
+enum MHD_Result http_respond(struct t_request_data *request_data,
                              unsigned int status_code,
                              const char *content_type,
                              const char *message);
+void http_connection_suspend(struct t_request_data *request_data);
+void http_connection_disable_timeout(struct t_request_data *request_data);
 enum http_method http_parse_method(const char *method);
 const char *http_lookup_method(enum http_method method);
 
-void http_connection_resume_gpio(struct t_request_data *request_data,
-                                 unsigned gpio,
-                                 enum mygpiod_event_types event_type,
+sds http_print_event_gpio(sds buffer,
+                          unsigned gpio,
+                          enum mygpiod_event_types event_type,
+                          uint64_t timestamp);
+sds http_print_event_input(sds buffer,
+                           struct t_mygpiod_input_event *input_event);
+sds http_print_event_http_done(sds buffer,
+                               const char *uri,
+                               unsigned http_status,
+                               uint64_t duration_ms,
+                               uint64_t timestamp);
+sds http_print_event_system_done(sds buffer,
+                                 const char *cmd,
+                                 int exit_code,
+                                 uint64_t duration_ms,
                                  uint64_t timestamp);
-
-void http_connection_resume_input(struct t_request_data *request_data,
-                                  struct t_mygpiod_input_event *input_event);
+sds http_print_event_lua_timeout(sds buffer,
+                                 const char *script,
+                                 const char *vm,
+                                 const char *reason,
+                                 uint64_t duration_ms,
+                                 uint64_t timestamp);
+sds http_print_event_mpd_player(sds buffer,
+                                const char *state,
+                                int song_pos,
+                                uint64_t timestamp);
+sds http_print_event_mpd_mixer(sds buffer,
+                               int volume,
+                               uint64_t timestamp);
+void http_connection_resume(struct t_request_data *request_data,
+                            const char *json);
 
 void http_connection_done(void *cls,
                            struct MHD_Connection *connection,
                            void **req_cls,
                            enum MHD_RequestTerminationCode toe);
+void http_socket_notify(void *cls,
+                        struct MHD_Connection *connection,
+                        void **socket_context,
+                        enum MHD_ConnectionNotificationCode toe);
+struct t_socket_data *http_get_socket_data(struct MHD_Connection *connection);
 
 #endif
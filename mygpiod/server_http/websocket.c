@@ -0,0 +1,673 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief WebSocket endpoint
+ *
+ * The upgraded connections are polled in the central event loop.
+ * Clients send json commands and receive the responses and all events.
+ */
+
+#include "compile_time.h"
+#include "mygpiod/server_http/websocket.h"
+
+#include "mygpio-common/util.h"
+#include "mygpiod/event_loop/event_loop.h"
+#include "mygpiod/lib/json_parse.h"
+#include "mygpiod/lib/list.h"
+#include "mygpiod/lib/log.h"
+#include "mygpiod/lib/mem.h"
+#include "mygpiod/lib/sds_extras.h"
+#include "mygpiod/lib/sha1.h"
+#include "mygpiod/server_http/cmd_queue.h"
+#include "mygpiod/server_http/rest_api_gpio.h"
+#include "mygpiod/server_http/util.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// private definitions
+
+/**
+ * GUID for the Sec-WebSocket-Accept calculation
+ */
+#define WS_GUID "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+/**
+ * WebSocket opcodes
+ */
+enum ws_opcodes {
+    WS_OPCODE_CONTINUATION = 0x0,
+    WS_OPCODE_TEXT = 0x1,
+    WS_OPCODE_BINARY = 0x2,
+    WS_OPCODE_CLOSE = 0x8,
+    WS_OPCODE_PING = 0x9,
+    WS_OPCODE_PONG = 0xA
+};
+
+/**
+ * WebSocket close status codes
+ */
+enum ws_close_codes {
+    WS_CLOSE_NORMAL = 1000,
+    WS_CLOSE_PROTOCOL_ERROR = 1002,
+    WS_CLOSE_UNSUPPORTED = 1003,
+    WS_CLOSE_TOO_BIG = 1009
+};
+
+static void upgrade_handler(void *cls, struct MHD_Connection *connection, void *req_cls,
+        const char *extra_in, size_t extra_in_size, MHD_socket sock,
+        struct MHD_UpgradeResponseHandle *urh);
+static void client_add(struct t_config *config, void *data);
+static void client_data_free(void *data);
+static bool parse_frames(struct t_config *config, struct t_list_node *node);
+static void handle_message(struct t_config *config, struct t_list_node *node);
+static sds handle_command(struct t_config *config, struct t_json_object *cmd, sds buffer, bool *rc);
+static void send_frame(struct t_ws_client *client, enum ws_opcodes opcode, const char *payload, size_t len);
+static void send_close(struct t_ws_client *client, enum ws_close_codes code);
+static bool flush_output(struct t_ws_client *client);
+static void client_close(struct t_config *config, struct t_list_node *node);
+static void client_discard(void *data);
+static void upgrade_close(struct t_config *config, void *data);
+static void upgrade_close_discard(void *data);
+static struct t_list_node *get_node_by_fd(struct t_list *clients, int fd);
+static sds sds_catbase64(sds s, const uint8_t *data, size_t len);
+
+// public functions
+
+/**
+ * Handles the WebSocket handshake
+ * @param request_data User data from a MHD connection
+ * @param config Pointer to config
+ * @return enum MHD_Result
+ */
+enum MHD_Result websocket_handler(struct t_request_data *request_data,
+                                  struct t_config *config)
+{
+    struct MHD_Connection *connection = request_data->connection;
+    unsigned http_conn_id = request_data->conn_id;
+    const char *upgrade = MHD_lookup_connection_value(connection, MHD_HEADER_KIND, "Upgrade");
+    const char *version = MHD_lookup_connection_value(connection, MHD_HEADER_KIND, "Sec-WebSocket-Version");
+    const char *key = MHD_lookup_connection_value(connection, MHD_HEADER_KIND, "Sec-WebSocket-Key");
+    if (upgrade == NULL ||
+        strcasecmp(upgrade, "websocket") != 0 ||
+        version == NULL ||
+        strcmp(version, "13") != 0 ||
+        key == NULL)
+    {
+        MYGPIOD_LOG_ERROR("HTTP connection %u: Invalid WebSocket handshake", http_conn_id);
+        return http_respond(request_data, MHD_HTTP_BAD_REQUEST, "text/plain; charset=utf-8", "400 Bad Request");
+    }
+    if (config->ws_clients.length >= CLIENT_CONNECTIONS_MAX) {
+        MYGPIOD_LOG_ERROR("HTTP connection %u: WebSocket client limit reached", http_conn_id);
+        return http_respond(request_data, MHD_HTTP_SERVICE_UNAVAILABLE, "text/plain; charset=utf-8", "503 Service Unavailable");
+    }
+
+    sds accept_key = sdscatfmt(sdsempty(), "%s%s", key, WS_GUID);
+    uint8_t digest[SHA1_DIGEST_LEN];
+    sha1(accept_key, sdslen(accept_key), digest);
+    sdsclear(accept_key);
+    accept_key = sds_catbase64(accept_key, digest, SHA1_DIGEST_LEN);
+
+    struct MHD_Response *response = MHD_create_response_for_upgrade(&upgrade_handler, config);
+    MHD_add_response_header(response, "Upgrade", "websocket");
+    MHD_add_response_header(response, "Sec-WebSocket-Accept", accept_key);
+    FREE_SDS(accept_key);
+    return http_queue_response(request_data, MHD_HTTP_SWITCHING_PROTOCOLS, response);
+}
+
+/**
+ * Handles poll events of a WebSocket connection
+ * @param config Pointer to config
+ * @param client_fd WebSocket client poll fd
+ * @return true on success, else false
+ */
+bool websocket_client_handle(struct t_config *config, struct pollfd *client_fd) {
+    struct t_list_node *node = get_node_by_fd(&config->ws_clients, client_fd->fd);
+    if (node == NULL) {
+        MYGPIOD_LOG_ERROR("Could not find fd in WebSocket connection table");
+        return false;
+    }
+    struct t_ws_client *client = (struct t_ws_client *)node->data;
+
+    if (client_fd->revents & (POLLHUP | POLLERR | POLLNVAL)) {
+        MYGPIOD_LOG_DEBUG("WebSocket#%u: Socket closed", node->id);
+        client_close(config, node);
+        return true;
+    }
+    if (client_fd->revents & POLLOUT) {
+        if (flush_output(client) == false) {
+            client_close(config, node);
+            return false;
+        }
+        if (client->closing == true &&
+            sdslen(client->buf_out) == 0)
+        {
+            client_close(config, node);
+            return true;
+        }
+    }
+    if (client_fd->revents & POLLIN) {
+        size_t oldlen = sdslen(client->buf_in);
+        client->buf_in = sdsMakeRoomFor(client->buf_in, WS_MESSAGE_MAX);
+        ssize_t nread = read(client->fd, client->buf_in + oldlen, WS_MESSAGE_MAX);
+        if (nread < 0 &&
+            (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+        {
+            return true;
+        }
+        if (nread <= 0) {
+            MYGPIOD_LOG_DEBUG("WebSocket#%u: Could not read from socket", node->id);
+            client_close(config, node);
+            return false;
+        }
+        sdsIncrLen(client->buf_in, nread);
+        if (parse_frames(config, node) == false ||
+            flush_output(client) == false)
+        {
+            client_close(config, node);
+            return false;
+        }
+        if (client->closing == true &&
+            sdslen(client->buf_out) == 0)
+        {
+            client_close(config, node);
+        }
+    }
+    return true;
+}
+
+/**
+ * Sends an event to all WebSocket clients
+ * @param config Pointer to config
+ * @param json Event as json object
+ */
+void websocket_send_event(struct t_config *config, const char *json) {
+    size_t len = strlen(json);
+    struct t_list_node *current = config->ws_clients.head;
+    while (current != NULL) {
+        struct t_list_node *next = current->next;
+        struct t_ws_client *client = (struct t_ws_client *)current->data;
+        if (client->closing == false) {
+            send_frame(client, WS_OPCODE_TEXT, json, len);
+            if (flush_output(client) == false) {
+                client_close(config, current);
+            }
+        }
+        current = next;
+    }
+}
+
+/**
+ * Closes all WebSocket connections
+ * @param config Pointer to config
+ */
+void websocket_close_all(struct t_config *config) {
+    while (config->ws_clients.head != NULL) {
+        struct t_ws_client *client = (struct t_ws_client *)config->ws_clients.head->data;
+        send_close(client, WS_CLOSE_NORMAL);
+        flush_output(client);
+        client_close(config, config->ws_clients.head);
+    }
+}
+
+// private functions
+
+/**
+ * MHD upgrade handler, adds the connection to the WebSocket clients.
+ * If MHD runs in its own threads, the client is added by the event loop thread.
+ * @param cls Pointer to config
+ * @param connection MHD connection
+ * @param req_cls Connection specific user data
+ * @param extra_in Already received data
+ * @param extra_in_size Size of extra_in
+ * @param sock Socket of the connection
+ * @param urh Upgrade handle
+ */
+static void upgrade_handler(void *cls, struct MHD_Connection *connection, void *req_cls,
+        const char *extra_in, size_t extra_in_size, MHD_socket sock,
+        struct MHD_UpgradeResponseHandle *urh)
+{
+    (void)connection;
+    struct t_config *config = (struct t_config *)cls;
+    struct t_request_data *request_data = (struct t_request_data *)req_cls;
+
+    int flags = fcntl(sock, F_GETFL, 0);
+    if (fcntl(sock, F_SETFL, flags | O_NONBLOCK) == -1) {
+        MYGPIOD_LOG_ERROR("HTTP connection %u: Can not set WebSocket options", request_data->conn_id);
+        MHD_upgrade_action(urh, MHD_UPGRADE_ACTION_CLOSE);
+        return;
+    }
+
+    struct t_ws_client *client = malloc_assert(sizeof(struct t_ws_client));
+    client->fd = sock;
+    client->urh = urh;
+    client->conn_id = request_data->conn_id;
+    client->buf_in = sdsnewlen(extra_in, extra_in_size);
+    client->message = sdsempty();
+    client->buf_out = sdsempty();
+    client->bytes_out = 0;
+    client->events = POLLIN;
+    client->closing = false;
+    client->fragmented = false;
+    if (config->http_threads > 0) {
+        http_cmd_push(config, client_add, client, client_discard);
+        return;
+    }
+    client_add(config, client);
+}
+
+/**
+ * Adds the client to the polled WebSocket clients and handles already received data
+ * @param config Pointer to config
+ * @param data WebSocket client
+ */
+static void client_add(struct t_config *config, void *data) {
+    struct t_ws_client *client = (struct t_ws_client *)data;
+    list_push(&config->ws_clients, client->conn_id, client);
+    update_pollfds = true;
+    MYGPIOD_LOG_INFO("WebSocket#%u: Client connected", client->conn_id);
+
+    if (sdslen(client->buf_in) > 0 &&
+        (parse_frames(config, config->ws_clients.tail) == false ||
+         flush_output(client) == false))
+    {
+        client_close(config, config->ws_clients.tail);
+    }
+}
+
+/**
+ * Parses the received frames and handles complete messages
+ * @param config Pointer to config
+ * @param node Node holding the client
+ * @return true on success, false on protocol error
+ */
+static bool parse_frames(struct t_config *config, struct t_list_node *node) {
+    struct t_ws_client *client = (struct t_ws_client *)node->data;
+    while (client->closing == false) {
+        size_t len = sdslen(client->buf_in);
+        unsigned char *p = (unsigned char *)client->buf_in;
+        if (len < 2) {
+            return true;
+        }
+        bool fin = (p[0] & 0x80) != 0;
+        unsigned opcode = p[0] & 0x0f;
+        bool masked = (p[1] & 0x80) != 0;
+        uint64_t payload_len = p[1] & 0x7f;
+        if ((p[0] & 0x70) != 0) {
+            MYGPIOD_LOG_ERROR("WebSocket#%u: Reserved bits set", node->id);
+            send_close(client, WS_CLOSE_PROTOCOL_ERROR);
+            return true;
+        }
+        if (opcode >= WS_OPCODE_CLOSE &&
+            (fin == false || payload_len > 125))
+        {
+            MYGPIOD_LOG_ERROR("WebSocket#%u: Invalid control frame", node->id);
+            send_close(client, WS_CLOSE_PROTOCOL_ERROR);
+            return true;
+        }
+        if ((opcode == WS_OPCODE_CONTINUATION && client->fragmented == false) ||
+            (opcode == WS_OPCODE_TEXT && client->fragmented == true))
+        {
+            MYGPIOD_LOG_ERROR("WebSocket#%u: Invalid fragmentation", node->id);
+            send_close(client, WS_CLOSE_PROTOCOL_ERROR);
+            return true;
+        }
+        size_t header_len = 2;
+        if (payload_len == 126) {
+            if (len < 4) {
+                return true;
+            }
+            payload_len = ((uint64_t)p[2] << 8) | p[3];
+            header_len = 4;
+        }
+        else if (payload_len == 127) {
+            if (len < 10) {
+                return true;
+            }
+            payload_len = 0;
+            for (size_t i = 2; i < 10; i++) {
+                payload_len = (payload_len << 8) | p[i];
+            }
+            header_len = 10;
+        }
+        if (masked == false) {
+            MYGPIOD_LOG_ERROR("WebSocket#%u: Received unmasked frame", node->id);
+            send_close(client, WS_CLOSE_PROTOCOL_ERROR);
+            return true;
+        }
+        if (payload_len > WS_MESSAGE_MAX) {
+            MYGPIOD_LOG_ERROR("WebSocket#%u: Frame too big", node->id);
+            send_close(client, WS_CLOSE_TOO_BIG);
+            return true;
+        }
+        header_len += 4;
+        if (len < header_len + payload_len) {
+            // Wait for more data
+            return true;
+        }
+        const unsigned char *mask = p + header_len - 4;
+        char *payload = client->buf_in + header_len;
+        for (size_t i = 0; i < payload_len; i++) {
+            payload[i] = (char)(payload[i] ^ mask[i % 4]);
+        }
+        switch(opcode) {
+            case WS_OPCODE_CONTINUATION:
+            case WS_OPCODE_TEXT:
+                if (sdslen(client->message) + payload_len > WS_MESSAGE_MAX) {
+                    MYGPIOD_LOG_ERROR("WebSocket#%u: Message too big", node->id);
+                    send_close(client, WS_CLOSE_TOO_BIG);
+                    return true;
+                }
+                client->message = sdscatlen(client->message, payload, (size_t)payload_len);
+                client->fragmented = fin == false;
+                if (fin == true) {
+                    handle_message(config, node);
+                    sdsclear(client->message);
+                }
+                break;
+            case WS_OPCODE_CLOSE:
+                MYGPIOD_LOG_DEBUG("WebSocket#%u: Close frame received", node->id);
+                send_frame(client, WS_OPCODE_CLOSE, payload, payload_len >= 2 ? 2 : 0);
+                client->closing = true;
+                break;
+            case WS_OPCODE_PING:
+                send_frame(client, WS_OPCODE_PONG, payload, (size_t)payload_len);
+                break;
+            case WS_OPCODE_PONG:
+                break;
+            default:
+                MYGPIOD_LOG_ERROR("WebSocket#%u: Unsupported opcode %u", node->id, opcode);
+                send_close(client, WS_CLOSE_UNSUPPORTED);
+                return true;
+        }
+        sdsrange(client->buf_in, (ssize_t)(header_len + payload_len), -1);
+    }
+    return true;
+}
+
+/**
+ * Handles a complete json command message and sends the response
+ * @param config Pointer to config
+ * @param node Node holding the client
+ */
+static void handle_message(struct t_config *config, struct t_list_node *node) {
+    struct t_ws_client *client = (struct t_ws_client *)node->data;
+    MYGPIOD_LOG_DEBUG("WebSocket#%u: Received message \"%s\"", node->id, client->message);
+    sds buffer = sdsempty();
+    struct t_json_object cmd;
+    bool rc = false;
+    const char *end = json_parse_object(client->message, &cmd);
+    if (end == NULL ||
+        json_skip_ws(end) != client->message + sdslen(client->message))
+    {
+        MYGPIOD_LOG_WARN("WebSocket#%u: Invalid json message", node->id);
+        buffer = sdscat(buffer, "{\"response\":{\"error\":\"Invalid json\"}}");
+    }
+    else {
+        buffer = sdscat(buffer, "{");
+        unsigned id;
+        const char *id_str = json_object_get(&cmd, "id");
+        if (id_str != NULL &&
+            mygpio_parse_uint(id_str, &id, NULL, 0, UINT_MAX) == true)
+        {
+            buffer = sdscatfmt(buffer, "\"id\":%u,", id);
+        }
+        buffer = sdscat(buffer, "\"response\":");
+        buffer = handle_command(config, &cmd, buffer, &rc);
+        buffer = sdscatlen(buffer, "}", 1);
+        if (rc == false) {
+            MYGPIOD_LOG_DEBUG("WebSocket#%u: Command failed", node->id);
+        }
+    }
+    json_object_clear(&cmd);
+    send_frame(client, WS_OPCODE_TEXT, buffer, sdslen(buffer));
+    FREE_SDS(buffer);
+}
+
+/**
+ * Executes a json command
+ * @param config Pointer to config
+ * @param cmd Parsed command
+ * @param buffer Already allocated buffer to append the response
+ * @param rc Pointer to bool to set the result code
+ * @return Pointer to buffer
+ */
+static sds handle_command(struct t_config *config, struct t_json_object *cmd, sds buffer, bool *rc) {
+    const char *cmd_name = json_object_get(cmd, "cmd");
+    if (cmd_name == NULL) {
+        *rc = false;
+        return sdscat(buffer, "{\"error\":\"Missing cmd\"}");
+    }
+    if (strcmp(cmd_name, "gpiolist") == 0) {
+        return rest_api_gpio_get(config, buffer, json_object_get(cmd, "gpios"), rc);
+    }
+
+    const char *gpio_str = json_object_get(cmd, "gpio");
+    unsigned gpio_nr;
+    if (gpio_str == NULL ||
+        mygpio_parse_uint(gpio_str, &gpio_nr, NULL, 0, GPIOS_MAX) == false)
+    {
+        *rc = false;
+        return sdscat(buffer, "{\"error\":\"Invalid GPIO number\"}");
+    }
+    if (strcmp(cmd_name, "gpioget") == 0) {
+        return rest_api_gpio_gpio_get(config, buffer, gpio_nr, rc);
+    }
+    if (strcmp(cmd_name, "gpioinfo") == 0) {
+        return rest_api_gpio_gpio_options(config, buffer, gpio_nr, rc);
+    }
+    if (strcmp(cmd_name, "gpioset") == 0) {
+        return rest_api_gpio_gpio_set(config, buffer, gpio_nr, json_object_get(cmd, "value"), rc);
+    }
+    if (strcmp(cmd_name, "gpiotoggle") == 0) {
+        return rest_api_gpio_gpio_toggle(config, buffer, gpio_nr, rc);
+    }
+    if (strcmp(cmd_name, "gpioblink") == 0) {
+        return rest_api_gpio_gpio_blink(config, buffer, gpio_nr,
+            json_object_get(cmd, "timeout"), json_object_get(cmd, "interval"), rc);
+    }
+    *rc = false;
+    return sdscat(buffer, "{\"error\":\"Invalid cmd\"}");
+}
+
+/**
+ * Appends a frame to the output buffer
+ * @param client WebSocket client
+ * @param opcode Frame opcode
+ * @param payload Payload
+ * @param len Payload length
+ */
+static void send_frame(struct t_ws_client *client, enum ws_opcodes opcode, const char *payload, size_t len) {
+    unsigned char header[10];
+    size_t header_len;
+    header[0] = (unsigned char)(0x80 | opcode);
+    if (len < 126) {
+        header[1] = (unsigned char)len;
+        header_len = 2;
+    }
+    else if (len <= 0xFFFF) {
+        header[1] = 126;
+        header[2] = (unsigned char)(len >> 8);
+        header[3] = (unsigned char)len;
+        header_len = 4;
+    }
+    else {
+        header[1] = 127;
+        for (size_t i = 0; i < 8; i++) {
+            header[2 + i] = (unsigned char)((uint64_t)len >> (56 - i * 8));
+        }
+        header_len = 10;
+    }
+    client->buf_out = sdscatlen(client->buf_out, header, header_len);
+    client->buf_out = sdscatlen(client->buf_out, payload, len);
+}
+
+/**
+ * Sends a close frame and closes the connection after the output buffer is sent
+ * @param client WebSocket client
+ * @param code Close status code
+ */
+static void send_close(struct t_ws_client *client, enum ws_close_codes code) {
+    char payload[2] = {
+        (char)((unsigned)code >> 8),
+        (char)((unsigned)code & 0xFF)
+    };
+    send_frame(client, WS_OPCODE_CLOSE, payload, 2);
+    client->closing = true;
+}
+
+/**
+ * Writes the output buffer to the socket without blocking
+ * @param client WebSocket client
+ * @return true on success or if the socket is not writeable, false on error
+ */
+static bool flush_output(struct t_ws_client *client) {
+    size_t max_bytes = sdslen(client->buf_out) - client->bytes_out;
+    if (max_bytes > 0) {
+        ssize_t result = send(client->fd, client->buf_out + client->bytes_out, max_bytes, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (result < 0) {
+            if (errno != EAGAIN &&
+                errno != EWOULDBLOCK &&
+                errno != EINTR)
+            {
+                return false;
+            }
+            result = 0;
+        }
+        client->bytes_out += (size_t)result;
+    }
+    short events = POLLIN;
+    if (client->bytes_out == sdslen(client->buf_out)) {
+        sdsclear(client->buf_out);
+        client->bytes_out = 0;
+    }
+    else if (sdslen(client->buf_out) - client->bytes_out > WS_BUFFER_OUT_MAX) {
+        MYGPIOD_LOG_WARN("WebSocket client is too slow");
+        return false;
+    }
+    else {
+        events |= POLLOUT;
+    }
+    if (client->events != events) {
+        client->events = events;
+        update_pollfds = true;
+    }
+    return true;
+}
+
+/**
+ * Removes the client from the list and hands the socket back to MHD for closing.
+ * If MHD runs in its own threads, the socket is closed through the HTTP command
+ * queue after it was removed from the poll set, MHD could reuse the fd otherwise.
+ * @param config Pointer to config
+ * @param node Node holding the client
+ */
+static void client_close(struct t_config *config, struct t_list_node *node) {
+    MYGPIOD_LOG_INFO("WebSocket#%u: Connection closed", node->id);
+    struct t_ws_client *client = (struct t_ws_client *)node->data;
+    list_remove_node(&config->ws_clients, node);
+    if (config->http_threads > 0) {
+        http_cmd_push(config, upgrade_close, client->urh, upgrade_close_discard);
+    }
+    else {
+        MHD_upgrade_action(client->urh, MHD_UPGRADE_ACTION_CLOSE);
+    }
+    client_data_free(client);
+    FREE_PTR(node);
+    update_pollfds = true;
+}
+
+/**
+ * Hands the socket of a not yet added client back to MHD and frees the client
+ * @param data WebSocket client
+ */
+static void client_discard(void *data) {
+    struct t_ws_client *client = (struct t_ws_client *)data;
+    MHD_upgrade_action(client->urh, MHD_UPGRADE_ACTION_CLOSE);
+    client_data_free(client);
+}
+
+/**
+ * HTTP command callback that hands the socket back to MHD for closing
+ * @param config Pointer to config
+ * @param data MHD upgrade handle
+ */
+static void upgrade_close(struct t_config *config, void *data) {
+    (void)config;
+    MHD_upgrade_action((struct MHD_UpgradeResponseHandle *)data, MHD_UPGRADE_ACTION_CLOSE);
+}
+
+/**
+ * Closes the socket if the HTTP command is discarded
+ * @param data MHD upgrade handle
+ */
+static void upgrade_close_discard(void *data) {
+    MHD_upgrade_action((struct MHD_UpgradeResponseHandle *)data, MHD_UPGRADE_ACTION_CLOSE);
+}
+
+/**
+ * Frees the WebSocket client
+ * @param data WebSocket client
+ */
+static void client_data_free(void *data) {
+    struct t_ws_client *client = (struct t_ws_client *)data;
+    FREE_SDS(client->buf_in);
+    FREE_SDS(client->message);
+    FREE_SDS(client->buf_out);
+    FREE_PTR(client);
+}
+
+/**
+ * Gets the client node by socket
+ * @param clients List of WebSocket clients
+ * @param fd Socket
+ * @return The list node or NULL if not found
+ */
+static struct t_list_node *get_node_by_fd(struct t_list *clients, int fd) {
+    struct t_list_node *current = clients->head;
+    while (current != NULL) {
+        struct t_ws_client *client = (struct t_ws_client *)current->data;
+        if (client->fd == fd) {
+            return current;
+        }
+        current = current->next;
+    }
+    return NULL;
+}
+
+/**
+ * Appends base64 encoded data
+ * @param s sds string to append to
+ * @param data Data to encode
+ * @param len Length of data
+ * @return Modified sds string
+ */
+static sds sds_catbase64(sds s, const uint8_t *data, size_t len) {
+    static const char *chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    for (size_t i = 0; i < len; i += 3) {
+        uint32_t v = (uint32_t)data[i] << 16;
+        if (i + 1 < len) {
+            v |= (uint32_t)data[i + 1] << 8;
+        }
+        if (i + 2 < len) {
+            v |= data[i + 2];
+        }
+        char out[4] = {
+            chars[(v >> 18) & 0x3F],
+            chars[(v >> 12) & 0x3F],
+            i + 1 < len ? chars[(v >> 6) & 0x3F] : '=',
+            i + 2 < len ? chars[v & 0x3F] : '='
+        };
+        s = sdscatlen(s, out, 4);
+    }
+    return s;
+}
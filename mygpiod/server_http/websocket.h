@@ -0,0 +1,53 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief WebSocket endpoint
+ */
+
+#ifndef MYGPIOD_SERVER_HTTPD_WEBSOCKET_H
+#define MYGPIOD_SERVER_HTTPD_WEBSOCKET_H
+
+#include "dist/sds/sds.h"
+#include "mygpiod/config/config.h"
+#include "mygpiod/server_http/util.h"
+
+#include <microhttpd.h>
+#include <poll.h>
+
+/**
+ * Maximum size of a received message
+ */
+#define WS_MESSAGE_MAX 4096
+
+/**
+ * Maximum size of the output buffer, slower clients are disconnected
+ */
+#define WS_BUFFER_OUT_MAX 65536
+
+/**
+ * WebSocket client connection
+ */
+struct t_ws_client {
+    int fd;                                  //!< Socket, owned by MHD
+    struct MHD_UpgradeResponseHandle *urh;   //!< MHD upgrade handle
+    unsigned conn_id;                        //!< HTTP connection id
+    sds buf_in;                              //!< Received raw frames
+    sds message;                             //!< Message assembled from frames
+    sds buf_out;                             //!< Outgoing frames
+    size_t bytes_out;                        //!< Bytes of buf_out already sent
+    short events;                            //!< Events to poll
+    bool closing;                            //!< Close after the output buffer is sent
+    bool fragmented;                         //!< A fragmented message is being received
+};
+
+enum MHD_Result websocket_handler(struct t_request_data *request_data,
+                                  struct t_config *config);
+bool websocket_client_handle(struct t_config *config, struct pollfd *client_fd);
+void websocket_send_event(struct t_config *config, const char *json);
+void websocket_close_all(struct t_config *config);
+
+#endif
@@ -15,61 +15,178 @@
 #include "mygpiod/server_http/util.h"
 
 #include <microhttpd.h>
+#include <stdbool.h>
+#include <stdio.h>
 #include <string.h>
 
+// private definitions
+
 /**
- * Creates a MHD response object for an embedded file
+ * Embedded file
+ */
+struct t_embedded_file {
+    const char *url;                //!< URL path
+    const char *mimetype;           //!< Content-Type
+    const unsigned char *data;      //!< Uncompressed content
+    const unsigned int *size;       //!< Size of the uncompressed content
+    const unsigned char *gz_data;   //!< Gzip compressed content
+    const unsigned int *gz_size;    //!< Size of the gzip compressed content
+    const char *etag;               //!< Content hash
+};
+
+/**
+ * Macro to populate the embedded files table
+ */
+#define EMBEDDED_FILE(URL, MIMETYPE, NAME) { URL, MIMETYPE, NAME##_data, &NAME##_size, \
+    NAME##_gz_data, &NAME##_gz_size, NAME##_etag }
+
+/**
+ * Embedded files table
+ */
+static const struct t_embedded_file embedded_files[] = {
+    EMBEDDED_FILE("/", "text/html; charset=utf-8", index_html),
+    EMBEDDED_FILE("/bootstrap-native.min.js", "application/javascript", bootstrap_native_min_js),
+    EMBEDDED_FILE("/bootstrap.min.css", "text/css", bootstrap_min_css),
+    EMBEDDED_FILE("/favicon.svg", "image/svg+xml", favicon_svg),
+    EMBEDDED_FILE("/index.html", "text/html; charset=utf-8", index_html),
+    EMBEDDED_FILE("/mygpiod.css", "text/css", mygpiod_css),
+    EMBEDDED_FILE("/mygpiod.js", "application/javascript", mygpiod_js),
+    EMBEDDED_FILE("/openapi.yml", "text/yaml", openapi_yml),
+    { NULL, NULL, NULL, NULL, NULL, NULL, NULL }
+};
+
+static const struct t_embedded_file *get_embedded_file(const char *url);
+static bool accepts_gzip(const char *accept_encoding);
+static bool etag_matches(const char *if_none_match, const char *etag);
+static void add_cache_headers(struct MHD_Response *response, const char *etag);
+
+// public functions
+
+/**
+ * Request handler for the WebUI.
+ * Serves the gzip compressed assets if the client accepts it and
+ * responds with 304 if the client has a current copy.
+ * @param request_data User data from a MHD connection
  * @param url URL
- * @return struct MHD_Response* 
+ * @return enum MHD_Result 
  */
-static struct MHD_Response *serve_embedded_file(const char *url) {
-    struct MHD_Response *response = NULL;
-    if (strcmp(url, "/bootstrap-native.min.js") == 0) {
-        response = MHD_create_response_from_buffer(bootstrap_native_min_js_size, (void *)bootstrap_native_min_js_data, MHD_RESPMEM_PERSISTENT);
-        MHD_add_response_header(response, "Content-Type", "application/javascript");
+enum MHD_Result webui_handler(struct t_request_data *request_data, const char *url) {
+    struct MHD_Connection *connection = request_data->connection;
+    const struct t_embedded_file *file = get_embedded_file(url);
+    if (file == NULL) {
+        return http_respond(request_data, MHD_HTTP_NOT_FOUND, "text/plain; charset=utf-8", "File not found.");
     }
-    else if (strcmp(url, "/bootstrap.min.css") == 0) {
-        response = MHD_create_response_from_buffer(bootstrap_min_css_size, (void *)bootstrap_min_css_data, MHD_RESPMEM_PERSISTENT);
-        MHD_add_response_header(response, "Content-Type", "text/css");
+    bool gzip = accepts_gzip(MHD_lookup_connection_value(connection, MHD_HEADER_KIND, "Accept-Encoding"));
+    char etag[64];
+    snprintf(etag, sizeof(etag), "\"%s%s\"", file->etag, (gzip == true ? "-gz" : ""));
+
+    unsigned http_response_code = MHD_HTTP_OK;
+    struct MHD_Response *response;
+    if (etag_matches(MHD_lookup_connection_value(connection, MHD_HEADER_KIND, "If-None-Match"), file->etag) == true) {
+        http_response_code = MHD_HTTP_NOT_MODIFIED;
+        response = MHD_create_response_from_buffer(0, NULL, MHD_RESPMEM_PERSISTENT);
     }
-    else if (strcmp(url, "/favicon.svg") == 0) {
-        response = MHD_create_response_from_buffer(favicon_svg_size, (void *)favicon_svg_data, MHD_RESPMEM_PERSISTENT);
-        MHD_add_response_header(response, "Content-Type", "image/svg+xml");
+    else if (gzip == true) {
+        response = MHD_create_response_from_buffer(*file->gz_size, (void *)file->gz_data, MHD_RESPMEM_PERSISTENT);
+        MHD_add_response_header(response, "Content-Type", file->mimetype);
+        MHD_add_response_header(response, "Content-Encoding", "gzip");
     }
-    else if (strcmp(url, "/index.html") == 0 ||
-             strcmp(url, "/") == 0)
-    {
-        response = MHD_create_response_from_buffer(index_html_size, (void *)index_html_data, MHD_RESPMEM_PERSISTENT);
-        MHD_add_response_header(response, "Content-Type", "text/html; charset=utf-8");
+    else {
+        response = MHD_create_response_from_buffer(*file->size, (void *)file->data, MHD_RESPMEM_PERSISTENT);
+        MHD_add_response_header(response, "Content-Type", file->mimetype);
     }
-    else if (strcmp(url, "/mygpiod.css") == 0) {
-        response = MHD_create_response_from_buffer(mygpiod_css_size, (void *)mygpiod_css_data, MHD_RESPMEM_PERSISTENT);
-        MHD_add_response_header(response, "Content-Type", "text/css");
+    add_cache_headers(response, etag);
+    return http_queue_response(request_data, http_response_code, response);
+}
+
+// private functions
+
+/**
+ * Looks up the embedded file for an URL
+ * @param url URL
+ * @return Pointer to the embedded file or NULL if not found
+ */
+static const struct t_embedded_file *get_embedded_file(const char *url) {
+    for (const struct t_embedded_file *p = embedded_files; p->url != NULL; p++) {
+        if (strcmp(url, p->url) == 0) {
+            return p;
+        }
     }
-    else if (strcmp(url, "/mygpiod.js") == 0) {
-        response = MHD_create_response_from_buffer(mygpiod_js_size, (void *)mygpiod_js_data, MHD_RESPMEM_PERSISTENT);
-        MHD_add_response_header(response, "Content-Type", "application/javascript");
+    return NULL;
+}
+
+/**
+ * Checks if the Accept-Encoding header allows gzip
+ * @param accept_encoding Value of the Accept-Encoding header or NULL
+ * @return true if gzip is accepted, else false
+ */
+static bool accepts_gzip(const char *accept_encoding) {
+    if (accept_encoding == NULL) {
+        return false;
     }
-    else if (strcmp(url, "/openapi.yml") == 0) {
-        response = MHD_create_response_from_buffer(openapi_yml_size, (void *)openapi_yml_data, MHD_RESPMEM_PERSISTENT);
-        MHD_add_response_header(response, "Content-Type", "text/yaml");
+    const char *p = accept_encoding;
+    while ((p = strstr(p, "gzip")) != NULL) {
+        if ((p == accept_encoding || p[-1] == ',' || p[-1] == ' ') &&
+            (p[4] == '\0' || p[4] == ',' || p[4] == ';' || p[4] == ' '))
+        {
+            // Check for a q=0 parameter
+            const char *q = p + 4;
+            while (*q == ' ' || *q == ';') {
+                q++;
+            }
+            if (strncmp(q, "q=0", 3) == 0 &&
+                strspn(q + 3, ".0") == strcspn(q + 3, ", "))
+            {
+                return false;
+            }
+            return true;
+        }
+        p += 4;
     }
-    return response;
+    return false;
 }
 
 /**
- * Request handler for the WebUI
- * @param connection HTTP connection
- * @param url URL
- * @return enum MHD_Result 
+ * Checks if the If-None-Match header matches the etag.
+ * Uses the weak comparison, the compression suffix is ignored.
+ * @param if_none_match Value of the If-None-Match header or NULL
+ * @param etag Content hash of the embedded file
+ * @return true on match, else false
  */
-enum MHD_Result webui_handler(struct MHD_Connection *connection, const char *url) {
-    unsigned http_response_code = MHD_HTTP_OK;
-    struct MHD_Response *response = serve_embedded_file(url);
-    if (response != NULL) {
-        enum MHD_Result result = MHD_queue_response(connection, http_response_code, response);
-        MHD_destroy_response(response);
-        return result;
+static bool etag_matches(const char *if_none_match, const char *etag) {
+    if (if_none_match == NULL) {
+        return false;
+    }
+    if (strcmp(if_none_match, "*") == 0) {
+        return true;
+    }
+    size_t etag_len = strlen(etag);
+    const char *p = if_none_match;
+    while ((p = strchr(p, '"')) != NULL) {
+        p++;
+        if (strncmp(p, etag, etag_len) == 0 &&
+            (p[etag_len] == '"' || strncmp(p + etag_len, "-gz\"", 4) == 0))
+        {
+            return true;
+        }
+        // Skip to the closing quote
+        p = strchr(p, '"');
+        if (p == NULL) {
+            break;
+        }
+        p++;
     }
-    return http_respond(connection, MHD_HTTP_NOT_FOUND, "text/plain; charset=utf-8", "File not found.");
+    return false;
+}
+
+/**
+ * Adds the caching headers.
+ * The assets are not versioned by URL, clients must revalidate them.
+ * @param response MHD response
+ * @param etag Quoted ETag
+ */
+static void add_cache_headers(struct MHD_Response *response, const char *etag) {
+    MHD_add_response_header(response, "ETag", etag);
+    MHD_add_response_header(response, "Cache-Control", "no-cache");
+    MHD_add_response_header(response, "Vary", "Accept-Encoding");
 }
@@ -11,8 +11,10 @@
 #ifndef MYGPIOD_SERVER_HTTPD_WEBUI_H
 #define MYGPIOD_SERVER_HTTPD_WEBUI_H
 
+#include "mygpiod/server_http/util.h"
+
 #include <microhttpd.h>
 
-enum MHD_Result webui_handler(struct MHD_Connection *connection, const char *url);
+enum MHD_Result webui_handler(struct t_request_data *request_data, const char *url);
 
 #endif
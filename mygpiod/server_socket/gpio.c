@@ -31,26 +31,26 @@
 bool handle_gpiolist(struct t_config *config, struct t_list_node *client_node) {
     struct t_client_data *client_data = (struct t_client_data *)client_node->data;
     server_response_start(client_data);
-    server_response_append(client_data, "%s", DEFAULT_MSG_OK);
+    server_response_append_line(client_data, DEFAULT_MSG_OK);
     struct t_list_node *current = config->gpios_in.head;
     while (current != NULL) {
         struct t_gpio_in_data *data = (struct t_gpio_in_data *)current->data;
-        server_response_append(client_data, "gpio:%u", current->id);
-        server_response_append(client_data, "direction:in");
-        server_response_append(client_data, "value:%s", lookup_gpio_value(gpio_get_value(config, current->id)));
-        server_response_append(client_data, "name:%s", data->name);
+        server_response_append_kv_uint(client_data, "gpio", current->id);
+        server_response_append_kv(client_data, "direction", "in");
+        server_response_append_kv(client_data, "value", lookup_gpio_value(gpio_get_value(config, current->id)));
+        server_response_append_kv(client_data, "name", data->name);
         current = current->next;
     }
     current = config->gpios_out.head;
     while (current != NULL) {
         struct t_gpio_out_data *data = (struct t_gpio_out_data *)current->data;
-        server_response_append(client_data, "gpio:%u", current->id);
-        server_response_append(client_data, "direction:out");
-        server_response_append(client_data, "value:%s", lookup_gpio_value(gpio_get_value(config, current->id)));
-        server_response_append(client_data, "name:%s", data->name);
+        server_response_append_kv_uint(client_data, "gpio", current->id);
+        server_response_append_kv(client_data, "direction", "out");
+        server_response_append_kv(client_data, "value", lookup_gpio_value(gpio_get_value(config, current->id)));
+        server_response_append_kv(client_data, "name", data->name);
         current = current->next;
     }
-    server_response_append(client_data, "%s", DEFAULT_MSG_END);
+    server_response_append_line(client_data, DEFAULT_MSG_END);
     server_response_end(client_data);
     return true;
 }
@@ -86,21 +86,21 @@ bool handle_gpioinfo(struct t_cmd_options *options, struct t_config *config, str
     }
 
     server_response_start(client_data);
-    server_response_append(client_data, "%s", DEFAULT_MSG_OK);
-    server_response_append(client_data, "gpio:%u", gpio);
+    server_response_append_line(client_data, DEFAULT_MSG_OK);
+    server_response_append_kv_uint(client_data, "gpio", gpio);
     if (gpio_direction == GPIOD_LINE_DIRECTION_INPUT) {
         struct gpiod_line_info *info = gpiod_chip_get_line_info(config->chip, node->id);
         struct t_gpio_in_data *data = (struct t_gpio_in_data *)node->data;
         if (info != NULL) {
-            server_response_append(client_data, "direction:in");
-            server_response_append(client_data, "value:%s", lookup_gpio_value(gpio_get_value(config, gpio)));
-            server_response_append(client_data, "active_low:%s", mygpio_bool_to_str(gpiod_line_info_is_active_low(info)));
-            server_response_append(client_data, "bias:%s", lookup_bias(gpiod_line_info_get_bias(info)));
-            server_response_append(client_data, "event_request:%s", lookup_event_request(gpiod_line_info_get_edge_detection(info)));
-            server_response_append(client_data, "is_debounced:%s", mygpio_bool_to_str(gpiod_line_info_is_debounced(info)));
-            server_response_append(client_data, "debounce_period_us:%lu", gpiod_line_info_get_debounce_period_us(info));
-            server_response_append(client_data, "event_clock:%s", lookup_event_clock(gpiod_line_info_get_event_clock(info)));
-            server_response_append(client_data, "name:%s", data->name);
+            server_response_append_kv(client_data, "direction", "in");
+            server_response_append_kv(client_data, "value", lookup_gpio_value(gpio_get_value(config, gpio)));
+            server_response_append_kv(client_data, "active_low", mygpio_bool_to_str(gpiod_line_info_is_active_low(info)));
+            server_response_append_kv(client_data, "bias", lookup_bias(gpiod_line_info_get_bias(info)));
+            server_response_append_kv(client_data, "event_request", lookup_event_request(gpiod_line_info_get_edge_detection(info)));
+            server_response_append_kv(client_data, "is_debounced", mygpio_bool_to_str(gpiod_line_info_is_debounced(info)));
+            server_response_append_kv_uint(client_data, "debounce_period_us", gpiod_line_info_get_debounce_period_us(info));
+            server_response_append_kv(client_data, "event_clock", lookup_event_clock(gpiod_line_info_get_event_clock(info)));
+            server_response_append_kv(client_data, "name", data->name);
             gpiod_line_info_free(info);
         }
     }
@@ -108,14 +108,14 @@ bool handle_gpioinfo(struct t_cmd_options *options, struct t_config *config, str
         struct gpiod_line_info *info = gpiod_chip_get_line_info(config->chip, node->id);
         struct t_gpio_out_data *data = (struct t_gpio_out_data *)node->data;
         if (info != NULL) {
-            server_response_append(client_data, "direction:out");
-            server_response_append(client_data, "value:%s", lookup_gpio_value(gpio_get_value(config, gpio)));
-            server_response_append(client_data, "drive:%s", lookup_drive(gpiod_line_info_get_drive(info)));
-            server_response_append(client_data, "name:%s", data->name);
+            server_response_append_kv(client_data, "direction", "out");
+            server_response_append_kv(client_data, "value", lookup_gpio_value(gpio_get_value(config, gpio)));
+            server_response_append_kv(client_data, "drive", lookup_drive(gpiod_line_info_get_drive(info)));
+            server_response_append_kv(client_data, "name", data->name);
             gpiod_line_info_free(info);
         }
     }
-    server_response_append(client_data, "%s", DEFAULT_MSG_END);
+    server_response_append_line(client_data, DEFAULT_MSG_END);
     server_response_end(client_data);
     return true;
 }
@@ -144,9 +144,9 @@ bool handle_gpioget(struct t_cmd_options *options, struct t_config *config, stru
         return false;
     }
     server_response_start(client_data);
-    server_response_append(client_data, "%s", DEFAULT_MSG_OK);
-    server_response_append(client_data, "value:%s", lookup_gpio_value(value));
-    server_response_append(client_data, "%s", DEFAULT_MSG_END);
+    server_response_append_line(client_data, DEFAULT_MSG_OK);
+    server_response_append_kv(client_data, "value", lookup_gpio_value(value));
+    server_response_append_line(client_data, DEFAULT_MSG_END);
     server_response_end(client_data);
     return true;
 }
@@ -68,26 +68,49 @@ bool send_idle_events(struct t_list_node *client_node, bool send_ok) {
 
     server_response_start(client_data);
     if (send_ok == true) {
-        server_response_append(client_data, "%s", DEFAULT_MSG_OK);
+        server_response_append_line(client_data, DEFAULT_MSG_OK);
     }
     struct t_list_node *current = client_data->waiting_events.head;
     while (current != NULL) {
         struct t_event_data *event_data = (struct t_event_data *)current->data;
-        server_response_append(client_data, "event:%s", mygpiod_event_name(event_data->mygpiod_event_type));
-        server_response_append(client_data, "timestamp_ms:%llu", (long long unsigned)(event_data->timestamp_ns / 1000000));
+        server_response_append_kv(client_data, "event", mygpiod_event_name(event_data->mygpiod_event_type));
+        server_response_append_kv_uint(client_data, "timestamp_ms", event_data->timestamp_ns / 1000000);
         if (event_data->mygpiod_event_type == MYGPIOD_EVENT_INPUT) {
-            server_response_append(client_data, "device:%s", event_data->input_event.device->name);
-            server_response_append(client_data, "type:%s", input_event_type_name(event_data->input_event.data.type));
-            server_response_append(client_data, "code:%s", input_event_code_name(event_data->input_event.data.type, event_data->input_event.data.code));
-            server_response_append(client_data, "value:%u", event_data->input_event.data.value);
+            server_response_append_kv(client_data, "device", event_data->input_event.device->name);
+            server_response_append_kv(client_data, "type", input_event_type_name(event_data->input_event.data.type));
+            server_response_append_kv(client_data, "code", input_event_code_name(event_data->input_event.data.type, event_data->input_event.data.code));
+            server_response_append_kv_uint(client_data, "value", (uint32_t)event_data->input_event.data.value);
+        }
+        else if (event_data->mygpiod_event_type == MYGPIOD_EVENT_HTTP_DONE) {
+            server_response_append_kv(client_data, "uri", event_data->uri);
+            server_response_append_kv_uint(client_data, "status", event_data->http_status);
+            server_response_append_kv_uint(client_data, "duration_ms", event_data->duration_ms);
+        }
+        else if (event_data->mygpiod_event_type == MYGPIOD_EVENT_SYSTEM_DONE) {
+            server_response_append_kv(client_data, "command", event_data->cmd);
+            server_response_append_kv_int(client_data, "exit_code", event_data->exit_code);
+            server_response_append_kv_uint(client_data, "duration_ms", event_data->duration_ms);
+        }
+        else if (event_data->mygpiod_event_type == MYGPIOD_EVENT_LUA_TIMEOUT) {
+            server_response_append_kv(client_data, "script", event_data->lua_script);
+            server_response_append_kv(client_data, "vm", event_data->lua_vm);
+            server_response_append_kv(client_data, "reason", event_data->lua_reason);
+            server_response_append_kv_uint(client_data, "duration_ms", event_data->duration_ms);
+        }
+        else if (event_data->mygpiod_event_type == MYGPIOD_EVENT_MPD_PLAYER) {
+            server_response_append_kv(client_data, "state", event_data->mpd_state);
+            server_response_append_kv_int(client_data, "song_pos", event_data->mpd_song_pos);
+        }
+        else if (event_data->mygpiod_event_type == MYGPIOD_EVENT_MPD_MIXER) {
+            server_response_append_kv_int(client_data, "volume", event_data->mpd_volume);
         }
         else {
-            server_response_append(client_data, "gpio:%u", current->id);
+            server_response_append_kv_uint(client_data, "gpio", current->id);
         }
         current = current -> next;
     }
     list_clear(&client_data->waiting_events, event_data_clear);
-    server_response_append(client_data, "%s", DEFAULT_MSG_END);
+    server_response_append_line(client_data, DEFAULT_MSG_END);
     server_response_end(client_data);
     return true;
 }
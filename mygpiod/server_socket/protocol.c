@@ -19,6 +19,7 @@
 #include "mygpiod/server_socket/raspberry.h"
 #include "mygpiod/server_socket/response.h"
 #include "mygpiod/server_socket/socket.h"
+#include "mygpiod/server_socket/stats.h"
 #include "mygpiod/server_socket/timerev.h"
 #include "protocol.h"
 
@@ -125,6 +126,9 @@ bool server_protocol_handler(struct t_config *config, struct t_list_node *client
         case CMD_TIMEREVLIST:
             rc = handle_timerevlist(config, client_node);
             break;
+        case CMD_STATS:
+            rc = handle_stats(config, client_node);
+            break;
         case CMD_INVALID:
         case CMD_COUNT:
             MYGPIOD_LOG_ERROR("Client#%u: Invalid command", client_node->id);
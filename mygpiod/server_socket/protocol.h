@@ -36,6 +36,7 @@
     X(CMD_VCIOTHROTTLED) \
     X(CMD_HOOK) \
     X(CMD_TIMEREVLIST) \
+    X(CMD_STATS) \
     X(CMD_COUNT)
 
 /**
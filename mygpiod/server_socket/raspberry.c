@@ -34,9 +34,9 @@ bool handle_raspberry_vcio(struct t_list_node *client_node, const char *command)
         return false;
     }
     server_response_start(client_data);
-    server_response_append(client_data, "%s", DEFAULT_MSG_OK);
-    server_response_append(client_data, "value:%s", result);
-    server_response_append(client_data, "%s", DEFAULT_MSG_END);
+    server_response_append_line(client_data, DEFAULT_MSG_OK);
+    server_response_append_kv(client_data, "value", result);
+    server_response_append_line(client_data, DEFAULT_MSG_END);
     server_response_end(client_data);
     FREE_SDS(result);
     return true;
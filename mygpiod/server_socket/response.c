@@ -13,8 +13,30 @@
 
 #include "mygpiod/event_loop/event_loop.h"
 
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+// private definitions
+
+/**
+ * Buffer size for a formatted 64 bit integer including sign
+ */
+#define INT64_STR_LEN 21
+
+static void response_append_kv_len(struct t_client_data *client_data, const char *key,
+        const char *value, size_t value_len);
+static char *format_uint(char *end, uint64_t value);
+static ssize_t response_write(int fd, struct iovec *iov, int iovcnt);
+static void response_written(struct t_client_data *client_data);
+static void response_wait_writable(struct t_client_data *client_data);
+
+// public functions
+
 /**
  * Starts a new response by clearing the output buffer.
+ * The allocated buffer is reused.
  * @param client_data pointer to client data
  */
 void server_response_start(struct t_client_data *client_data) {
@@ -36,24 +58,227 @@ void server_response_append(struct t_client_data *client_data, const char *fmt,
 }
 
 /**
- * Sets the client state to writing.
- * It sends the response from buf_out to the client.
+ * Appends a line to the output buffer
+ * @param client_data pointer to client data
+ * @param line line to append, without newline
+ */
+void server_response_append_line(struct t_client_data *client_data, const char *line) {
+    size_t len = strlen(line);
+    client_data->buf_out = sdsMakeRoomFor(client_data->buf_out, len + 1);
+    char *p = client_data->buf_out + sdslen(client_data->buf_out);
+    memcpy(p, line, len);
+    p[len] = '\n';
+    sdsIncrLen(client_data->buf_out, (ssize_t)(len + 1));
+}
+
+/**
+ * Appends a key:value line to the output buffer
+ * @param client_data pointer to client data
+ * @param key the key
+ * @param value string value
+ */
+void server_response_append_kv(struct t_client_data *client_data, const char *key, const char *value) {
+    response_append_kv_len(client_data, key, value, strlen(value));
+}
+
+/**
+ * Appends a key:value line with an unsigned integer value to the output buffer
+ * @param client_data pointer to client data
+ * @param key the key
+ * @param value unsigned integer value
+ */
+void server_response_append_kv_uint(struct t_client_data *client_data, const char *key, uint64_t value) {
+    char buf[INT64_STR_LEN];
+    char *end = buf + sizeof(buf);
+    char *start = format_uint(end, value);
+    response_append_kv_len(client_data, key, start, (size_t)(end - start));
+}
+
+/**
+ * Appends a key:value line with a signed integer value to the output buffer
+ * @param client_data pointer to client data
+ * @param key the key
+ * @param value signed integer value
+ */
+void server_response_append_kv_int(struct t_client_data *client_data, const char *key, int64_t value) {
+    char buf[INT64_STR_LEN];
+    char *end = buf + sizeof(buf);
+    char *start;
+    if (value < 0) {
+        start = format_uint(end, (uint64_t)0 - (uint64_t)value);
+        *--start = '-';
+    }
+    else {
+        start = format_uint(end, (uint64_t)value);
+    }
+    response_append_kv_len(client_data, key, start, (size_t)(end - start));
+}
+
+/**
+ * Sets the client state to writing and tries to send the response
+ * from buf_out immediately. If the socket is not writeable, the
+ * remaining bytes are sent after the next POLLOUT event.
  * @param client_data pointer to client data
  */
 void server_response_end(struct t_client_data *client_data) {
     client_data->state = CLIENT_SOCKET_STATE_WRITING;
     client_data->bytes_out = 0;
-    client_data->events = POLLOUT;
-    update_pollfds = true;
+    if (server_response_flush(client_data) == false) {
+        // Let the event loop handle the socket error
+        response_wait_writable(client_data);
+    }
+}
+
+/**
+ * Writes the pending bytes from buf_out to the client socket.
+ * @param client_data pointer to client data
+ * @return true on success or if the socket is not writeable, false on socket error
+ */
+bool server_response_flush(struct t_client_data *client_data) {
+    size_t max_bytes = sdslen(client_data->buf_out) - (size_t)client_data->bytes_out;
+    struct iovec iov = {
+        .iov_base = client_data->buf_out + client_data->bytes_out,
+        .iov_len = max_bytes
+    };
+    ssize_t result = response_write(client_data->fd, &iov, 1);
+    if (result < 0) {
+        if (errno == EAGAIN ||
+            errno == EWOULDBLOCK ||
+            errno == EINTR)
+        {
+            response_wait_writable(client_data);
+            return true;
+        }
+        return false;
+    }
+    client_data->bytes_out += result;
+    if ((size_t)result == max_bytes) {
+        response_written(client_data);
+    }
+    else {
+        response_wait_writable(client_data);
+    }
+    return true;
 }
 
 /**
- * Shortcut for server_response_start, server_response_append and server_response_end.
+ * Sends a single message to the client.
+ * The message is written directly from the given string,
+ * it is only copied to buf_out if the socket is not writeable.
  * @param client_data pointer to client data
  * @param message message to send
  */
 void server_response_send(struct t_client_data *client_data, const char *message) {
-    server_response_start(client_data);
-    server_response_append(client_data, "%s", message);
-    server_response_end(client_data);
+    sdsclear(client_data->buf_out);
+    client_data->state = CLIENT_SOCKET_STATE_WRITING;
+    client_data->bytes_out = 0;
+    struct iovec iov[2] = {
+        { .iov_base = (void *)message, .iov_len = strlen(message) },
+        { .iov_base = (void *)"\n", .iov_len = 1 }
+    };
+    size_t total = iov[0].iov_len + 1;
+    ssize_t result = response_write(client_data->fd, iov, 2);
+    if (result >= 0 &&
+        (size_t)result == total)
+    {
+        response_written(client_data);
+        return;
+    }
+    // Keep the unsent bytes
+    size_t written = result > 0
+        ? (size_t)result
+        : 0;
+    if (written < iov[0].iov_len) {
+        client_data->buf_out = sdscatlen(client_data->buf_out, message + written, iov[0].iov_len - written);
+    }
+    client_data->buf_out = sdscatlen(client_data->buf_out, "\n", 1);
+    response_wait_writable(client_data);
+}
+
+// private functions
+
+/**
+ * Appends a key:value line to the output buffer
+ * @param client_data pointer to client data
+ * @param key the key
+ * @param value the value
+ * @param value_len length of the value
+ */
+static void response_append_kv_len(struct t_client_data *client_data, const char *key,
+        const char *value, size_t value_len)
+{
+    size_t key_len = strlen(key);
+    size_t len = key_len + value_len + 2;
+    client_data->buf_out = sdsMakeRoomFor(client_data->buf_out, len);
+    char *p = client_data->buf_out + sdslen(client_data->buf_out);
+    memcpy(p, key, key_len);
+    p[key_len] = ':';
+    memcpy(p + key_len + 1, value, value_len);
+    p[len - 1] = '\n';
+    sdsIncrLen(client_data->buf_out, (ssize_t)len);
+}
+
+/**
+ * Formats an unsigned integer backwards from end
+ * @param end pointer behind the last char of the buffer
+ * @param value value to format
+ * @return pointer to the first char
+ */
+static char *format_uint(char *end, uint64_t value) {
+    char *p = end;
+    do {
+        *--p = (char)('0' + (value % 10));
+        value /= 10;
+    } while (value > 0);
+    return p;
+}
+
+/**
+ * Writes the iovecs to the socket without blocking and
+ * without raising SIGPIPE.
+ * @param fd socket
+ * @param iov iovec array
+ * @param iovcnt number of iovecs
+ * @return number of bytes written or -1 on error
+ */
+static ssize_t response_write(int fd, struct iovec *iov, int iovcnt) {
+    struct msghdr msg = {
+        .msg_iov = iov,
+        .msg_iovlen = (size_t)iovcnt
+    };
+    errno = 0;
+    return sendmsg(fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+}
+
+/**
+ * Response was completely written, switch back to reading
+ * @param client_data pointer to client data
+ */
+static void response_written(struct t_client_data *client_data) {
+    client_data->state = CLIENT_SOCKET_STATE_READING;
+    client_data->bytes_out = 0;
+    if (sdsalloc(client_data->buf_out) > BUFFER_SIZE_OUTPUT_MAX) {
+        // Shrink the arena after a huge response
+        sdsfree(client_data->buf_out);
+        client_data->buf_out = sdsMakeRoomFor(sdsempty(), BUFFER_SIZE_OUTPUT);
+    }
+    else {
+        sdsclear(client_data->buf_out);
+    }
+    if (client_data->events != POLLIN) {
+        client_data->events = POLLIN;
+        update_pollfds = true;
+    }
+}
+
+/**
+ * Waits for the socket to become writeable
+ * @param client_data pointer to client data
+ */
+static void response_wait_writable(struct t_client_data *client_data) {
+    client_data->state = CLIENT_SOCKET_STATE_WRITING;
+    if (client_data->events != POLLOUT) {
+        client_data->events = POLLOUT;
+        update_pollfds = true;
+    }
 }
@@ -13,6 +13,8 @@
 
 #include "mygpiod/server_socket/socket.h"
 
+#include <stdint.h>
+
 /** 
  * Default message prefix for errors
  */
@@ -32,6 +34,11 @@ void server_response_send(struct t_client_data *client_data, const char *message
 void server_response_start(struct t_client_data *client_data);
 void server_response_append(struct t_client_data *client_data, const char *fmt, ...)
     __attribute__ ((format (printf, 2, 3)));
+void server_response_append_line(struct t_client_data *client_data, const char *line);
+void server_response_append_kv(struct t_client_data *client_data, const char *key, const char *value);
+void server_response_append_kv_uint(struct t_client_data *client_data, const char *key, uint64_t value);
+void server_response_append_kv_int(struct t_client_data *client_data, const char *key, int64_t value);
 void server_response_end(struct t_client_data *client_data);
+bool server_response_flush(struct t_client_data *client_data);
 
 #endif
@@ -24,6 +24,9 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <poll.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -38,6 +41,7 @@
 
 static struct t_list_node *get_node_by_clientfd(struct t_list *clients, int *client_fd);
 static struct t_list_node *get_node_by_timeoutfd(struct t_list *clients, int *timeout_fd);
+static bool set_tcp_options(int fd);
 
 // public functions
 
@@ -74,7 +78,7 @@ int server_socket_create(struct t_config *config) {
         return -1;
     }
 
-    if (listen(fd, 10) < 0) {
+    if (listen(fd, SOCKET_LISTEN_BACKLOG) < 0) {
         MYGPIOD_LOG_ERROR("Can not listen on socket \"%s\"", config->socket_path);
         close(fd);
         return -1;
@@ -83,13 +87,72 @@ int server_socket_create(struct t_config *config) {
     return fd;
 }
 
+/**
+ * Creates the tcp server socket
+ * @param config pointer to config
+ * @return the created socket fd or -1 on error
+ */
+int server_socket_tcp_create(struct t_config *config) {
+    MYGPIOD_LOG_INFO("Creating tcp server socket \"%s:%u\"", config->tcp_ip, config->tcp_port);
+    struct addrinfo hints = { 0 };
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE | AI_NUMERICHOST | AI_NUMERICSERV;
+    char port[6];
+    snprintf(port, sizeof(port), "%u", config->tcp_port);
+    struct addrinfo *res = NULL;
+    int rc = getaddrinfo(config->tcp_ip, port, &hints, &res);
+    if (rc != 0) {
+        MYGPIOD_LOG_ERROR("Invalid tcp listening address \"%s\": %s", config->tcp_ip, gai_strerror(rc));
+        return -1;
+    }
+
+    int fd = socket(res->ai_family, SOCK_STREAM, 0);
+    if (fd == -1) {
+        MYGPIOD_LOG_ERROR("Can not create tcp socket");
+        freeaddrinfo(res);
+        return -1;
+    }
+
+    int flags = fcntl(fd, F_GETFL, 0);
+    int reuse = 1;
+    if (fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1 ||
+        fcntl(fd, F_SETFD, FD_CLOEXEC) == -1 ||
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) == -1)
+    {
+        MYGPIOD_LOG_ERROR("Can not set socket options");
+        freeaddrinfo(res);
+        close(fd);
+        return -1;
+    }
+
+    errno = 0;
+    if (bind(fd, res->ai_addr, res->ai_addrlen) == -1) {
+        MYGPIOD_LOG_ERROR("Can not bind to \"%s:%u\"", config->tcp_ip, config->tcp_port);
+        MYGPIOD_LOG_ERRNO(errno);
+        freeaddrinfo(res);
+        close(fd);
+        return -1;
+    }
+    freeaddrinfo(res);
+
+    if (listen(fd, SOCKET_LISTEN_BACKLOG) < 0) {
+        MYGPIOD_LOG_ERROR("Can not listen on \"%s:%u\"", config->tcp_ip, config->tcp_port);
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
 /**
  * Accepts a new client connection
  * @param config pointer to config
  * @param server_fd server file descriptor
+ * @param tcp true if server_fd is the tcp listener
  * @return true on success, else false
  */
-bool server_client_connection_accept(struct t_config *config, int *server_fd) {
+bool server_client_connection_accept(struct t_config *config, int *server_fd, bool tcp) {
     int client_fd = accept(*server_fd, NULL, NULL);
     if (client_fd < 0) {
         MYGPIOD_LOG_ERROR("Error creating client socket");
@@ -106,11 +169,18 @@ bool server_client_connection_accept(struct t_config *config, int *server_fd) {
         close(client_fd);
         return false;
     }
+    if (tcp == true &&
+        set_tcp_options(client_fd) == false)
+    {
+        MYGPIOD_LOG_ERROR("Can not set tcp socket options");
+        close(client_fd);
+        return false;
+    }
 
     struct t_client_data *data = server_client_connection_new(client_fd);
     config->client_id++;
     list_push(&config->clients, config->client_id, data);
-    MYGPIOD_LOG_INFO("Client#%u: Accepted new connection", config->client_id);
+    MYGPIOD_LOG_INFO("Client#%u: Accepted new %s connection", config->client_id, (tcp == true ? "tcp" : "unix socket"));
     server_response_send(data, DEFAULT_MSG_OK "\nversion:" MYGPIO_VERSION "\n" DEFAULT_MSG_END);
     data->timeout_fd = server_client_connection_set_timeout(data->timeout_fd, config->socket_timeout_s);
     timer_log_next_expire("Client timeout", data->timeout_fd);
@@ -174,21 +244,11 @@ bool server_client_connection_handle(struct t_config *config, struct pollfd *cli
             return true;
         }
         case CLIENT_SOCKET_STATE_WRITING: {
-            size_t max_bytes = sdslen(data->buf_out) - (size_t)data->bytes_out;
-            ssize_t result = write(data->fd, data->buf_out + data->bytes_out, max_bytes);
-            if (result < 0) {
+            if (server_response_flush(data) == false) {
                 MYGPIOD_LOG_ERROR("Client#%u: Could not write to socket", node->id);
                 server_client_disconnect(&config->clients, node);
                 return false;
             }
-            data->bytes_out += result;
-            if ((size_t)result == max_bytes) {
-                MYGPIOD_LOG_DEBUG("Finished writing to socket");
-                data->state = CLIENT_SOCKET_STATE_READING;
-                data->events = POLLIN;
-                update_pollfds = true;
-                sdsclear(data->buf_out);
-            }
             return true;
         }
     }
@@ -207,8 +267,11 @@ struct t_client_data *server_client_connection_new(int client_fd) {
     data->timeout_fd = -1;
     data->state = CLIENT_SOCKET_STATE_WRITING;
     data->buf_in = sdsempty();
-    data->buf_out = sdsempty();
+    data->buf_out = sdsMakeRoomFor(sdsempty(), BUFFER_SIZE_OUTPUT);
+    data->bytes_out = 0;
+    data->events = POLLIN;
     list_init(&data->waiting_events);
+    data->events_dropped = 0;
     update_pollfds = true;
     return data;
 }
@@ -326,3 +389,25 @@ static struct t_list_node *get_node_by_timeoutfd(struct t_list *clients, int *ti
     }
     return NULL;
 }
+
+/**
+ * Disables the nagle algorithm and enables tcp keepalive
+ * @param fd client socket
+ * @return true on success, else false
+ */
+static bool set_tcp_options(int fd) {
+    int on = 1;
+    int keepidle = TCP_KEEPALIVE_IDLE;
+    int keepintvl = TCP_KEEPALIVE_INTERVAL;
+    int keepcnt = TCP_KEEPALIVE_COUNT;
+    if (setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on)) == -1 ||
+        setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &on, sizeof(on)) == -1 ||
+        setsockopt(fd, IPPROTO_TCP, TCP_KEEPIDLE, &keepidle, sizeof(keepidle)) == -1 ||
+        setsockopt(fd, IPPROTO_TCP, TCP_KEEPINTVL, &keepintvl, sizeof(keepintvl)) == -1 ||
+        setsockopt(fd, IPPROTO_TCP, TCP_KEEPCNT, &keepcnt, sizeof(keepcnt)) == -1)
+    {
+        MYGPIOD_LOG_ERRNO(errno);
+        return false;
+    }
+    return true;
+}
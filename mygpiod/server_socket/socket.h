@@ -36,6 +36,36 @@ enum client_socket_state {
  */
 #define BUFFER_SIZE 1024
 
+/**
+ * Preallocated output buffer size
+ */
+#define BUFFER_SIZE_OUTPUT 4096
+
+/**
+ * Output buffers larger than this are shrinked after the response was sent
+ */
+#define BUFFER_SIZE_OUTPUT_MAX 65536
+
+/**
+ * Accept backlog for the listening sockets
+ */
+#define SOCKET_LISTEN_BACKLOG 16
+
+/**
+ * Idle time in seconds before tcp keepalive probes are sent
+ */
+#define TCP_KEEPALIVE_IDLE 60
+
+/**
+ * Interval in seconds between tcp keepalive probes
+ */
+#define TCP_KEEPALIVE_INTERVAL 10
+
+/**
+ * Number of unanswered tcp keepalive probes before the connection is dropped
+ */
+#define TCP_KEEPALIVE_COUNT 3
+
 /**
  * Client data
  */
@@ -43,15 +73,17 @@ struct t_client_data {
     int fd;                          //!< client file descriptor
     enum client_socket_state state;  //!< internal socket state
     sds buf_in;                      //!< incoming buffer
-    sds buf_out;                     //!< outgoing buffer
+    sds buf_out;                     //!< outgoing buffer, reused for all responses
     ssize_t bytes_out;               //!< bytes written to socket
     short events;                    //!< events to poll
     struct t_list waiting_events;    //!< waiting events
+    unsigned events_dropped;         //!< events dropped because the client did not fetch them
     int timeout_fd;                  //!< timer fd for socket timeout
 };
 
 int server_socket_create(struct t_config *config);
-bool server_client_connection_accept(struct t_config *config, int *server_fd);
+int server_socket_tcp_create(struct t_config *config);
+bool server_client_connection_accept(struct t_config *config, int *server_fd, bool tcp);
 bool server_client_connection_handle(struct t_config *config, struct pollfd *client_fd);
 bool server_client_disconnect(struct t_list *clients, struct t_list_node *node);
 struct t_client_data *server_client_connection_new(int client_fd);
@@ -0,0 +1,41 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Stats command handling
+ */
+
+#include "compile_time.h"
+#include "mygpiod/server_socket/stats.h"
+
+#include "mygpiod/lib/stats.h"
+#include "mygpiod/server_socket/response.h"
+
+/**
+ * Stats command handler.
+ * @param config pointer to config
+ * @param client_node client
+ * @return true on success, else false
+ */
+bool handle_stats(struct t_config *config, struct t_list_node *client_node) {
+    struct t_client_data *client_data = (struct t_client_data *)client_node->data;
+    struct t_stats stats;
+    stats_get(config, &stats);
+    server_response_start(client_data);
+    server_response_append_line(client_data, DEFAULT_MSG_OK);
+    server_response_append_kv_uint(client_data, "uptime", stats.uptime);
+    server_response_append_kv_uint(client_data, "events", stats.events);
+    server_response_append_kv_uint(client_data, "actions", stats.actions);
+    server_response_append_kv_uint(client_data, "actions_failed", stats.actions_failed);
+    server_response_append_kv_uint(client_data, "events_dropped", stats.events_dropped);
+    server_response_append_kv_uint(client_data, "timers", stats.timers);
+    server_response_append_kv_uint(client_data, "fds", stats.fds);
+    server_response_append_kv_uint(client_data, "poll_wakeups", stats.poll_wakeups);
+    server_response_append_kv_uint(client_data, "memory", stats.memory);
+    server_response_append_line(client_data, DEFAULT_MSG_END);
+    server_response_end(client_data);
+    return true;
+}
@@ -0,0 +1,20 @@
+/*
+ SPDX-License-Identifier: GPL-3.0-or-later
+ myGPIOd (c) 2020-2026 Juergen Mang <mail@jcgames.de>
+ https://github.com/jcorporation/myGPIOd
+*/
+
+/*! \file
+ * \brief Stats command handling
+ */
+
+#ifndef MYGPIOD_SERVER_STATS_H
+#define MYGPIOD_SERVER_STATS_H
+
+#include "mygpiod/config/config.h"
+
+#include <stdbool.h>
+
+bool handle_stats(struct t_config *config, struct t_list_node *client_node);
+
+#endif
@@ -24,15 +24,15 @@
 bool handle_timerevlist(struct t_config *config, struct t_list_node *client_node) {
     struct t_client_data *client_data = (struct t_client_data *)client_node->data;
     server_response_start(client_data);
-    server_response_append(client_data, "%s", DEFAULT_MSG_OK);
+    server_response_append_line(client_data, DEFAULT_MSG_OK);
     struct t_list_node *current = config->timer_definitions.head;
     while (current != NULL) {
         struct t_timer_definition *data = (struct t_timer_definition *)current->data;
-        server_response_append(client_data, "name:%s", data->name);
-        server_response_append(client_data, "next:%lld", (long long)timer_get_next_expire_ts(data->name, data->fd));
+        server_response_append_kv(client_data, "name", data->name);
+        server_response_append_kv_int(client_data, "next", (int64_t)timer_get_next_expire_ts(data->name, data->fd));
         current = current->next;
     }
-    server_response_append(client_data, "%s", DEFAULT_MSG_END);
+    server_response_append_line(client_data, DEFAULT_MSG_END);
     server_response_end(client_data);
     return true;
 }
@@ -13,6 +13,7 @@
 
 #include "mygpiod/config/config.h"
 #include "mygpiod/config/timer_ev.h"
+#include "mygpiod/lib/metrics.h"
 #include "mygpiod/lib/timer.h"
 #include "mygpiod/timer_ev/action.h"
 #include "mygpiod/timer_ev/timer_ev.h"
@@ -29,6 +30,7 @@ bool timer_ev_handle_event(struct t_config *config, int *fd) {
     if (timerfd_read_value(fd) == false) {
         return false;
     }
+    METRICS_INC(metrics.timer_fires[METRICS_TIMER_EV]);
     timer_ev_action_handle(config, timer_definition);
     timer_log_next_expire(timer_definition->name, timer_definition->fd);
     return true;